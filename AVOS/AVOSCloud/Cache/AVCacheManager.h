@@ -13,9 +13,23 @@
 
 + (AVCacheManager *)sharedInstance;
 
+/// Size limit in bytes of the cached values, beyond which the least recently used ones are evicted. 0 means no limit.
+@property (nonatomic, assign) unsigned long long maxCacheSize;
+
 // cache
 - (void)getWithKey:(NSString *)key maxCacheAge:(NSTimeInterval)maxCacheAge block:(AVIdResultBlock)block;
 - (void)saveJSON:(id)JSON forKey:(NSString *)key;
+/// Saves a value that expires `maxCacheAge` seconds from now, whatever age readers accept.
+- (void)saveJSON:(id)JSON forKey:(NSString *)key maxCacheAge:(NSTimeInterval)maxCacheAge;
+
+// HTTP validators
+/// Saves a response along with its `ETag` and `Last-Modified` header values, either of which may be nil.
+- (void)saveJSON:(id)JSON forKey:(NSString *)key ETag:(NSString *)ETag lastModified:(NSString *)lastModified;
+/// The `If-None-Match` and `If-Modified-Since` header fields for the validators cached with `key`, if any.
+/// Served from memory, it never waits for the database.
+- (NSDictionary<NSString *, NSString *> *)conditionalHeadersForKey:(NSString *)key;
+/// Marks the cached value as fresh again after a 304 response, and gets it whatever its age.
+- (void)revalidateCacheForKey:(NSString *)key block:(AVIdResultBlock)block;
 
 - (BOOL)hasCacheForKey:(NSString *)key;
 - (BOOL)hasCacheForMD5Key:(NSString *)key;
@@ -26,4 +40,6 @@
 + (BOOL)clearCacheMoreThanDays:(NSInteger)numberOfDays;
 - (void)clearCacheForKey:(NSString *)key;
 - (void)clearCacheForMD5Key:(NSString *)key;
+/// Clears the values saved with HTTP validators.
+- (void)clearValidatedCache;
 @end
@@ -10,11 +10,95 @@
 #import "AVErrorUtils.h"
 #import "AVUtils.h"
 #import "AVPersistenceUtils.h"
+#import "LCDatabaseQueue.h"
+#import "LCDatabase.h"
+#import "LCDatabaseAdditions.h"
+#import "LCResultSet.h"
 
+#ifdef DEBUG
+static BOOL shouldLogError = YES;
+#else
+static BOOL shouldLogError = NO;
+#endif
+
+/*
+ All the cached responses live in one SQLite file. Each row is indexed by the MD5 of its key, and
+ carries the size, modification time, last access time and optional expiration time of its value,
+ so lookups, expiry and LRU eviction never touch more than the rows they concern.
+ */
+#define LC_SQL_CREATE_CACHE_TABLE                                                        \
+    @"CREATE TABLE IF NOT EXISTS cache ("                                                \
+        @"key TEXT PRIMARY KEY, value BLOB, format INTEGER, size INTEGER, "              \
+        @"mtime REAL, atime REAL, expires REAL, etag TEXT, last_modified TEXT"           \
+    @");"                                                                                \
+    @"CREATE INDEX IF NOT EXISTS cache_atime ON cache (atime);"                          \
+    @"CREATE INDEX IF NOT EXISTS cache_mtime ON cache (mtime);"                          \
+    @"CREATE INDEX IF NOT EXISTS cache_expires ON cache (expires);"
+
+#define LC_SQL_SELECT_CACHE        @"SELECT value, format, mtime, atime, expires FROM cache WHERE key = ?"
+#define LC_SQL_SELECT_CACHE_EXISTS @"SELECT COUNT(*) FROM cache WHERE key = ? AND (expires IS NULL OR expires > ?)"
+#define LC_SQL_SELECT_VALIDATORS   @"SELECT key, etag, last_modified FROM cache WHERE etag IS NOT NULL OR last_modified IS NOT NULL"
+#define LC_SQL_SELECT_CACHE_SIZE   @"SELECT size FROM cache WHERE key = ?"
+#define LC_SQL_SELECT_TOTAL_SIZE   @"SELECT IFNULL(SUM(size), 0) FROM cache"
+#define LC_SQL_SELECT_LRU          @"SELECT key, size FROM cache ORDER BY atime LIMIT 64"
+#define LC_SQL_UPDATE_CACHE        @"INSERT OR REPLACE INTO cache (key, value, format, size, mtime, atime, expires, etag, last_modified) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)"
+#define LC_SQL_UPDATE_CACHE_ATIME  @"UPDATE cache SET atime = ? WHERE key = ?"
+#define LC_SQL_UPDATE_CACHE_MTIME  @"UPDATE cache SET mtime = ?, atime = ? WHERE key = ?"
+#define LC_SQL_DELETE_CACHE        @"DELETE FROM cache WHERE key = ?"
+#define LC_SQL_DELETE_ALL_CACHE    @"DELETE FROM cache"
+#define LC_SQL_DELETE_OLD_CACHE    @"DELETE FROM cache WHERE mtime < ? OR expires <= ?"
+#define LC_SQL_DELETE_VALIDATED_CACHE @"DELETE FROM cache WHERE etag IS NOT NULL OR last_modified IS NOT NULL"
+
+/// Columns added in schema version 2, for databases created at version 1.
+#define LC_SQL_ADD_VALIDATOR_COLUMNS                     \
+    @"ALTER TABLE cache ADD COLUMN etag TEXT;"           \
+    @"ALTER TABLE cache ADD COLUMN last_modified TEXT;"
+
+/**
+ Version stored in the database's `user_version`.
+ 1: the legacy cache directory is imported. 2: rows carry their HTTP validators.
+ */
+static const uint32_t LCCacheSchemaVersion = 2;
+/// Access times are only rewritten when older than this, which keeps reads of hot keys read-only.
+static const NSTimeInterval LCCacheAccessTimeResolution = 60;
+static const unsigned long long LCCacheDefaultMaxSize = 32 * 1024 * 1024;
+static const NSUInteger LCCacheMemoryCountLimit = 64;
+
+typedef NS_ENUM(NSInteger, LCCacheFormat) {
+    LCCacheFormatJSON = 0,
+    LCCacheFormatKeyedArchive = 1,
+};
+
+/// A decoded value kept in memory, with the times needed to check its freshness without the database.
+@interface LCCacheMemoryEntry : NSObject
+
+@property (nonatomic, strong) id JSON;
+@property (nonatomic, assign) NSTimeInterval modified;
+@property (nonatomic, assign) NSTimeInterval expires;
+
+@end
+
+@implementation LCCacheMemoryEntry
+
+@end
 
 @interface AVCacheManager ()
 @property (nonatomic, copy) NSString *diskCachePath;
 
+/**
+ Recently read values. `memoryGeneration` is bumped by every save and clear, so a value decoded
+ on `cacheQueue` is only kept if nothing changed since the read that produced it was requested.
+ */
+@property (nonatomic, strong) NSCache<NSString *, LCCacheMemoryEntry *> *memoryCache;
+@property (nonatomic, assign) NSUInteger memoryGeneration;
+
+/**
+ The conditional header fields of the rows that carry HTTP validators, so that building a request never waits
+ for the database. Loaded when the database opens and changed along with the rows, always on `cacheQueue`;
+ read from any thread.
+ */
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSDictionary<NSString *, NSString *> *> *conditionalHeaders;
+
 // This is singleton, so the queue doesn't need release
 #if OS_OBJECT_USE_OBJC
 @property (nonatomic, strong) dispatch_queue_t cacheQueue;
@@ -22,6 +106,10 @@
 @property (nonatomic, assign) dispatch_queue_t cacheQueue;
 #endif
 
+/// Only used on `cacheQueue`.
+@property (nonatomic, strong) LCDatabaseQueue *dbQueue;
+@property (nonatomic, assign) unsigned long long totalSize;
+
 @end
 
 @implementation AVCacheManager
@@ -38,46 +126,357 @@
     self = [super init];
     if (self) {
         _cacheQueue = dispatch_queue_create("avos.paas.cacheQueue", DISPATCH_QUEUE_SERIAL);
-        _diskCachePath = [AVCacheManager path];
+        _diskCachePath = [AVPersistenceUtils avCacheDatabasePath];
+        _maxCacheSize = LCCacheDefaultMaxSize;
+        _memoryCache = [[NSCache alloc] init];
+        _memoryCache.countLimit = LCCacheMemoryCountLimit;
+        _conditionalHeaders = [NSMutableDictionary dictionary];
+
+        dispatch_async(_cacheQueue, ^{
+            [self openDatabase];
+        });
     }
     return self;
 }
 
-#pragma mark - Accessors
-+ (NSString *)path {
-    return [AVPersistenceUtils avCacheDirectory];
+#pragma mark - Database
+
+- (void)openDatabase {
+    self.dbQueue = [LCDatabaseQueue databaseQueueWithPath:self.diskCachePath];
+
+    __block uint32_t version = 0;
+
+    [self.dbQueue inDatabase:^(LCDatabase *db) {
+        db.logsErrors = shouldLogError;
+        [db executeStatements:LC_SQL_CREATE_CACHE_TABLE];
+        version = [db userVersion];
+
+        if (version == 1) {
+            [db executeStatements:LC_SQL_ADD_VALIDATOR_COLUMNS];
+            [db setUserVersion:LCCacheSchemaVersion];
+        }
+    }];
+
+    if (version == 0) {
+        [self migrateCacheDirectory];
+    }
+
+    [self.dbQueue inDatabase:^(LCDatabase *db) {
+        self.totalSize = (unsigned long long)[db longForQuery:LC_SQL_SELECT_TOTAL_SIZE];
+    }];
+
+    [self loadConditionalHeaders];
+}
+
+/// Rebuilds the conditional headers from the database. Only used on `cacheQueue`.
+- (void)loadConditionalHeaders {
+    NSMutableDictionary<NSString *, NSDictionary<NSString *, NSString *> *> *conditionalHeaders = [NSMutableDictionary dictionary];
+
+    [self.dbQueue inDatabase:^(LCDatabase *db) {
+        db.logsErrors = shouldLogError;
+
+        LCResultSet *result = [db executeQuery:LC_SQL_SELECT_VALIDATORS];
+
+        while ([result next]) {
+            conditionalHeaders[[result stringForColumnIndex:0]] = [self conditionalHeadersWithETag:[result stringForColumnIndex:1]
+                                                                                      lastModified:[result stringForColumnIndex:2]];
+        }
+
+        [result close];
+    }];
+
+    @synchronized (self.conditionalHeaders) {
+        [self.conditionalHeaders setDictionary:conditionalHeaders];
+    }
+}
+
+- (NSDictionary<NSString *, NSString *> *)conditionalHeadersWithETag:(NSString *)ETag lastModified:(NSString *)lastModified {
+    NSMutableDictionary<NSString *, NSString *> *headers = [NSMutableDictionary dictionary];
+    headers[@"If-None-Match"] = ETag;
+    headers[@"If-Modified-Since"] = lastModified;
+    return headers.count ? [headers copy] : nil;
+}
+
+/// Sets or, if `headers` is nil, removes the conditional headers of `key`, or of every key if `key` is nil.
+- (void)setConditionalHeaders:(NSDictionary<NSString *, NSString *> *)headers forMD5Key:(NSString *)key {
+    @synchronized (self.conditionalHeaders) {
+        if (!key) {
+            [self.conditionalHeaders removeAllObjects];
+        } else if (headers) {
+            self.conditionalHeaders[key] = headers;
+        } else {
+            [self.conditionalHeaders removeObjectForKey:key];
+        }
+    }
+}
+
+/// Imports the files written by the previous file-per-key layout, keeping their modification times.
+- (void)migrateCacheDirectory {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSString *directory = [AVPersistenceUtils avCacheDirectory];
+
+    [self.dbQueue inTransaction:^(LCDatabase *db, BOOL *rollback) {
+        db.logsErrors = shouldLogError;
+
+        for (NSString *fileName in [fileManager contentsOfDirectoryAtPath:directory error:NULL]) {
+            NSString *path = [directory stringByAppendingPathComponent:fileName];
+            NSDate *lastModified = [AVPersistenceUtils lastModified:path];
+            id JSON = [AVPersistenceUtils getJSONFromPath:path];
+
+            if (JSON && lastModified) {
+                [self saveJSON:JSON forMD5Key:fileName modified:[lastModified timeIntervalSince1970] expires:0 ETag:nil lastModified:nil database:db];
+            }
+        }
+
+        [db setUserVersion:LCCacheSchemaVersion];
+    }];
+
+    [fileManager removeItemAtPath:directory error:NULL];
+}
+
+- (NSData *)dataWithJSON:(id)JSON format:(LCCacheFormat *)format {
+    if ([NSJSONSerialization isValidJSONObject:JSON]) {
+        *format = LCCacheFormatJSON;
+        return [NSJSONSerialization dataWithJSONObject:JSON options:0 error:NULL];
+    }
+
+    *format = LCCacheFormatKeyedArchive;
+    return [NSKeyedArchiver archivedDataWithRootObject:JSON];
+}
+
+- (id)JSONWithData:(NSData *)data format:(LCCacheFormat)format {
+    if (!data) {
+        return nil;
+    }
+
+    @try {
+        switch (format) {
+            case LCCacheFormatJSON:
+                return [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL];
+            case LCCacheFormatKeyedArchive:
+                return [NSKeyedUnarchiver unarchiveObjectWithData:data];
+        }
+    } @catch (NSException *exception) {
+        // Treat an undecodable value as a miss.
+    }
+
+    return nil;
+}
+
+- (BOOL)saveJSON:(id)JSON
+       forMD5Key:(NSString *)key
+        modified:(NSTimeInterval)modified
+         expires:(NSTimeInterval)expires
+            ETag:(NSString *)ETag
+    lastModified:(NSString *)lastModified
+        database:(LCDatabase *)db
+{
+    if (![JSON isKindOfClass:[NSDictionary class]] && ![JSON isKindOfClass:[NSArray class]]) {
+        return NO;
+    }
+
+    LCCacheFormat format;
+    NSData *data = [self dataWithJSON:JSON format:&format];
+
+    if (!data) {
+        return NO;
+    }
+
+    long oldSize = [db longForQuery:LC_SQL_SELECT_CACHE_SIZE, key];
+    NSArray *args = @[key, data, @(format), @(data.length), @(modified), @(modified),
+                      (expires > 0 ? @(expires) : [NSNull null]),
+                      ETag ?: [NSNull null],
+                      lastModified ?: [NSNull null]];
+
+    if (![db executeUpdate:LC_SQL_UPDATE_CACHE withArgumentsInArray:args]) {
+        return NO;
+    }
+
+    self.totalSize = self.totalSize - (unsigned long long)oldSize + data.length;
+    [self setConditionalHeaders:[self conditionalHeadersWithETag:ETag lastModified:lastModified] forMD5Key:key];
+
+    return YES;
+}
+
+/// Evicts the least recently used values until the cache is back under three quarters of its size limit.
+- (void)evictIfNeeded {
+    unsigned long long maxCacheSize = self.maxCacheSize;
+
+    if (!maxCacheSize || self.totalSize <= maxCacheSize) {
+        return;
+    }
+
+    unsigned long long targetSize = maxCacheSize / 4 * 3;
+
+    [self.dbQueue inTransaction:^(LCDatabase *db, BOOL *rollback) {
+        db.logsErrors = shouldLogError;
+
+        while (self.totalSize > targetSize) {
+            /* Key and size pairs, least recently used first. */
+            NSMutableArray<NSArray *> *rows = [NSMutableArray array];
+            LCResultSet *result = [db executeQuery:LC_SQL_SELECT_LRU];
+
+            while ([result next]) {
+                [rows addObject:@[[result stringForColumnIndex:0], @([result longLongIntForColumnIndex:1])]];
+            }
+
+            [result close];
+
+            if (!rows.count) {
+                self.totalSize = 0;
+                break;
+            }
+
+            for (NSArray *row in rows) {
+                if (self.totalSize <= targetSize) {
+                    break;
+                }
+
+                NSString *key = row[0];
+                [db executeUpdate:LC_SQL_DELETE_CACHE, key];
+                [self setConditionalHeaders:nil forMD5Key:key];
+                [self invalidateMemoryCacheForMD5Key:key];
+                self.totalSize -= MIN(self.totalSize, [row[1] unsignedLongLongValue]);
+            }
+        }
+    }];
+}
+
+- (void)removeCacheForMD5Key:(NSString *)key {
+    [self.dbQueue inDatabase:^(LCDatabase *db) {
+        db.logsErrors = shouldLogError;
+
+        long size = [db longForQuery:LC_SQL_SELECT_CACHE_SIZE, key];
+
+        if ([db executeUpdate:LC_SQL_DELETE_CACHE, key] && [db changes]) {
+            self.totalSize -= MIN(self.totalSize, (unsigned long long)size);
+        }
+        [self setConditionalHeaders:nil forMD5Key:key];
+    }];
+}
+
+#pragma mark - Memory Cache
+
+/// Drops `key` from the memory cache, or everything if `key` is nil.
+- (void)invalidateMemoryCacheForMD5Key:(NSString *)key {
+    @synchronized (self.memoryCache) {
+        if (key) {
+            [self.memoryCache removeObjectForKey:key];
+        } else {
+            [self.memoryCache removeAllObjects];
+        }
+        self.memoryGeneration += 1;
+    }
+}
+
+- (NSUInteger)currentMemoryGeneration {
+    @synchronized (self.memoryCache) {
+        return self.memoryGeneration;
+    }
+}
+
+- (void)cacheEntry:(LCCacheMemoryEntry *)entry forMD5Key:(NSString *)key generation:(NSUInteger)generation {
+    @synchronized (self.memoryCache) {
+        if (generation == self.memoryGeneration) {
+            [self.memoryCache setObject:entry forKey:key];
+        }
+    }
 }
 
-- (NSString *)pathForKey:(NSString *)key {
-    return [self.diskCachePath stringByAppendingPathComponent:key];
+/// Returns the value if the memory cache has it and it is fresh enough.
+- (id)memoryCachedJSONForMD5Key:(NSString *)key maxCacheAge:(NSTimeInterval)maxCacheAge {
+    NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+
+    @synchronized (self.memoryCache) {
+        LCCacheMemoryEntry *entry = [self.memoryCache objectForKey:key];
+
+        if (!entry || (entry.expires > 0 && entry.expires <= now) || now - entry.modified > maxCacheAge) {
+            return nil;
+        }
+
+        return entry.JSON;
+    }
+}
+
+#pragma mark - Accessors
++ (NSString *)path {
+    return [AVPersistenceUtils avCacheDatabasePath];
 }
 
 - (BOOL)hasCacheForKey:(NSString *)key {
-    return [[NSFileManager defaultManager] fileExistsAtPath:[self pathForKey:[key AVMD5String]]];
+    return [self hasCacheForMD5Key:[key AVMD5String]];
 }
 - (BOOL)hasCacheForMD5Key:(NSString *)key {
-    return [[NSFileManager defaultManager] fileExistsAtPath:[self pathForKey:key]];
+    __block BOOL hasCache = NO;
+    dispatch_sync(self.cacheQueue, ^{
+        [self.dbQueue inDatabase:^(LCDatabase *db) {
+            hasCache = [db longForQuery:LC_SQL_SELECT_CACHE_EXISTS, key, @([[NSDate date] timeIntervalSince1970])] > 0;
+        }];
+    });
+    return hasCache;
 }
 
 - (void)getWithKey:(NSString *)key maxCacheAge:(NSTimeInterval)maxCacheAge block:(AVIdResultBlock)block {
+    NSString *MD5Key = [key AVMD5String];
+    id memoryResult = (maxCacheAge > 0 ? [self memoryCachedJSONForMD5Key:MD5Key maxCacheAge:maxCacheAge] : nil);
+
+    if (memoryResult) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (block) block(memoryResult, nil);
+        });
+        return;
+    }
+
+    NSUInteger generation = [self currentMemoryGeneration];
+
     dispatch_async(self.cacheQueue, ^{
-        
-        BOOL isTooOld = NO;
-        id diskResult =nil;
-        if (maxCacheAge<=0) {
-            isTooOld=YES;
-        } else {
-             diskResult=[AVPersistenceUtils getJSONFromPath:[self pathForKey:[key AVMD5String]]];
-            if (diskResult && maxCacheAge > 0) {
-                NSDate *lastModified = [AVPersistenceUtils lastModified:[self pathForKey:[key AVMD5String]]];
-                if ([[NSDate date] timeIntervalSinceDate:lastModified] > maxCacheAge) {
-                    isTooOld = YES;
+
+        id diskResult = nil;
+        if (maxCacheAge > 0) {
+            NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+            __block NSData *data = nil;
+            __block LCCacheFormat format = LCCacheFormatJSON;
+            __block NSTimeInterval modified = 0, accessed = 0, expires = 0;
+
+            [self.dbQueue inDatabase:^(LCDatabase *db) {
+                db.logsErrors = shouldLogError;
+
+                LCResultSet *result = [db executeQuery:LC_SQL_SELECT_CACHE, MD5Key];
+
+                if ([result next]) {
+                    data = [result dataForColumnIndex:0];
+                    format = [result intForColumnIndex:1];
+                    modified = [result doubleForColumnIndex:2];
+                    accessed = [result doubleForColumnIndex:3];
+                    expires = [result doubleForColumnIndex:4];
+                }
+
+                [result close];
+            }];
+
+            if (expires > 0 && expires <= now) {
+                [self removeCacheForMD5Key:MD5Key];
+            } else if (data && now - modified <= maxCacheAge) {
+                diskResult = [self JSONWithData:data format:format];
+
+                if (diskResult) {
+                    LCCacheMemoryEntry *entry = [[LCCacheMemoryEntry alloc] init];
+                    entry.JSON = diskResult;
+                    entry.modified = modified;
+                    entry.expires = expires;
+                    [self cacheEntry:entry forMD5Key:MD5Key generation:generation];
+                }
+
+                if (diskResult && now - accessed > LCCacheAccessTimeResolution) {
+                    [self.dbQueue inDatabase:^(LCDatabase *db) {
+                        [db executeUpdate:LC_SQL_UPDATE_CACHE_ATIME, @(now), MD5Key];
+                    }];
                 }
             }
         }
-        
+
         dispatch_async(dispatch_get_main_queue(), ^{
-            if (diskResult && !isTooOld) {
+            if (diskResult) {
                 if (block) block(diskResult, nil);
             } else {
                 if (block) block(nil, LCError(kAVErrorCacheMiss, nil, nil));
@@ -86,25 +485,87 @@
     });
 }
 
+- (void)revalidateCacheForKey:(NSString *)key block:(AVIdResultBlock)block {
+    NSString *MD5Key = [key AVMD5String];
+    NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+
+    @synchronized (self.memoryCache) {
+        [self.memoryCache objectForKey:MD5Key].modified = now;
+    }
+
+    dispatch_async(self.cacheQueue, ^{
+        [self.dbQueue inDatabase:^(LCDatabase *db) {
+            db.logsErrors = shouldLogError;
+            [db executeUpdate:LC_SQL_UPDATE_CACHE_MTIME, @(now), @(now), MD5Key];
+        }];
+    });
+
+    [self getWithKey:key maxCacheAge:DBL_MAX block:block];
+}
+
+- (NSDictionary<NSString *, NSString *> *)conditionalHeadersForKey:(NSString *)key {
+    NSString *MD5Key = [key AVMD5String];
+
+    // Until the database is open, the request simply goes unconditional.
+    @synchronized (self.conditionalHeaders) {
+        return self.conditionalHeaders[MD5Key] ?: @{};
+    }
+}
+
 - (void)saveJSON:(id)JSON forKey:(NSString *)key {
+    [self saveJSON:JSON forKey:key maxCacheAge:0 ETag:nil lastModified:nil];
+}
+
+- (void)saveJSON:(id)JSON forKey:(NSString *)key maxCacheAge:(NSTimeInterval)maxCacheAge {
+    [self saveJSON:JSON forKey:key maxCacheAge:maxCacheAge ETag:nil lastModified:nil];
+}
+
+- (void)saveJSON:(id)JSON forKey:(NSString *)key ETag:(NSString *)ETag lastModified:(NSString *)lastModified {
+    [self saveJSON:JSON forKey:key maxCacheAge:0 ETag:ETag lastModified:lastModified];
+}
+
+- (void)saveJSON:(id)JSON forKey:(NSString *)key maxCacheAge:(NSTimeInterval)maxCacheAge ETag:(NSString *)ETag lastModified:(NSString *)lastModified {
+    [self invalidateMemoryCacheForMD5Key:[key AVMD5String]];
+
+    // Visible to the next request right away; set again on `cacheQueue` once the row is written.
+    if ([JSON isKindOfClass:[NSDictionary class]] || [JSON isKindOfClass:[NSArray class]]) {
+        [self setConditionalHeaders:[self conditionalHeadersWithETag:ETag lastModified:lastModified] forMD5Key:[key AVMD5String]];
+    }
+
     dispatch_async(self.cacheQueue, ^{
-        [AVPersistenceUtils saveJSON:JSON toPath:[self pathForKey:[key AVMD5String]]];
+        NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+
+        [self.dbQueue inDatabase:^(LCDatabase *db) {
+            db.logsErrors = shouldLogError;
+            [self saveJSON:JSON
+                 forMD5Key:[key AVMD5String]
+                  modified:now
+                   expires:(maxCacheAge > 0 ? now + maxCacheAge : 0)
+                      ETag:ETag
+              lastModified:lastModified
+                  database:db];
+        }];
+
+        [self evictIfNeeded];
     });
 }
 
 #pragma mark - Clear Cache
 + (BOOL)clearAllCache {
+    AVCacheManager *cacheManager = [AVCacheManager sharedInstance];
     BOOL __block success;
-    dispatch_sync([AVCacheManager sharedInstance].cacheQueue, ^{
-        NSString *path = [AVCacheManager path];
-        success = [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
-        // ignore create diectory error
-        [[NSFileManager defaultManager] createDirectoryAtPath:path
-                                  withIntermediateDirectories:YES
-                                                   attributes:nil
-                                                        error:NULL];
+    [cacheManager invalidateMemoryCacheForMD5Key:nil];
+    dispatch_sync(cacheManager.cacheQueue, ^{
+        [cacheManager.dbQueue inDatabase:^(LCDatabase *db) {
+            db.logsErrors = shouldLogError;
+            success = [db executeUpdate:LC_SQL_DELETE_ALL_CACHE];
+        }];
+        if (success) {
+            cacheManager.totalSize = 0;
+            [cacheManager setConditionalHeaders:nil forMD5Key:nil];
+        }
     });
-    
+
     return success;
 }
 
@@ -113,25 +574,47 @@
 }
 
 + (BOOL)clearCacheMoreThanDays:(NSInteger)numberOfDays {
+    AVCacheManager *cacheManager = [AVCacheManager sharedInstance];
     BOOL __block success = NO;
-    
+    [cacheManager invalidateMemoryCacheForMD5Key:nil];
+
     // 为了避免冲突把读写cache的操作都放在cacheQueue里面, 这里是同步的block删除
-    dispatch_sync([AVCacheManager sharedInstance].cacheQueue, ^{
-        [AVPersistenceUtils deleteFilesInDirectory:[AVCacheManager path] moreThanDays:numberOfDays];
+    dispatch_sync(cacheManager.cacheQueue, ^{
+        NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+        [cacheManager.dbQueue inDatabase:^(LCDatabase *db) {
+            db.logsErrors = shouldLogError;
+            success = [db executeUpdate:LC_SQL_DELETE_OLD_CACHE, @(now - numberOfDays * 24 * 3600), @(now)];
+            if (success && [db changes]) {
+                cacheManager.totalSize = (unsigned long long)[db longForQuery:LC_SQL_SELECT_TOTAL_SIZE];
+            }
+        }];
+        [cacheManager loadConditionalHeaders];
     });
-    
+
     return success;
 }
 
-- (void)clearCacheForKey:(NSString *)key {
+- (void)clearValidatedCache {
+    [self invalidateMemoryCacheForMD5Key:nil];
     dispatch_sync(self.cacheQueue, ^{
-        [[NSFileManager defaultManager] removeItemAtPath:[self pathForKey:[key AVMD5String]] error:NULL];
+        [self.dbQueue inDatabase:^(LCDatabase *db) {
+            db.logsErrors = shouldLogError;
+            if ([db executeUpdate:LC_SQL_DELETE_VALIDATED_CACHE] && [db changes]) {
+                self.totalSize = (unsigned long long)[db longForQuery:LC_SQL_SELECT_TOTAL_SIZE];
+            }
+        }];
+        [self setConditionalHeaders:nil forMD5Key:nil];
     });
 }
 
+- (void)clearCacheForKey:(NSString *)key {
+    [self clearCacheForMD5Key:[key AVMD5String]];
+}
+
 - (void)clearCacheForMD5Key:(NSString *)key {
+    [self invalidateMemoryCacheForMD5Key:key];
     dispatch_sync(self.cacheQueue, ^{
-        [[NSFileManager defaultManager] removeItemAtPath:[self pathForKey:key] error:NULL];
+        [self removeCacheForMD5Key:key];
     });
 }
 @end
@@ -14,6 +14,7 @@
 + (NSString *)homeDirectoryLibraryCachesLeanCloudCachesRouter;
 
 + (NSString *)avCacheDirectory;
++ (NSString *)avCacheDatabasePath;
 
 + (NSString *)currentUserArchivePath;
 + (NSString *)currentUserClassArchivePath;
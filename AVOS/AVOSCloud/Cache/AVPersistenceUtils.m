@@ -100,13 +100,18 @@
     return path;
 }
 
-// ~/Library/Caches/AVPaasCache, for AVCacheManager
+// ~/Library/Caches/AVPaasCache, the file-per-key layout AVCacheManager migrates from
 + (NSString *)avCacheDirectory {
     NSString *ret = [[AVPersistenceUtils homeDirectoryLibraryCaches] stringByAppendingPathComponent:@"AVPaasCache"];
     [self createDirectoryIfNeeded:ret];
     return ret;
 }
 
+// ~/Library/Caches/AVPaasCache.db, for AVCacheManager
++ (NSString *)avCacheDatabasePath {
+    return [[AVPersistenceUtils homeDirectoryLibraryCaches] stringByAppendingPathComponent:@"AVPaasCache.db"];
+}
+
 // ~/Library/Caches/LeanCloud/MessageCache
 + (NSString *)messageCachePath {
     NSString *path = [self homeDirectoryLibraryCaches];
@@ -44,6 +44,13 @@ FOUNDATION_EXPORT NSString *const LCHeaderFieldNameProduction;
 
 @property (nonatomic, strong) NSLock *lock;
 
+/// Cache policy lookups answered by the response cache.
+@property (nonatomic, readonly) NSUInteger cacheHitCount;
+/// Cache policy lookups the response cache could not answer.
+@property (nonatomic, readonly) NSUInteger cacheMissCount;
+/// Cacheable GETs that joined an identical request already in flight instead of sending their own.
+@property (nonatomic, readonly) NSUInteger collapsedRequestCount;
+
 -(void)clearLastModifyCache;
 
 - (AVACL *)updatedDefaultACL;
@@ -102,7 +109,7 @@ FOUNDATION_EXPORT NSString *const LCHeaderFieldNameProduction;
 -(Class)classFor:(NSString *)parseClassName;
 
 // offline
-// TODO: never called this yet!
+/// Replays the journaled eventually requests in order. Does nothing while a replay is running.
 - (void)handleAllArchivedRequests;
 
 #pragma mark - Network Utils
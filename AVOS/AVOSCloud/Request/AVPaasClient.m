@@ -27,6 +27,24 @@ static NSString * const kLC_error = @"error";
 
 #define MAX_LAG_TIME 5.0
 
+/* A copy of a JSON result with fresh containers, leaves (strings, numbers and nulls) are immutable and shared. */
+static id LCJSONObjectCopy(id object) {
+    if ([object isKindOfClass:[NSDictionary class]]) {
+        NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithCapacity:[object count]];
+        [object enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+            dictionary[key] = LCJSONObjectCopy(value);
+        }];
+        return dictionary;
+    } else if ([object isKindOfClass:[NSArray class]]) {
+        NSMutableArray *array = [NSMutableArray arrayWithCapacity:[object count]];
+        for (id value in object) {
+            [array addObject:LCJSONObjectCopy(value)];
+        }
+        return array;
+    }
+    return object;
+}
+
 NSString *const LCHeaderFieldNameId = @"X-LC-Id";
 NSString *const LCHeaderFieldNameKey = @"X-LC-Key";
 NSString *const LCHeaderFieldNameSign = @"X-LC-Sign";
@@ -109,15 +127,348 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
 }
 @end
 
-@interface AVPaasClient()
+#pragma mark - Eventually journal
+
+/*
+ The requests saved for eventual delivery are appended to one journal file, as records of
+ `[length][CRC32][payload]` with both integers in big endian. A payload is the JSON of either a
+ request, or the acknowledgement of a request's sequence number. A torn or corrupted tail, left by a
+ crash in the middle of an append, is detected by the length and checksum, and truncated on load.
+ */
+static const char LCEventuallyJournalMagic[4] = {'L', 'C', 'J', '1'};
+static NSString * const LCEventuallyJournalFileName = @"journal";
+/// The journal is rewritten with only its pending requests once more requests than this are acknowledged.
+static const NSUInteger LCEventuallyJournalCompactionThreshold = 64;
+
+static uint32_t LCCRC32(const uint8_t *bytes, NSUInteger length) {
+    static uint32_t table[256];
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+            }
+            table[i] = c;
+        }
+    });
+    uint32_t crc = 0xFFFFFFFF;
+    for (NSUInteger i = 0; i < length; i++) {
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+@implementation LCEventuallyEntry {
+    AVIdResultBlock _block;
+}
+
+- (instancetype)initWithBlock:(AVIdResultBlock)block {
+    self = [super init];
+    if (self) {
+        _block = [block copy];
+    }
+    return self;
+}
+
+- (AVIdResultBlock)takeBlock {
+    @synchronized (self) {
+        AVIdResultBlock block = _block;
+        _block = nil;
+        return block;
+    }
+}
+
+@end
+
+@implementation LCEventuallyJournal {
+    NSString *_directory;
+    NSString *_path;
+    NSFileHandle *_fileHandle;
+    NSMutableArray<LCEventuallyEntry *> *_entries;
+    NSUInteger _acknowledgedCount;
+    uint64_t _nextSequence;
+    BOOL _replaying;
+}
+
+- (instancetype)initWithDirectory:(NSString *)directory {
+    self = [super init];
+    if (self) {
+        _directory = [directory copy];
+        _path = [directory stringByAppendingPathComponent:LCEventuallyJournalFileName];
+        _entries = [NSMutableArray array];
+        _nextSequence = 1;
+        [self load];
+        [self importArchivedRequests];
+    }
+    return self;
+}
+
+#pragma mark Records
+
++ (NSData *)recordWithPayload:(NSDictionary *)payload {
+    NSData *JSONData = [NSJSONSerialization dataWithJSONObject:payload options:0 error:NULL];
+    if (!JSONData) {
+        return nil;
+    }
+    uint32_t header[2] = {
+        CFSwapInt32HostToBig((uint32_t)JSONData.length),
+        CFSwapInt32HostToBig(LCCRC32(JSONData.bytes, JSONData.length)),
+    };
+    NSMutableData *record = [NSMutableData dataWithBytes:header length:sizeof(header)];
+    [record appendData:JSONData];
+    return record;
+}
+
++ (NSDictionary *)payloadWithEntry:(LCEventuallyEntry *)entry {
+    NSURLRequest *request = entry.request;
+    NSMutableDictionary *payload = [NSMutableDictionary dictionary];
+    payload[@"sequence"] = @(entry.sequence);
+    payload[@"method"] = request.HTTPMethod ?: @"GET";
+    payload[@"URL"] = request.URL.absoluteString ?: @"";
+    payload[@"headers"] = request.allHTTPHeaderFields ?: @{};
+    if (request.HTTPBody) {
+        payload[@"body"] = [request.HTTPBody base64EncodedStringWithOptions:0];
+    }
+    if (entry.path) {
+        payload[@"path"] = entry.path;
+    }
+    if (entry.parameters) {
+        payload[@"parameters"] = entry.parameters;
+    }
+    return payload;
+}
+
++ (LCEventuallyEntry *)entryWithPayload:(NSDictionary *)payload {
+    NSURL *URL = [NSURL URLWithString:payload[@"URL"]];
+    if (!URL) {
+        return nil;
+    }
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:URL];
+    request.HTTPMethod = payload[@"method"];
+    request.allHTTPHeaderFields = payload[@"headers"];
+    if (payload[@"body"]) {
+        request.HTTPBody = [[NSData alloc] initWithBase64EncodedString:payload[@"body"] options:0];
+    }
+    LCEventuallyEntry *entry = [[LCEventuallyEntry alloc] initWithBlock:nil];
+    entry.sequence = [payload[@"sequence"] unsignedLongLongValue];
+    entry.request = request;
+    entry.path = payload[@"path"];
+    entry.parameters = payload[@"parameters"];
+    return entry;
+}
+
+#pragma mark File
+
+- (void)load {
+    NSData *data = [NSData dataWithContentsOfFile:_path];
+    const uint8_t *bytes = data.bytes;
+    NSUInteger length = data.length;
+    NSUInteger offset = 0;
+    
+    if (length >= sizeof(LCEventuallyJournalMagic) && memcmp(bytes, LCEventuallyJournalMagic, sizeof(LCEventuallyJournalMagic)) == 0) {
+        offset = sizeof(LCEventuallyJournalMagic);
+        NSMutableDictionary<NSNumber *, LCEventuallyEntry *> *entries = [NSMutableDictionary dictionary];
+        
+        while (offset + 2 * sizeof(uint32_t) <= length) {
+            uint32_t header[2];
+            memcpy(header, bytes + offset, sizeof(header));
+            NSUInteger payloadLength = CFSwapInt32BigToHost(header[0]);
+            if (offset + sizeof(header) + payloadLength > length ||
+                LCCRC32(bytes + offset + sizeof(header), payloadLength) != CFSwapInt32BigToHost(header[1])) {
+                break;
+            }
+            NSData *record = [data subdataWithRange:NSMakeRange(offset, sizeof(header) + payloadLength)];
+            NSDictionary *payload = [NSJSONSerialization JSONObjectWithData:[record subdataWithRange:NSMakeRange(sizeof(header), payloadLength)] options:0 error:NULL];
+            if (![payload isKindOfClass:[NSDictionary class]]) {
+                break;
+            }
+            offset += record.length;
+            
+            NSNumber *acknowledged = payload[@"ack"];
+            if (acknowledged) {
+                [entries removeObjectForKey:acknowledged];
+                _acknowledgedCount += 1;
+                continue;
+            }
+            LCEventuallyEntry *entry = [LCEventuallyJournal entryWithPayload:payload];
+            if (entry) {
+                entry.record = record;
+                entries[@(entry.sequence)] = entry;
+                _nextSequence = MAX(_nextSequence, entry.sequence + 1);
+            }
+        }
+        
+        for (NSNumber *sequence in [entries.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+            [_entries addObject:entries[sequence]];
+        }
+    }
+    
+    if (offset == 0) {
+        [[NSData dataWithBytes:LCEventuallyJournalMagic length:sizeof(LCEventuallyJournalMagic)] writeToFile:_path atomically:YES];
+        offset = sizeof(LCEventuallyJournalMagic);
+    }
+    
+    _fileHandle = [NSFileHandle fileHandleForWritingAtPath:_path];
+    
+    if (offset < length) {
+        /* Drop the torn tail, so that the next record is appended after the last valid one. */
+        [_fileHandle truncateFileAtOffset:offset];
+    }
+}
+
+/// Moves the requests archived one per file by earlier versions into the journal, in the order they were made.
+- (void)importArchivedRequests {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSMutableArray<NSString *> *fileNames = [NSMutableArray array];
+    
+    for (NSString *fileName in [fileManager contentsOfDirectoryAtPath:_directory error:NULL]) {
+        if ([fileName doubleValue] > 0) {
+            [fileNames addObject:fileName];
+        }
+    }
+    [fileNames sortUsingComparator:^NSComparisonResult(NSString *fileName1, NSString *fileName2) {
+        return [@([fileName1 doubleValue]) compare:@([fileName2 doubleValue])];
+    }];
+    
+    for (NSString *fileName in fileNames) {
+        NSString *path = [_directory stringByAppendingPathComponent:fileName];
+        NSURLRequest *request = nil;
+        @try {
+            request = [NSKeyedUnarchiver unarchiveObjectWithFile:path];
+        } @catch (NSException *exception) {
+            request = nil;
+        }
+        if ([request isKindOfClass:[NSURLRequest class]]) {
+            [self appendRequest:request path:nil parameters:nil block:nil];
+        }
+        [fileManager removeItemAtPath:path error:NULL];
+    }
+}
+
+- (BOOL)writeRecords:(NSData *)records {
+    @try {
+        [_fileHandle seekToEndOfFile];
+        [_fileHandle writeData:records];
+        [_fileHandle synchronizeFile];
+        return YES;
+    } @catch (NSException *exception) {
+        AVLoggerError(AVLoggerDomainStorage, @"Failed to write the eventually journal: %@", exception);
+        return NO;
+    }
+}
+
+/// Rewrites the journal with only the pending requests. The new file replaces the old one atomically.
+- (void)compact {
+    NSMutableData *data = [NSMutableData dataWithBytes:LCEventuallyJournalMagic length:sizeof(LCEventuallyJournalMagic)];
+    for (LCEventuallyEntry *entry in _entries) {
+        [data appendData:entry.record];
+    }
+    if (![data writeToFile:_path options:NSDataWritingAtomic error:NULL]) {
+        return;
+    }
+    [_fileHandle closeFile];
+    _fileHandle = [NSFileHandle fileHandleForWritingAtPath:_path];
+    _acknowledgedCount = 0;
+}
+
+#pragma mark Entries
+
+- (void)appendRequest:(NSURLRequest *)request path:(NSString *)path parameters:(NSDictionary *)parameters block:(AVIdResultBlock)block {
+    LCEventuallyEntry *entry = [[LCEventuallyEntry alloc] initWithBlock:block];
+    entry.request = request;
+    entry.path = path;
+    entry.parameters = parameters;
+    
+    @synchronized (self) {
+        entry.sequence = _nextSequence++;
+        entry.record = [LCEventuallyJournal recordWithPayload:[LCEventuallyJournal payloadWithEntry:entry]];
+        
+        if (!entry.record) {
+            /* Parameters which can not be written as JSON are only journaled in their serialized form. */
+            entry.path = nil;
+            entry.parameters = nil;
+            entry.record = [LCEventuallyJournal recordWithPayload:[LCEventuallyJournal payloadWithEntry:entry]];
+        }
+        
+        /* The request is still replayed in this launch if it can not be written. */
+        [self writeRecords:entry.record];
+        [_entries addObject:entry];
+    }
+}
+
+- (BOOL)beginReplay {
+    @synchronized (self) {
+        if (_replaying) {
+            return NO;
+        }
+        _replaying = YES;
+        return YES;
+    }
+}
+
+- (NSArray<LCEventuallyEntry *> *)entriesToReplay {
+    @synchronized (self) {
+        if (!_entries.count) {
+            _replaying = NO;
+            return nil;
+        }
+        return [_entries copy];
+    }
+}
+
+- (void)endReplay {
+    @synchronized (self) {
+        _replaying = NO;
+    }
+}
+
+- (void)acknowledgeEntries:(NSArray<LCEventuallyEntry *> *)entries {
+    if (!entries.count) {
+        return;
+    }
+    @synchronized (self) {
+        NSMutableData *records = [NSMutableData data];
+        for (LCEventuallyEntry *entry in entries) {
+            [records appendData:[LCEventuallyJournal recordWithPayload:@{@"ack": @(entry.sequence)}]];
+        }
+        [_entries removeObjectsInArray:entries];
+        _acknowledgedCount += entries.count;
+        
+        if (!_entries.count) {
+            [_fileHandle truncateFileAtOffset:sizeof(LCEventuallyJournalMagic)];
+            [_fileHandle synchronizeFile];
+            _acknowledgedCount = 0;
+        } else if (_acknowledgedCount >= LCEventuallyJournalCompactionThreshold && _acknowledgedCount > _entries.count) {
+            [self compact];
+        } else {
+            [self writeRecords:records];
+        }
+    }
+}
+
+@end
+
+@interface AVPaasClient() {
+    NSUInteger _cacheHitCount;
+    NSUInteger _cacheMissCount;
+    NSUInteger _collapsedRequestCount;
+}
 
 @property (nonatomic, strong) LCURLSessionManager *sessionManager;
 
 @property (nonatomic, strong) dispatch_queue_t completionQueue;
 
-@property (nonatomic, strong) NSMutableSet *runningArchivedRequests;
+#if !TARGET_OS_WATCH
+/// Replays the eventually journal when the network becomes reachable.
+@property (nonatomic, strong) LCNetworkReachabilityManager *reachabilityManager;
+#endif
+
+/// Delay of the next retry of the eventually journal after a failed replay. Guarded by `lock`.
+@property (nonatomic, assign) NSTimeInterval eventuallyRetryInterval;
 
-@property (atomic, strong) NSMutableDictionary *lastModify;
+/// Callbacks waiting on each cacheable GET in flight, keyed by its session token and absolute URL string. Guarded by `lock`.
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray<AVIdResultBlock> *> *inflightGetBlocks;
 
 @end
 
@@ -136,7 +487,10 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
         sharedInstance.applicationKeyField = LCHeaderFieldNameKey;
         sharedInstance.sessionTokenField = LCHeaderFieldNameSession;
         
-        sharedInstance.runningArchivedRequests=[[NSMutableSet alloc] init];
+        sharedInstance.eventuallyJournal = [[LCEventuallyJournal alloc] initWithDirectory:[AVPersistenceUtils eventuallyPath]];
+#if !TARGET_OS_WATCH
+        [sharedInstance startMonitoringReachability];
+#endif
         
         [AVScheduler sharedInstance];
     });
@@ -161,6 +515,7 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
             manager;
         });
         _lock = [[NSLock alloc] init];
+        _inflightGetBlocks = [NSMutableDictionary dictionary];
     }
     
     return self;
@@ -171,28 +526,8 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
     [_sessionManager invalidateSessionCancelingTasks:YES];
 }
 
--(void)setIsLastModifyEnabled:(BOOL)isLastModifyEnabled{
-    if (_isLastModifyEnabled==isLastModifyEnabled) {
-        return;
-    }
-    _isLastModifyEnabled=isLastModifyEnabled;
-    if (_isLastModifyEnabled) {
-        //FIXME: 永久化
-        self.lastModify=[[NSMutableDictionary alloc] init];
-        
-    } else {
-        self.lastModify=nil;
-    }
-}
-
 -(void)clearLastModifyCache {
-    if (self.lastModify.count) {
-        for (NSString *key in self.lastModify) {
-            [[AVCacheManager sharedInstance] clearCacheForMD5Key:key];
-        }
-        
-        [self.lastModify removeAllObjects];
-    }
+    [[AVCacheManager sharedInstance] clearValidatedCache];
 }
 
 - (NSString *)signatureHeaderFieldValue {
@@ -300,12 +635,79 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
                 [AVUtils callIdResultBlock:block object:nil error:error];
             }
         }];
+    } else if (policy == kAVCachePolicyIgnoreCache) {
+        [self performRequest:request saveResult:NO block:block];
     } else {
-        BOOL needCache = (policy != kAVCachePolicyIgnoreCache);
-        [self performRequest:request saveResult:needCache block:block];
+        /* Identical cacheable GETs in flight share one request, if they are sent with the same session. */
+        NSString *sessionToken = [request valueForHTTPHeaderField:LCHeaderFieldNameSession];
+        NSString *key = [NSString stringWithFormat:@"%@ %@", sessionToken ?: @"", request.URL.absoluteString];
+        AVIdResultBlock waiter = [block copy] ?: ^(id object, NSError *error) {};
+
+        [self.lock lock];
+        NSMutableArray<AVIdResultBlock> *waiters = self.inflightGetBlocks[key];
+        if (waiters) {
+            [waiters addObject:waiter];
+            _collapsedRequestCount += 1;
+        } else {
+            self.inflightGetBlocks[key] = [NSMutableArray arrayWithObject:waiter];
+        }
+        [self.lock unlock];
+
+        if (waiters) {
+            return;
+        }
+
+        [self performRequest:request saveResult:YES block:^(id object, NSError *error) {
+            [self.lock lock];
+            NSArray<AVIdResultBlock> *blocks = self.inflightGetBlocks[key];
+            [self.inflightGetBlocks removeObjectForKey:key];
+            [self.lock unlock];
+
+            /* Every waiter gets its own containers, so that one mutating its result does not affect the others. */
+            [blocks enumerateObjectsUsingBlock:^(AVIdResultBlock waitingBlock, NSUInteger idx, BOOL *stop) {
+                waitingBlock(idx == 0 ? object : LCJSONObjectCopy(object), error);
+            }];
+        }];
     }
 }
 
+- (void)getCachedObjectWithKey:(NSString *)key maxCacheAge:(NSTimeInterval)maxCacheAge block:(AVIdResultBlock)block {
+    [[AVCacheManager sharedInstance] getWithKey:key maxCacheAge:maxCacheAge block:^(id object, NSError *error) {
+        [self.lock lock];
+        if (error) {
+            self->_cacheMissCount += 1;
+        } else {
+            self->_cacheHitCount += 1;
+        }
+        [self.lock unlock];
+
+        if (block) {
+            block(object, error);
+        }
+    }];
+}
+
+- (NSUInteger)cacheHitCount {
+    [self.lock lock];
+    NSUInteger count = _cacheHitCount;
+    [self.lock unlock];
+    return count;
+}
+
+- (NSUInteger)cacheMissCount {
+    [self.lock lock];
+    NSUInteger count = _cacheMissCount;
+    [self.lock unlock];
+    return count;
+}
+
+- (NSUInteger)collapsedRequestCount {
+    [self.lock lock];
+    NSUInteger count = _collapsedRequestCount;
+    [self.lock unlock];
+    return count;
+}
+
 - (void)getObject:(NSString *)path withParameters:(NSDictionary *)parameters policy:(AVCachePolicy)policy maxCacheAge:(NSTimeInterval)maxCacheAge block:(AVIdResultBlock)block {
     
     NSString *key = [self absoluteStringFromPath:path parameters:parameters];
@@ -318,7 +720,7 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
             break;
         case kAVCachePolicyCacheOnly:
         {
-            [[AVCacheManager sharedInstance] getWithKey:key maxCacheAge:maxCacheAge block:block];
+            [self getCachedObjectWithKey:key maxCacheAge:maxCacheAge block:block];
         }
             break;
         case kAVCachePolicyNetworkOnly:
@@ -330,7 +732,7 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
             break;
         case kAVCachePolicyCacheElseNetwork:
         {
-            [[AVCacheManager sharedInstance] getWithKey:key maxCacheAge:maxCacheAge block:^(id object, NSError *error) {
+            [self getCachedObjectWithKey:key maxCacheAge:maxCacheAge block:^(id object, NSError *error) {
                 if (error) {
                     [self getObjectFromNetworkWithPath:path withParameters:parameters policy:policy block:block];
                 } else {
@@ -343,7 +745,7 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
         {
             [self getObjectFromNetworkWithPath:path withParameters:parameters policy:policy block:^(id object, NSError *error) {
                 if (error) {
-                    [[AVCacheManager sharedInstance] getWithKey:key maxCacheAge:maxCacheAge block:block];
+                    [self getCachedObjectWithKey:key maxCacheAge:maxCacheAge block:block];
                 } else {
                     block(object, error);
                 }
@@ -352,7 +754,7 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
             break;
         case kAVCachePolicyCacheThenNetwork:
         {
-            [[AVCacheManager sharedInstance] getWithKey:key maxCacheAge:maxCacheAge block:^(id object, NSError *error) {
+            [self getCachedObjectWithKey:key maxCacheAge:maxCacheAge block:^(id object, NSError *error) {
                 block(object, error);
                 [self getObjectFromNetworkWithPath:path withParameters:parameters policy:policy block:block];
             }];
@@ -398,14 +800,11 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
     [self postBatchObject:parameterArray headerMap:nil eventually:NO block:block];
 }
 
--(void)postBatchObject:(NSArray *)requests headerMap:(NSDictionary *)headerMap eventually:(BOOL)isEventually block:(AVArrayResultBlock)block {
-    NSString *path = [AVObjectUtils batchPath];
-    NSDictionary *parameters = @{@"requests": requests ?: @[]};
-    NSMutableURLRequest *request = [self requestWithPath:path method:@"POST" headers:headerMap parameters:parameters];
-    
-    AVIdResultBlock handleResultBlock = ^(NSArray *objects, NSError *error) {
+/// Splits the response of a /batch request into the results of its sub-requests.
+- (AVIdResultBlock)batchResultBlockWithRequestCount:(NSUInteger)count block:(AVArrayResultBlock)block {
+    return ^(NSArray *objects, NSError *error) {
         // 区分某个删除失败还是网络请求失败，两种情况 error 都不为空
-        if (objects.count != requests.count) {
+        if (objects.count != count) {
             // 网络请求失败，子操作数量不一致
             if (error) {
                 block(nil, error);
@@ -438,10 +837,17 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
             block(results, nil);
         }
     };
+}
+
+-(void)postBatchObject:(NSArray *)requests headerMap:(NSDictionary *)headerMap eventually:(BOOL)isEventually block:(AVArrayResultBlock)block {
+    NSString *path = [AVObjectUtils batchPath];
+    NSDictionary *parameters = @{@"requests": requests ?: @[]};
+    NSMutableURLRequest *request = [self requestWithPath:path method:@"POST" headers:headerMap parameters:parameters];
+    
+    AVIdResultBlock handleResultBlock = [self batchResultBlockWithRequestCount:requests.count block:block];
     
     if (isEventually) {
-        NSString *filePath = [self archiveRequest:request];
-        [self handleArchivedRequestAtPath:filePath block:handleResultBlock];
+        [self archiveRequest:request path:nil parameters:nil block:handleResultBlock];
     } else {
         [self performRequest:request saveResult:NO block:handleResultBlock];
     }
@@ -453,8 +859,7 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
     NSMutableURLRequest *request = [self requestWithPath:path method:@"POST" headers:headerMap parameters:parameters];
     
     if (isEventually) {
-        NSString *filePath = [self archiveRequest:request];
-        [self handleArchivedRequestAtPath:filePath block:block];
+        [self archiveRequest:request path:nil parameters:nil block:block];
     } else {
         [self performRequest:request saveResult:NO block:block];
     }
@@ -471,8 +876,7 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
     NSMutableURLRequest *request = [self requestWithPath:path method:@"POST" headers:nil parameters:parameters];
     
     if (isEventually) {
-        NSString *filePath = [self archiveRequest:request];
-        [self handleArchivedRequestAtPath:filePath block:block];
+        [self archiveRequest:request path:nil parameters:nil block:block];
     } else {
         [self performRequest:request saveResult:NO block:block];
     }
@@ -489,8 +893,7 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
     NSMutableURLRequest *request = [self requestWithPath:path method:@"DELETE" headers:nil parameters:parameters];
     
     if (isEventually) {
-        NSString *filePath = [self archiveRequest:request];
-        [self handleArchivedRequestAtPath:filePath block:block];
+        [self archiveRequest:request path:path parameters:parameters block:block];
     } else {
         [self performRequest:request saveResult:NO block:block];
     }
@@ -498,6 +901,18 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
 
 #pragma mark - The final method for network
 
+/// Header field lookup ignoring case, since `allHeaderFields` keeps the server's spelling of the names.
+static NSString *LCHTTPHeaderValue(NSHTTPURLResponse *response, NSString *field) {
+    __block NSString *value = nil;
+    [response.allHeaderFields enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSString *obj, BOOL *stop) {
+        if ([key caseInsensitiveCompare:field] == NSOrderedSame) {
+            value = obj;
+            *stop = YES;
+        }
+    }];
+    return value;
+}
+
 - (void)performRequest:(NSURLRequest *)request saveResult:(BOOL)saveResult block:(AVIdResultBlock)block {
     [self performRequest:request saveResult:saveResult block:block retryTimes:0];
 }
@@ -507,31 +922,29 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
     NSString *URLString = URL.absoluteString;
     NSMutableURLRequest *mutableRequest = [request mutableCopy];
     
-    if (self.isLastModifyEnabled && [request.HTTPMethod isEqualToString:@"GET"]) {
-        NSString *modifiedSince = self.lastModify[[URLString AVMD5String]];
-        if (modifiedSince && [[AVCacheManager sharedInstance] hasCacheForKey:URLString]) {
-            [mutableRequest setValue:modifiedSince forHTTPHeaderField:@"If-Modified-Since"];
+    /* Revalidate GETs against the validators persisted with their cached responses. */
+    BOOL revalidates = ([request.HTTPMethod isEqualToString:@"GET"] && (self.isLastModifyEnabled || saveResult));
+    
+    if (revalidates) {
+        NSDictionary *conditionalHeaders = [[AVCacheManager sharedInstance] conditionalHeadersForKey:URLString];
+        for (NSString *field in conditionalHeaders) {
+            [mutableRequest setValue:conditionalHeaders[field] forHTTPHeaderField:field];
         }
     }
     
     [self performRequest:mutableRequest
                  success:^(NSHTTPURLResponse *response, id responseObject)
      {
-        if (block) {
-            
-            block(responseObject, nil);
+        NSString *ETag = (revalidates ? LCHTTPHeaderValue(response, @"ETag") : nil);
+        NSString *lastModified = (revalidates ? LCHTTPHeaderValue(response, @"Last-Modified") : nil);
+        
+        if (saveResult || ETag || lastModified) {
+            [[AVCacheManager sharedInstance] saveJSON:responseObject forKey:URLString ETag:ETag lastModified:lastModified];
         }
         
-        if (self.isLastModifyEnabled && [request.HTTPMethod isEqualToString:@"GET"]) {
-            NSString *URLMD5 = [URLString AVMD5String];
-            NSString *lastModified = [response.allHeaderFields objectForKey:@"Last-Modified"];
+        if (block) {
             
-            if (lastModified && ![self.lastModify[URLMD5] isEqualToString:lastModified]) {
-                [[AVCacheManager sharedInstance] saveJSON:responseObject forKey:URLString];
-                [self.lastModify setObject:lastModified forKey:URLMD5];
-            }
-        } else if (saveResult) {
-            [[AVCacheManager sharedInstance] saveJSON:responseObject forKey:URLString];
+            block(responseObject, nil);
         }
     }
                  failure:^(NSHTTPURLResponse *response, id responseObject, NSError *error)
@@ -540,12 +953,12 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
         
         if (statusCode == 304) {
             // 304 is not error
-            [[AVCacheManager sharedInstance] getWithKey:URLString maxCacheAge:3600 * 24 * 30 block:^(id object, NSError *error) {
+            [[AVCacheManager sharedInstance] revalidateCacheForKey:URLString block:^(id object, NSError *error) {
                 if (error) {
                     if (retryTimes < 3) {
-                        [self.lastModify removeObjectForKey:[URLString AVMD5String]];
                         [[AVCacheManager sharedInstance] clearCacheForKey:URLString];
-                        [mutableRequest setValue:@"" forHTTPHeaderField:@"If-Modified-Since"];
+                        [mutableRequest setValue:nil forHTTPHeaderField:@"If-None-Match"];
+                        [mutableRequest setValue:nil forHTTPHeaderField:@"If-Modified-Since"];
                         [self performRequest:mutableRequest saveResult:saveResult block:block retryTimes:retryTimes + 1];
                     } else {
                         if (block)
@@ -639,12 +1052,10 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
                 LCNetworkStatistics *statistician = [LCNetworkStatistics sharedInstance];
                 
                 if (error.code == NSURLErrorTimedOut) {
-                    [statistician addIncrementalAttribute:1 forKey:@"timeout"];
+                    [statistician addTimeout];
                 } else {
-                    [statistician addIncrementalAttribute:1 forKey:[NSString stringWithFormat:@"%ld", (long)statusCode]];
+                    [statistician addResponseWithStatusCode:statusCode];
                 }
-                
-                [statistician addIncrementalAttribute:1 forKey:@"total"];
             }
         } else {
             
@@ -658,14 +1069,7 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
             // Doing network statistics
             NSInteger statusCode = HTTPResponse.statusCode;
             if ([self shouldStatisticsForPath:path statusCode:statusCode]) {
-                LCNetworkStatistics *statistician = [LCNetworkStatistics sharedInstance];
-                
-                if ((NSInteger)(statusCode / 100) == 2) {
-                    [statistician addAverageAttribute:costTime forKey:@"avg"];
-                }
-                
-                [statistician addIncrementalAttribute:1 forKey:[NSString stringWithFormat:@"%ld", (long)statusCode]];
-                [statistician addIncrementalAttribute:1 forKey:@"total"];
+                [[LCNetworkStatistics sharedInstance] addResponseWithStatusCode:statusCode costTime:costTime];
             }
         }
         
@@ -683,17 +1087,8 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
         dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
 }
 
-- (BOOL)validateStatusCode:(NSInteger)statusCode {
-    if (statusCode >= 100 && statusCode < 600) {
-        return YES;
-    }
-    return NO;
-}
-
+/// Responses of every status code are counted, a transport failure without one as an other response.
 - (BOOL)shouldStatisticsForPath:(NSString *)url statusCode:(NSInteger)statusCode {
-    if (![self validateStatusCode:statusCode]) {
-        return NO;
-    }
     NSArray *exclusiveApis = @[
         @"appHosts",
         @"stats/collect",
@@ -711,85 +1106,215 @@ NSString *const LCHeaderFieldNameProduction = @"X-LC-Prod";
 
 #pragma mark - Archive and handle request
 
-- (NSString *)archiveRequest:(NSURLRequest *)request {
-    NSString *fileName = [NSString stringWithFormat:@"%f", [NSDate timeIntervalSinceReferenceDate]];
-    NSString *fullPath = [[AVPersistenceUtils eventuallyPath] stringByAppendingPathComponent:fileName];
-    [NSKeyedArchiver archiveRootObject:request toFile:fullPath];
-    return fullPath;
-}
+/// The most requests sent in one batch when replaying the journal.
+static const NSUInteger LCEventuallyBatchLimit = 50;
+/// Bounds of the delay before the journal is replayed again after a failure, doubled by each failure in a row.
+static const NSTimeInterval LCEventuallyRetryMinInterval = 2;
+static const NSTimeInterval LCEventuallyRetryMaxInterval = 300;
+/// A request failing with a 5xx error this many times in a launch is dropped, and its callback gets the last error.
+static const NSUInteger LCEventuallyMaxServerFailureCount = 5;
 
-- (void)handleArchivedRequestAtPath:(NSString *)path {
-    [self handleArchivedRequestAtPath:path block:nil];
+- (void)archiveRequest:(NSURLRequest *)request path:(NSString *)path parameters:(NSDictionary *)parameters block:(AVIdResultBlock)block {
+    if ([NSURL URLWithString:path].scheme.length) {
+        /* A batch can only address paths of the app server. */
+        path = nil;
+        parameters = nil;
+    }
+    [self.eventuallyJournal appendRequest:request path:path parameters:parameters block:block];
+    [self handleAllArchivedRequests];
 }
 
 - (BOOL)isErrorFromServer:(NSError *)error {
     NSDictionary *userInfo = error.userInfo;
-    return userInfo && (userInfo[@"error"] || userInfo[@"code"]);
+    return userInfo && (userInfo[@"error"] || userInfo[@"code"] || userInfo[kLeanCloudRESTAPIResponseError]);
 }
 
-- (void)handleArchivedRequestAtPath:(NSString *)path block:(AVIdResultBlock)block {
-    NSURLRequest *request = nil;
-    NSFileManager *fileManager = [NSFileManager defaultManager];
-    
-    if (![fileManager fileExistsAtPath:path]) {
-        if (block) block(nil, nil);
-        return;
+/**
+ A request can be dropped from the journal once it succeeds, or fails with an error other than a server error.
+ A request failing with server errors is dropped after `LCEventuallyMaxServerFailureCount` of them, so it does not
+ hold back the requests to the same object forever.
+ */
+- (BOOL)shouldAcknowledgeEventuallyEntry:(LCEventuallyEntry *)entry error:(NSError *)error {
+    if (!error) {
+        return YES;
+    }
+    NSInteger errorCode = error.code;
+    BOOL isServerError = errorCode >= 500 && errorCode < 600;
+    if (isServerError) {
+        entry.serverFailureCount += 1;
+        return entry.serverFailureCount >= LCEventuallyMaxServerFailureCount;
     }
+    return [self isErrorFromServer:error];
+}
+
+/// Requests with the same key are replayed in order, a kept one holds back the later ones with its key.
+- (NSString *)orderingKeyForEventuallyEntry:(LCEventuallyEntry *)entry {
+    return entry.path ?: entry.request.URL.path ?: @"";
+}
+
+/// The headers a request is replayed with, except its signature, which is made again.
+- (NSDictionary *)replayHeadersForEventuallyEntry:(LCEventuallyEntry *)entry {
+    NSMutableDictionary *headers = [entry.request.allHTTPHeaderFields mutableCopy] ?: [NSMutableDictionary dictionary];
+    [headers removeObjectForKey:LCHeaderFieldNameSign];
+    [headers removeObjectForKey:@"Content-Length"];
+    return headers;
+}
+
+- (NSArray<LCEventuallyEntry *> *)eventuallyGroupFromEntries:(NSArray<LCEventuallyEntry *> *)entries {
+    LCEventuallyEntry *first = entries.firstObject;
+    NSDictionary *headers = [self replayHeadersForEventuallyEntry:first];
+    NSUInteger count = 1;
     
-    @try {
-        request = [NSKeyedUnarchiver unarchiveObjectWithFile:path];
-    } @catch (NSException *exception) {
-        [fileManager removeItemAtPath:path error:NULL];
-        if (block) block(nil, nil);
-        return;
+    while (first.path && count < entries.count && count < LCEventuallyBatchLimit) {
+        LCEventuallyEntry *entry = entries[count];
+        if (![entry.path isEqualToString:first.path] ||
+            ![[self replayHeadersForEventuallyEntry:entry] isEqualToDictionary:headers]) {
+            break;
+        }
+        count += 1;
     }
     
-    if (![request isKindOfClass:[NSURLRequest class]]) {
-        [fileManager removeItemAtPath:path error:NULL];
-        if (block) block(nil, nil);
+    return [entries subarrayWithRange:NSMakeRange(0, count)];
+}
+
+- (void)replayEventuallyEntries:(NSArray<LCEventuallyEntry *> *)entries block:(void (^)(NSArray *objects, NSArray *errors))block {
+    if (entries.count == 1) {
+        /* Requests may be replayed long after they were made, so they are signed again. */
+        NSMutableURLRequest *request = [entries.firstObject.request mutableCopy];
+        [request setValue:[self signatureHeaderFieldValue] forHTTPHeaderField:LCHeaderFieldNameSign];
+        
+        [self performRequest:request saveResult:NO block:^(id object, NSError *error) {
+            block(@[object ?: [NSNull null]], @[error ?: [NSNull null]]);
+        }];
         return;
     }
     
-    @synchronized (self.runningArchivedRequests) {
-        if ([self.runningArchivedRequests containsObject:path])
-            return;
-        
-        [self.runningArchivedRequests addObject:path];
+    NSMutableArray *requests = [NSMutableArray array];
+    for (LCEventuallyEntry *entry in entries) {
+        NSString *method = entry.request.HTTPMethod;
+        BOOL parametersInURL = [method isEqualToString:@"GET"] || [method isEqualToString:@"DELETE"];
+        [requests addObject:[AVPaasClient batchMethod:method
+                                                 path:entry.path
+                                                 body:parametersInURL ? nil : entry.parameters
+                                           parameters:parametersInURL ? entry.parameters : nil]];
     }
+    /* The batch carries the headers of its requests, which are the same for the whole group. */
+    NSMutableURLRequest *request = [self requestWithPath:[AVObjectUtils batchPath] method:@"POST" headers:nil parameters:@{@"requests": requests}];
+    NSMutableDictionary *headers = [[self replayHeadersForEventuallyEntry:entries.firstObject] mutableCopy];
+    headers[LCHeaderFieldNameSign] = [self signatureHeaderFieldValue];
+    request.allHTTPHeaderFields = headers;
     
-    [self performRequest:request saveResult:NO block:^(id object, NSError *error) {
-        if (!error) {
-            [fileManager removeItemAtPath:path error:NULL];
+    [self performRequest:request saveResult:NO block:[self batchResultBlockWithRequestCount:requests.count block:^(NSArray *results, NSError *error) {
+        NSMutableArray *objects = [NSMutableArray array];
+        NSMutableArray *errors = [NSMutableArray array];
+        for (NSUInteger i = 0; i < entries.count; i++) {
+            id result = i < results.count ? results[i] : nil;
+            NSError *resultError = error;
+            if ([result isKindOfClass:[NSDictionary class]] && result[kLC_code] && result[kLC_error]) {
+                resultError = LCError([result[kLC_code] integerValue], result[kLC_error], @{kLeanCloudRESTAPIResponseError: result});
+                result = nil;
+            }
+            [objects addObject:result ?: [NSNull null]];
+            [errors addObject:resultError ?: [NSNull null]];
+        }
+        block(objects, errors);
+    }]];
+}
+
+/**
+ Replays the journal one group of entries at a time, in the order they were made. Each callback is called
+ once, with the outcome of the first attempt of its own request. An entry kept in the journal holds back the
+ later entries with the same ordering key until the next replay; the other entries go on. The entries kept are
+ retried after a backoff, or as soon as the network becomes reachable.
+ */
+- (void)replayEventuallyEntriesAfterSequence:(uint64_t)sequence heldKeys:(NSMutableSet<NSString *> *)heldKeys {
+    NSArray<LCEventuallyEntry *> *entries = [self.eventuallyJournal entriesToReplay];
+    if (!entries) {
+        return;
+    }
+    NSMutableArray<LCEventuallyEntry *> *candidates = [NSMutableArray array];
+    for (LCEventuallyEntry *entry in entries) {
+        if (entry.sequence > sequence && ![heldKeys containsObject:[self orderingKeyForEventuallyEntry:entry]]) {
+            [candidates addObject:entry];
+        }
+    }
+    if (!candidates.count) {
+        [self.eventuallyJournal endReplay];
+        if (heldKeys.count) {
+            [self scheduleEventuallyRetry];
         } else {
-            NSInteger errorCode = error.code;
-            BOOL isServerError = errorCode >= 500 && errorCode < 600;
-            
-            /* If error is a server error, we need retain the cached request. */
-            if (!isServerError && [self isErrorFromServer:error]) {
-                [fileManager removeItemAtPath:path error:NULL];
+            [self resetEventuallyRetryInterval];
+        }
+        return;
+    }
+    NSArray<LCEventuallyEntry *> *group = [self eventuallyGroupFromEntries:candidates];
+    
+    [self replayEventuallyEntries:group block:^(NSArray *objects, NSArray *errors) {
+        NSMutableArray<LCEventuallyEntry *> *acknowledgedEntries = [NSMutableArray array];
+        
+        for (NSUInteger i = 0; i < group.count; i++) {
+            NSError *error = errors[i] == [NSNull null] ? nil : errors[i];
+            if ([self shouldAcknowledgeEventuallyEntry:group[i] error:error]) {
+                [acknowledgedEntries addObject:group[i]];
+            } else {
+                [heldKeys addObject:[self orderingKeyForEventuallyEntry:group[i]]];
             }
         }
+        [self.eventuallyJournal acknowledgeEntries:acknowledgedEntries];
         
-        @synchronized (self.runningArchivedRequests) {
-            [self.runningArchivedRequests removeObject:path];
+        for (NSUInteger i = 0; i < group.count; i++) {
+            AVIdResultBlock block = [group[i] takeBlock];
+            if (block) {
+                id object = objects[i] == [NSNull null] ? nil : objects[i];
+                NSError *error = errors[i] == [NSNull null] ? nil : errors[i];
+                block(object, error);
+            }
         }
         
-        if (block) block(object, error);
+        [self replayEventuallyEntriesAfterSequence:group.lastObject.sequence heldKeys:heldKeys];
     }];
 }
 
 - (void)handleAllArchivedRequests {
-    NSFileManager *fileMgr = [[NSFileManager alloc] init];
-    
-    NSString *documentsDirectory = [AVPersistenceUtils eventuallyPath];
-    NSArray *directoryContents = [fileMgr contentsOfDirectoryAtPath:documentsDirectory error:NULL];
-    
-    for (NSString *path in directoryContents) {
-        NSString *fullPath = [documentsDirectory stringByAppendingPathComponent:path];
-        [self handleArchivedRequestAtPath:fullPath];
+    if ([self.eventuallyJournal beginReplay]) {
+        [self replayEventuallyEntriesAfterSequence:0 heldKeys:[NSMutableSet set]];
     }
 }
 
+- (void)resetEventuallyRetryInterval {
+    [self.lock lock];
+    _eventuallyRetryInterval = 0;
+    [self.lock unlock];
+}
+
+- (void)scheduleEventuallyRetry {
+    [self.lock lock];
+    NSTimeInterval interval = MIN(MAX(_eventuallyRetryInterval * 2, LCEventuallyRetryMinInterval), LCEventuallyRetryMaxInterval);
+    _eventuallyRetryInterval = interval;
+    [self.lock unlock];
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(interval * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [self handleAllArchivedRequests];
+    });
+}
+
+#if !TARGET_OS_WATCH
+- (void)startMonitoringReachability {
+    __weak typeof(self) ws = self;
+    LCNetworkReachabilityManager *reachabilityManager = [LCNetworkReachabilityManager manager];
+
+    [reachabilityManager setReachabilityStatusChangeBlock:^(LCNetworkReachabilityStatus status) {
+        if (status == LCNetworkReachabilityStatusReachableViaWWAN || status == LCNetworkReachabilityStatusReachableViaWiFi) {
+            [ws resetEventuallyRetryInterval];
+            [ws handleAllArchivedRequests];
+        }
+    }];
+    [reachabilityManager startMonitoring];
+
+    self.reachabilityManager = reachabilityManager;
+}
+#endif
+
 #pragma mark - Util method for client
 
 - (NSString *)absoluteStringFromPath:(NSString *)path parameters:(NSDictionary *)parameters {
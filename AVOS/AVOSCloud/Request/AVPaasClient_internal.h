@@ -8,8 +8,47 @@
 
 #import "AVPaasClient.h"
 
+/// A journaled request. `path` and `parameters` are only kept for single object writes, which can be replayed in a batch.
+@interface LCEventuallyEntry : NSObject
+
+@property (nonatomic, assign) uint64_t sequence;
+@property (nonatomic, copy) NSURLRequest *request;
+@property (nonatomic, copy) NSString *path;
+@property (nonatomic, copy) NSDictionary *parameters;
+@property (nonatomic, copy) NSData *record;
+/// The 5xx errors the request got in this launch.
+@property (nonatomic, assign) NSUInteger serverFailureCount;
+
+/// Returns the callback of the request once, or nil if the request was journaled by a previous launch.
+- (AVIdResultBlock)takeBlock;
+
+@end
+
+/// The requests saved for eventual delivery, in the order they were made.
+@interface LCEventuallyJournal : NSObject
+
+/// Opens the journal in `directory`, truncating a torn tail and importing the requests archived by earlier versions.
+- (instancetype)initWithDirectory:(NSString *)directory;
+
+- (void)appendRequest:(NSURLRequest *)request path:(NSString *)path parameters:(NSDictionary *)parameters block:(AVIdResultBlock)block NS_SWIFT_NAME(append(_:path:parameters:block:));
+
+/// Marks the start of a replay. Returns NO if one is already running.
+- (BOOL)beginReplay;
+
+/// Returns the pending entries in journal order, or nil after ending the replay if there are none.
+- (NSArray<LCEventuallyEntry *> *)entriesToReplay;
+
+/// Ends the replay early. The pending entries keep their callbacks until they are replayed.
+- (void)endReplay;
+
+- (void)acknowledgeEntries:(NSArray<LCEventuallyEntry *> *)entries NS_SWIFT_NAME(acknowledge(_:));
+
+@end
+
 @interface AVPaasClient()
 
+@property (nonatomic, strong) LCEventuallyJournal *eventuallyJournal;
+
 /**
  A table of requests indexed by URL.
 
@@ -19,4 +58,21 @@
  */
 @property (nonatomic, strong) NSMapTable *requestTable;
 
+/**
+ Performs a request, caching its response if `saveResult` is YES.
+
+ GETs that save their result, and every GET when `isLastModifyEnabled`, send the validators persisted with
+ the cached response and are answered from the cache on 304.
+ */
+- (void)performRequest:(NSURLRequest *)request saveResult:(BOOL)saveResult block:(AVIdResultBlock)block;
+
+/**
+ Returns the leading entries to replay together: a run of writes to the same object with the same
+ headers, which are sent in one batch with those headers, or else the first entry alone.
+ */
+- (NSArray<LCEventuallyEntry *> *)eventuallyGroupFromEntries:(NSArray<LCEventuallyEntry *> *)entries NS_SWIFT_NAME(eventuallyGroup(from:));
+
+/// Whether a replayed entry can be dropped from the journal after getting `error`, counting its 5xx errors.
+- (BOOL)shouldAcknowledgeEventuallyEntry:(LCEventuallyEntry *)entry error:(NSError *)error NS_SWIFT_NAME(shouldAcknowledgeEventuallyEntry(_:error:));
+
 @end
@@ -8,12 +8,26 @@
 
 #import <Foundation/Foundation.h>
 
+@class LCKeyValueStore;
+
 @interface LCNetworkStatistics : NSObject
 
 + (instancetype)sharedInstance;
 
-- (void)addIncrementalAttribute:(NSInteger)amount forKey:(NSString *)key;
-- (void)addAverageAttribute:(double)amount forKey:(NSString *)key;
+/// Statistics persisted in `store`. The shared instance uses the shared key-value store.
+- (instancetype)initWithKeyValueStore:(LCKeyValueStore *)store;
+
+/// Counts a response by its status code. Codes outside 100..599, such as 0 for a transport failure, are counted as other responses.
+- (void)addResponseWithStatusCode:(NSInteger)statusCode;
+
+/// Counts a response by its status code, and adds its cost time in milliseconds to the latency histogram if it is a 2xx response.
+- (void)addResponseWithStatusCode:(NSInteger)statusCode costTime:(double)costTime;
+
+/// Counts a request which timed out.
+- (void)addTimeout;
+
+/// The attributes that would be uploaded for the counts not uploaded yet, which are persisted first.
+- (NSDictionary *)attributes;
 
 - (void)start;
 - (void)stop;
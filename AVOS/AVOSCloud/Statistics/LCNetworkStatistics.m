@@ -13,7 +13,8 @@
 #endif
 #import "AVPaasClient.h"
 #import "AVUtils.h"
-#import <libkern/OSAtomic.h>
+#import <stdatomic.h>
+#import <pthread.h>
 
 #define LC_INTERVAL_HALF_AN_HOUR 30 * 60
 
@@ -21,107 +22,330 @@ static NSTimeInterval LCNetworkStatisticsCheckInterval  = 60; // A minute
 static NSTimeInterval LCNetworkStatisticsUploadInterval = 24 * 60 * 60; // A day
 
 //After v3.7.0, SDK use millisecond instead of second as time unit in networking performance.
-static NSString *LCNetworkStatisticsInfoKey       = @"LCNetworkStatisticsInfoKey" @"-" @"v1.0";
+static NSString *LCNetworkStatisticsInfoKey       = @"LCNetworkStatisticsInfoKey" @"-" @"v2.0";
+static NSString *LCNetworkStatisticsLegacyInfoKey = @"LCNetworkStatisticsInfoKey" @"-" @"v1.0";
 static NSString *LCNetworkStatisticsLastUpdateKey = @"LCNetworkStatisticsLastUpdateKey";
 static NSInteger LCNetworkStatisticsMaxCount      = 10;
-static NSInteger LCNetworkStatisticsCacheSize     = 20;
+
+#define LC_STATUS_CODE_MIN   100
+#define LC_STATUS_CODE_COUNT 500
+
+/// Latencies are bucketed by quarter powers of two of milliseconds, which spans 1ms to about 65s.
+#define LC_LATENCY_BUCKETS_PER_OCTAVE 4
+#define LC_LATENCY_BUCKET_COUNT       64
+
+#define LC_STRIPE_COUNT 8
+
+/*
+ Responses are counted into a few stripes of atomic counters, picked by the recording thread, so
+ concurrent callbacks neither take a lock nor share a cache line in the common case. The background
+ check drains the stripes into one aggregate, and persists the aggregate in a single write when it changed.
+ */
+typedef struct {
+    _Atomic(uint64_t) statusCounts[LC_STATUS_CODE_COUNT];
+    _Atomic(uint64_t) otherCount; // Responses without a valid status code, such as transport failures.
+    _Atomic(uint64_t) timeoutCount;
+    _Atomic(uint64_t) latencyBuckets[LC_LATENCY_BUCKET_COUNT];
+    _Atomic(uint64_t) latencySum; // In microseconds.
+    char padding[64];
+} LCNetworkStatisticsStripe;
+
+typedef struct {
+    uint64_t statusCounts[LC_STATUS_CODE_COUNT];
+    uint64_t otherCount;
+    uint64_t timeoutCount;
+    uint64_t latencyBuckets[LC_LATENCY_BUCKET_COUNT];
+    uint64_t latencySum; // In microseconds.
+} LCNetworkStatisticsCounts;
+
+static NSUInteger LCLatencyBucket(double costTime) {
+    if (!(costTime >= 1)) {
+        return 0;
+    }
+    return MIN((NSUInteger)(log2(costTime) * LC_LATENCY_BUCKETS_PER_OCTAVE), LC_LATENCY_BUCKET_COUNT - 1);
+}
+
+/// The geometric middle of a bucket, in milliseconds.
+static double LCLatencyBucketValue(NSUInteger bucket) {
+    return exp2((bucket + 0.5) / LC_LATENCY_BUCKETS_PER_OCTAVE);
+}
+
+static uint64_t LCNetworkStatisticsTotal(const LCNetworkStatisticsCounts *counts) {
+    uint64_t total = counts->timeoutCount + counts->otherCount;
+    for (NSUInteger i = 0; i < LC_STATUS_CODE_COUNT; i++) {
+        total += counts->statusCounts[i];
+    }
+    return total;
+}
+
+static uint64_t LCNetworkStatisticsLatencyCount(const LCNetworkStatisticsCounts *counts) {
+    uint64_t count = 0;
+    for (NSUInteger i = 0; i < LC_LATENCY_BUCKET_COUNT; i++) {
+        count += counts->latencyBuckets[i];
+    }
+    return count;
+}
+
+static double LCNetworkStatisticsPercentile(const LCNetworkStatisticsCounts *counts, uint64_t latencyCount, double percentile) {
+    uint64_t rank = (uint64_t)ceil(percentile * latencyCount);
+    uint64_t cumulative = 0;
+    for (NSUInteger i = 0; i < LC_LATENCY_BUCKET_COUNT; i++) {
+        cumulative += counts->latencyBuckets[i];
+        if (cumulative >= rank) {
+            return LCLatencyBucketValue(i);
+        }
+    }
+    return LCLatencyBucketValue(LC_LATENCY_BUCKET_COUNT - 1);
+}
+
+static void LCNetworkStatisticsAdd(LCNetworkStatisticsCounts *counts, const LCNetworkStatisticsCounts *other) {
+    for (NSUInteger i = 0; i < LC_STATUS_CODE_COUNT; i++) {
+        counts->statusCounts[i] += other->statusCounts[i];
+    }
+    counts->otherCount += other->otherCount;
+    counts->timeoutCount += other->timeoutCount;
+    for (NSUInteger i = 0; i < LC_LATENCY_BUCKET_COUNT; i++) {
+        counts->latencyBuckets[i] += other->latencyBuckets[i];
+    }
+    counts->latencySum += other->latencySum;
+}
 
 @interface LCNetworkStatistics ()
 
 @property (nonatomic, assign) BOOL                 enable;
-@property (nonatomic, strong) NSMutableDictionary *cachedStatisticDict;
-@property (nonatomic, strong) NSRecursiveLock     *cachedStatisticDictLock;
 @property (nonatomic, assign) NSTimeInterval       cachedLastUpdatedAt;
 
 @end
 
-@implementation LCNetworkStatistics
+@implementation LCNetworkStatistics {
+    LCKeyValueStore *_store;
+    LCNetworkStatisticsStripe _stripes[LC_STRIPE_COUNT];
+    /// The drained counts, guarded by `_countsLock`.
+    LCNetworkStatisticsCounts _counts;
+    NSLock *_countsLock;
+    BOOL _countsLoaded;
+}
 
 + (instancetype)sharedInstance {
     static LCNetworkStatistics *instance = nil;
     static dispatch_once_t onceToken;
 
     dispatch_once(&onceToken, ^{
-        instance = [[self alloc] init];
+        instance = [[self alloc] initWithKeyValueStore:[LCKeyValueStore sharedInstance]];
     });
 
     return instance;
 }
 
 - (instancetype)init {
+    return [self initWithKeyValueStore:[LCKeyValueStore sharedInstance]];
+}
+
+- (instancetype)initWithKeyValueStore:(LCKeyValueStore *)store {
     self = [super init];
 
     if (self) {
-        _cachedStatisticDictLock = [[NSRecursiveLock alloc] init];
+        _store = store;
+        _countsLock = [[NSLock alloc] init];
     }
 
     return self;
 }
 
-- (NSMutableDictionary *)statisticsInfo {
-    NSMutableDictionary *dict = nil;
-    [self.cachedStatisticDictLock lock];
-    if (self.cachedStatisticDict) {
-        dict = self.cachedStatisticDict;
-    } else {
-        LCKeyValueStore *store = [LCKeyValueStore sharedInstance];
-        NSData *data = [store dataForKey:LCNetworkStatisticsInfoKey];
-        if (data) {
-            dict = [NSKeyedUnarchiver unarchiveObjectWithData:data];
-        } else {
-            dict = [NSMutableDictionary dictionary];
+#pragma mark - Recording
+
+- (LCNetworkStatisticsStripe *)currentStripe {
+    return &_stripes[pthread_mach_thread_np(pthread_self()) % LC_STRIPE_COUNT];
+}
+
+- (void)addResponseWithStatusCode:(NSInteger)statusCode {
+    if (statusCode < LC_STATUS_CODE_MIN || statusCode >= LC_STATUS_CODE_MIN + LC_STATUS_CODE_COUNT) {
+        atomic_fetch_add_explicit(&[self currentStripe]->otherCount, 1, memory_order_relaxed);
+        return;
+    }
+    atomic_fetch_add_explicit(&[self currentStripe]->statusCounts[statusCode - LC_STATUS_CODE_MIN], 1, memory_order_relaxed);
+}
+
+- (void)addResponseWithStatusCode:(NSInteger)statusCode costTime:(double)costTime {
+    [self addResponseWithStatusCode:statusCode];
+
+    if ((NSInteger)(statusCode / 100) == 2 && costTime >= 0) {
+        LCNetworkStatisticsStripe *stripe = [self currentStripe];
+        atomic_fetch_add_explicit(&stripe->latencyBuckets[LCLatencyBucket(costTime)], 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&stripe->latencySum, (uint64_t)(costTime * 1000), memory_order_relaxed);
+    }
+}
+
+- (void)addTimeout {
+    atomic_fetch_add_explicit(&[self currentStripe]->timeoutCount, 1, memory_order_relaxed);
+}
+
+#pragma mark - Aggregation
+
+/// Moves the counts of all stripes into `_counts`. Returns NO if there were none.
+- (BOOL)drainStripes {
+    BOOL drained = NO;
+    for (NSUInteger i = 0; i < LC_STRIPE_COUNT; i++) {
+        LCNetworkStatisticsStripe *stripe = &_stripes[i];
+        for (NSUInteger j = 0; j < LC_STATUS_CODE_COUNT; j++) {
+            uint64_t count = atomic_exchange_explicit(&stripe->statusCounts[j], 0, memory_order_relaxed);
+            _counts.statusCounts[j] += count;
+            drained = drained || count;
+        }
+        uint64_t otherCount = atomic_exchange_explicit(&stripe->otherCount, 0, memory_order_relaxed);
+        _counts.otherCount += otherCount;
+        drained = drained || otherCount;
+        uint64_t timeoutCount = atomic_exchange_explicit(&stripe->timeoutCount, 0, memory_order_relaxed);
+        _counts.timeoutCount += timeoutCount;
+        drained = drained || timeoutCount;
+        for (NSUInteger j = 0; j < LC_LATENCY_BUCKET_COUNT; j++) {
+            uint64_t count = atomic_exchange_explicit(&stripe->latencyBuckets[j], 0, memory_order_relaxed);
+            _counts.latencyBuckets[j] += count;
+            drained = drained || count;
         }
+        _counts.latencySum += atomic_exchange_explicit(&stripe->latencySum, 0, memory_order_relaxed);
     }
-    [self.cachedStatisticDictLock unlock];
-    return dict;
+    return drained;
 }
 
-- (void)saveStatisticsDict:(NSDictionary *)statisticsDict {
-    [self.cachedStatisticDictLock lock];
-    self.cachedStatisticDict = [statisticsDict mutableCopy];
-    [self.cachedStatisticDictLock unlock];
+/// Reads the counts persisted by a previous launch into `_counts`, keeping only their non-zero entries.
+- (void)loadCountsIfNeeded {
+    if (_countsLoaded) {
+        return;
+    }
+    _countsLoaded = YES;
+
+    LCKeyValueStore *store = _store;
+    /* The counts of earlier versions hold a decayed average instead of a histogram, so they are dropped. */
+    [store deleteKey:LCNetworkStatisticsLegacyInfoKey];
+
+    NSData *data = [store dataForKey:LCNetworkStatisticsInfoKey];
+    NSDictionary *info = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL] : nil;
+    if (![info isKindOfClass:[NSDictionary class]]) {
+        return;
+    }
+
+    NSDictionary *statusCounts = info[@"status"];
+    for (NSString *statusCode in statusCounts) {
+        NSInteger index = [statusCode integerValue] - LC_STATUS_CODE_MIN;
+        if (index >= 0 && index < LC_STATUS_CODE_COUNT) {
+            _counts.statusCounts[index] += [statusCounts[statusCode] unsignedLongLongValue];
+        }
+    }
+    NSDictionary *latencyBuckets = info[@"latency"];
+    for (NSString *bucket in latencyBuckets) {
+        NSInteger index = [bucket integerValue];
+        if (index >= 0 && index < LC_LATENCY_BUCKET_COUNT) {
+            _counts.latencyBuckets[index] += [latencyBuckets[bucket] unsignedLongLongValue];
+        }
+    }
+    _counts.otherCount += [info[@"other"] unsignedLongLongValue];
+    _counts.timeoutCount += [info[@"timeout"] unsignedLongLongValue];
+    _counts.latencySum += [info[@"latencySum"] unsignedLongLongValue];
 }
 
-- (void)writeCachedStatisticsDict {
-    [self.cachedStatisticDictLock lock];
-    if (self.cachedStatisticDict) {
-        LCKeyValueStore *store = [LCKeyValueStore sharedInstance];
-        NSData *data = [NSKeyedArchiver archivedDataWithRootObject:self.cachedStatisticDict];
-        [store setData:data forKey:LCNetworkStatisticsInfoKey];
+- (void)writeCounts {
+    NSMutableDictionary *statusCounts = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < LC_STATUS_CODE_COUNT; i++) {
+        if (_counts.statusCounts[i]) {
+            statusCounts[[NSString stringWithFormat:@"%lu", (unsigned long)(i + LC_STATUS_CODE_MIN)]] = @(_counts.statusCounts[i]);
+        }
     }
-    [self.cachedStatisticDictLock unlock];
+    NSMutableDictionary *latencyBuckets = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < LC_LATENCY_BUCKET_COUNT; i++) {
+        if (_counts.latencyBuckets[i]) {
+            latencyBuckets[[NSString stringWithFormat:@"%lu", (unsigned long)i]] = @(_counts.latencyBuckets[i]);
+        }
+    }
+    NSDictionary *info = @{
+        @"status": statusCounts,
+        @"other": @(_counts.otherCount),
+        @"timeout": @(_counts.timeoutCount),
+        @"latency": latencyBuckets,
+        @"latencySum": @(_counts.latencySum),
+    };
+    NSData *data = [NSJSONSerialization dataWithJSONObject:info options:0 error:NULL];
+    [_store setData:data forKey:LCNetworkStatisticsInfoKey];
 }
 
-- (void)addIncrementalAttribute:(NSInteger)amount forKey:(NSString *)key {
-    [self.cachedStatisticDictLock lock];
-    NSMutableDictionary *statisticsInfo = [self statisticsInfo];
-    NSNumber *value = statisticsInfo[key];
-    if (value) {
-        statisticsInfo[key] = @([value integerValue] + amount);
-    } else {
-        statisticsInfo[key] = @(amount);
+/// The attributes uploaded for `counts`: the count of each status code, other responses, timeouts and the total, and the mean and percentiles of 2xx latencies in milliseconds.
+- (NSDictionary *)attributesWithCounts:(const LCNetworkStatisticsCounts *)counts {
+    NSMutableDictionary *attributes = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < LC_STATUS_CODE_COUNT; i++) {
+        if (counts->statusCounts[i]) {
+            attributes[[NSString stringWithFormat:@"%lu", (unsigned long)(i + LC_STATUS_CODE_MIN)]] = @(counts->statusCounts[i]);
+        }
     }
-    [self saveStatisticsDict:statisticsInfo];
-    [self.cachedStatisticDictLock unlock];
+    if (counts->otherCount) {
+        attributes[@"other"] = @(counts->otherCount);
+    }
+    if (counts->timeoutCount) {
+        attributes[@"timeout"] = @(counts->timeoutCount);
+    }
+    attributes[@"total"] = @(LCNetworkStatisticsTotal(counts));
+
+    uint64_t latencyCount = LCNetworkStatisticsLatencyCount(counts);
+    if (latencyCount) {
+        attributes[@"avg"] = @(counts->latencySum / 1000.0 / latencyCount);
+        attributes[@"p50"] = @(LCNetworkStatisticsPercentile(counts, latencyCount, 0.50));
+        attributes[@"p90"] = @(LCNetworkStatisticsPercentile(counts, latencyCount, 0.90));
+        attributes[@"p99"] = @(LCNetworkStatisticsPercentile(counts, latencyCount, 0.99));
+    }
+    return attributes;
 }
 
-- (void)addAverageAttribute:(double)amount forKey:(NSString *)key {
-    [self.cachedStatisticDictLock lock];
-    NSMutableDictionary *statisticsInfo = [self statisticsInfo];
-    NSNumber *value = statisticsInfo[key];
-    if (value) {
-        statisticsInfo[key] = @(([value doubleValue] + amount) / 2.0);
-    } else {
-        statisticsInfo[key] = @(amount);
+- (NSDictionary *)attributes {
+    [_countsLock lock];
+    [self loadCountsIfNeeded];
+    if ([self drainStripes]) {
+        [self writeCounts];
+    }
+    NSDictionary *attributes = [self attributesWithCounts:&_counts];
+    [_countsLock unlock];
+
+    return attributes;
+}
+
+/**
+ Drains the stripes, and uploads the counts when enough requests were made or a day has passed.
+ The uploaded counts are taken out of the aggregate, and added back if the upload fails.
+ */
+- (void)checkStatistics {
+    LCNetworkStatisticsCounts uploadingCounts;
+    BOOL shouldUpload = NO;
+
+    [_countsLock lock];
+    [self loadCountsIfNeeded];
+    BOOL changed = [self drainStripes];
+    uint64_t total = LCNetworkStatisticsTotal(&_counts);
+
+    if (total > 0 && ([self atTimeToUpload] || total > LCNetworkStatisticsMaxCount)) {
+        uploadingCounts = _counts;
+        memset(&_counts, 0, sizeof(_counts));
+        shouldUpload = YES;
+        changed = YES;
     }
-    [self saveStatisticsDict:statisticsInfo];
-    [self.cachedStatisticDictLock unlock];
+    if (changed) {
+        [self writeCounts];
+    }
+    [_countsLock unlock];
+
+    if (shouldUpload) {
+        [self uploadCounts:uploadingCounts];
+    }
+}
+
+- (void)restoreCounts:(LCNetworkStatisticsCounts)counts {
+    [_countsLock lock];
+    LCNetworkStatisticsAdd(&_counts, &counts);
+    [self writeCounts];
+    [_countsLock unlock];
 }
 
-- (void)uploadStatisticsInfo:(NSDictionary *)statisticsInfo
+- (void)uploadCounts:(LCNetworkStatisticsCounts)counts
 {
     NSMutableDictionary *payloadDic = [NSMutableDictionary dictionary];
-    if (statisticsInfo) { payloadDic[@"attributes"] = statisticsInfo; }
+    payloadDic[@"attributes"] = [self attributesWithCounts:&counts];
 #if !TARGET_OS_WATCH
 #if defined(__IPHONE_OS_VERSION_MIN_REQUIRED)
     NSMutableDictionary *clientDic = [NSMutableDictionary dictionaryWithCapacity:4];
@@ -144,24 +368,19 @@ static NSInteger LCNetworkStatisticsCacheSize     = 20;
      success:^(NSHTTPURLResponse *response, id responseObject) {
         [self statisticsInfoDidUpload];
     }
-     failure:nil];
+     failure:^(NSHTTPURLResponse *response, id responseObject, NSError *error) {
+        [self restoreCounts:counts];
+    }];
 }
 
 - (void)statisticsInfoDidUpload {
-    [self.cachedStatisticDictLock lock];
-    // Reset network statistics data
-    LCKeyValueStore *store = [LCKeyValueStore sharedInstance];
-    [store deleteKey:LCNetworkStatisticsInfoKey];
-    // Clean cached statistic dict
-    [self.cachedStatisticDict removeAllObjects];
     // Increase check interval to save CPU time
     LCNetworkStatisticsCheckInterval = LC_INTERVAL_HALF_AN_HOUR;
     [self updateLastUpdateAt];
-    [self.cachedStatisticDictLock unlock];
 }
 
 - (void)updateLastUpdateAt {
-    LCKeyValueStore *store = [LCKeyValueStore sharedInstance];
+    LCKeyValueStore *store = _store;
 
     NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
     NSData *dateData = [NSData dataWithBytes:&now length:sizeof(now)];
@@ -176,7 +395,7 @@ static NSInteger LCNetworkStatisticsCacheSize     = 20;
         return self.cachedLastUpdatedAt;
     }
 
-    LCKeyValueStore *store = [LCKeyValueStore sharedInstance];
+    LCKeyValueStore *store = _store;
     NSData *dateData = [store dataForKey:LCNetworkStatisticsLastUpdateKey];
 
     if (dateData) {
@@ -212,18 +431,7 @@ static NSInteger LCNetworkStatisticsCacheSize     = 20;
     NSAssert(![NSThread isMainThread], @"This method must run in background.");
 
     AV_WAIT_WITH_ROUTINE_TIL_TRUE(!self.enable, LCNetworkStatisticsCheckInterval, ({
-        NSDictionary *statisticsInfo = [[self statisticsInfo] copy];
-
-        NSInteger total = [statisticsInfo[@"total"] integerValue];
-
-        if (total > 0) {
-            if ([self atTimeToUpload] || total > LCNetworkStatisticsMaxCount) {
-                [self uploadStatisticsInfo:statisticsInfo];
-            }
-            if (total % LCNetworkStatisticsCacheSize == 0) {
-                [self writeCachedStatisticsDict];
-            }
-        }
+        [self checkStatistics];
     }));
 }
 
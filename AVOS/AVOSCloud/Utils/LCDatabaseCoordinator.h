@@ -17,6 +17,24 @@
 
 - (void)executeTransaction:(LCDatabaseJob)job fail:(LCDatabaseJob)fail;
 
+/**
+ Run a job on the database, blocking until it returns.
+ Asynchronous jobs queued before it are committed first.
+ */
 - (void)executeJob:(LCDatabaseJob)job;
 
+/**
+ Queue a job to run in a transaction, without blocking the calling thread.
+
+ Jobs queued while a previous batch is being committed are group committed in one transaction,
+ each inside its own save point, so a job that raises an exception is rolled back alone.
+
+ @param job The job to run.
+ @param completionQueue The queue to call completion on, the main queue if nil.
+ @param completion Called with whether the job has been committed. May be nil.
+ */
+- (void)executeTransactionAsync:(LCDatabaseJob)job
+                completionQueue:(dispatch_queue_t)completionQueue
+                     completion:(void (^)(BOOL succeeded))completion;
+
 @end
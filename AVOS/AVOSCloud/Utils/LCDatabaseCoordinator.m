@@ -12,7 +12,7 @@
 #import "AVLogger.h"
 #import "AVErrorUtils.h"
 
-#import <libkern/OSAtomic.h>
+#import <stdatomic.h>
 
 #ifdef DEBUG
 #define LC_SHOULD_LOG_ERRORS YES
@@ -20,9 +20,35 @@
 #define LC_SHOULD_LOG_ERRORS NO
 #endif
 
+/* Most jobs committed in one transaction, so that completions of a long backlog are not held back by its tail. */
+static NSUInteger const LCDatabaseGroupCommitLimit = 128;
+
+static NSString *const LCDatabaseJobSavePointName = @"lc_job";
+
+@interface LCDatabasePendingJob : NSObject
+
+@property (nonatomic, copy) LCDatabaseJob job;
+@property (nonatomic, strong) dispatch_queue_t completionQueue;
+@property (nonatomic, copy) void (^completion)(BOOL succeeded);
+@property (nonatomic, assign) BOOL succeeded;
+
+/* Job queued before this one. Each job on the stack is retained by the stack itself. */
+@property (nonatomic, unsafe_unretained) LCDatabasePendingJob *next;
+
+@end
+
+@implementation LCDatabasePendingJob
+
+@end
+
 @interface LCDatabaseCoordinator () {
-    LCDatabaseQueue *_dbQueue;
-    OSSpinLock _dbQueueLock;
+    /* Retained LCDatabaseQueue, published once by compare-and-swap. */
+    _Atomic(void *) _dbQueue;
+
+    /* Lock-free stack of retained LCDatabasePendingJob, newest first. */
+    _Atomic(void *) _pendingJobs;
+
+    dispatch_queue_t _jobQueue;
 }
 
 - (LCDatabaseQueue *)dbQueue;
@@ -35,14 +61,16 @@
     self = [super init];
 
     if (self) {
-        _dbQueueLock = OS_SPINLOCK_INIT;
+        atomic_init(&_dbQueue, NULL);
+        atomic_init(&_pendingJobs, NULL);
+        _jobQueue = dispatch_queue_create("cn.leancloud.database-coordinator", DISPATCH_QUEUE_SERIAL);
     }
 
     return self;
 }
 
 - (instancetype)initWithDatabasePath:(NSString *)databasePath {
-    self = [super init];
+    self = [self init];
 
     if (self) {
         _databasePath = [databasePath copy];
@@ -65,10 +93,109 @@
 }
 
 - (void)executeJob:(LCDatabaseJob)job {
+    dispatch_sync(_jobQueue, ^{
+        [self commitPendingJobs];
+
+        [self.dbQueue inDatabase:^(LCDatabase *db) {
+            db.logsErrors = LC_SHOULD_LOG_ERRORS;
+            job(db);
+        }];
+    });
+}
+
+- (void)executeTransactionAsync:(LCDatabaseJob)job
+                completionQueue:(dispatch_queue_t)completionQueue
+                     completion:(void (^)(BOOL))completion
+{
+    LCDatabasePendingJob *pendingJob = [[LCDatabasePendingJob alloc] init];
+
+    pendingJob.job = job;
+    pendingJob.completionQueue = completionQueue ?: dispatch_get_main_queue();
+    pendingJob.completion = completion;
+
+    void *node = (__bridge_retained void *)pendingJob;
+    void *head = atomic_load_explicit(&_pendingJobs, memory_order_relaxed);
+
+    do {
+        pendingJob.next = (__bridge LCDatabasePendingJob *)head;
+    } while (!atomic_compare_exchange_weak_explicit(&_pendingJobs, &head, node, memory_order_release, memory_order_relaxed));
+
+    /* Only the job that finds the stack empty schedules a commit; later ones join its batch, or the next one. */
+    if (!head) {
+        dispatch_async(_jobQueue, ^{
+            [self commitPendingJobs];
+        });
+    }
+}
+
+/* Runs on the job queue. */
+- (void)commitPendingJobs {
+    void *head = atomic_exchange_explicit(&_pendingJobs, NULL, memory_order_acquire);
+
+    if (!head)
+        return;
+
+    NSMutableArray *jobs = [NSMutableArray array];
+    LCDatabasePendingJob *pendingJob = (__bridge LCDatabasePendingJob *)head;
+
+    while (pendingJob) {
+        LCDatabasePendingJob *next = pendingJob.next;
+        [jobs addObject:CFBridgingRelease((__bridge CFTypeRef)pendingJob)];
+        pendingJob = next;
+    }
+
+    /* The stack is newest first, jobs are committed in the order they were queued. */
+    NSArray *orderedJobs = [[jobs reverseObjectEnumerator] allObjects];
+
+    for (NSUInteger location = 0; location < orderedJobs.count; location += LCDatabaseGroupCommitLimit) {
+        NSRange range = NSMakeRange(location, MIN(LCDatabaseGroupCommitLimit, orderedJobs.count - location));
+        [self commitJobs:[orderedJobs subarrayWithRange:range]];
+    }
+}
+
+- (void)commitJobs:(NSArray *)jobs {
+    /* An exclusive transaction takes the write lock up front, so another process holding the database
+       makes it wait in the busy handler, instead of failing a deferred transaction on lock upgrade. */
     [self.dbQueue inDatabase:^(LCDatabase *db) {
         db.logsErrors = LC_SHOULD_LOG_ERRORS;
-        job(db);
+
+        if (![db beginTransaction])
+            return;
+
+        for (LCDatabasePendingJob *pendingJob in jobs) {
+            if (![db startSavePointWithName:LCDatabaseJobSavePointName error:NULL])
+                continue;
+
+            @try {
+                pendingJob.job(db);
+                pendingJob.succeeded = YES;
+            } @catch (NSException *exception) {
+                AVLoggerError(AVLoggerDomainDefault, @"%@: Database job failed: %@", [[self class] description], exception);
+                [db rollbackToSavePointWithName:LCDatabaseJobSavePointName error:NULL];
+            }
+
+            [db releaseSavePointWithName:LCDatabaseJobSavePointName error:NULL];
+        }
+
+        if (![db commit]) {
+            [db rollback];
+
+            for (LCDatabasePendingJob *pendingJob in jobs)
+                pendingJob.succeeded = NO;
+        }
     }];
+
+    for (LCDatabasePendingJob *pendingJob in jobs) {
+        void (^completion)(BOOL) = pendingJob.completion;
+
+        if (completion) {
+            BOOL succeeded = pendingJob.succeeded;
+
+            dispatch_async(pendingJob.completionQueue, ^{
+                completion(succeeded);
+            });
+        }
+    }
 }
 
 #pragma mark - Lazy loading
@@ -79,21 +206,38 @@
         return nil;
     }
 
-    OSSpinLockLock(&_dbQueueLock);
+    void *dbQueue = atomic_load_explicit(&_dbQueue, memory_order_acquire);
 
-    if (!_dbQueue) {
-        _dbQueue = [LCDatabaseQueue databaseQueueWithPath:_databasePath];
-    }
+    if (dbQueue)
+        return (__bridge LCDatabaseQueue *)dbQueue;
 
-    OSSpinLockUnlock(&_dbQueueLock);
+    LCDatabaseQueue *newQueue = [LCDatabaseQueue databaseQueueWithPath:_databasePath];
 
-    return _dbQueue;
+    if (!newQueue)
+        return nil;
+
+    void *retainedQueue = (__bridge_retained void *)newQueue;
+
+    if (atomic_compare_exchange_strong_explicit(&_dbQueue, &dbQueue, retainedQueue, memory_order_acq_rel, memory_order_acquire))
+        return newQueue;
+
+    /* Another thread has published its queue first. */
+    CFRelease(retainedQueue);
+    [newQueue close];
+
+    return (__bridge LCDatabaseQueue *)dbQueue;
 }
 
 #pragma mark -
 
 - (void)dealloc {
-    [_dbQueue close];
+    /* Every queued job retains the coordinator through its commit block, so the stack is empty here. */
+    void *dbQueue = atomic_exchange(&_dbQueue, NULL);
+
+    if (dbQueue) {
+        LCDatabaseQueue *queue = CFBridgingRelease(dbQueue);
+        [queue close];
+    }
 }
 
 @end
@@ -11,34 +11,21 @@
 #import "LCDatabase.h"
 #import "LCDatabaseAdditions.h"
 
-#import <libkern/OSAtomic.h>
-
-@interface LCDatabaseMigrator () {
-    LCDatabaseCoordinator *_coordinator;
-    OSSpinLock _coordinatorLock;
-}
+@interface LCDatabaseMigrator ()
 
+/* Opens the database lazily itself, so it is cheap to create along with the migrator. */
 @property (readonly) LCDatabaseCoordinator *coordinator;
 
 @end
 
 @implementation LCDatabaseMigrator
 
-- (instancetype)init {
-    self = [super init];
-
-    if (self) {
-        _coordinatorLock = OS_SPINLOCK_INIT;
-    }
-
-    return self;
-}
-
 - (instancetype)initWithDatabasePath:(NSString *)databasePath {
     self = [super init];
 
     if (self) {
         _databasePath = [databasePath copy];
+        _coordinator = [[LCDatabaseCoordinator alloc] initWithDatabasePath:_databasePath];
     }
 
     return self;
@@ -84,20 +71,6 @@
     }
 }
 
-#pragma mark - Lazy loading
-
-- (LCDatabaseCoordinator *)coordinator {
-    OSSpinLockLock(&_coordinatorLock);
-
-    if (!_coordinator) {
-        _coordinator = [[LCDatabaseCoordinator alloc] initWithDatabasePath:_databasePath];
-    }
-
-    OSSpinLockUnlock(&_coordinatorLock);
-
-    return _coordinator;
-}
-
 @end
 
 @implementation LCDatabaseMigration
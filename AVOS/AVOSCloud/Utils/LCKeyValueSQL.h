@@ -23,6 +23,9 @@
 #define LC_SQL_SELECT_KEY_VALUE_FMT  \
     @"SELECT * FROM %@ WHERE " LC_FIELD_KEY @" = ?"
 
+#define LC_SQL_SELECT_KEY_VALUE_IN_FMT  \
+    @"SELECT * FROM %@ WHERE " LC_FIELD_KEY @" IN (%@)"
+
 #define LC_SQL_UPDATE_KEY_VALUE_FMT               \
     @"INSERT OR REPLACE INTO %@ "                 \
     @"(" LC_FIELD_KEY @", " LC_FIELD_VALUE @") "  \
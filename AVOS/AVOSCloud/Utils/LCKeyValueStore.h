@@ -24,4 +24,38 @@
 
 - (void)deleteKey:(NSString *)key;
 
+/**
+ Returns the data stored for each of `keys`, reading all the uncached ones in one transaction.
+ Keys without data are absent from the result.
+ */
+- (NSDictionary<NSString *, NSData *> *)dataForKeys:(NSArray<NSString *> *)keys;
+
+/// Stores every entry of `dictionary`, committed to the database in one transaction.
+- (void)setDataDictionary:(NSDictionary<NSString *, NSData *> *)dictionary;
+
+/// Deletes every key of `keys`, committed to the database in one transaction.
+- (void)deleteKeys:(NSArray<NSString *> *)keys;
+
+/**
+ Enumerates the entries whose keys are in [`fromKey`, `toKey`), in ascending key order.
+ A nil `fromKey` or `toKey` leaves that end of the range open.
+
+ Queued writes are flushed first. Rows are read in pages, so `block` may call back into the store.
+ */
+- (void)enumerateDataFromKey:(NSString *)fromKey
+                       toKey:(NSString *)toKey
+                  usingBlock:(void (^)(NSString *key, NSData *data, BOOL *stop))block;
+
+/// Enumerates the entries whose keys start with `prefix`, in ascending key order.
+/// A nil or empty `prefix` enumerates all entries.
+- (void)enumerateDataWithKeyPrefix:(NSString *)prefix
+                        usingBlock:(void (^)(NSString *key, NSData *data, BOOL *stop))block;
+
+/**
+ Blocks until every preceding `setData:forKey:` and `deleteKey:` on this table is written to the database.
+
+ Writes are visible to `dataForKey:` as soon as they return, but reach the database asynchronously.
+ */
+- (void)flush;
+
 @end
@@ -29,10 +29,160 @@ static BOOL shouldLogError = NO;
 
 static OSSpinLock dbQueueLock = OS_SPINLOCK_INIT;
 
+/// Values above this size are read from the database every time rather than kept in memory.
+static const NSUInteger LCKeyValueMemoryTierMaxValueLength = 64 * 1024;
+static const NSUInteger LCKeyValueMemoryTierTotalCostLimit = 1024 * 1024;
+
+/// Keeps `IN (...)` lists under SQLite's default limit of 999 bound parameters.
+static const NSUInteger LCKeyValueStoreMaxKeysPerQuery = 500;
+/// Rows fetched per database hop while enumerating a key range.
+static const NSUInteger LCKeyValueStoreScanPageSize = 128;
+
+/**
+ In-memory tier in front of one key-value table, shared by all the stores opened on that table.
+
+ `cache` holds recently read or written values (`NSNull` for a key known to be absent), evicted by cost.
+ `pendingWrites` holds the values whose write is still queued on `writeQueue`, so a read never reaches
+ the database for a key that has not been written yet.
+ */
+@interface LCKeyValueMemoryTier : NSObject {
+    @package
+    NSCache<NSString *, id> *_cache;
+    NSMutableDictionary<NSString *, id> *_pendingWrites;
+    NSMutableDictionary<NSString *, NSNumber *> *_pendingWriteCounts;
+    NSUInteger _writeCount;
+    dispatch_queue_t _writeQueue;
+}
+
+@end
+
+@implementation LCKeyValueMemoryTier
+
++ (instancetype)tierForDatabasePath:(NSString *)databasePath tableName:(NSString *)tableName {
+    static NSMutableDictionary<NSString *, LCKeyValueMemoryTier *> *tiers;
+    static dispatch_once_t onceToken;
+
+    dispatch_once(&onceToken, ^{
+        tiers = [NSMutableDictionary dictionary];
+    });
+
+    NSString *key = [NSString stringWithFormat:@"%@|%@", databasePath, tableName];
+
+    @synchronized (tiers) {
+        LCKeyValueMemoryTier *tier = tiers[key];
+
+        if (!tier) {
+            tier = [[self alloc] init];
+            tiers[key] = tier;
+        }
+
+        return tier;
+    }
+}
+
+- (instancetype)init {
+    self = [super init];
+
+    if (self) {
+        _cache = [[NSCache alloc] init];
+        _cache.totalCostLimit = LCKeyValueMemoryTierTotalCostLimit;
+        _pendingWrites = [NSMutableDictionary dictionary];
+        _pendingWriteCounts = [NSMutableDictionary dictionary];
+        _writeQueue = dispatch_queue_create("LC.Objc.LCKeyValueStore.writeQueue", DISPATCH_QUEUE_SERIAL);
+    }
+
+    return self;
+}
+
+- (void)cacheObject:(id)object forKey:(NSString *)key {
+    NSUInteger length = ([object isKindOfClass:[NSData class]] ? [(NSData *)object length] : 0);
+
+    if (length > LCKeyValueMemoryTierMaxValueLength) {
+        [_cache removeObjectForKey:key];
+    } else {
+        [_cache setObject:object forKey:key cost:(key.length + length)];
+    }
+}
+
+/// Returns the value for `key` (`NSNull` if known to be absent), or nil if it has to be read from the database.
+- (id)objectForKey:(NSString *)key writeCount:(NSUInteger *)writeCount {
+    @synchronized (self) {
+        id object = _pendingWrites[key] ?: [_cache objectForKey:key];
+
+        if (!object && writeCount) {
+            *writeCount = _writeCount;
+        }
+
+        return object;
+    }
+}
+
+/// Adds the values known for `keys` to `objects` and the others to `missingKeys`, returning the write count.
+- (NSUInteger)getObjects:(NSMutableDictionary *)objects missingKeys:(NSMutableArray *)missingKeys forKeys:(NSArray<NSString *> *)keys {
+    @synchronized (self) {
+        for (NSString *key in keys) {
+            id object = _pendingWrites[key] ?: [_cache objectForKey:key];
+
+            if (object) {
+                objects[key] = object;
+            } else {
+                [missingKeys addObject:key];
+            }
+        }
+
+        return _writeCount;
+    }
+}
+
+/// Caches values just read from the database, unless a write happened since the read started.
+- (void)fillObjects:(NSDictionary<NSString *, id> *)objects writeCount:(NSUInteger)writeCount {
+    @synchronized (self) {
+        if (writeCount == _writeCount) {
+            [objects enumerateKeysAndObjectsUsingBlock:^(NSString *key, id object, BOOL *stop) {
+                [self cacheObject:object forKey:key];
+            }];
+        }
+    }
+}
+
+/// Records `objects` as pending, returning the write count that identifies this write.
+- (NSUInteger)writeObjects:(NSDictionary<NSString *, id> *)objects {
+    @synchronized (self) {
+        NSNumber *writeCount = @(++_writeCount);
+
+        [_pendingWrites addEntriesFromDictionary:objects];
+        [objects enumerateKeysAndObjectsUsingBlock:^(NSString *key, id object, BOOL *stop) {
+            self->_pendingWriteCounts[key] = writeCount;
+            [self cacheObject:object forKey:key];
+        }];
+
+        return _writeCount;
+    }
+}
+
+/// Drops the pending values of a write once it is in the database, unless a later write replaced them.
+- (void)didWriteObjects:(NSDictionary<NSString *, id> *)objects writeCount:(NSUInteger)writeCount {
+    @synchronized (self) {
+        for (NSString *key in objects) {
+            if ([_pendingWriteCounts[key] unsignedIntegerValue] == writeCount) {
+                [_pendingWrites removeObjectForKey:key];
+                [_pendingWriteCounts removeObjectForKey:key];
+            }
+        }
+    }
+}
+
+@end
+
 @interface LCKeyValueStore () {
     NSString *_dbPath;
     NSString *_tableName;
     LCDatabaseQueue *_dbQueue;
+    LCKeyValueMemoryTier *_memoryTier;
+    LCSQLHandle *_selectSQL;
+    LCSQLHandle *_selectManySQL;
+    LCSQLHandle *_updateSQL;
+    LCSQLHandle *_deleteSQL;
 }
 
 - (NSString *)dbPath;
@@ -65,21 +215,25 @@ static OSSpinLock dbQueueLock = OS_SPINLOCK_INIT;
     return instance;
 }
 
-- (instancetype)initWithDatabasePath:(NSString *)databasePath {
-    self = [super init];
-
-    if (self) {
-        _dbPath = [databasePath copy];
-    }
+- (instancetype)init {
+    return [self initWithDatabasePath:nil tableName:nil];
+}
 
-    return self;
+- (instancetype)initWithDatabasePath:(NSString *)databasePath {
+    return [self initWithDatabasePath:databasePath tableName:nil];
 }
 
 - (instancetype)initWithDatabasePath:(NSString *)databasePath tableName:(NSString *)tableName {
-    self = [self initWithDatabasePath:databasePath];
+    self = [super init];
 
     if (self) {
+        _dbPath = [databasePath copy];
         _tableName = [tableName copy];
+        _memoryTier = [LCKeyValueMemoryTier tierForDatabasePath:[self dbPath] tableName:[self tableName]];
+        _selectSQL = [LCSQLHandle handleWithSQL:[self formatSQL:LC_SQL_SELECT_KEY_VALUE_FMT withTableName:[self tableName]]];
+        _selectManySQL = [LCSQLHandle handleWithSQL:[self selectSQLForKeyCount:LCKeyValueStoreMaxKeysPerQuery]];
+        _updateSQL = [LCSQLHandle handleWithSQL:[self formatSQL:LC_SQL_UPDATE_KEY_VALUE_FMT withTableName:[self tableName]]];
+        _deleteSQL = [LCSQLHandle handleWithSQL:[self formatSQL:LC_SQL_DELETE_KEY_VALUE_FMT withTableName:[self tableName]]];
     }
 
     return self;
@@ -90,44 +244,223 @@ static OSSpinLock dbQueueLock = OS_SPINLOCK_INIT;
 }
 
 - (NSData *)dataForKey:(NSString *)key {
+    if (![key length]) {
+        return nil;
+    }
+
+    NSUInteger writeCount = 0;
+    id object = [_memoryTier objectForKey:key writeCount:&writeCount];
+
+    if (object) {
+        return (object == [NSNull null] ? nil : object);
+    }
+
     __block NSData *data = nil;
-    
-    if ([key length]) {
+
+    LC_OPEN_DATABASE(db, ({
+        LCResultSet *result = [db executeQueryWithHandle:self->_selectSQL arguments:@[key]];
+
+        if ([result next]) {
+            data = [result dataForColumn:LC_FIELD_VALUE];
+        }
+
+        [result close];
+    }));
+
+    [_memoryTier fillObjects:@{ key: (data ?: [NSNull null]) } writeCount:writeCount];
+
+    return data;
+}
+
+- (NSDictionary<NSString *, NSData *> *)dataForKeys:(NSArray<NSString *> *)keys {
+    NSMutableDictionary *objects = [NSMutableDictionary dictionary];
+    NSMutableArray *missingKeys = [NSMutableArray array];
+    NSUInteger writeCount = [_memoryTier getObjects:objects missingKeys:missingKeys forKeys:keys];
+
+    if (missingKeys.count) {
+        NSMutableDictionary *fetchedObjects = [NSMutableDictionary dictionary];
+
+        for (NSString *key in missingKeys) {
+            fetchedObjects[key] = [NSNull null];
+        }
+
+        [self.dbQueue inDeferredTransaction:^(LCDatabase *db, BOOL *rollback) {
+            db.logsErrors = shouldLogError;
+
+            for (NSUInteger location = 0; location < missingKeys.count; location += LCKeyValueStoreMaxKeysPerQuery) {
+                NSRange range = NSMakeRange(location, MIN(LCKeyValueStoreMaxKeysPerQuery, missingKeys.count - location));
+                NSArray *args = [missingKeys subarrayWithRange:range];
+                LCResultSet *result = (range.length == LCKeyValueStoreMaxKeysPerQuery ?
+                                       [db executeQueryWithHandle:self->_selectManySQL arguments:args] :
+                                       [db executeQuery:[self selectSQLForKeyCount:range.length] withArgumentsInArray:args]);
+
+                while ([result next]) {
+                    NSData *data = [result dataForColumn:LC_FIELD_VALUE];
+                    fetchedObjects[[result stringForColumn:LC_FIELD_KEY]] = data ?: [NSNull null];
+                }
+
+                [result close];
+            }
+        }];
+
+        [_memoryTier fillObjects:fetchedObjects writeCount:writeCount];
+        [objects addEntriesFromDictionary:fetchedObjects];
+    }
+
+    [objects removeObjectsForKeys:[objects allKeysForObject:[NSNull null]]];
+
+    return objects;
+}
+
+- (NSString *)selectSQLForKeyCount:(NSUInteger)count {
+    NSMutableArray *placeholders = [NSMutableArray arrayWithCapacity:count];
+
+    for (NSUInteger i = 0; i < count; i++) {
+        [placeholders addObject:@"?"];
+    }
+
+    return [NSString stringWithFormat:LC_SQL_SELECT_KEY_VALUE_IN_FMT, [self tableName], [placeholders componentsJoinedByString:@", "]];
+}
+
+- (void)setData:(NSData *)data forKey:(NSString *)key {
+    [self writeObjects:@{ key: ([data copy] ?: [NSNull null]) }];
+}
+
+- (void)setDataDictionary:(NSDictionary<NSString *, NSData *> *)dictionary {
+    if (!dictionary.count) {
+        return;
+    }
+
+    NSMutableDictionary *objects = [NSMutableDictionary dictionaryWithCapacity:dictionary.count];
+
+    [dictionary enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSData *data, BOOL *stop) {
+        objects[key] = [data copy];
+    }];
+
+    [self writeObjects:objects];
+}
+
+- (void)deleteKey:(NSString *)key {
+    [self writeObjects:@{ key: [NSNull null] }];
+}
+
+- (void)deleteKeys:(NSArray<NSString *> *)keys {
+    if (!keys.count) {
+        return;
+    }
+
+    NSMutableDictionary *objects = [NSMutableDictionary dictionaryWithCapacity:keys.count];
+
+    for (NSString *key in keys) {
+        objects[key] = [NSNull null];
+    }
+
+    [self writeObjects:objects];
+}
+
+/**
+ Writes through the memory tier right away, and to the database in order on the tier's write queue.
+ `NSNull` values delete their keys. Each call is committed in one transaction.
+ */
+- (void)writeObjects:(NSDictionary<NSString *, id> *)objects {
+    LCKeyValueMemoryTier *memoryTier = _memoryTier;
+    LCSQLHandle *updateSQL = _updateSQL;
+    LCSQLHandle *deleteSQL = _deleteSQL;
+
+    NSUInteger writeCount = [memoryTier writeObjects:objects];
+
+    dispatch_async(memoryTier->_writeQueue, ^{
+        [self.dbQueue inTransaction:^(LCDatabase *db, BOOL *rollback) {
+            db.logsErrors = shouldLogError;
+
+            [objects enumerateKeysAndObjectsUsingBlock:^(NSString *key, id object, BOOL *stop) {
+                if (object == [NSNull null]) {
+                    [db executeUpdateWithHandle:deleteSQL arguments:@[key]];
+                } else {
+                    [db executeUpdateWithHandle:updateSQL arguments:@[key, object]];
+                }
+            }];
+        }];
+        [memoryTier didWriteObjects:objects writeCount:writeCount];
+    });
+}
+
+- (void)enumerateDataFromKey:(NSString *)fromKey
+                       toKey:(NSString *)toKey
+                  usingBlock:(void (^)(NSString *key, NSData *data, BOOL *stop))block
+{
+    [self flush];
+
+    NSString *lowerKey = fromKey;
+    BOOL inclusive = YES;
+    BOOL stop = NO;
+
+    while (!stop) {
+        NSMutableArray *keys = [NSMutableArray arrayWithCapacity:LCKeyValueStoreScanPageSize];
+        NSMutableArray *values = [NSMutableArray arrayWithCapacity:LCKeyValueStoreScanPageSize];
+        NSMutableString *SQL = [NSMutableString stringWithFormat:@"SELECT * FROM %@ WHERE 1", [self tableName]];
+        NSMutableArray *args = [NSMutableArray array];
+
+        if (lowerKey) {
+            [SQL appendString:(inclusive ? @" AND " LC_FIELD_KEY @" >= ?" : @" AND " LC_FIELD_KEY @" > ?")];
+            [args addObject:lowerKey];
+        }
+        if (toKey) {
+            [SQL appendString:@" AND " LC_FIELD_KEY @" < ?"];
+            [args addObject:toKey];
+        }
+        [SQL appendFormat:@" ORDER BY " LC_FIELD_KEY @" LIMIT %lu", (unsigned long)LCKeyValueStoreScanPageSize];
+
         LC_OPEN_DATABASE(db, ({
-            NSArray *args = @[key];
-            NSString *SQL = [self formatSQL:LC_SQL_SELECT_KEY_VALUE_FMT withTableName:[self tableName]];
             LCResultSet *result = [db executeQuery:SQL withArgumentsInArray:args];
-            
-            if ([result next]) {
-                data = [result dataForColumn:LC_FIELD_VALUE];
+
+            while ([result next]) {
+                [keys addObject:[result stringForColumn:LC_FIELD_KEY]];
+                [values addObject:([result dataForColumn:LC_FIELD_VALUE] ?: [NSData data])];
             }
-            
+
             [result close];
         }));
+
+        for (NSUInteger i = 0; i < keys.count && !stop; i++) {
+            block(keys[i], values[i], &stop);
+        }
+
+        if (keys.count < LCKeyValueStoreScanPageSize) {
+            break;
+        }
+
+        lowerKey = [keys lastObject];
+        inclusive = NO;
     }
-    
-    return data;
 }
 
-- (void)setData:(NSData *)data forKey:(NSString *)key {
-    LC_OPEN_DATABASE(db, ({
-        NSArray *args = @[key, data];
-        NSString *SQL = [self formatSQL:LC_SQL_UPDATE_KEY_VALUE_FMT withTableName:[self tableName]];
-        [db executeUpdate:SQL withArgumentsInArray:args];
-    }));
+- (void)enumerateDataWithKeyPrefix:(NSString *)prefix
+                        usingBlock:(void (^)(NSString *key, NSData *data, BOOL *stop))block
+{
+    // -hasPrefix: is false for an empty prefix, which matches every key.
+    if (prefix.length == 0) {
+        [self enumerateDataFromKey:nil toKey:nil usingBlock:block];
+        return;
+    }
+    [self enumerateDataFromKey:prefix toKey:nil usingBlock:^(NSString *key, NSData *data, BOOL *stop) {
+        // Keys sharing a prefix are contiguous in the index, so the first one without it ends the scan.
+        if ([key hasPrefix:prefix]) {
+            block(key, data, stop);
+        } else {
+            *stop = YES;
+        }
+    }];
 }
 
-- (void)deleteKey:(NSString *)key {
-    LC_OPEN_DATABASE(db, ({
-        NSArray *args = @[key];
-        NSString *SQL = [self formatSQL:LC_SQL_DELETE_KEY_VALUE_FMT withTableName:[self tableName]];
-        [db executeUpdate:SQL withArgumentsInArray:args];
-    }));
+- (void)flush {
+    dispatch_sync(_memoryTier->_writeQueue, ^{});
 }
 
 - (void)createSchemeForDatabaseQueue:(LCDatabaseQueue *)dbQueue {
     [dbQueue inDatabase:^(LCDatabase *db) {
         db.logsErrors = shouldLogError;
+        db.shouldCacheStatements = YES;
 
         NSString *SQL = [self formatSQL:LC_SQL_CREATE_KEY_VALUE_TABLE_FMT withTableName:[self tableName]];
         [db executeUpdate:SQL];
@@ -41,6 +41,8 @@
 
 typedef int(^FMDBExecuteStatementsCallbackBlock)(NSDictionary *resultsDictionary);
 
+@class LCSQLHandle;
+
 
 /** A SQLite ([http://sqlite.org/](http://sqlite.org/)) Objective-C wrapper.
  
@@ -86,6 +88,12 @@ typedef int(^FMDBExecuteStatementsCallbackBlock)(NSDictionary *resultsDictionary
     NSTimeInterval      _startBusyRetryTime;
     
     NSMutableDictionary *_cachedStatements;
+    NSMutableOrderedSet *_cachedStatementHandles;
+    NSUInteger          _cachedStatementCost;
+    NSUInteger          _statementCacheCountLimit;
+    NSUInteger          _statementCacheCostLimit;
+    NSUInteger          _statementCacheHitCount;
+    NSUInteger          _statementCacheMissCount;
     NSMutableSet        *_openResultSets;
     NSMutableSet        *_openFunctions;
 
@@ -112,7 +120,7 @@ typedef int(^FMDBExecuteStatementsCallbackBlock)(NSDictionary *resultsDictionary
 
 @property (atomic, assign) BOOL logsErrors;
 
-/** Dictionary of cached statements */
+/** Dictionary of cached statements, keyed by `<LCSQLHandle>` */
 
 @property (atomic, retain) NSMutableDictionary *cachedStatements;
 
@@ -351,6 +359,21 @@ typedef int(^FMDBExecuteStatementsCallbackBlock)(NSDictionary *resultsDictionary
 
 - (BOOL)executeUpdate:(NSString*)sql withArgumentsInArray:(NSArray *)arguments;
 
+/** Execute single update statement of an interned SQL handle
+
+ Like `<executeUpdate:withArgumentsInArray:>`, but the cached statement is looked up by the identity of `handle`, without hashing the SQL.
+
+ @param handle The interned SQL to be performed, with optional `?` placeholders.
+
+ @param arguments A `NSArray` of objects to be used when binding values to the `?` placeholders in the SQL statement.
+
+ @return `YES` upon success; `NO` upon failure.
+
+ @see LCSQLHandle
+ */
+
+- (BOOL)executeUpdateWithHandle:(LCSQLHandle *)handle arguments:(NSArray *)arguments;
+
 /** Execute single update statement
 
  This method executes a single SQL update statement (i.e. any SQL that does not return results, such as `UPDATE`, `INSERT`, or `DELETE`. This method employs [`sqlite3_prepare_v2`](http://sqlite.org/c3ref/prepare.html) and [`sqlite_step`](http://sqlite.org/c3ref/step.html) to perform the update. Unlike the other `executeUpdate` methods, this uses printf-style formatters (e.g. `%s`, `%d`, etc.) to build the SQL.
@@ -527,6 +550,21 @@ typedef int(^FMDBExecuteStatementsCallbackBlock)(NSDictionary *resultsDictionary
 
 - (LCResultSet *)executeQuery:(NSString *)sql withArgumentsInArray:(NSArray *)arguments;
 
+/** Execute select statement of an interned SQL handle
+
+ Like `<executeQuery:withArgumentsInArray:>`, but the cached statement is looked up by the identity of `handle`, without hashing the SQL.
+
+ @param handle The interned SELECT statement to be performed, with optional `?` placeholders.
+
+ @param arguments A `NSArray` of objects to be used when binding values to the `?` placeholders in the SQL statement.
+
+ @return A `<FMResultSet>` for the result set upon success; `nil` upon failure.
+
+ @see LCSQLHandle
+ */
+
+- (LCResultSet *)executeQueryWithHandle:(LCSQLHandle *)handle arguments:(NSArray *)arguments;
+
 /** Execute select statement
 
  Executing queries returns an `<FMResultSet>` object if successful, and `nil` upon failure.  Like executing updates, there is a variant that accepts an `NSError **` parameter.  Otherwise you should use the `<lastErrorMessage>` and `<lastErrorMessage>` methods to determine why a query failed.
@@ -651,6 +689,22 @@ typedef int(^FMDBExecuteStatementsCallbackBlock)(NSDictionary *resultsDictionary
 
 - (void)setShouldCacheStatements:(BOOL)value;
 
+/** The most SQL handles with cached statements. The least recently used ones are evicted beyond it. Defaults to 64. */
+
+@property (atomic, assign) NSUInteger statementCacheCountLimit;
+
+/** The most total cost of the cached statements, where a statement costs the length of its SQL. Defaults to 64K. */
+
+@property (atomic, assign) NSUInteger statementCacheCostLimit;
+
+/** Number of statements found in the cache */
+
+@property (atomic, readonly) NSUInteger statementCacheHitCount;
+
+/** Number of statements prepared while caching statements */
+
+@property (atomic, readonly) NSUInteger statementCacheMissCount;
+
 
 ///-------------------------
 /// @name Encryption methods
@@ -1035,11 +1089,29 @@ typedef int(^FMDBExecuteStatementsCallbackBlock)(NSDictionary *resultsDictionary
  - [`sqlite3_stmt`](http://www.sqlite.org/c3ref/stmt.html)
  */
 
+/** Interned SQL
+
+ There is one `LCSQLHandle` for equal SQL strings while it is alive, so cached statements are looked up by its identity. Callers running the same SQL repeatedly can keep a handle and pass it to `<[LCDatabase executeQueryWithHandle:arguments:]>` and `<[LCDatabase executeUpdateWithHandle:arguments:]>`.
+ */
+
+@interface LCSQLHandle : NSObject <NSCopying>
+
+/** The interned handle of `SQL` */
+
++ (instancetype)handleWithSQL:(NSString *)SQL;
+
+/** SQL statement */
+
+@property (nonatomic, readonly, copy) NSString *SQL;
+
+@end
+
 @interface LCStatement : NSObject {
     sqlite3_stmt *_statement;
     NSString *_query;
     long _useCount;
     BOOL _inUse;
+    NSMutableDictionary *_columnNameToIndexMap;
 }
 
 ///-----------------
@@ -1065,6 +1137,13 @@ typedef int(^FMDBExecuteStatementsCallbackBlock)(NSDictionary *resultsDictionary
 
 @property (atomic, assign) BOOL inUse;
 
+/** Lowercased column names mapped to column indexes, shared by the result sets of this statement
+ 
+ Set by the first `<LCResultSet>` that looks up a column by name, so that a cached statement resolves its column names once.
+ */
+
+@property (atomic, retain) NSMutableDictionary *columnNameToIndexMap;
+
 ///----------------------------
 /// @name Closing and Resetting
 ///----------------------------
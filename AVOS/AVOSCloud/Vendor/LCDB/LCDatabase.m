@@ -6,6 +6,8 @@
 
 - (LCResultSet *)executeQuery:(NSString *)sql withArgumentsInArray:(NSArray*)arrayArgs orDictionary:(NSDictionary *)dictionaryArgs orVAList:(va_list)args;
 - (BOOL)executeUpdate:(NSString*)sql error:(NSError**)outErr withArgumentsInArray:(NSArray*)arrayArgs orDictionary:(NSDictionary *)dictionaryArgs orVAList:(va_list)args;
+- (LCResultSet *)executeQuery:(NSString *)sql handle:(LCSQLHandle *)handle withArgumentsInArray:(NSArray*)arrayArgs orDictionary:(NSDictionary *)dictionaryArgs orVAList:(va_list)args;
+- (BOOL)executeUpdate:(NSString*)sql handle:(LCSQLHandle *)handle error:(NSError**)outErr withArgumentsInArray:(NSArray*)arrayArgs orDictionary:(NSDictionary *)dictionaryArgs orVAList:(va_list)args;
 
 @end
 
@@ -15,6 +17,10 @@
 @synthesize crashOnErrors=_crashOnErrors;
 @synthesize checkedOut=_checkedOut;
 @synthesize traceExecution=_traceExecution;
+@synthesize statementCacheCountLimit=_statementCacheCountLimit;
+@synthesize statementCacheCostLimit=_statementCacheCostLimit;
+@synthesize statementCacheHitCount=_statementCacheHitCount;
+@synthesize statementCacheMissCount=_statementCacheMissCount;
 
 #pragma mark FMDatabase instantiation and deallocation
 
@@ -39,6 +45,8 @@
         _logsErrors                 = YES;
         _crashOnErrors              = NO;
         _maxBusyRetryTimeInterval   = 2;
+        _statementCacheCountLimit   = 64;
+        _statementCacheCostLimit    = 64 * 1024;
     }
     
     return self;
@@ -56,6 +64,7 @@
     [self close];
     FMDBRelease(_openResultSets);
     FMDBRelease(_cachedStatements);
+    FMDBRelease(_cachedStatementHandles);
     FMDBRelease(_dateFormat);
     FMDBRelease(_databasePath);
     FMDBRelease(_openFunctions);
@@ -316,36 +325,81 @@ static int FMDBDatabaseBusyHandler(void *f, int count) {
     }
     
     [_cachedStatements removeAllObjects];
+    [_cachedStatementHandles removeAllObjects];
+    _cachedStatementCost = 0;
 }
 
-- (LCStatement*)cachedStatementForQuery:(NSString*)query {
+- (void)touchCachedStatementHandle:(LCSQLHandle*)handle {
     
-    NSMutableSet* statements = [_cachedStatements objectForKey:query];
+    if ([_cachedStatementHandles lastObject] != handle) {
+        [_cachedStatementHandles removeObject:handle];
+        [_cachedStatementHandles addObject:handle];
+    }
+}
+
+- (LCStatement*)cachedStatementForHandle:(LCSQLHandle*)handle {
+    
+    NSMutableSet* statements = [_cachedStatements objectForKey:handle];
     
-    return [[statements objectsPassingTest:^BOOL(LCStatement* statement, BOOL *stop) {
+    LCStatement *statement = [[statements objectsPassingTest:^BOOL(LCStatement* statement, BOOL *stop) {
         
         *stop = ![statement inUse];
         return *stop;
         
     }] anyObject];
+    
+    if (statement) {
+        _statementCacheHitCount++;
+        [self touchCachedStatementHandle:handle];
+    }
+    else {
+        _statementCacheMissCount++;
+    }
+    
+    return statement;
 }
 
 
-- (void)setCachedStatement:(LCStatement*)statement forQuery:(NSString*)query {
+- (void)setCachedStatement:(LCStatement*)statement forHandle:(LCSQLHandle*)handle {
     
-    query = [query copy]; // in case we got handed in a mutable string...
-    [statement setQuery:query];
+    [statement setQuery:[handle SQL]];
     
-    NSMutableSet* statements = [_cachedStatements objectForKey:query];
+    NSMutableSet* statements = [_cachedStatements objectForKey:handle];
     if (!statements) {
         statements = [NSMutableSet set];
+        [_cachedStatements setObject:statements forKey:handle];
     }
     
     [statements addObject:statement];
     
-    [_cachedStatements setObject:statements forKey:query];
+    [self touchCachedStatementHandle:handle];
+    _cachedStatementCost += [[handle SQL] length];
     
-    FMDBRelease(query);
+    [self evictCachedStatementsIfNeeded];
+}
+
+/*
+ Evicts the statements of the least recently used handles until the cache is within its limits.
+ The most recent handle is always kept, since its statement is about to run. A statement still
+ used by a result set is finalized once the result set releases it.
+ */
+- (void)evictCachedStatementsIfNeeded {
+    
+    while ([_cachedStatementHandles count] > 1 &&
+           ([_cachedStatementHandles count] > _statementCacheCountLimit || _cachedStatementCost > _statementCacheCostLimit)) {
+        
+        LCSQLHandle *handle = [_cachedStatementHandles firstObject];
+        
+        for (LCStatement *statement in [_cachedStatements objectForKey:handle]) {
+            if (![statement inUse]) {
+                [statement close];
+            }
+            _cachedStatementCost -= [[handle SQL] length];
+        }
+        
+        [_cachedStatements removeObjectForKey:handle];
+        [_cachedStatementHandles removeObjectAtIndex:0];
+    }
 }
 
 #pragma mark Key routines
@@ -732,6 +786,14 @@ static int FMDBDatabaseBusyHandler(void *f, int count) {
 }
 
 - (LCResultSet *)executeQuery:(NSString *)sql withArgumentsInArray:(NSArray*)arrayArgs orDictionary:(NSDictionary *)dictionaryArgs orVAList:(va_list)args {
+    return [self executeQuery:sql handle:nil withArgumentsInArray:arrayArgs orDictionary:dictionaryArgs orVAList:args];
+}
+
+- (LCResultSet *)executeQueryWithHandle:(LCSQLHandle *)handle arguments:(NSArray *)arguments {
+    return [self executeQuery:[handle SQL] handle:handle withArgumentsInArray:arguments orDictionary:nil orVAList:nil];
+}
+
+- (LCResultSet *)executeQuery:(NSString *)sql handle:(LCSQLHandle *)handle withArgumentsInArray:(NSArray*)arrayArgs orDictionary:(NSDictionary *)dictionaryArgs orVAList:(va_list)args {
     
     if (![self databaseExists]) {
         return 0x00;
@@ -753,8 +815,11 @@ static int FMDBDatabaseBusyHandler(void *f, int count) {
         NSLog(@"%@ executeQuery: %@", self, sql);
     }
     
-    if (_shouldCacheStatements) {
-        statement = [self cachedStatementForQuery:sql];
+    if (_shouldCacheStatements && sql) {
+        if (!handle) {
+            handle = [LCSQLHandle handleWithSQL:sql];
+        }
+        statement = [self cachedStatementForHandle:handle];
         pStmt = statement ? [statement statement] : 0x00;
         [statement reset];
     }
@@ -857,7 +922,7 @@ static int FMDBDatabaseBusyHandler(void *f, int count) {
         [statement setStatement:pStmt];
         
         if (_shouldCacheStatements && sql) {
-            [self setCachedStatement:statement forQuery:sql];
+            [self setCachedStatement:statement forHandle:handle];
         }
     }
     
@@ -911,6 +976,14 @@ static int FMDBDatabaseBusyHandler(void *f, int count) {
 #pragma mark Execute updates
 
 - (BOOL)executeUpdate:(NSString*)sql error:(NSError**)outErr withArgumentsInArray:(NSArray*)arrayArgs orDictionary:(NSDictionary *)dictionaryArgs orVAList:(va_list)args {
+    return [self executeUpdate:sql handle:nil error:outErr withArgumentsInArray:arrayArgs orDictionary:dictionaryArgs orVAList:args];
+}
+
+- (BOOL)executeUpdateWithHandle:(LCSQLHandle *)handle arguments:(NSArray *)arguments {
+    return [self executeUpdate:[handle SQL] handle:handle error:nil withArgumentsInArray:arguments orDictionary:nil orVAList:nil];
+}
+
+- (BOOL)executeUpdate:(NSString*)sql handle:(LCSQLHandle *)handle error:(NSError**)outErr withArgumentsInArray:(NSArray*)arrayArgs orDictionary:(NSDictionary *)dictionaryArgs orVAList:(va_list)args {
     
     if (![self databaseExists]) {
         return NO;
@@ -931,8 +1004,11 @@ static int FMDBDatabaseBusyHandler(void *f, int count) {
         NSLog(@"%@ executeUpdate: %@", self, sql);
     }
     
-    if (_shouldCacheStatements) {
-        cachedStmt = [self cachedStatementForQuery:sql];
+    if (_shouldCacheStatements && sql) {
+        if (!handle) {
+            handle = [LCSQLHandle handleWithSQL:sql];
+        }
+        cachedStmt = [self cachedStatementForHandle:handle];
         pStmt = cachedStmt ? [cachedStmt statement] : 0x00;
         [cachedStmt reset];
     }
@@ -1067,12 +1143,12 @@ static int FMDBDatabaseBusyHandler(void *f, int count) {
         NSAssert(NO, @"A executeUpdate is being called with a query string '%@'", sql);
     }
     
-    if (_shouldCacheStatements && !cachedStmt) {
+    if (_shouldCacheStatements && sql && !cachedStmt) {
         cachedStmt = [[LCStatement alloc] init];
         
         [cachedStmt setStatement:pStmt];
         
-        [self setCachedStatement:cachedStmt forQuery:sql];
+        [self setCachedStatement:cachedStmt forHandle:handle];
         
         FMDBRelease(cachedStmt);
     }
@@ -1340,10 +1416,16 @@ static NSString *FMDBEscapeSavePointName(NSString *savepointName) {
     
     if (_shouldCacheStatements && !_cachedStatements) {
         [self setCachedStatements:[NSMutableDictionary dictionary]];
+        FMDBRelease(_cachedStatementHandles);
+        _cachedStatementHandles = [[NSMutableOrderedSet alloc] init];
+        _cachedStatementCost = 0;
     }
     
     if (!_shouldCacheStatements) {
         [self setCachedStatements:nil];
+        FMDBRelease(_cachedStatementHandles);
+        _cachedStatementHandles = nil;
+        _cachedStatementCost = 0;
     }
 }
 
@@ -1382,11 +1464,56 @@ void LCDBBlockSQLiteCallBackFunction(sqlite3_context *context, int argc, sqlite3
 
 
 
+@implementation LCSQLHandle
+@synthesize SQL=_SQL;
+
++ (instancetype)handleWithSQL:(NSString *)SQL {
+    
+    static NSMapTable *handles = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^{
+        // Both sides are weak: the key is the SQL owned by the handle, so an entry goes away with its handle.
+        handles = FMDBReturnRetained([NSMapTable weakToWeakObjectsMapTable]);
+    });
+    
+    @synchronized (handles) {
+        LCSQLHandle *handle = [handles objectForKey:SQL];
+        
+        if (!handle) {
+            handle = FMDBReturnAutoreleased([[self alloc] init]);
+            handle->_SQL = [SQL copy];
+            [handles setObject:handle forKey:handle->_SQL];
+        }
+        
+        return handle;
+    }
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    return FMDBReturnRetained(self);
+}
+
+- (void)dealloc {
+    FMDBRelease(_SQL);
+#if ! __has_feature(objc_arc)
+    [super dealloc];
+#endif
+}
+
+- (NSString*)description {
+    return [NSString stringWithFormat:@"%@ %@", [super description], _SQL];
+}
+
+@end
+
+
 @implementation LCStatement
 @synthesize statement=_statement;
 @synthesize query=_query;
 @synthesize useCount=_useCount;
 @synthesize inUse=_inUse;
+@synthesize columnNameToIndexMap=_columnNameToIndexMap;
 
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-implementations"
@@ -1399,6 +1526,7 @@ void LCDBBlockSQLiteCallBackFunction(sqlite3_context *context, int argc, sqlite3
 - (void)dealloc {
     [self close];
     FMDBRelease(_query);
+    FMDBRelease(_columnNameToIndexMap);
 #if ! __has_feature(objc_arc)
     [super dealloc];
 #endif
@@ -127,6 +127,28 @@
 
 - (int)columnIndexForName:(NSString*)columnName;
 
+/** Column indexes for column names
+
+ Resolves a list of column names once, so that a row can then be read with the `*ForColumnIndex:` methods alone.
+
+ @param columnIndexes A buffer of at least `[columnNames count]` ints, receiving the zero-based index of each column, or `-1` if there is no such column.
+ @param columnNames `NSArray` of the names of the columns.
+ */
+
+- (void)getColumnIndexes:(int *)columnIndexes forColumnNames:(NSArray*)columnNames;
+
+/** Enumerate the remaining rows with resolved column indexes
+
+ Column names are resolved once before the first row; `block` is then called for every row with the indexes, in the order of `columnNames`.
+
+ @param columnNames `NSArray` of the names of the columns read by `block`.
+ @param block The row visitor. Set `*stop` to `YES` to stop the enumeration.
+
+ @see getColumnIndexes:forColumnNames:
+ */
+
+- (void)enumerateRowsWithColumnNames:(NSArray*)columnNames usingBlock:(void (^)(LCResultSet *row, const int *columnIndexes, BOOL *stop))block;
+
 /** Column name for column index
 
  @param columnIdx Zero-based index for column.
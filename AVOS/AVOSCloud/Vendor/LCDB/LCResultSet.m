@@ -64,16 +64,47 @@
 - (NSMutableDictionary *)columnNameToIndexMap {
     if (!_columnNameToIndexMap) {
         int columnCount = sqlite3_column_count([_statement statement]);
+        
+        // a cached statement keeps the map of its previous result sets, unless a schema change re-prepared it with other columns
+        NSMutableDictionary *statementMap = [_statement columnNameToIndexMap];
+        if (statementMap && [statementMap count] == (NSUInteger)columnCount) {
+            _columnNameToIndexMap = FMDBReturnRetained(statementMap);
+            return _columnNameToIndexMap;
+        }
+        
         _columnNameToIndexMap = [[NSMutableDictionary alloc] initWithCapacity:(NSUInteger)columnCount];
         int columnIdx = 0;
         for (columnIdx = 0; columnIdx < columnCount; columnIdx++) {
             [_columnNameToIndexMap setObject:[NSNumber numberWithInt:columnIdx]
                                       forKey:[[NSString stringWithUTF8String:sqlite3_column_name([_statement statement], columnIdx)] lowercaseString]];
         }
+        [_statement setColumnNameToIndexMap:_columnNameToIndexMap];
     }
     return _columnNameToIndexMap;
 }
 
+- (void)getColumnIndexes:(int *)columnIndexes forColumnNames:(NSArray *)columnNames {
+    NSUInteger count = [columnNames count];
+    NSUInteger idx = 0;
+    for (idx = 0; idx < count; idx++) {
+        columnIndexes[idx] = [self columnIndexForName:[columnNames objectAtIndex:idx]];
+    }
+}
+
+- (void)enumerateRowsWithColumnNames:(NSArray *)columnNames usingBlock:(void (^)(LCResultSet *row, const int *columnIndexes, BOOL *stop))block {
+    NSUInteger count = [columnNames count];
+    int *columnIndexes = malloc(sizeof(int) * MAX(count, (NSUInteger)1));
+    
+    [self getColumnIndexes:columnIndexes forColumnNames:columnNames];
+    
+    BOOL stop = NO;
+    while (!stop && [self next]) {
+        block(self, columnIndexes, &stop);
+    }
+    
+    free(columnIndexes);
+}
+
 - (void)kvcMagic:(id)object {
     
     int columnCount = sqlite3_column_count([_statement statement]);
@@ -27,6 +27,7 @@ typedef NS_OPTIONS(NSUInteger, LCIMSessionConfigOptions) {
     LCIMSessionConfigOptionsPartialFailedMessage                = 1 << 5,
     LCIMSessionConfigOptionsGroupChatRCP                        = 1 << 6,
     LCIMSessionConfigOptionsOmitPeerID                          = 1 << 7,
+    LCIMSessionConfigOptionsMessagePackBody                     = 1 << 8,
 };
 
 /// conversation property key
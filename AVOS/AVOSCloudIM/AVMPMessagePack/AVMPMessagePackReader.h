@@ -10,6 +10,8 @@
 
 typedef NS_ENUM(NSInteger, AVMPMessagePackReaderOptions) {
   AVMPMessagePackReaderOptionsUseOrderedDictionary = 1 << 0,
+  // Strings and data are views into the source data, which is kept alive by them.
+  AVMPMessagePackReaderOptionsNoCopy = 1 << 1,
 };
 
 
@@ -19,7 +19,40 @@
 @property AVMPMessagePackReaderOptions options;
 @end
 
-@implementation AVMPMessagePackReader
+#define AVMP_INTERNED_KEY_MAX_LENGTH 16
+#define AVMP_INTERNED_KEY_SLOTS      64
+
+/* The parent data is kept alive by the allocator, which no-copy strings retain as their contents deallocator. */
+static const void *mp_retain_parent(const void *info) {
+  return CFRetain(info);
+}
+
+static void mp_release_parent(const void *info) {
+  CFRelease(info);
+}
+
+static void *mp_allocate_nothing(CFIndex size, CFOptionFlags hint, void *info) {
+  return NULL;
+}
+
+static void mp_deallocate_nothing(void *ptr, void *info) {
+}
+
+static const uint8_t *mp_read_in_place(avmp_ctx_t *ctx, uint32_t length) {
+  if (length > ctx->size - ctx->pos) {
+    return NULL;
+  }
+  const uint8_t *bytes = ctx->data + ctx->pos;
+  ctx->pos += length;
+  return bytes;
+}
+
+@implementation AVMPMessagePackReader {
+  CFAllocatorRef _parentDeallocator;
+  NSString *_internedKeys[AVMP_INTERNED_KEY_SLOTS];
+  uint8_t _internedKeyBytes[AVMP_INTERNED_KEY_SLOTS][AVMP_INTERNED_KEY_MAX_LENGTH];
+  uint8_t _internedKeyLengths[AVMP_INTERNED_KEY_SLOTS];
+}
 
 - (instancetype)initWithData:(NSData *)data {
   if ((self = [super init])) {
@@ -31,11 +64,86 @@
 - (instancetype)initWithData:(NSData *)data options:(AVMPMessagePackReaderOptions)options {
   if ((self = [self initWithData:data])) {
     _options = options;
+    if ([self noCopy]) {
+      // Views must not see later mutations, copying an immutable data only retains it.
+      _data = [data copy];
+    }
   }
   return self;
 }
 
+- (void)dealloc {
+  if (_parentDeallocator) {
+    CFRelease(_parentDeallocator);
+  }
+}
+
+- (BOOL)noCopy {
+  return (_options & AVMPMessagePackReaderOptionsNoCopy) == AVMPMessagePackReaderOptionsNoCopy;
+}
+
+- (CFAllocatorRef)parentDeallocator {
+  if (!_parentDeallocator) {
+    CFAllocatorContext context = {
+      .version = 0,
+      .info = (__bridge void *)_data,
+      .retain = mp_retain_parent,
+      .release = mp_release_parent,
+      .allocate = mp_allocate_nothing,
+      .deallocate = mp_deallocate_nothing
+    };
+    _parentDeallocator = CFAllocatorCreate(kCFAllocatorDefault, &context);
+  }
+  return _parentDeallocator;
+}
+
+- (NSData *)dataWithBytes:(const uint8_t *)bytes length:(uint32_t)length {
+  if (![self noCopy]) {
+    return [NSData dataWithBytes:bytes length:length];
+  }
+  NSData *parent = _data;
+  return [[NSData alloc] initWithBytesNoCopy:(void *)bytes length:length deallocator:^(void *bytes, NSUInteger length) {
+    (void)parent;
+  }];
+}
+
+// Bytes must be validated UTF-8.
+- (NSString *)stringWithBytes:(const uint8_t *)bytes length:(uint32_t)length ascii:(BOOL)ascii {
+  CFStringEncoding encoding = ascii ? kCFStringEncodingASCII : kCFStringEncodingUTF8;
+  if (![self noCopy]) {
+    return CFBridgingRelease(CFStringCreateWithBytes(kCFAllocatorDefault, bytes, length, encoding, false));
+  }
+  // CoreFoundation still copies when the bytes are not ASCII, and then calls the deallocator right away.
+  CFStringRef string = CFStringCreateWithBytesNoCopy(kCFAllocatorDefault, bytes, length, encoding, false, [self parentDeallocator]);
+  return CFBridgingRelease(string);
+}
+
+- (NSString *)internedKeyWithBytes:(const uint8_t *)bytes length:(uint32_t)length ascii:(BOOL)ascii {
+  uint32_t hash = 2166136261u;
+  for (uint32_t i = 0; i < length; i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  NSUInteger slot = hash & (AVMP_INTERNED_KEY_SLOTS - 1);
+
+  NSString *key = _internedKeys[slot];
+  if (key && _internedKeyLengths[slot] == length && memcmp(_internedKeyBytes[slot], bytes, length) == 0) {
+    return key;
+  }
+
+  key = CFBridgingRelease(CFStringCreateWithBytes(kCFAllocatorDefault, bytes, length, ascii ? kCFStringEncodingASCII : kCFStringEncodingUTF8, false));
+  if (key) {
+    _internedKeys[slot] = key;
+    _internedKeyLengths[slot] = length;
+    memcpy(_internedKeyBytes[slot], bytes, length);
+  }
+  return key;
+}
+
 - (id)readFromContext:(avmp_ctx_t *)context error:(NSError * __autoreleasing *)error {
+  return [self readFromContext:context asKey:NO error:error];
+}
+
+- (id)readFromContext:(avmp_ctx_t *)context asKey:(BOOL)asKey error:(NSError * __autoreleasing *)error {
   avmp_object_t obj;
   if (!avmp_read_object(context, &obj)) {
     return [self returnNilWithErrorCode:200 description:@"Unable to read object" error:error];
@@ -53,12 +161,11 @@
       if (length > [_data length]) { // binary data can't be larger than the total data size
         return [self returnNilWithErrorCode:298 description:@"Invalid data length, data might be malformed" error:error];
       }
-      NSMutableData *data = [NSMutableData dataWithLength:length];
-      bool readSuccess = context->read(context, [data mutableBytes], length);
-      if (!readSuccess) {
+      const uint8_t *bytes = mp_read_in_place(context, length);
+      if (!bytes) {
         return [self returnNilWithErrorCode:202 description:@"Unable to read object" error:error];
       }
-      return data;
+      return [self dataWithBytes:bytes length:length];
     }
 
     case AVMP_TYPE_POSITIVE_FIXNUM: return @(obj.as.u8);
@@ -83,20 +190,23 @@
       if (length > [_data length]) { // str data can't be larger than the total data size
         return [self returnNilWithErrorCode:298 description:@"Invalid data length, data might be malformed" error:error];
       }
-      NSMutableData *data = [NSMutableData dataWithLength:length];
-      bool readSuccess = context->read(context, [data mutableBytes], length);
-      if (!readSuccess) {
+      const uint8_t *bytes = mp_read_in_place(context, length);
+      if (!bytes) {
         return [self returnNilWithErrorCode:202 description:@"Unable to read object" error:error];
       }
-      NSString *str = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
-      if (!str) {
+      bool ascii = false;
+      if (!avmp_utf8_validate(bytes, length, &ascii)) {
+        NSData *data = [self dataWithBytes:bytes length:length];
         // Invalid string encoding
         // Other languages have a raw byte string but not Objective-C
         AVMPErr(@"Invalid string encoding (type=%@), using str instead of bin? We'll have to return an NSData. (%@)", @(obj.type), data);
         return data;
         //return [NSNull null];
       }
-      return str;
+      if (asKey && length <= AVMP_INTERNED_KEY_MAX_LENGTH) {
+        return [self internedKeyWithBytes:bytes length:length ascii:ascii];
+      }
+      return [self stringWithBytes:bytes length:length ascii:ascii];
     }
 
     case AVMP_TYPE_FIXARRAY:
@@ -152,7 +262,7 @@
   }
   
   for (NSInteger i = 0; i < length; i++) {
-    id key = [self readFromContext:context error:error];
+    id key = [self readFromContext:context asKey:YES error:error];
     if (!key) {
       return [self returnNilWithErrorCode:203 description:@"Unable to read object" error:error];
     }
@@ -170,33 +280,13 @@
   return nil;
 }
 
-- (size_t)read:(void *)data limit:(size_t)limit {
-  if (_index + limit > [_data length]) {
-    return 0;
-  }
-  [_data getBytes:data range:NSMakeRange(_index, limit)];
-  
-//  NSData *read = [NSData dataWithBytes:data length:limit];
-//  NSLog(@"Read bytes: %@", read);
-  
-  _index += limit;
-  return limit;
-}
-
-static bool mp_reader(avmp_ctx_t *ctx, void *data, size_t limit) {
-  AVMPMessagePackReader *mp = (__bridge AVMPMessagePackReader *)ctx->buf;
-  return [mp read:data limit:limit];
-}
-
-static size_t mp_writer(avmp_ctx_t *ctx, const void *data, size_t count) {
-  return 0;
-}
-
 - (id)readObject:(NSError * __autoreleasing *)error {
   avmp_ctx_t ctx;
-  avmp_init(&ctx, (__bridge void *)self, mp_reader, mp_writer);
+  avmp_init_buffer(&ctx, (__bridge void *)self, (void *)[_data bytes], [_data length], NULL);
+  ctx.pos = _index;
   size_t index = _index;
   id obj = [self readFromContext:&ctx error:error];
+  _index = ctx.pos;
   if (error && *error) _index = index;
   return obj;
 }
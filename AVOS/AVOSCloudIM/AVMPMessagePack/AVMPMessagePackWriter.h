@@ -12,6 +12,27 @@ typedef NS_ENUM(NSInteger, AVMPMessagePackWriterOptions) {
   AVMPMessagePackWriterOptionsSortDictionaryKeys = 1 << 0,
 };
 
+typedef NS_ENUM(NSInteger, AVMPMessagePackFieldType) {
+  // Any value, written by the generic path.
+  AVMPMessagePackFieldTypeObject = 0,
+  AVMPMessagePackFieldTypeString,
+  // Integers are written directly, floating point numbers take the generic path.
+  AVMPMessagePackFieldTypeInteger,
+  // Any number is written as a float64.
+  AVMPMessagePackFieldTypeDouble,
+};
+
+/**
+ A precomputed field table for dictionaries of a known shape.
+ Keys are pre-encoded, values of the declared types are written through typed fast paths.
+ Keys out of the schema and values of unexpected types fall back to the generic path.
+ */
+@interface AVMPMessagePackSchema : NSObject
+
++ (instancetype)schemaWithFieldTypes:(NSDictionary<NSString *, NSNumber *> *)fieldTypes;
+
+@end
+
 @interface AVMPMessagePackWriter : NSObject
 
 - (NSMutableData *)writeObject:(id)obj options:(AVMPMessagePackWriterOptions)options error:(NSError * __autoreleasing *)error;
@@ -20,4 +41,6 @@ typedef NS_ENUM(NSInteger, AVMPMessagePackWriterOptions) {
 
 + (NSMutableData *)writeObject:(id)obj options:(AVMPMessagePackWriterOptions)options error:(NSError * __autoreleasing *)error;
 
++ (NSMutableData *)writeDictionary:(NSDictionary *)dictionary schema:(AVMPMessagePackSchema *)schema error:(NSError * __autoreleasing *)error;
+
 @end
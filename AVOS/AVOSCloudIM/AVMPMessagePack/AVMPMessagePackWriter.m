@@ -13,39 +13,121 @@
 #import "AVMPOrderedDictionary.h"
 #import "AVMPDefines.h"
 
-@interface AVMPMessagePackWriter ()
-@property NSMutableData *data;
+typedef struct {
+  __unsafe_unretained NSString *key;
+  AVMPMessagePackFieldType type;
+  const void *encodedKey;
+  size_t encodedKeyLength;
+} AVMPMessagePackField;
+
+@interface AVMPMessagePackSchema () {
+@public
+  AVMPMessagePackField *_fields;
+  NSUInteger _fieldCount;
+  NSSet<NSString *> *_keys;
+}
+// Own the keys and encoded keys referenced by the field table.
+@property NSArray *storage;
 @end
 
-@implementation AVMPMessagePackWriter
+@implementation AVMPMessagePackSchema
+
++ (instancetype)schemaWithFieldTypes:(NSDictionary<NSString *, NSNumber *> *)fieldTypes {
+  AVMPMessagePackSchema *schema = [[self alloc] init];
+  NSMutableArray *storage = [NSMutableArray array];
+
+  schema->_fieldCount = fieldTypes.count;
+  schema->_fields = calloc(MAX(fieldTypes.count, 1), sizeof(AVMPMessagePackField));
+  schema->_keys = [NSSet setWithArray:fieldTypes.allKeys];
+
+  NSUInteger index = 0;
+  for (NSString *key in fieldTypes) {
+    NSString *fieldKey = [key copy];
+    NSData *encodedKey = [AVMPMessagePackWriter writeObject:fieldKey error:nil];
+    [storage addObject:fieldKey];
+    [storage addObject:encodedKey];
+
+    AVMPMessagePackField *field = &schema->_fields[index++];
+    field->key = fieldKey;
+    field->type = [fieldTypes[key] integerValue];
+    field->encodedKey = encodedKey.bytes;
+    field->encodedKeyLength = encodedKey.length;
+  }
+
+  schema.storage = storage;
+  return schema;
+}
 
-- (size_t)write:(const void *)data count:(size_t)count {
-  [_data appendBytes:data length:count];
-  return count;
+- (void)dealloc {
+  free(_fields);
 }
 
-static bool mp_reader(avmp_ctx_t *ctx, void *data, size_t limit) {
-  return 0;
+@end
+
+static bool mp_write_string(avmp_ctx_t *ctx, NSString *string) {
+  CFStringRef cfString = (__bridge CFStringRef)string;
+  CFIndex length = CFStringGetLength(cfString);
+  // Strings stored as ASCII expose one byte per character, embedded NULs included.
+  const char *cString = CFStringGetCStringPtr(cfString, kCFStringEncodingASCII);
+  if (cString) {
+    return avmp_write_str(ctx, cString, (uint32_t)length);
+  }
+  // At most 3 UTF-8 bytes per UTF-16 unit, short strings convert on the stack.
+  UInt8 stackBuffer[192];
+  CFIndex maxLength = (length <= 64 ? (CFIndex)sizeof(stackBuffer) : CFStringGetMaximumSizeForEncoding(length, kCFStringEncodingUTF8));
+  if (maxLength == kCFNotFound) {
+    return false;
+  }
+  UInt8 *buffer = (length <= 64 ? stackBuffer : malloc(maxLength));
+  if (!buffer) {
+    return false;
+  }
+  CFIndex used = 0;
+  CFIndex converted = CFStringGetBytes(cfString, CFRangeMake(0, length), kCFStringEncodingUTF8, 0, false, buffer, maxLength, &used);
+  bool succeeded = (converted == length && avmp_write_str(ctx, (const char *)buffer, (uint32_t)used));
+  if (buffer != stackBuffer) {
+    free(buffer);
+  }
+  return succeeded;
 }
 
-static size_t mp_writer(avmp_ctx_t *ctx, const void *data, size_t count) {
+@interface AVMPMessagePackWriter ()
+@property NSMutableData *data;
+@end
+
+@implementation AVMPMessagePackWriter
+
+static bool mp_grower(avmp_ctx_t *ctx, size_t needed) {
   AVMPMessagePackWriter *mp = (__bridge AVMPMessagePackWriter *)ctx->buf;
-  return [mp write:data count:count];
+  size_t size = MAX(ctx->size * 2, ctx->pos + needed);
+  [mp.data setLength:size];
+  ctx->data = [mp.data mutableBytes];
+  ctx->size = size;
+  return true;
 }
 
-- (NSMutableData *)writeObject:(id)obj options:(AVMPMessagePackWriterOptions)options error:(NSError * __autoreleasing *)error {
-  _data = [NSMutableData data];
+- (NSMutableData *)writeWithBlock:(BOOL (^)(avmp_ctx_t *context))block {
+  _data = [NSMutableData dataWithLength:256];
   
   avmp_ctx_t ctx;
-  avmp_init(&ctx, (__bridge void *)self, mp_reader, mp_writer);
+  avmp_init_buffer(&ctx, (__bridge void *)self, [_data mutableBytes], [_data length], mp_grower);
   
-  if (![self writeObject:obj options:options context:&ctx error:error]) {
+  BOOL succeeded = block(&ctx);
+  [_data setLength:ctx.pos];
+  
+  if (!succeeded) {
     return nil;
   }
   
   return _data;
 }
 
+- (NSMutableData *)writeObject:(id)obj options:(AVMPMessagePackWriterOptions)options error:(NSError * __autoreleasing *)error {
+  return [self writeWithBlock:^BOOL(avmp_ctx_t *context) {
+    return [self writeObject:obj options:options context:context error:error];
+  }];
+}
+
 + (NSMutableData *)writeObject:(id)obj error:(NSError * __autoreleasing *)error {
   return [self writeObject:obj options:0 error:error];
 }
@@ -56,6 +138,109 @@ static size_t mp_writer(avmp_ctx_t *ctx, const void *data, size_t count) {
   return messagePack.data;
 }
 
++ (NSMutableData *)writeDictionary:(NSDictionary *)dictionary schema:(AVMPMessagePackSchema *)schema error:(NSError * __autoreleasing *)error {
+  AVMPMessagePackWriter *messagePack = [[AVMPMessagePackWriter alloc] init];
+  return [messagePack writeWithBlock:^BOOL(avmp_ctx_t *context) {
+    return [messagePack writeDictionary:dictionary schema:schema context:context error:error];
+  }];
+}
+
+- (BOOL)writeDictionary:(NSDictionary *)dictionary schema:(AVMPMessagePackSchema *)schema context:(avmp_ctx_t *)context error:(NSError * __autoreleasing *)error {
+  if (!avmp_write_map(context, (uint32_t)dictionary.count)) {
+    if (error) *error = [NSError errorWithDomain:@"AVMPMessagePack" code:102 userInfo:@{NSLocalizedDescriptionKey: @"Error writing map"}];
+    return NO;
+  }
+  
+  NSUInteger written = 0;
+  
+  for (NSUInteger i = 0; i < schema->_fieldCount; i++) {
+    AVMPMessagePackField *field = &schema->_fields[i];
+    id value = dictionary[field->key];
+    if (!value) {
+      continue;
+    }
+    if (!avmp_write_bytes(context, field->encodedKey, field->encodedKeyLength)) {
+      if (error) *error = [NSError errorWithDomain:@"AVMPMessagePack" code:102 userInfo:@{NSLocalizedDescriptionKey: @"Error writing string"}];
+      return NO;
+    }
+    if (![self writeValue:value type:field->type context:context error:error]) {
+      return NO;
+    }
+    written++;
+  }
+  
+  if (written == dictionary.count) {
+    return YES;
+  }
+  
+  for (id key in dictionary) {
+    if ([schema->_keys containsObject:key]) {
+      continue;
+    }
+    if (![self writeObject:key options:0 context:context error:error]) {
+      return NO;
+    }
+    if (![self writeObject:dictionary[key] options:0 context:context error:error]) {
+      return NO;
+    }
+  }
+  
+  return YES;
+}
+
+- (BOOL)writeValue:(id)value type:(AVMPMessagePackFieldType)type context:(avmp_ctx_t *)context error:(NSError * __autoreleasing *)error {
+  switch (type) {
+    case AVMPMessagePackFieldTypeString: {
+      if (![value isKindOfClass:[NSString class]]) {
+        break;
+      }
+      if (!mp_write_string(context, value)) {
+        if (error) *error = [NSError errorWithDomain:@"AVMPMessagePack" code:102 userInfo:@{NSLocalizedDescriptionKey: @"Error writing string"}];
+        return NO;
+      }
+      return YES;
+    }
+    case AVMPMessagePackFieldTypeInteger:
+    case AVMPMessagePackFieldTypeDouble: {
+      // Booleans take the generic path.
+      if (![value isKindOfClass:[NSNumber class]] ||
+          value == (id)kCFBooleanTrue ||
+          value == (id)kCFBooleanFalse) {
+        break;
+      }
+      CFNumberRef number = (__bridge CFNumberRef)value;
+      bool succeeded = false;
+      if (type == AVMPMessagePackFieldTypeDouble) {
+        double d = 0;
+        // Integers and single precision floats keep their type, as on the generic path.
+        CFNumberType numberType = CFNumberGetType(number);
+        if ((numberType != kCFNumberFloat64Type && numberType != kCFNumberDoubleType) ||
+            !CFNumberGetValue(number, kCFNumberDoubleType, &d)) {
+          break;
+        }
+        succeeded = avmp_write_double(context, d);
+      } else {
+        int64_t i = 0;
+        // Floating point numbers keep their type, as on the generic path.
+        if (CFNumberIsFloatType(number) || !CFNumberGetValue(number, kCFNumberSInt64Type, &i)) {
+          break;
+        }
+        succeeded = (i >= 0
+                     ? avmp_write_uint(context, (uint64_t)i)
+                     : avmp_write_sint(context, i));
+      }
+      if (!succeeded) {
+        if (error) *error = [NSError errorWithDomain:@"AVMPMessagePack" code:102 userInfo:@{NSLocalizedDescriptionKey: @"Error writing number"}];
+        return NO;
+      }
+      return YES;
+    }
+    case AVMPMessagePackFieldTypeObject:
+      break;
+  }
+  return [self writeObject:value options:0 context:context error:error];
+}
+
 - (BOOL)writeNumber:(NSNumber *)number context:(avmp_ctx_t *)context error:(NSError * __autoreleasing *)error {
   if (strcmp([number objCType], @encode(bool)) == 0) {
     avmp_write_bool(context, number.boolValue);
@@ -119,9 +304,7 @@ static size_t mp_writer(avmp_ctx_t *ctx, const void *data, size_t count) {
       }
     }
   } else if ([obj isKindOfClass:[NSString class]]) {
-    const char *str = ((NSString*)obj).UTF8String;
-    size_t len = strlen(str);
-    if (!avmp_write_str(context, str, (uint32_t)len)) {
+    if (!mp_write_string(context, obj)) {
       if (error) *error = [NSError errorWithDomain:@"AVMPMessagePack" code:102 userInfo:@{NSLocalizedDescriptionKey: @"Error writing string"}];
       return NO;
     }
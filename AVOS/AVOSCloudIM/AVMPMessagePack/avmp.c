@@ -1,9 +1,18 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "avmp.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 static const uint32_t version = 10;
 static const uint32_t mp_version = 5;
 
@@ -92,116 +101,119 @@ const char *avmp_error_messages[ERROR_MAX + 1] = {
   "Max Error"
 };
 
-static const int32_t _i = 1;
-#define is_bigendian() ((*(char *)&_i) == 0)
+/*
+ * Byte order is known at compile time; on little-endian targets the swaps
+ * compile down to single bswap/rev instructions.
+ */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define AVMP_BIG_ENDIAN 1
+#endif
 
-static uint16_t be16(uint16_t x) {
-  char *b = (char *)&x;
-  
-  if (!is_bigendian()) {
-    char swap = 0;
-    
-    swap = b[0];
-    b[0] = b[1];
-    b[1] = swap;
-  }
-  
+static inline uint16_t be16(uint16_t x) {
+#ifdef AVMP_BIG_ENDIAN
   return x;
+#else
+  return __builtin_bswap16(x);
+#endif
 }
 
-static uint32_t be32(uint32_t x) {
-  char *b = (char *)&x;
+static inline uint32_t be32(uint32_t x) {
+#ifdef AVMP_BIG_ENDIAN
+  return x;
+#else
+  return __builtin_bswap32(x);
+#endif
+}
+
+static inline uint64_t be64(uint64_t x) {
+#ifdef AVMP_BIG_ENDIAN
+  return x;
+#else
+  return __builtin_bswap64(x);
+#endif
+}
+
+static inline float befloat(float x) {
+  uint32_t u;
   
-  if (!is_bigendian()) {
-    char swap = 0;
-    
-    swap = b[0];
-    b[0] = b[3];
-    b[3] = swap;
-    
-    swap = b[1];
-    b[1] = b[2];
-    b[2] = swap;
-  }
+  memcpy(&u, &x, sizeof(u));
+  u = be32(u);
+  memcpy(&x, &u, sizeof(u));
   
   return x;
 }
 
-static uint64_t be64(uint64_t x) {
-  char *b = (char *)&x;
+static inline double bedouble(double x) {
+  uint64_t u;
   
-  if (!is_bigendian()) {
-    char swap = 0;
-    
-    swap = b[0];
-    b[0] = b[7];
-    b[7] = swap;
-    
-    swap = b[1];
-    b[1] = b[6];
-    b[6] = swap;
-    
-    swap = b[2];
-    b[2] = b[5];
-    b[5] = swap;
-    
-    swap = b[3];
-    b[3] = b[4];
-    b[4] = swap;
-  }
+  memcpy(&u, &x, sizeof(u));
+  u = be64(u);
+  memcpy(&x, &u, sizeof(u));
   
   return x;
 }
 
-static float befloat(float x) {
-  char *b = (char *)&x;
-  
-  if (!is_bigendian()) {
-    char swap = 0;
-    
-    swap = b[0];
-    b[0] = b[3];
-    b[3] = swap;
+/*
+ * All I/O goes through read_data() and write_data().  In buffer mode they are
+ * inlined against the buffer, so reads and writes of known size compile down
+ * to a bounds check and a fixed-size copy; the callbacks are only for streams.
+ */
+
+static inline bool read_data(avmp_ctx_t *ctx, void *data, size_t limit) {
+  if (ctx->data) {
+    if (limit > ctx->size - ctx->pos)
+      return false;
     
-    swap = b[1];
-    b[1] = b[2];
-    b[2] = swap;
+    memcpy(data, ctx->data + ctx->pos, limit);
+    ctx->pos += limit;
+    return true;
   }
   
-  return x;
+  return ctx->read(ctx, data, limit);
 }
 
-static double bedouble(double x) {
-  char *b = (char *)&x;
+static bool grow_buffer(avmp_ctx_t *ctx, size_t needed) {
+  if (!ctx->grow || !ctx->grow(ctx, needed))
+    return false;
   
-  if (!is_bigendian()) {
-    char swap = 0;
-    
-    swap = b[0];
-    b[0] = b[7];
-    b[7] = swap;
-    
-    swap = b[1];
-    b[1] = b[6];
-    b[6] = swap;
-    
-    swap = b[2];
-    b[2] = b[5];
-    b[5] = swap;
+  return needed <= ctx->size - ctx->pos;
+}
+
+static inline size_t write_data(avmp_ctx_t *ctx, const void *data,
+                                size_t count) {
+  if (ctx->data) {
+    if (count > ctx->size - ctx->pos && !grow_buffer(ctx, count))
+      return 0;
     
-    swap = b[3];
-    b[3] = b[4];
-    b[4] = swap;
+    memcpy(ctx->data + ctx->pos, data, count);
+    ctx->pos += count;
+    return count;
   }
   
-  return x;
+  return ctx->write(ctx, data, count);
 }
 
-static bool read_byte(avmp_ctx_t *ctx, uint8_t *x) {
+static inline bool read_byte(avmp_ctx_t *ctx, uint8_t *x) {
+  if (ctx->data) {
+    if (ctx->pos >= ctx->size)
+      return false;
+    
+    *x = ctx->data[ctx->pos++];
+    return true;
+  }
+  
   return ctx->read(ctx, x, sizeof(uint8_t));
 }
 
-static bool write_byte(avmp_ctx_t *ctx, uint8_t x) {
+static inline bool write_byte(avmp_ctx_t *ctx, uint8_t x) {
+  if (ctx->data) {
+    if (ctx->pos >= ctx->size && !grow_buffer(ctx, sizeof(uint8_t)))
+      return false;
+    
+    ctx->data[ctx->pos++] = x;
+    return true;
+  }
+  
   return (ctx->write(ctx, &x, sizeof(uint8_t)) == (sizeof(uint8_t)));
 }
 
@@ -234,6 +246,138 @@ void avmp_init(avmp_ctx_t *ctx, void *buf, avmp_reader read, avmp_writer write)
   ctx->buf = buf;
   ctx->read = read;
   ctx->write = write;
+  ctx->data = NULL;
+  ctx->size = 0;
+  ctx->pos = 0;
+  ctx->grow = NULL;
+}
+
+void avmp_init_buffer(avmp_ctx_t *ctx, void *buf, void *data, size_t size,
+                      avmp_grower grow) {
+  static uint8_t empty_buffer[1];
+  
+  avmp_init(ctx, buf, NULL, NULL);
+  /* A non-NULL data pointer is what selects buffer mode */
+  ctx->data = data ? data : empty_buffer;
+  ctx->size = data ? size : 0;
+  ctx->grow = grow;
+}
+
+/* Returns the length of the leading run of ASCII bytes. */
+static size_t ascii_prefix_length(const uint8_t *s, size_t size) {
+  size_t i = 0;
+  
+#if defined(__AVX2__)
+  for (; i + 32 <= size; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+    if (_mm256_movemask_epi8(v))
+      break;
+  }
+#endif
+#if defined(__SSE2__)
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+    if (_mm_movemask_epi8(v))
+      break;
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  for (; i + 16 <= size; i += 16) {
+    uint8x16_t v = vld1q_u8(s + i);
+#if defined(__aarch64__)
+    if (vmaxvq_u8(v) & 0x80)
+      break;
+#else
+    uint8x8_t m = vorr_u8(vget_low_u8(v), vget_high_u8(v));
+    if (vget_lane_u64(vreinterpret_u64_u8(m), 0) & 0x8080808080808080ULL)
+      break;
+#endif
+  }
+#endif
+  
+  for (; i + 8 <= size; i += 8) {
+    uint64_t w;
+    memcpy(&w, s + i, sizeof(w));
+    if (w & 0x8080808080808080ULL)
+      break;
+  }
+  
+  while (i < size && s[i] < 0x80)
+    i++;
+  
+  return i;
+}
+
+bool avmp_utf8_validate(const void *data, size_t size, bool *is_ascii) {
+  const uint8_t *s = data;
+  size_t i = ascii_prefix_length(s, size);
+  
+  if (is_ascii)
+    *is_ascii = (i == size);
+  
+  while (i < size) {
+    uint8_t c = s[i];
+    uint8_t lower = 0x80;
+    uint8_t upper = 0xBF;
+    size_t continuations = 0;
+    
+    if (c < 0x80) {
+      i += ascii_prefix_length(s + i, size - i);
+      continue;
+    }
+    
+    /* Well-formed sequences, see table 3-7 of the Unicode standard. */
+    if (c >= 0xC2 && c <= 0xDF) {
+      continuations = 1;
+    }
+    else if (c >= 0xE0 && c <= 0xEF) {
+      continuations = 2;
+      if (c == 0xE0)
+        lower = 0xA0;
+      else if (c == 0xED)
+        upper = 0x9F;
+    }
+    else if (c >= 0xF0 && c <= 0xF4) {
+      continuations = 3;
+      if (c == 0xF0)
+        lower = 0x90;
+      else if (c == 0xF4)
+        upper = 0x8F;
+    }
+    else {
+      return false;
+    }
+    
+    if (continuations > size - i - 1)
+      return false;
+    
+    if (s[i + 1] < lower || s[i + 1] > upper)
+      return false;
+    
+    for (size_t k = 2; k <= continuations; k++) {
+      if ((s[i + k] & 0xC0) != 0x80)
+        return false;
+    }
+    
+    i += continuations + 1;
+  }
+  
+  return true;
+}
+
+bool avmp_read_bytes(avmp_ctx_t *ctx, void *data, size_t count) {
+  if (read_data(ctx, data, count))
+    return true;
+  
+  ctx->error = DATA_READING_ERROR;
+  return false;
+}
+
+bool avmp_write_bytes(avmp_ctx_t *ctx, const void *data, size_t count) {
+  if (write_data(ctx, data, count) == count)
+    return true;
+  
+  ctx->error = DATA_WRITING_ERROR;
+  return false;
 }
 
 uint32_t avmp_version(void) {
@@ -281,7 +425,7 @@ bool avmp_write_s8(avmp_ctx_t *ctx, int8_t c) {
   if (!write_type_marker(ctx, S8_MARKER))
     return false;
   
-  return ctx->write(ctx, &c, sizeof(int8_t));
+  return write_data(ctx, &c, sizeof(int8_t));
 }
 
 bool avmp_write_s16(avmp_ctx_t *ctx, int16_t s) {
@@ -290,7 +434,7 @@ bool avmp_write_s16(avmp_ctx_t *ctx, int16_t s) {
   
   s = be16(s);
   
-  return ctx->write(ctx, &s, sizeof(int16_t));
+  return write_data(ctx, &s, sizeof(int16_t));
 }
 
 bool avmp_write_s32(avmp_ctx_t *ctx, int32_t i) {
@@ -299,7 +443,7 @@ bool avmp_write_s32(avmp_ctx_t *ctx, int32_t i) {
   
   i = be32(i);
   
-  return ctx->write(ctx, &i, sizeof(int32_t));
+  return write_data(ctx, &i, sizeof(int32_t));
 }
 
 bool avmp_write_s64(avmp_ctx_t *ctx, int64_t l) {
@@ -308,7 +452,7 @@ bool avmp_write_s64(avmp_ctx_t *ctx, int64_t l) {
   
   l = be64(l);
   
-  return ctx->write(ctx, &l, sizeof(int64_t));
+  return write_data(ctx, &l, sizeof(int64_t));
 }
 
 bool avmp_write_sint(avmp_ctx_t *ctx, int64_t d) {
@@ -334,7 +478,7 @@ bool avmp_write_u8(avmp_ctx_t *ctx, uint8_t c) {
   if (!write_type_marker(ctx, U8_MARKER))
     return false;
   
-  return ctx->write(ctx, &c, sizeof(uint8_t));
+  return write_data(ctx, &c, sizeof(uint8_t));
 }
 
 bool avmp_write_u16(avmp_ctx_t *ctx, uint16_t s) {
@@ -343,7 +487,7 @@ bool avmp_write_u16(avmp_ctx_t *ctx, uint16_t s) {
   
   s = be16(s);
   
-  return ctx->write(ctx, &s, sizeof(uint16_t));
+  return write_data(ctx, &s, sizeof(uint16_t));
 }
 
 bool avmp_write_u32(avmp_ctx_t *ctx, uint32_t i) {
@@ -352,7 +496,7 @@ bool avmp_write_u32(avmp_ctx_t *ctx, uint32_t i) {
   
   i = be32(i);
   
-  return ctx->write(ctx, &i, sizeof(uint32_t));
+  return write_data(ctx, &i, sizeof(uint32_t));
 }
 
 bool avmp_write_u64(avmp_ctx_t *ctx, uint64_t l) {
@@ -361,7 +505,7 @@ bool avmp_write_u64(avmp_ctx_t *ctx, uint64_t l) {
   
   l = be64(l);
   
-  return ctx->write(ctx, &l, sizeof(uint64_t));
+  return write_data(ctx, &l, sizeof(uint64_t));
 }
 
 bool avmp_write_uint(avmp_ctx_t *ctx, uint64_t u) {
@@ -383,7 +527,7 @@ bool avmp_write_float(avmp_ctx_t *ctx, float f) {
   
   f = befloat(f);
   
-  return ctx->write(ctx, &f, sizeof(float));
+  return write_data(ctx, &f, sizeof(float));
 }
 
 bool avmp_write_double(avmp_ctx_t *ctx, double d) {
@@ -392,7 +536,7 @@ bool avmp_write_double(avmp_ctx_t *ctx, double d) {
   
   d = bedouble(d);
   
-  return ctx->write(ctx, &d, sizeof(double));
+  return write_data(ctx, &d, sizeof(double));
 }
 
 bool avmp_write_nil(avmp_ctx_t *ctx) {
@@ -436,7 +580,7 @@ bool avmp_write_fixstr(avmp_ctx_t *ctx, const char *data, uint8_t size) {
   if (size == 0)
     return true;
   
-  if (ctx->write(ctx, data, size))
+  if (write_data(ctx, data, size))
     return true;
   
   ctx->error = DATA_WRITING_ERROR;
@@ -447,7 +591,7 @@ bool avmp_write_str8_marker(avmp_ctx_t *ctx, uint8_t size) {
   if (!write_type_marker(ctx, STR8_MARKER))
     return false;
   
-  if (ctx->write(ctx, &size, sizeof(uint8_t)))
+  if (write_data(ctx, &size, sizeof(uint8_t)))
     return true;
   
   ctx->error = LENGTH_WRITING_ERROR;
@@ -461,7 +605,7 @@ bool avmp_write_str8(avmp_ctx_t *ctx, const char *data, uint8_t size) {
   if (size == 0)
     return true;
   
-  if (ctx->write(ctx, data, size))
+  if (write_data(ctx, data, size))
     return true;
   
   ctx->error = DATA_WRITING_ERROR;
@@ -474,7 +618,7 @@ bool avmp_write_str16_marker(avmp_ctx_t *ctx, uint16_t size) {
   
   size = be16(size);
   
-  if (ctx->write(ctx, &size, sizeof(uint16_t)))
+  if (write_data(ctx, &size, sizeof(uint16_t)))
     return true;
   
   ctx->error = LENGTH_WRITING_ERROR;
@@ -488,7 +632,7 @@ bool avmp_write_str16(avmp_ctx_t *ctx, const char *data, uint16_t size) {
   if (size == 0)
     return true;
   
-  if (ctx->write(ctx, data, size))
+  if (write_data(ctx, data, size))
     return true;
   
   ctx->error = DATA_WRITING_ERROR;
@@ -501,7 +645,7 @@ bool avmp_write_str32_marker(avmp_ctx_t *ctx, uint32_t size) {
   
   size = be32(size);
   
-  if (ctx->write(ctx, &size, sizeof(uint32_t)))
+  if (write_data(ctx, &size, sizeof(uint32_t)))
     return true;
   
   ctx->error = LENGTH_WRITING_ERROR;
@@ -515,7 +659,7 @@ bool avmp_write_str32(avmp_ctx_t *ctx, const char *data, uint32_t size) {
   if (size == 0)
     return true;
   
-  if (ctx->write(ctx, data, size))
+  if (write_data(ctx, data, size))
     return true;
   
   ctx->error = DATA_WRITING_ERROR;
@@ -548,7 +692,7 @@ bool avmp_write_bin8_marker(avmp_ctx_t *ctx, uint8_t size) {
   if (!write_type_marker(ctx, BIN8_MARKER))
     return false;
   
-  if (ctx->write(ctx, &size, sizeof(uint8_t)))
+  if (write_data(ctx, &size, sizeof(uint8_t)))
     return true;
   
   ctx->error = LENGTH_WRITING_ERROR;
@@ -562,7 +706,7 @@ bool avmp_write_bin8(avmp_ctx_t *ctx, const void *data, uint8_t size) {
   if (size == 0)
     return true;
   
-  if (ctx->write(ctx, data, size))
+  if (write_data(ctx, data, size))
     return true;
   
   ctx->error = DATA_WRITING_ERROR;
@@ -575,7 +719,7 @@ bool avmp_write_bin16_marker(avmp_ctx_t *ctx, uint16_t size) {
   
   size = be16(size);
   
-  if (ctx->write(ctx, &size, sizeof(uint16_t)))
+  if (write_data(ctx, &size, sizeof(uint16_t)))
     return true;
   
   ctx->error = LENGTH_WRITING_ERROR;
@@ -589,7 +733,7 @@ bool avmp_write_bin16(avmp_ctx_t *ctx, const void *data, uint16_t size) {
   if (size == 0)
     return true;
   
-  if (ctx->write(ctx, data, size))
+  if (write_data(ctx, data, size))
     return true;
   
   ctx->error = DATA_WRITING_ERROR;
@@ -602,7 +746,7 @@ bool avmp_write_bin32_marker(avmp_ctx_t *ctx, uint32_t size) {
   
   size = be32(size);
   
-  if (ctx->write(ctx, &size, sizeof(uint32_t)))
+  if (write_data(ctx, &size, sizeof(uint32_t)))
     return true;
   
   ctx->error = LENGTH_WRITING_ERROR;
@@ -616,7 +760,7 @@ bool avmp_write_bin32(avmp_ctx_t *ctx, const void *data, uint32_t size) {
   if (size == 0)
     return true;
   
-  if (ctx->write(ctx, data, size))
+  if (write_data(ctx, data, size))
     return true;
   
   ctx->error = DATA_WRITING_ERROR;
@@ -655,7 +799,7 @@ bool avmp_write_array16(avmp_ctx_t *ctx, uint16_t size) {
   
   size = be16(size);
   
-  if (ctx->write(ctx, &size, sizeof(uint16_t)))
+  if (write_data(ctx, &size, sizeof(uint16_t)))
     return true;
   
   ctx->error = LENGTH_WRITING_ERROR;
@@ -668,7 +812,7 @@ bool avmp_write_array32(avmp_ctx_t *ctx, uint32_t size) {
   
   size = be32(size);
   
-  if (ctx->write(ctx, &size, sizeof(uint32_t)))
+  if (write_data(ctx, &size, sizeof(uint32_t)))
     return true;
   
   ctx->error = LENGTH_WRITING_ERROR;
@@ -698,7 +842,7 @@ bool avmp_write_map16(avmp_ctx_t *ctx, uint16_t size) {
   
   size = be16(size);
   
-  if (ctx->write(ctx, &size, sizeof(uint16_t)))
+  if (write_data(ctx, &size, sizeof(uint16_t)))
     return true;
   
   ctx->error = LENGTH_WRITING_ERROR;
@@ -711,7 +855,7 @@ bool avmp_write_map32(avmp_ctx_t *ctx, uint32_t size) {
   
   size = be32(size);
   
-  if (ctx->write(ctx, &size, sizeof(uint32_t)))
+  if (write_data(ctx, &size, sizeof(uint32_t)))
     return true;
   
   ctx->error = LENGTH_WRITING_ERROR;
@@ -731,7 +875,7 @@ bool avmp_write_fixext1_marker(avmp_ctx_t *ctx, int8_t type) {
   if (!write_type_marker(ctx, FIXEXT1_MARKER))
     return false;
   
-  if (ctx->write(ctx, &type, sizeof(int8_t)))
+  if (write_data(ctx, &type, sizeof(int8_t)))
     return true;
   
   ctx->error = EXT_TYPE_WRITING_ERROR;
@@ -742,7 +886,7 @@ bool avmp_write_fixext1(avmp_ctx_t *ctx, int8_t type, const void *data) {
   if (!avmp_write_fixext1_marker(ctx, type))
     return false;
   
-  if (ctx->write(ctx, data, 1))
+  if (write_data(ctx, data, 1))
     return true;
   
   ctx->error = DATA_WRITING_ERROR;
@@ -753,7 +897,7 @@ bool avmp_write_fixext2_marker(avmp_ctx_t *ctx, int8_t type) {
   if (!write_type_marker(ctx, FIXEXT2_MARKER))
     return false;
   
-  if (ctx->write(ctx, &type, sizeof(int8_t)))
+  if (write_data(ctx, &type, sizeof(int8_t)))
     return true;
   
   ctx->error = EXT_TYPE_WRITING_ERROR;
@@ -764,7 +908,7 @@ bool avmp_write_fixext2(avmp_ctx_t *ctx, int8_t type, const void *data) {
   if (!avmp_write_fixext2_marker(ctx, type))
     return false;
   
-  if (ctx->write(ctx, data, 2))
+  if (write_data(ctx, data, 2))
     return true;
   
   ctx->error = DATA_WRITING_ERROR;
@@ -775,7 +919,7 @@ bool avmp_write_fixext4_marker(avmp_ctx_t *ctx, int8_t type) {
   if (!write_type_marker(ctx, FIXEXT4_MARKER))
     return false;
   
-  if (ctx->write(ctx, &type, sizeof(int8_t)))
+  if (write_data(ctx, &type, sizeof(int8_t)))
     return true;
   
   ctx->error = EXT_TYPE_WRITING_ERROR;
@@ -786,7 +930,7 @@ bool avmp_write_fixext4(avmp_ctx_t *ctx, int8_t type, const void *data) {
   if (!avmp_write_fixext4_marker(ctx, type))
     return false;
   
-  if (ctx->write(ctx, data, 4))
+  if (write_data(ctx, data, 4))
     return true;
   
   ctx->error = DATA_WRITING_ERROR;
@@ -797,7 +941,7 @@ bool avmp_write_fixext8_marker(avmp_ctx_t *ctx, int8_t type) {
   if (!write_type_marker(ctx, FIXEXT8_MARKER))
     return false;
   
-  if (ctx->write(ctx, &type, sizeof(int8_t)))
+  if (write_data(ctx, &type, sizeof(int8_t)))
     return true;
   
   ctx->error = EXT_TYPE_WRITING_ERROR;
@@ -808,7 +952,7 @@ bool avmp_write_fixext8(avmp_ctx_t *ctx, int8_t type, const void *data) {
   if (!avmp_write_fixext8_marker(ctx, type))
     return false;
   
-  if (ctx->write(ctx, data, 8))
+  if (write_data(ctx, data, 8))
     return true;
   
   ctx->error = DATA_WRITING_ERROR;
@@ -819,7 +963,7 @@ bool avmp_write_fixext16_marker(avmp_ctx_t *ctx, int8_t type) {
   if (!write_type_marker(ctx, FIXEXT16_MARKER))
     return false;
   
-  if (ctx->write(ctx, &type, sizeof(int8_t)))
+  if (write_data(ctx, &type, sizeof(int8_t)))
     return true;
   
   ctx->error = EXT_TYPE_WRITING_ERROR;
@@ -830,7 +974,7 @@ bool avmp_write_fixext16(avmp_ctx_t *ctx, int8_t type, const void *data) {
   if (!avmp_write_fixext16_marker(ctx, type))
     return false;
   
-  if (ctx->write(ctx, data, 16))
+  if (write_data(ctx, data, 16))
     return true;
   
   ctx->error = DATA_WRITING_ERROR;
@@ -841,12 +985,12 @@ bool avmp_write_ext8_marker(avmp_ctx_t *ctx, int8_t type, uint8_t size) {
   if (!write_type_marker(ctx, EXT8_MARKER))
     return false;
   
-  if (!ctx->write(ctx, &size, sizeof(uint8_t))) {
+  if (!write_data(ctx, &size, sizeof(uint8_t))) {
     ctx->error = LENGTH_WRITING_ERROR;
     return false;
   }
   
-  if (ctx->write(ctx, &type, sizeof(int8_t)))
+  if (write_data(ctx, &type, sizeof(int8_t)))
     return true;
   
   ctx->error = EXT_TYPE_WRITING_ERROR;
@@ -857,7 +1001,7 @@ bool avmp_write_ext8(avmp_ctx_t *ctx, int8_t tp, uint8_t sz, const void *data) {
   if (!avmp_write_ext8_marker(ctx, tp, sz))
     return false;
   
-  if (ctx->write(ctx, data, sz))
+  if (write_data(ctx, data, sz))
     return true;
   
   ctx->error = DATA_WRITING_ERROR;
@@ -870,12 +1014,12 @@ bool avmp_write_ext16_marker(avmp_ctx_t *ctx, int8_t type, uint16_t size) {
   
   size = be16(size);
   
-  if (!ctx->write(ctx, &size, sizeof(uint16_t))) {
+  if (!write_data(ctx, &size, sizeof(uint16_t))) {
     ctx->error = LENGTH_WRITING_ERROR;
     return false;
   }
   
-  if (ctx->write(ctx, &type, sizeof(int8_t)))
+  if (write_data(ctx, &type, sizeof(int8_t)))
     return true;
   
   ctx->error = EXT_TYPE_WRITING_ERROR;
@@ -886,7 +1030,7 @@ bool avmp_write_ext16(avmp_ctx_t *ctx, int8_t tp, uint16_t sz, const void *data)
   if (!avmp_write_ext16_marker(ctx, tp, sz))
     return false;
   
-  if (ctx->write(ctx, data, sz))
+  if (write_data(ctx, data, sz))
     return true;
   
   ctx->error = DATA_WRITING_ERROR;
@@ -899,12 +1043,12 @@ bool avmp_write_ext32_marker(avmp_ctx_t *ctx, int8_t type, uint32_t size) {
   
   size = be32(size);
   
-  if (!ctx->write(ctx, &size, sizeof(uint32_t))) {
+  if (!write_data(ctx, &size, sizeof(uint32_t))) {
     ctx->error = LENGTH_WRITING_ERROR;
     return false;
   }
   
-  if (ctx->write(ctx, &type, sizeof(int8_t)))
+  if (write_data(ctx, &type, sizeof(int8_t)))
     return true;
   
   ctx->error = EXT_TYPE_WRITING_ERROR;
@@ -915,7 +1059,7 @@ bool avmp_write_ext32(avmp_ctx_t *ctx, int8_t tp, uint32_t sz, const void *data)
   if (!avmp_write_ext32_marker(ctx, tp, sz))
     return false;
   
-  if (ctx->write(ctx, data, sz))
+  if (write_data(ctx, data, sz))
     return true;
   
   ctx->error = DATA_WRITING_ERROR;
@@ -1558,7 +1702,7 @@ bool avmp_read_str(avmp_ctx_t *ctx, char *data, uint32_t *size) {
     return false;
   }
   
-  if (!ctx->read(ctx, data, str_size)) {
+  if (!read_data(ctx, data, str_size)) {
     ctx->error = DATA_READING_ERROR;
     return false;
   }
@@ -1598,7 +1742,7 @@ bool avmp_read_bin(avmp_ctx_t *ctx, void *data, uint32_t *size) {
     return false;
   }
   
-  if (!ctx->read(ctx, data, bin_size)) {
+  if (!read_data(ctx, data, bin_size)) {
     ctx->error = DATA_READING_ERROR;
     return false;
   }
@@ -1662,7 +1806,7 @@ bool avmp_read_fixext1(avmp_ctx_t *ctx, int8_t *type, void *data) {
   if (!avmp_read_fixext1_marker(ctx, type))
     return false;
   
-  if (ctx->read(ctx, data, 1))
+  if (read_data(ctx, data, 1))
     return true;
   
   ctx->error = DATA_READING_ERROR;
@@ -1688,7 +1832,7 @@ bool avmp_read_fixext2(avmp_ctx_t *ctx, int8_t *type, void *data) {
   if (!avmp_read_fixext2_marker(ctx, type))
     return false;
   
-  if (ctx->read(ctx, data, 2))
+  if (read_data(ctx, data, 2))
     return true;
   
   ctx->error = DATA_READING_ERROR;
@@ -1714,7 +1858,7 @@ bool avmp_read_fixext4(avmp_ctx_t *ctx, int8_t *type, void *data) {
   if (!avmp_read_fixext4_marker(ctx, type))
     return false;
   
-  if (ctx->read(ctx, data, 4))
+  if (read_data(ctx, data, 4))
     return true;
   
   ctx->error = DATA_READING_ERROR;
@@ -1740,7 +1884,7 @@ bool avmp_read_fixext8(avmp_ctx_t *ctx, int8_t *type, void *data) {
   if (!avmp_read_fixext8_marker(ctx, type))
     return false;
   
-  if (ctx->read(ctx, data, 8))
+  if (read_data(ctx, data, 8))
     return true;
   
   ctx->error = DATA_READING_ERROR;
@@ -1766,7 +1910,7 @@ bool avmp_read_fixext16(avmp_ctx_t *ctx, int8_t *type, void *data) {
   if (!avmp_read_fixext16_marker(ctx, type))
     return false;
   
-  if (ctx->read(ctx, data, 16))
+  if (read_data(ctx, data, 16))
     return true;
   
   ctx->error = DATA_READING_ERROR;
@@ -1794,7 +1938,7 @@ bool avmp_read_ext8(avmp_ctx_t *ctx, int8_t *type, uint8_t *size, void *data) {
   if (!avmp_read_ext8_marker(ctx, type, size))
     return false;
   
-  if (ctx->read(ctx, data, *size))
+  if (read_data(ctx, data, *size))
     return true;
   
   ctx->error = DATA_READING_ERROR;
@@ -1822,7 +1966,7 @@ bool avmp_read_ext16(avmp_ctx_t *ctx, int8_t *type, uint16_t *size, void *data)
   if (!avmp_read_ext16_marker(ctx, type, size))
     return false;
   
-  if (ctx->read(ctx, data, *size))
+  if (read_data(ctx, data, *size))
     return true;
   
   ctx->error = DATA_READING_ERROR;
@@ -1850,7 +1994,7 @@ bool avmp_read_ext32(avmp_ctx_t *ctx, int8_t *type, uint32_t *size, void *data)
   if (!avmp_read_ext32_marker(ctx, type, size))
     return false;
   
-  if (ctx->read(ctx, data, *size))
+  if (read_data(ctx, data, *size))
     return true;
   
   ctx->error = DATA_READING_ERROR;
@@ -1885,7 +2029,7 @@ bool avmp_read_ext(avmp_ctx_t *ctx, int8_t *type, uint32_t *size, void *data) {
   if (!avmp_read_ext_marker(ctx, type, size))
     return false;
   
-  if (ctx->read(ctx, data, *size))
+  if (read_data(ctx, data, *size))
     return true;
   
   ctx->error = DATA_READING_ERROR;
@@ -1928,7 +2072,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == BIN8_MARKER) {
     obj->type = AVMP_TYPE_BIN8;
-    if (!ctx->read(ctx, &obj->as.u8, sizeof(uint8_t))) {
+    if (!read_data(ctx, &obj->as.u8, sizeof(uint8_t))) {
       ctx->error = LENGTH_READING_ERROR;
       return false;
     }
@@ -1936,7 +2080,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == BIN16_MARKER) {
     obj->type = AVMP_TYPE_BIN16;
-    if (!ctx->read(ctx, &obj->as.u16, sizeof(uint16_t))) {
+    if (!read_data(ctx, &obj->as.u16, sizeof(uint16_t))) {
       ctx->error = LENGTH_READING_ERROR;
       return false;
     }
@@ -1944,7 +2088,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == BIN32_MARKER) {
     obj->type = AVMP_TYPE_BIN32;
-    if (!ctx->read(ctx, &obj->as.u32, sizeof(uint32_t))) {
+    if (!read_data(ctx, &obj->as.u32, sizeof(uint32_t))) {
       ctx->error = LENGTH_READING_ERROR;
       return false;
     }
@@ -1955,11 +2099,11 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
     int8_t ext_type;
     
     obj->type = AVMP_TYPE_EXT8;
-    if (!ctx->read(ctx, &ext_size, sizeof(uint8_t))) {
+    if (!read_data(ctx, &ext_size, sizeof(uint8_t))) {
       ctx->error = LENGTH_READING_ERROR;
       return false;
     }
-    if (!ctx->read(ctx, &ext_type, sizeof(int8_t))) {
+    if (!read_data(ctx, &ext_type, sizeof(int8_t))) {
       ctx->error = EXT_TYPE_READING_ERROR;
       return false;
     }
@@ -1971,11 +2115,11 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
     uint16_t ext_size;
     
     obj->type = AVMP_TYPE_EXT16;
-    if (!ctx->read(ctx, &ext_size, sizeof(uint16_t))) {
+    if (!read_data(ctx, &ext_size, sizeof(uint16_t))) {
       ctx->error = LENGTH_READING_ERROR;
       return false;
     }
-    if (!ctx->read(ctx, &ext_type, sizeof(int8_t))) {
+    if (!read_data(ctx, &ext_type, sizeof(int8_t))) {
       ctx->error = EXT_TYPE_READING_ERROR;
       return false;
     }
@@ -1987,11 +2131,11 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
     uint32_t ext_size;
     
     obj->type = AVMP_TYPE_EXT32;
-    if (!ctx->read(ctx, &ext_size, sizeof(uint32_t))) {
+    if (!read_data(ctx, &ext_size, sizeof(uint32_t))) {
       ctx->error = LENGTH_READING_ERROR;
       return false;
     }
-    if (!ctx->read(ctx, &ext_type, sizeof(int8_t))) {
+    if (!read_data(ctx, &ext_type, sizeof(int8_t))) {
       ctx->error = EXT_TYPE_READING_ERROR;
       return false;
     }
@@ -2000,7 +2144,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == FLOAT_MARKER) {
     obj->type = AVMP_TYPE_FLOAT;
-    if (!ctx->read(ctx, &obj->as.flt, sizeof(float))) {
+    if (!read_data(ctx, &obj->as.flt, sizeof(float))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
@@ -2008,7 +2152,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == DOUBLE_MARKER) {
     obj->type = AVMP_TYPE_DOUBLE;
-    if (!ctx->read(ctx, &obj->as.dbl, sizeof(double))) {
+    if (!read_data(ctx, &obj->as.dbl, sizeof(double))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
@@ -2016,14 +2160,14 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == U8_MARKER) {
     obj->type = AVMP_TYPE_UINT8;
-    if (!ctx->read(ctx, &obj->as.u8, sizeof(uint8_t))) {
+    if (!read_data(ctx, &obj->as.u8, sizeof(uint8_t))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
   }
   else if (type_marker == U16_MARKER) {
     obj->type = AVMP_TYPE_UINT16;
-    if (!ctx->read(ctx, &obj->as.u16, sizeof(uint16_t))) {
+    if (!read_data(ctx, &obj->as.u16, sizeof(uint16_t))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
@@ -2031,7 +2175,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == U32_MARKER) {
     obj->type = AVMP_TYPE_UINT32;
-    if (!ctx->read(ctx, &obj->as.u32, sizeof(uint32_t))) {
+    if (!read_data(ctx, &obj->as.u32, sizeof(uint32_t))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
@@ -2039,7 +2183,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == U64_MARKER) {
     obj->type = AVMP_TYPE_UINT64;
-    if (!ctx->read(ctx, &obj->as.u64, sizeof(uint64_t))) {
+    if (!read_data(ctx, &obj->as.u64, sizeof(uint64_t))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
@@ -2047,14 +2191,14 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == S8_MARKER) {
     obj->type = AVMP_TYPE_SINT8;
-    if (!ctx->read(ctx, &obj->as.s8, sizeof(int8_t))) {
+    if (!read_data(ctx, &obj->as.s8, sizeof(int8_t))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
   }
   else if (type_marker == S16_MARKER) {
     obj->type = AVMP_TYPE_SINT16;
-    if (!ctx->read(ctx, &obj->as.s16, sizeof(int16_t))) {
+    if (!read_data(ctx, &obj->as.s16, sizeof(int16_t))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
@@ -2062,7 +2206,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == S32_MARKER) {
     obj->type = AVMP_TYPE_SINT32;
-    if (!ctx->read(ctx, &obj->as.s32, sizeof(int32_t))) {
+    if (!read_data(ctx, &obj->as.s32, sizeof(int32_t))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
@@ -2070,7 +2214,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == S64_MARKER) {
     obj->type = AVMP_TYPE_SINT64;
-    if (!ctx->read(ctx, &obj->as.s64, sizeof(int64_t))) {
+    if (!read_data(ctx, &obj->as.s64, sizeof(int64_t))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
@@ -2078,7 +2222,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == FIXEXT1_MARKER) {
     obj->type = AVMP_TYPE_FIXEXT1;
-    if (!ctx->read(ctx, &obj->as.ext.type, sizeof(int8_t))) {
+    if (!read_data(ctx, &obj->as.ext.type, sizeof(int8_t))) {
       ctx->error = EXT_TYPE_READING_ERROR;
       return false;
     }
@@ -2086,7 +2230,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == FIXEXT2_MARKER) {
     obj->type = AVMP_TYPE_FIXEXT2;
-    if (!ctx->read(ctx, &obj->as.ext.type, sizeof(int8_t))) {
+    if (!read_data(ctx, &obj->as.ext.type, sizeof(int8_t))) {
       ctx->error = EXT_TYPE_READING_ERROR;
       return false;
     }
@@ -2094,7 +2238,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == FIXEXT4_MARKER) {
     obj->type = AVMP_TYPE_FIXEXT4;
-    if (!ctx->read(ctx, &obj->as.ext.type, sizeof(int8_t))) {
+    if (!read_data(ctx, &obj->as.ext.type, sizeof(int8_t))) {
       ctx->error = EXT_TYPE_READING_ERROR;
       return false;
     }
@@ -2102,7 +2246,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == FIXEXT8_MARKER) {
     obj->type = AVMP_TYPE_FIXEXT8;
-    if (!ctx->read(ctx, &obj->as.ext.type, sizeof(int8_t))) {
+    if (!read_data(ctx, &obj->as.ext.type, sizeof(int8_t))) {
       ctx->error = EXT_TYPE_READING_ERROR;
       return false;
     }
@@ -2110,7 +2254,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == FIXEXT16_MARKER) {
     obj->type = AVMP_TYPE_FIXEXT16;
-    if (!ctx->read(ctx, &obj->as.ext.type, sizeof(int8_t))) {
+    if (!read_data(ctx, &obj->as.ext.type, sizeof(int8_t))) {
       ctx->error = EXT_TYPE_READING_ERROR;
       return false;
     }
@@ -2118,7 +2262,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == STR8_MARKER) {
     obj->type = AVMP_TYPE_STR8;
-    if (!ctx->read(ctx, &obj->as.u8, sizeof(uint8_t))) {
+    if (!read_data(ctx, &obj->as.u8, sizeof(uint8_t))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
@@ -2126,7 +2270,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == STR16_MARKER) {
     obj->type = AVMP_TYPE_STR16;
-    if (!ctx->read(ctx, &obj->as.u16, sizeof(uint16_t))) {
+    if (!read_data(ctx, &obj->as.u16, sizeof(uint16_t))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
@@ -2134,7 +2278,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == STR32_MARKER) {
     obj->type = AVMP_TYPE_STR32;
-    if (!ctx->read(ctx, &obj->as.u32, sizeof(uint32_t))) {
+    if (!read_data(ctx, &obj->as.u32, sizeof(uint32_t))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
@@ -2142,7 +2286,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == ARRAY16_MARKER) {
     obj->type = AVMP_TYPE_ARRAY16;
-    if (!ctx->read(ctx, &obj->as.u16, sizeof(uint16_t))) {
+    if (!read_data(ctx, &obj->as.u16, sizeof(uint16_t))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
@@ -2150,7 +2294,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == ARRAY32_MARKER) {
     obj->type = AVMP_TYPE_ARRAY32;
-    if (!ctx->read(ctx, &obj->as.u32, sizeof(uint32_t))) {
+    if (!read_data(ctx, &obj->as.u32, sizeof(uint32_t))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
@@ -2158,7 +2302,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == MAP16_MARKER) {
     obj->type = AVMP_TYPE_MAP16;
-    if (!ctx->read(ctx, &obj->as.u16, sizeof(uint16_t))) {
+    if (!read_data(ctx, &obj->as.u16, sizeof(uint16_t))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
@@ -2166,7 +2310,7 @@ bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj) {
   }
   else if (type_marker == MAP32_MARKER) {
     obj->type = AVMP_TYPE_MAP32;
-    if (!ctx->read(ctx, &obj->as.u32, sizeof(uint32_t))) {
+    if (!read_data(ctx, &obj->as.u32, sizeof(uint32_t))) {
       ctx->error = DATA_READING_ERROR;
       return false;
     }
@@ -2646,4 +2790,172 @@ bool avmp_object_as_ext(avmp_object_t *obj, int8_t *type, uint32_t *size) {
   return false;
 }
 
+static uint8_t header_size_for_marker(uint8_t marker) {
+  if (marker <= 0xBF || marker >= NEGATIVE_FIXNUM_MARKER)
+    return 1;
+  
+  switch (marker) {
+    case NIL_MARKER:
+    case FALSE_MARKER:
+    case TRUE_MARKER:
+      return 1;
+    case BIN8_MARKER:
+    case U8_MARKER:
+    case S8_MARKER:
+    case STR8_MARKER:
+    case FIXEXT1_MARKER:
+    case FIXEXT2_MARKER:
+    case FIXEXT4_MARKER:
+    case FIXEXT8_MARKER:
+    case FIXEXT16_MARKER:
+      return 2;
+    case BIN16_MARKER:
+    case U16_MARKER:
+    case S16_MARKER:
+    case STR16_MARKER:
+    case ARRAY16_MARKER:
+    case MAP16_MARKER:
+    case EXT8_MARKER:
+      return 3;
+    case EXT16_MARKER:
+      return 4;
+    case BIN32_MARKER:
+    case U32_MARKER:
+    case S32_MARKER:
+    case STR32_MARKER:
+    case ARRAY32_MARKER:
+    case MAP32_MARKER:
+    case FLOAT_MARKER:
+      return 5;
+    case EXT32_MARKER:
+      return 6;
+    case U64_MARKER:
+    case S64_MARKER:
+    case DOUBLE_MARKER:
+      return 9;
+    default:
+      return 0;
+  }
+}
+
+static uint32_t payload_size_for_object(avmp_object_t *obj) {
+  switch (obj->type) {
+    case AVMP_TYPE_FIXSTR:
+    case AVMP_TYPE_STR8:
+    case AVMP_TYPE_STR16:
+    case AVMP_TYPE_STR32:
+      return obj->as.str_size;
+    case AVMP_TYPE_BIN8:
+    case AVMP_TYPE_BIN16:
+    case AVMP_TYPE_BIN32:
+      return obj->as.bin_size;
+    case AVMP_TYPE_EXT8:
+    case AVMP_TYPE_EXT16:
+    case AVMP_TYPE_EXT32:
+    case AVMP_TYPE_FIXEXT1:
+    case AVMP_TYPE_FIXEXT2:
+    case AVMP_TYPE_FIXEXT4:
+    case AVMP_TYPE_FIXEXT8:
+    case AVMP_TYPE_FIXEXT16:
+      return obj->as.ext.size;
+    default:
+      return 0;
+  }
+}
+
+void avmp_tokenizer_init(avmp_tokenizer_t *tok) {
+  memset(tok, 0, sizeof(avmp_tokenizer_t));
+}
+
+void avmp_tokenizer_feed(avmp_tokenizer_t *tok, const void *data, size_t size) {
+  tok->input = data;
+  tok->input_size = size;
+  tok->input_pos = 0;
+}
+
+int avmp_tokenizer_next(avmp_tokenizer_t *tok, avmp_token_t *token) {
+  size_t available = tok->input_size - tok->input_pos;
+  
+  if (tok->error)
+    return AVMP_TOKENIZER_ERROR;
+  
+  if (tok->payload_remaining) {
+    uint32_t size = tok->payload_remaining;
+    
+    if (!available)
+      return AVMP_TOKENIZER_NEED_MORE;
+    
+    if (size > available)
+      size = (uint32_t)available;
+    
+    token->kind = AVMP_TOKEN_PAYLOAD;
+    token->data = tok->input + tok->input_pos;
+    token->size = size;
+    
+    tok->input_pos += size;
+    tok->payload_remaining -= size;
+    
+    token->complete = (tok->payload_remaining == 0);
+    return AVMP_TOKENIZER_OK;
+  }
+  
+  if (!tok->header_needed) {
+    if (!available)
+      return AVMP_TOKENIZER_NEED_MORE;
+    
+    tok->header_needed = header_size_for_marker(tok->input[tok->input_pos]);
+    tok->header_size = 0;
+    
+    if (!tok->header_needed) {
+      tok->error = INVALID_TYPE_ERROR;
+      return AVMP_TOKENIZER_ERROR;
+    }
+  }
+  
+  {
+    size_t size = tok->header_needed - tok->header_size;
+    avmp_ctx_t ctx;
+    
+    if (size > available)
+      size = available;
+    
+    memcpy(tok->header + tok->header_size, tok->input + tok->input_pos, size);
+    tok->header_size += size;
+    tok->input_pos += size;
+    
+    if (tok->header_size < tok->header_needed)
+      return AVMP_TOKENIZER_NEED_MORE;
+    
+    /* The header is complete, decode it with the one-shot reader. */
+    avmp_init_buffer(&ctx, NULL, tok->header, tok->header_size, NULL);
+    memset(&token->obj, 0, sizeof(avmp_object_t));
+    
+    if (!avmp_read_object(&ctx, &token->obj)) {
+      tok->error = ctx.error;
+      return AVMP_TOKENIZER_ERROR;
+    }
+  }
+  
+  tok->header_needed = 0;
+  tok->header_size = 0;
+  tok->payload_remaining = payload_size_for_object(&token->obj);
+  
+  token->kind = AVMP_TOKEN_OBJECT;
+  token->data = NULL;
+  token->size = 0;
+  token->complete = (tok->payload_remaining == 0);
+  return AVMP_TOKENIZER_OK;
+}
+
+bool avmp_tokenizer_is_pending(const avmp_tokenizer_t *tok) {
+  return tok->header_needed || tok->payload_remaining;
+}
+
+const char* avmp_tokenizer_strerror(avmp_tokenizer_t *tok) {
+  if (tok->error > ERROR_NONE && tok->error < ERROR_MAX)
+    return avmp_error_messages[tok->error];
+  
+  return "";
+}
+
 /* vi: set et ts=2 sw=2: */
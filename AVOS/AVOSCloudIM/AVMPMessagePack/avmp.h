@@ -7,6 +7,12 @@ typedef bool   (*avmp_reader)(struct avmp_ctx_s *ctx, void *data, size_t limit);
 typedef size_t (*avmp_writer)(struct avmp_ctx_s *ctx, const void *data,
                              size_t count);
 
+/*
+ * Called in buffer mode when fewer than `needed` bytes are left; it should
+ * enlarge `data`/`size` of the context, keeping `pos` and the bytes before it.
+ */
+typedef bool   (*avmp_grower)(struct avmp_ctx_s *ctx, size_t needed);
+
 enum {
   AVMP_TYPE_POSITIVE_FIXNUM, /*  0 */
   AVMP_TYPE_FIXMAP,          /*  1 */
@@ -74,6 +80,11 @@ typedef struct avmp_ctx_s {
   void       *buf;
   avmp_reader  read;
   avmp_writer  write;
+  /* Buffer mode, I/O goes to data[pos..size) directly when data is not NULL */
+  uint8_t     *data;
+  size_t       size;
+  size_t       pos;
+  avmp_grower  grow;
 } avmp_ctx_t;
 
 typedef struct avmp_object_s {
@@ -81,6 +92,36 @@ typedef struct avmp_object_s {
   union avmp_object_data_u as;
 } avmp_object_t;
 
+enum {
+  AVMP_TOKEN_OBJECT,  /* An object; str, bin and ext data follow as payload */
+  AVMP_TOKEN_PAYLOAD  /* A slice of the data of the previous object */
+};
+
+enum {
+  AVMP_TOKENIZER_OK,
+  AVMP_TOKENIZER_NEED_MORE,
+  AVMP_TOKENIZER_ERROR
+};
+
+typedef struct avmp_token_s {
+  uint8_t        kind;
+  avmp_object_t  obj;      /* AVMP_TOKEN_OBJECT */
+  const void    *data;     /* AVMP_TOKEN_PAYLOAD, points into the fed input */
+  uint32_t       size;
+  bool           complete; /* The last slice of the payload */
+} avmp_token_t;
+
+typedef struct avmp_tokenizer_s {
+  uint8_t        error;
+  const uint8_t *input;
+  size_t         input_size;
+  size_t         input_pos;
+  uint8_t        header[9];
+  uint8_t        header_size;
+  uint8_t        header_needed;
+  uint32_t       payload_remaining;
+} avmp_tokenizer_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -94,6 +135,28 @@ extern "C" {
   /* Initializes a AVMP context */
   void avmp_init(avmp_ctx_t *ctx, void *buf, avmp_reader read, avmp_writer write);
   
+  /*
+   * Initializes a AVMP context in buffer mode, which reads from or writes to
+   * a contiguous buffer without going through the reader/writer callbacks.
+   * When writing, `grow` is called if the buffer is full; pass NULL for a
+   * fixed-size buffer.
+   */
+  void avmp_init_buffer(avmp_ctx_t *ctx, void *buf, void *data, size_t size,
+                        avmp_grower grow);
+  
+  /*
+   * Returns true if `size` bytes at `data` are well-formed UTF-8, rejecting
+   * overlong forms, surrogates and code points above U+10FFFF.  If `is_ascii`
+   * is not NULL, it is set to whether all bytes are ASCII.
+   */
+  bool avmp_utf8_validate(const void *data, size_t size, bool *is_ascii);
+  
+  /* Reads `count` raw bytes from the backend */
+  bool avmp_read_bytes(avmp_ctx_t *ctx, void *data, size_t count);
+  
+  /* Writes `count` raw bytes to the backend */
+  bool avmp_write_bytes(avmp_ctx_t *ctx, const void *data, size_t count);
+  
   /* Returns AVMP's version */
   uint32_t avmp_version(void);
   
@@ -251,6 +314,31 @@ extern "C" {
   /* Reads an object from the backend */
   bool avmp_read_object(avmp_ctx_t *ctx, avmp_object_t *obj);
   
+  /*
+   * ============================================================================
+   * === Tokenizer API
+   * ============================================================================
+   */
+  
+  /*
+   * Pull-style tokenizer over fragmented input.  Feed a fragment, then call
+   * avmp_tokenizer_next() until it returns AVMP_TOKENIZER_NEED_MORE before
+   * feeding the next one.  Object headers split across fragments are buffered
+   * internally; payloads are returned as slices of the fed fragments, which
+   * are valid until the next feed.
+   */
+  void avmp_tokenizer_init(avmp_tokenizer_t *tok);
+  
+  void avmp_tokenizer_feed(avmp_tokenizer_t *tok, const void *data, size_t size);
+  
+  int avmp_tokenizer_next(avmp_tokenizer_t *tok, avmp_token_t *token);
+  
+  /* Returns true if the input ended inside an object header or payload */
+  bool avmp_tokenizer_is_pending(const avmp_tokenizer_t *tok);
+  
+  /* Returns a string description of a tokenizer's error */
+  const char* avmp_tokenizer_strerror(avmp_tokenizer_t *tok);
+  
   /*
    * ============================================================================
    * === Specific API
@@ -40,6 +40,10 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, copy, nullable) NSString *RTMServer;
 
+/// Ask the server to carry message bodies and LiveQuery events as MessagePack bytes instead of JSON strings,
+/// they are then decoded without building an intermediate JSON string. Takes effect on the next session open or LiveQuery login, default is false.
+@property (nonatomic, assign) BOOL messagePackBodyEnabled;
+
 @end
 
 @interface AVOSCloudIM : NSObject
@@ -56,6 +56,10 @@ NS_ASSUME_NONNULL_BEGIN
 /// The control switch for message query cache, default is `true`.
 @property (nonatomic) BOOL messageQueryCacheEnabled;
 
+/// The count of pages read ahead in background after querying history messages, default is `0` which disables read-ahead.
+/// When the message query cache has a breakpoint within the next pages before the queried range, these pages are fetched from server and filled into the cache.
+@property (nonatomic) NSUInteger messageQueryReadAheadPageCount;
+
 /// Initializing with an ID.
 /// @param clientId The length of the ID should in range `[1, 64]`.
 - (nullable instancetype)initWithClientId:(NSString *)clientId LC_WARN_UNUSED_RESULT;
@@ -7,6 +7,7 @@
 //
 
 #import "AVIMClient_Internal.h"
+#import "AVOSCloudIM.h"
 #import "AVIMConversation_Internal.h"
 #import "AVIMKeyedConversation_internal.h"
 #import "AVIMConversationMemberInfo_Internal.h"
@@ -196,6 +197,9 @@ void assertContextOfQueue(dispatch_queue_t queue, BOOL isRunIn)
                             | LCIMSessionConfigOptionsTransientMessageACK
                             | LCIMSessionConfigOptionsPartialFailedMessage
                             | LCIMSessionConfigOptionsOmitPeerID);
+    if ([AVOSCloudIM defaultOptions].messagePackBodyEnabled) {
+        _sessionConfigBitmap |= LCIMSessionConfigOptionsMessagePackBody;
+    }
     _status = AVIMClientStatusNone;
     _lock = [NSLock new];
     _lastUnreadNotifTime = 0;
@@ -774,6 +778,47 @@ void assertContextOfQueue(dispatch_queue_t queue, BOOL isRunIn)
     }];
 }
 
+- (void)sendCommandWrappers:(NSArray<LCIMProtobufCommandWrapper *> *)commandWrappers
+{
+    [self addOperationToInternalSerialQueue:^(AVIMClient *client) {
+        if ([client status] != AVIMClientStatusOpened) {
+            for (LCIMProtobufCommandWrapper *commandWrapper in commandWrappers) {
+                if (commandWrapper.callback) {
+                    commandWrapper.error = LCError(AVIMErrorCodeClientNotOpen,
+                                                   @"Client not open.", nil);
+                    commandWrapper.callback(client, commandWrapper);
+                    commandWrapper.callback = nil;
+                }
+            }
+            return;
+        }
+        __weak typeof(client) wClient = client;
+        NSMutableArray<AVIMGenericCommand *> *outCommands = [NSMutableArray arrayWithCapacity:commandWrappers.count];
+        NSMutableArray<LCRTMConnectionOutCommandCallback> *callbacks = [NSMutableArray arrayWithCapacity:commandWrappers.count];
+        for (LCIMProtobufCommandWrapper *commandWrapper in commandWrappers) {
+            [outCommands addObject:commandWrapper.outCommand];
+            [callbacks addObject:^(AVIMGenericCommand * _Nullable inCommand, NSError * _Nullable error) {
+                AVIMClient *sClient = wClient;
+                if (!sClient) {
+                    return;
+                }
+                AssertRunInQueue(sClient.internalSerialQueue);
+                commandWrapper.inCommand = inCommand;
+                commandWrapper.error = error;
+                if (commandWrapper.callback) {
+                    commandWrapper.callback(sClient, commandWrapper);
+                    commandWrapper.callback = nil;
+                }
+            }];
+        }
+        [client.connection sendCommands:outCommands
+                                service:LCRTMServiceInstantMessaging
+                                 peerID:client.clientId
+                                onQueue:client.internalSerialQueue
+                              callbacks:callbacks];
+    }];
+}
+
 // MARK: LCRTMConnection Delegate
 
 - (void)LCRTMConnection:(LCRTMConnection *)connection didReceiveCommand:(AVIMGenericCommand *)inCommand
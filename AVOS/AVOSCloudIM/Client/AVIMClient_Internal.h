@@ -72,6 +72,7 @@ void assertContextOfQueue(dispatch_queue_t queue, BOOL isRunIn);
 - (void)invokeDelegateInUserInteractQueue:(void (^)(id<AVIMClientDelegate> delegate))block;
 
 - (void)sendCommandWrapper:(LCIMProtobufCommandWrapper *)commandWrapper;
+- (void)sendCommandWrappers:(NSArray<LCIMProtobufCommandWrapper *> *)commandWrappers;
 
 - (void)getSignatureWithConversationId:(NSString *)conversationId
                                 action:(AVIMSignatureAction)action
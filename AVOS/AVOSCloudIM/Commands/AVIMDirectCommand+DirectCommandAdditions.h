@@ -13,4 +13,8 @@
 
 @property(nonatomic, strong) AVIMMessage *message;
 
+/// Sets the `msg` field from UTF-8 bytes.
+/// ASCII bytes are not copied: the string refers to them and keeps `data` alive.
+- (void)avim_setMsgData:(NSData *)data;
+
 @end
@@ -9,6 +9,22 @@
 #import "AVIMDirectCommand+DirectCommandAdditions.h"
 #import <objc/runtime.h>
 
+static const void *LCIMDataRetain(const void *info) {
+    return CFRetain(info);
+}
+
+static void LCIMDataRelease(const void *info) {
+    CFRelease(info);
+}
+
+static void *LCIMDataAllocate(CFIndex allocSize, CFOptionFlags hint, void *info) {
+    return NULL;
+}
+
+static void LCIMDataDeallocate(void *ptr, void *info) {
+    /* The bytes belong to the data in `info`, released with the allocator. */
+}
+
 @implementation AVIMDirectCommand (DirectCommandAdditions)
 
 - (AVIMMessage *)message {
@@ -19,4 +35,25 @@
     objc_setAssociatedObject(self, @selector(message), message, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
 }
 
+- (void)avim_setMsgData:(NSData *)data {
+    data = [data copy];
+    if (!data.length) {
+        self.msg = @"";
+        return;
+    }
+    /* The allocator only exists to own `data` until the string no longer needs its bytes. */
+    CFAllocatorContext context = {
+        .version = 0,
+        .info = (__bridge void *)data,
+        .retain = LCIMDataRetain,
+        .release = LCIMDataRelease,
+        .allocate = LCIMDataAllocate,
+        .deallocate = LCIMDataDeallocate,
+    };
+    CFAllocatorRef deallocator = CFAllocatorCreate(kCFAllocatorDefault, &context);
+    CFStringRef string = CFStringCreateWithBytesNoCopy(kCFAllocatorDefault, data.bytes, (CFIndex)data.length, kCFStringEncodingUTF8, false, deallocator);
+    CFRelease(deallocator);
+    self.msg = CFBridgingRelease(string);
+}
+
 @end
@@ -247,6 +247,7 @@ BOOL AVIMLogsCommand_QueryDirection_IsValidValue(int32_t value);
 
 typedef LCGPB_ENUM(AVIMJsonObjectMessage_FieldNumber) {
   AVIMJsonObjectMessage_FieldNumber_Data_p = 1,
+  AVIMJsonObjectMessage_FieldNumber_BinaryData = 2,
 };
 
 @interface AVIMJsonObjectMessage : LCGPBMessage
@@ -255,6 +256,10 @@ typedef LCGPB_ENUM(AVIMJsonObjectMessage_FieldNumber) {
 /** Test to see if @c data_p has been set. */
 @property(nonatomic, readwrite) BOOL hasData_p;
 
+@property(nonatomic, readwrite, copy, null_resettable) NSData *binaryData;
+/** Test to see if @c binaryData has been set. */
+@property(nonatomic, readwrite) BOOL hasBinaryData;
+
 @end
 
 #pragma mark - AVIMUnreadTuple
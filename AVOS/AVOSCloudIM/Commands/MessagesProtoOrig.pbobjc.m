@@ -352,10 +352,12 @@ BOOL AVIMStatusType_IsValidValue(int32_t value__) {
 @implementation AVIMJsonObjectMessage
 
 @dynamic hasData_p, data_p;
+@dynamic hasBinaryData, binaryData;
 
 typedef struct AVIMJsonObjectMessage__storage_ {
   uint32_t _has_storage_[1];
   NSString *data_p;
+  NSData *binaryData;
 } AVIMJsonObjectMessage__storage_;
 
 // This method is threadsafe because it is initially called
@@ -373,6 +375,15 @@ typedef struct AVIMJsonObjectMessage__storage_ {
         .flags = LCGPBFieldRequired,
         .dataType = LCGPBDataTypeString,
       },
+      {
+        .name = "binaryData",
+        .dataTypeSpecific.className = NULL,
+        .number = AVIMJsonObjectMessage_FieldNumber_BinaryData,
+        .hasIndex = 1,
+        .offset = (uint32_t)offsetof(AVIMJsonObjectMessage__storage_, binaryData),
+        .flags = LCGPBFieldOptional,
+        .dataType = LCGPBDataTypeBytes,
+      },
     };
     LCGPBDescriptor *localDescriptor =
         [LCGPBDescriptor allocDescriptorForClass:[AVIMJsonObjectMessage class]
@@ -104,6 +104,13 @@ typedef void(^LCRTMConnectionOutCommandCallback)(AVIMGenericCommand * _Nullable
             onQueue:(dispatch_queue_t _Nullable)queue
            callback:(LCRTMConnectionOutCommandCallback _Nullable)callback;
 
+/// Send commands in one outbound flush, the count of callbacks should be equal to the count of commands.
+- (void)sendCommands:(NSArray<AVIMGenericCommand *> *)commands
+             service:(LCRTMService)service
+              peerID:(NSString *)peerID
+             onQueue:(dispatch_queue_t)queue
+           callbacks:(NSArray<LCRTMConnectionOutCommandCallback> *)callbacks;
+
 @end
 
 NS_ASSUME_NONNULL_END
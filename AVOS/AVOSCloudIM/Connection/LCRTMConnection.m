@@ -923,76 +923,149 @@ static NSString * LCRTMStringFromConnectionAppState(LCRTMConnectionAppState stat
 {
     dispatch_async(self.serialQueue, ^{
         LCRTMWebSocket *socket = self.socket;
-        LCRTMConnectionTimer *timer = self.timer;
-        BOOL needCallback = (queue && callback);
-        if (!socket ||
-            !timer) {
-            if (needCallback) {
-                dispatch_async(queue, ^{
-                    callback(nil, LCError(AVIMErrorCodeConnectionLost,
-                                          @"Connection Lost", nil));
-                });
-            }
+        LCRTMWebSocketMessage *message = [self prepareOutCommand:command
+                                                         service:service
+                                                          peerID:peerID
+                                                         onQueue:queue
+                                                        callback:callback];
+        if (!message) {
             return;
         }
-        if (service == LCRTMServiceInstantMessaging) {
-            [self tryPadPeerID:peerID forCommand:command];
-        }
-        if (needCallback) {
-            if ([timer tryThrottling:command
-                                from:peerID
-                               queue:queue
-                            callback:callback]) {
-                return;
-            }
-            command.i = [timer nextIndex];
-        }
-        NSData *data = [command data];
-        if (!data) {
-            if (needCallback) {
-                dispatch_async(queue, ^{
-                    callback(nil, LCError(AVIMErrorCodeInvalidCommand,
-                                          @"Serializing out command failed.", nil));
-                });
-            }
-            return;
-        } else if (data.length > (1024 * 5)) {
-            if (needCallback) {
-                dispatch_async(queue, ^{
-                    callback(nil, LCError(AVIMErrorCodeCommandDataLengthTooLong,
-                                          @"The size of the out command should less than 5KB.", nil));
-                });
+#if DEBUG
+        void *specificKey = (__bridge void *)(self.serialQueue);
+#endif
+        [socket sendMessage:message completion:^{
+#if DEBUG
+            assert(dispatch_get_specific(specificKey) == specificKey);
+#endif
+            [self logOutCommands:@[command] socket:socket service:service peerID:peerID];
+        }];
+    });
+}
+
+- (void)sendCommands:(NSArray<AVIMGenericCommand *> *)commands
+             service:(LCRTMService)service
+              peerID:(NSString *)peerID
+             onQueue:(dispatch_queue_t)queue
+           callbacks:(NSArray<LCRTMConnectionOutCommandCallback> *)callbacks
+{
+    NSParameterAssert(commands.count == callbacks.count);
+    dispatch_async(self.serialQueue, ^{
+        LCRTMWebSocket *socket = self.socket;
+        NSMutableArray<AVIMGenericCommand *> *sentCommands = [NSMutableArray arrayWithCapacity:commands.count];
+        NSMutableArray<LCRTMWebSocketMessage *> *messages = [NSMutableArray arrayWithCapacity:commands.count];
+        [commands enumerateObjectsUsingBlock:^(AVIMGenericCommand *command, NSUInteger idx, BOOL *stop) {
+            LCRTMWebSocketMessage *message = [self prepareOutCommand:command
+                                                             service:service
+                                                              peerID:peerID
+                                                             onQueue:queue
+                                                            callback:callbacks[idx]];
+            if (message) {
+                [sentCommands addObject:command];
+                [messages addObject:message];
             }
+        }];
+        if (messages.count == 0) {
             return;
         }
-        if (needCallback) {
-            [timer appendOutCommand:[[LCRTMConnectionOutCommand alloc]
-                                     initWithPeerID:peerID
-                                     command:command
-                                     callingQueue:queue
-                                     callback:callback]
-                              index:@(command.i)];
-        }
 #if DEBUG
         void *specificKey = (__bridge void *)(self.serialQueue);
 #endif
-        [socket sendMessage:[LCRTMWebSocketMessage messageWithData:data] completion:^{
+        [socket sendMessages:messages completion:^(NSError *error) {
 #if DEBUG
             assert(dispatch_get_specific(specificKey) == specificKey);
 #endif
-            AVLoggerDebug(AVLoggerDomainIM,
-                          @"\n------ BEGIN LeanCloud Out Command"
-                          @"\n%@: %p"
-                          @"\nService: %d"
-                          @"\nPID: %@"
-                          @"\n%@"
-                          @"\n------ END",
-                          NSStringFromClass([socket class]), socket,
-                          service, peerID, command);
+            if (error) {
+                return;
+            }
+            [self logOutCommands:sentCommands socket:socket service:service peerID:peerID];
         }];
     });
 }
 
+- (LCRTMWebSocketMessage *)prepareOutCommand:(AVIMGenericCommand *)command
+                                     service:(LCRTMService)service
+                                      peerID:(NSString *)peerID
+                                     onQueue:(dispatch_queue_t)queue
+                                    callback:(LCRTMConnectionOutCommandCallback)callback
+{
+    NSParameterAssert([self assertSpecificSerialQueue]);
+    LCRTMWebSocket *socket = self.socket;
+    LCRTMConnectionTimer *timer = self.timer;
+    BOOL needCallback = (queue && callback);
+    if (!socket ||
+        !timer) {
+        if (needCallback) {
+            dispatch_async(queue, ^{
+                callback(nil, LCError(AVIMErrorCodeConnectionLost,
+                                      @"Connection Lost", nil));
+            });
+        }
+        return nil;
+    }
+    if (service == LCRTMServiceInstantMessaging) {
+        [self tryPadPeerID:peerID forCommand:command];
+    }
+    if (needCallback) {
+        if ([timer tryThrottling:command
+                            from:peerID
+                           queue:queue
+                        callback:callback]) {
+            return nil;
+        }
+        command.i = [timer nextIndex];
+    }
+    // Serialize straight into a framing buffer, after the room reserved for the frame header,
+    // so the command is neither copied into a separate NSData nor into the frame.
+    NSMutableData *buffer = [socket dequeueFramingBuffer];
+    if (![command writeToData:buffer offset:LCRTMWebSocketFrameHeaderReservedLength]) {
+        [socket recycleFramingBuffer:buffer];
+        if (needCallback) {
+            dispatch_async(queue, ^{
+                callback(nil, LCError(AVIMErrorCodeInvalidCommand,
+                                      @"Serializing out command failed.", nil));
+            });
+        }
+        return nil;
+    } else if (buffer.length - LCRTMWebSocketFrameHeaderReservedLength > (1024 * 5)) {
+        [socket recycleFramingBuffer:buffer];
+        if (needCallback) {
+            dispatch_async(queue, ^{
+                callback(nil, LCError(AVIMErrorCodeCommandDataLengthTooLong,
+                                      @"The size of the out command should less than 5KB.", nil));
+            });
+        }
+        return nil;
+    }
+    if (needCallback) {
+        [timer appendOutCommand:[[LCRTMConnectionOutCommand alloc]
+                                 initWithPeerID:peerID
+                                 command:command
+                                 callingQueue:queue
+                                 callback:callback]
+                          index:@(command.i)];
+    }
+    return [LCRTMWebSocketMessage messageWithFramingBuffer:buffer];
+}
+
+- (void)logOutCommands:(NSArray<AVIMGenericCommand *> *)commands
+                socket:(LCRTMWebSocket *)socket
+               service:(LCRTMService)service
+                peerID:(NSString *)peerID
+{
+    for (AVIMGenericCommand *command in commands) {
+        AVLoggerDebug(AVLoggerDomainIM,
+                      @"\n------ BEGIN LeanCloud Out Command"
+                      @"\n%@: %p"
+                      @"\nService: %d"
+                      @"\nPID: %@"
+                      @"\n%@"
+                      @"\n------ END",
+                      NSStringFromClass([socket class]), socket,
+                      service, peerID, command);
+    }
+}
+
 - (void)tryPadPeerID:(NSString *)peerID
           forCommand:(AVIMGenericCommand *)command
 {
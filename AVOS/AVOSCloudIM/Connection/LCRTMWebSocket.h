@@ -30,19 +30,30 @@ typedef NS_ENUM(NSInteger, LCRTMWebSocketMessageType) {
     LCRTMWebSocketMessageTypeString = 1,
 };
 
+/// The room a framing buffer keeps in front of its payload for the largest
+/// client frame header (2 bytes, 8 bytes of extended length, 4 bytes of masking key).
+FOUNDATION_EXPORT const NSUInteger LCRTMWebSocketFrameHeaderReservedLength;
+
 NS_ASSUME_NONNULL_BEGIN
 
 @interface LCRTMWebSocketMessage : NSObject
 
 + (instancetype)messageWithData:(NSData *)data;
 + (instancetype)messageWithString:(NSString *)string;
++ (instancetype)messageWithFramingBuffer:(NSMutableData *)buffer;
 
 - (instancetype)initWithData:(NSData *)data NS_DESIGNATED_INITIALIZER;
 - (instancetype)initWithString:(NSString *)string NS_DESIGNATED_INITIALIZER;
+/// A binary message whose payload is already in `buffer`, after the first
+/// `LCRTMWebSocketFrameHeaderReservedLength` bytes. The frame header is written
+/// into the reserved room and the payload is masked in place, so the buffer is
+/// sent without being copied, and must not be used by the caller afterwards.
+- (instancetype)initWithFramingBuffer:(NSMutableData *)buffer NS_DESIGNATED_INITIALIZER;
 
 @property (nonatomic, readonly) LCRTMWebSocketMessageType type;
 @property (nonatomic, nullable, readonly) NSData *data;
 @property (nonatomic, nullable, readonly) NSString *string;
+@property (nonatomic, nullable, readonly) NSMutableData *framingBuffer;
 
 - (instancetype)init NS_UNAVAILABLE;
 + (instancetype)new NS_UNAVAILABLE;
@@ -83,9 +94,18 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)closeWithCloseCode:(LCRTMWebSocketCloseCode)closeCode reason:(NSData * _Nullable)reason;
 
 - (void)sendMessage:(LCRTMWebSocketMessage *)message completion:(void (^ _Nullable)(void))completion;
+/// Sends the messages in order. `completion` runs once the last one is written, or with an
+/// error if the socket is no longer writable, in which case none of them is sent.
+- (void)sendMessages:(NSArray<LCRTMWebSocketMessage *> *)messages completion:(void (^ _Nullable)(NSError * _Nullable error))completion;
 - (void)sendPing:(NSData * _Nullable)data completion:(void (^ _Nullable)(void))completion;
 - (void)sendPong:(NSData * _Nullable)data completion:(void (^ _Nullable)(void))completion;
 
+/// Returns an empty framing buffer for `-[LCRTMWebSocketMessage initWithFramingBuffer:]`,
+/// reusing one whose message has been written out when possible.
+- (NSMutableData *)dequeueFramingBuffer;
+/// Gives back a framing buffer that was not sent.
+- (void)recycleFramingBuffer:(NSMutableData *)buffer;
+
 - (void)clean;
 
 @end
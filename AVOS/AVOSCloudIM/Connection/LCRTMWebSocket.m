@@ -37,6 +37,8 @@
 
 @end
 
+const NSUInteger LCRTMWebSocketFrameHeaderReservedLength = 14;
+
 @implementation LCRTMWebSocketMessage
 
 + (instancetype)messageWithData:(NSData *)data
@@ -49,6 +51,11 @@
     return [[self alloc] initWithString:string];
 }
 
++ (instancetype)messageWithFramingBuffer:(NSMutableData *)buffer
+{
+    return [[self alloc] initWithFramingBuffer:buffer];
+}
+
 - (instancetype)initWithData:(NSData *)data
 {
     self = [super init];
@@ -69,6 +76,17 @@
     return self;
 }
 
+- (instancetype)initWithFramingBuffer:(NSMutableData *)buffer
+{
+    NSParameterAssert(buffer.length >= LCRTMWebSocketFrameHeaderReservedLength);
+    self = [super init];
+    if (self) {
+        _type = LCRTMWebSocketMessageTypeData;
+        _framingBuffer = buffer;
+    }
+    return self;
+}
+
 @end
 
 typedef NS_ENUM(UInt8, LCRTMWebSocketOpcode) {
@@ -89,9 +107,11 @@ typedef NS_ENUM(UInt8, LCRTMWebSocketOpcode) {
 /// If the frame is output data, it means all data of the WebSocket data frame;
 /// If the frame is input data, it means the payload of the WebSocket data frame;
 @property (nonatomic) NSData *payload;
-/// The following two only for output data frame.
+/// The following three only for output data frame.
 @property (nonatomic) NSUInteger offset;
 @property (nonatomic) void(^completion)(void);
+/// The framing buffer `payload` points into, if any; recycled once written.
+@property (nonatomic) NSMutableData *framingBuffer;
 
 @end
 
@@ -187,48 +207,46 @@ static const UInt8 LCRTMWebSocketFrameBitMaskPayloadLength = 0x7F;
 + (LCRTMWebSocketFrame *)frameFrom:(NSData *)data
                             opcode:(LCRTMWebSocketOpcode)opcode
 {
-    UInt8 payloadLen;
-    NSUInteger bufferLength = 6 + data.length;
-    UInt16 payloadLen16 = 0;
-    UInt64 payloadLen64 = 0;
-    if (data.length < 126) {
-        payloadLen = (UInt8)(data.length);
-    } else if (data.length <= UINT16_MAX) {
-        payloadLen = 126;
-        bufferLength += 2;
-        payloadLen16 = (UInt16)(data.length);
-    } else {
-        payloadLen = 127;
-        bufferLength += 8;
-        payloadLen64 = (UInt64)(data.length);
-    }
-    UInt8 buffer[bufferLength];
-    buffer[0] = LCRTMWebSocketFrameBitMaskFIN | opcode;
-    buffer[1] = LCRTMWebSocketFrameBitMaskMask | payloadLen;
-    NSUInteger offset = 2;
-    if (payloadLen16 > 0) {
-        [self writeUInt16:payloadLen16 buffer:buffer offset:offset];
-        offset += 2;
-    } else if (payloadLen64 > 0) {
-        [self writeUInt64:payloadLen64 buffer:buffer offset:offset];
-        offset += 8;
-    }
-    UInt8 *maskingKey = buffer + offset;
-    __unused int status = SecRandomCopyBytes(kSecRandomDefault, 4, maskingKey);
-    offset += 4;
-    for (NSUInteger i = 0; i < data.length; i++) {
-        buffer[offset + i] = ((UInt8 *)(data.bytes))[i] ^ maskingKey[i % 4];
+    NSUInteger headerLength = [self headerLengthForPayloadLength:data.length];
+    NSMutableData *buffer = [NSMutableData dataWithLength:headerLength + data.length];
+    UInt8 *bytes = (UInt8 *)(buffer.mutableBytes);
+    if (data.length > 0) {
+        memcpy(bytes + headerLength, data.bytes, data.length);
     }
+    [self writeHeaderWithOpcode:opcode
+                  payloadLength:data.length
+                         buffer:bytes];
     LCRTMWebSocketFrame *frame = [LCRTMWebSocketFrame new];
     frame.opcode = opcode;
-    frame.payload = [NSData dataWithBytes:buffer
-                                   length:bufferLength];
+    frame.payload = buffer;
+    frame.offset = 0;
+    return frame;
+}
+
++ (LCRTMWebSocketFrame *)frameFromFramingBuffer:(NSMutableData *)buffer
+{
+    NSUInteger payloadLength = buffer.length - LCRTMWebSocketFrameHeaderReservedLength;
+    NSUInteger headerLength = [self headerLengthForPayloadLength:payloadLength];
+    // Right-align the header against the payload, so the frame starts inside the reserved room.
+    UInt8 *bytes = (UInt8 *)(buffer.mutableBytes) + (LCRTMWebSocketFrameHeaderReservedLength - headerLength);
+    [self writeHeaderWithOpcode:LCRTMWebSocketOpcodeBinary
+                  payloadLength:payloadLength
+                         buffer:bytes];
+    LCRTMWebSocketFrame *frame = [LCRTMWebSocketFrame new];
+    frame.opcode = LCRTMWebSocketOpcodeBinary;
+    frame.payload = [NSData dataWithBytesNoCopy:bytes
+                                         length:headerLength + payloadLength
+                                   freeWhenDone:false];
     frame.offset = 0;
+    frame.framingBuffer = buffer;
     return frame;
 }
 
 + (LCRTMWebSocketFrame *)frameFrom:(LCRTMWebSocketMessage *)message
 {
+    if (message.framingBuffer) {
+        return [self frameFromFramingBuffer:message.framingBuffer];
+    }
     NSData *data;
     LCRTMWebSocketOpcode opcode;
     if (message.type == LCRTMWebSocketMessageTypeData) {
@@ -242,6 +260,57 @@ static const UInt8 LCRTMWebSocketFrameBitMaskPayloadLength = 0x7F;
                     opcode:opcode];
 }
 
++ (NSUInteger)headerLengthForPayloadLength:(NSUInteger)payloadLength
+{
+    // 2 bytes of FIN, opcode, mask and payload length, then the extended payload length
+    // (if any), then 4 bytes of masking key.
+    NSUInteger headerLength = 6;
+    if (payloadLength >= 126) {
+        headerLength += (payloadLength <= UINT16_MAX) ? 2 : 8;
+    }
+    return headerLength;
+}
+
+/// Writes the header of a masked client frame at `buffer`, then masks the `payloadLength`
+/// bytes of payload that follow the header in place.
++ (void)writeHeaderWithOpcode:(LCRTMWebSocketOpcode)opcode
+                payloadLength:(NSUInteger)payloadLength
+                       buffer:(UInt8 *)buffer
+{
+    buffer[0] = LCRTMWebSocketFrameBitMaskFIN | opcode;
+    NSUInteger offset = 2;
+    if (payloadLength < 126) {
+        buffer[1] = LCRTMWebSocketFrameBitMaskMask | (UInt8)(payloadLength);
+    } else if (payloadLength <= UINT16_MAX) {
+        buffer[1] = LCRTMWebSocketFrameBitMaskMask | 126;
+        [self writeUInt16:(UInt16)(payloadLength) buffer:buffer offset:offset];
+        offset += 2;
+    } else {
+        buffer[1] = LCRTMWebSocketFrameBitMaskMask | 127;
+        [self writeUInt64:(UInt64)(payloadLength) buffer:buffer offset:offset];
+        offset += 8;
+    }
+    UInt8 *maskingKey = buffer + offset;
+    __unused int status = SecRandomCopyBytes(kSecRandomDefault, 4, maskingKey);
+    offset += 4;
+    UInt8 *payload = buffer + offset;
+    // Mask eight bytes at a time, then the tail; `i` stays a multiple of 4 in the first loop.
+    UInt64 mask;
+    for (int i = 0; i < 8; i++) {
+        ((UInt8 *)&mask)[i] = maskingKey[i % 4];
+    }
+    NSUInteger i = 0;
+    for (; i + 8 <= payloadLength; i += 8) {
+        UInt64 word;
+        memcpy(&word, payload + i, 8);
+        word ^= mask;
+        memcpy(payload + i, &word, 8);
+    }
+    for (; i < payloadLength; i++) {
+        payload[i] ^= maskingKey[i % 4];
+    }
+}
+
 + (UInt16)readUInt16:(UInt8 *)buffer offset:(NSUInteger)offset
 {
     return ((UInt16)(buffer[offset + 0]) << 8) | (UInt16)(buffer[offset + 1]);
@@ -290,9 +359,15 @@ static const UInt8 LCRTMWebSocketFrameBitMaskPayloadLength = 0x7F;
 @property (nonatomic) NSMutableData *inputSegmentBuffer;
 @property (nonatomic) NSMutableArray<LCRTMWebSocketFrame *> *inputFrameStack;
 @property (nonatomic) NSMutableArray<LCRTMWebSocketFrame *> *outputFrameQueue;
+@property (nonatomic) NSMutableArray<NSMutableData *> *framingBufferPool;
+@property (nonatomic) NSLock *framingBufferPoolLock;
 
 @end
 
+/// How many framing buffers are kept for reuse, and the largest one worth keeping.
+static const NSUInteger LCRTMWebSocketFramingBufferPoolCapacity = 4;
+static const NSUInteger LCRTMWebSocketFramingBufferMaxReusableLength = 1024 * 16;
+
 @implementation LCRTMWebSocket
 
 - (instancetype)init
@@ -324,6 +399,8 @@ static const UInt8 LCRTMWebSocketFrameBitMaskPayloadLength = 0x7F;
 #endif
         _inputFrameStack = [NSMutableArray array];
         _outputFrameQueue = [NSMutableArray array];
+        _framingBufferPool = [NSMutableArray array];
+        _framingBufferPoolLock = [NSLock new];
     }
     return self;
 }
@@ -496,6 +573,9 @@ static const UInt8 LCRTMWebSocketFrameBitMaskPayloadLength = 0x7F;
 {
     dispatch_async(self.writeQueue, ^{
         if (!self.isWritable) {
+            if (message.framingBuffer) {
+                [self recycleFramingBuffer:message.framingBuffer];
+            }
             return;
         }
         LCRTMWebSocketFrame *frame = [LCRTMWebSocketFrame frameFrom:message];
@@ -505,6 +585,41 @@ static const UInt8 LCRTMWebSocketFrameBitMaskPayloadLength = 0x7F;
     });
 }
 
+- (void)sendMessages:(NSArray<LCRTMWebSocketMessage *> *)messages
+          completion:(void (^)(NSError *))completion
+{
+    dispatch_async(self.writeQueue, ^{
+        if (!self.isWritable) {
+            for (LCRTMWebSocketMessage *message in messages) {
+                if (message.framingBuffer) {
+                    [self recycleFramingBuffer:message.framingBuffer];
+                }
+            }
+            if (completion) {
+                LCRTMWebSocketConnectionClosure *closure = [LCRTMWebSocketConnectionClosure new];
+                closure.closeCode = LCRTMWebSocketCloseCodeInvalid;
+                closure.reason = @"Socket is not writable";
+                NSError *error = [closure error];
+                dispatch_async(self.delegateQueue, ^{
+                    completion(error);
+                });
+            }
+            return;
+        }
+        LCRTMWebSocketFrame *lastFrame;
+        for (LCRTMWebSocketMessage *message in messages) {
+            lastFrame = [LCRTMWebSocketFrame frameFrom:message];
+            [self.outputFrameQueue addObject:lastFrame];
+        }
+        if (completion) {
+            lastFrame.completion = ^{
+                completion(nil);
+            };
+        }
+        [self dequeueFrames];
+    });
+}
+
 - (void)closeWithCloseCode:(LCRTMWebSocketCloseCode)closeCode
                     reason:(NSData *)reason
 {
@@ -560,6 +675,30 @@ static const UInt8 LCRTMWebSocketFrameBitMaskPayloadLength = 0x7F;
     });
 }
 
+- (NSMutableData *)dequeueFramingBuffer
+{
+    [self.framingBufferPoolLock lock];
+    NSMutableData *buffer = self.framingBufferPool.lastObject;
+    if (buffer) {
+        [self.framingBufferPool removeLastObject];
+    }
+    [self.framingBufferPoolLock unlock];
+    return buffer ?: [NSMutableData dataWithCapacity:1024];
+}
+
+- (void)recycleFramingBuffer:(NSMutableData *)buffer
+{
+    if (buffer.length > LCRTMWebSocketFramingBufferMaxReusableLength) {
+        return;
+    }
+    buffer.length = 0;
+    [self.framingBufferPoolLock lock];
+    if (self.framingBufferPool.count < LCRTMWebSocketFramingBufferPoolCapacity) {
+        [self.framingBufferPool addObject:buffer];
+    }
+    [self.framingBufferPoolLock unlock];
+}
+
 // MARK: NSStreamDelegate
 
 - (void)stream:(NSStream *)aStream handleEvent:(NSStreamEvent)eventCode
@@ -879,6 +1018,10 @@ static const UInt8 LCRTMWebSocketFrameBitMaskPayloadLength = 0x7F;
     }
     frame.offset += (NSUInteger)writtenBytes;
     if (frame.offset == frame.payload.length) {
+        if (frame.framingBuffer) {
+            [self recycleFramingBuffer:frame.framingBuffer];
+            frame.framingBuffer = nil;
+        }
         if (frame.completion) {
             dispatch_async(self.delegateQueue, ^{
                 frame.completion();
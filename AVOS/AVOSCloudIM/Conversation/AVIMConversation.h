@@ -324,6 +324,24 @@ __deprecated_msg("Deprecated, use `AVIMConversation.updatedAt` instead.");
       progressBlock:(void (^ _Nullable)(NSInteger progress))progressBlock
            callback:(void (^)(BOOL succeeded, NSError * _Nullable error))callback;
 
+/*!
+ Sends a batch of messages to this conversation.
+ The direct commands of the batch are sent in one flush, the sent messages are cached in one transaction and the last message is updated once.
+ @param messages － The messages to send, in order.
+ @param option － Message sending options, applied to every message.
+ @param callback － A callback on results, invoked once for each message in the order of messages.
+ */
+- (void)sendMessages:(NSArray<AVIMMessage *> *)messages
+              option:(nullable AVIMMessageOption *)option
+            callback:(void (^)(AVIMMessage *message, BOOL succeeded, NSError * _Nullable error))callback;
+
+/*!
+ Cancels sending messages of a batch whose files have not finished uploading.
+ The callback of a cancelled message is invoked with an `NSURLErrorCancelled` error, other messages of the batch are still sent.
+ @param messages － The messages to cancel.
+ */
+- (void)cancelSendingMessages:(NSArray<AVIMMessage *> *)messages;
+
 // MARK: - Message Update
 
 /*!
@@ -66,6 +66,120 @@
 
 @end
 
+@implementation LCIMMessageFileUploadStage {
+    dispatch_queue_t _queue;
+    NSUInteger _maxConcurrentCount;
+    NSMutableIndexSet *_pendingIndexes;
+    NSMutableDictionary<NSNumber *, AVFile *> *_uploadingFiles;
+    NSMutableIndexSet *_cancelledIndexes;
+    void (^_fillingBlock)(AVIMTypedMessage *, AVFile *);
+    void (^_completion)(LCIMMessageFileUploadStage *);
+}
+
+- (instancetype)initWithMessages:(NSArray<AVIMMessage *> *)messages
+              maxConcurrentCount:(NSUInteger)maxConcurrentCount
+                           queue:(dispatch_queue_t)queue
+{
+    self = [super init];
+    if (self) {
+        _messages = [messages copy];
+        _failures = [NSMutableArray arrayWithCapacity:_messages.count];
+        _queue = queue;
+        _maxConcurrentCount = (maxConcurrentCount ?: 3);
+        _pendingIndexes = [NSMutableIndexSet indexSet];
+        _uploadingFiles = [NSMutableDictionary dictionary];
+        _cancelledIndexes = [NSMutableIndexSet indexSet];
+        [_messages enumerateObjectsUsingBlock:^(AVIMMessage *message, NSUInteger idx, BOOL *stop) {
+            [self->_failures addObject:[NSNull null]];
+            if ([message isKindOfClass:[AVIMTypedMessage class]] &&
+                ((AVIMTypedMessage *)message).file) {
+                [self->_pendingIndexes addIndex:idx];
+            }
+        }];
+    }
+    return self;
+}
+
+- (void)startWithFillingBlock:(void (^)(AVIMTypedMessage *, AVFile *))fillingBlock
+                   completion:(void (^)(LCIMMessageFileUploadStage *))completion
+{
+    _fillingBlock = fillingBlock;
+    _completion = completion;
+    [self schedule];
+}
+
+- (void)schedule
+{
+    while (_uploadingFiles.count < _maxConcurrentCount &&
+           _pendingIndexes.count > 0) {
+        NSUInteger index = _pendingIndexes.firstIndex;
+        [_pendingIndexes removeIndex:index];
+        AVIMTypedMessage *typedMessage = (AVIMTypedMessage *)_messages[index];
+        AVFile *file = typedMessage.file;
+        _uploadingFiles[@(index)] = file;
+        [file uploadWithProgress:nil completionHandler:^(BOOL succeeded, NSError * _Nullable error) {
+            dispatch_async(self->_queue, ^{
+                [self->_uploadingFiles removeObjectForKey:@(index)];
+                if ([self->_cancelledIndexes containsIndex:index]) {
+                    [self failMessageAtIndex:index withError:[self cancellationError]];
+                } else if (error) {
+                    [self failMessageAtIndex:index withError:error];
+                } else if (self->_fillingBlock) {
+                    self->_fillingBlock(typedMessage, file);
+                }
+                [self schedule];
+            });
+        }];
+    }
+    if (_uploadingFiles.count == 0 &&
+        _pendingIndexes.count == 0 &&
+        _completion) {
+        void (^completion)(LCIMMessageFileUploadStage *) = _completion;
+        _completion = nil;
+        _fillingBlock = nil;
+        completion(self);
+    }
+}
+
+- (void)cancelMessages:(NSArray<AVIMMessage *> *)messages
+{
+    if (!_completion) {
+        return;
+    }
+    for (AVIMMessage *message in messages) {
+        NSUInteger index = [_messages indexOfObjectIdenticalTo:message];
+        if (index == NSNotFound) {
+            continue;
+        }
+        if ([_pendingIndexes containsIndex:index]) {
+            [_pendingIndexes removeIndex:index];
+            [self failMessageAtIndex:index withError:[self cancellationError]];
+        } else {
+            AVFile *file = _uploadingFiles[@(index)];
+            if (file) {
+                [_cancelledIndexes addIndex:index];
+                [file cancelUploading];
+            }
+        }
+    }
+    [self schedule];
+}
+
+- (void)failMessageAtIndex:(NSUInteger)index withError:(NSError *)error
+{
+    _messages[index].status = AVIMMessageStatusFailed;
+    _failures[index] = error;
+}
+
+- (NSError *)cancellationError
+{
+    return [NSError errorWithDomain:NSURLErrorDomain
+                               code:NSURLErrorCancelled
+                           userInfo:nil];
+}
+
+@end
+
 @implementation AVIMConversation {
     
     // public immutable
@@ -93,6 +207,12 @@
     // message cache for rcp
     NSMutableDictionary<NSString *, AVIMMessage *> *_rcpMessageTable;
     
+    // file uploading of message batches, only accessed in the internal serial queue of client
+    NSMutableArray<LCIMMessageFileUploadStage *> *_fileUploadStages;
+    
+    // history read-ahead
+    BOOL _isReadingAhead;
+    
 #if DEBUG
     dispatch_queue_t _internalSerialQueue;
 #endif
@@ -223,6 +343,7 @@ static dispatch_queue_t messageCacheOperationQueue;
         self->_isUpdating = false;
         self->_memberInfoTable = nil;
         self->_rcpMessageTable = [NSMutableDictionary dictionary];
+        self->_fileUploadStages = [NSMutableArray array];
         
         self->_lastDeliveredTimestamp = 0;
         self->_lastReadTimestamp = 0;
@@ -1334,6 +1455,70 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
     }
 }
 
+- (void)sendMessages:(NSArray<AVIMMessage *> *)messages
+              option:(AVIMMessageOption *)option
+            callback:(void (^)(AVIMMessage *, BOOL, NSError * _Nullable))callback
+{
+    AVIMClient *client = self.imClient;
+    if (!client) {
+        return;
+    }
+    
+    if (messages.count == 0) {
+        return;
+    }
+    
+    if (client.status != AVIMClientStatusOpened) {
+        for (AVIMMessage *message in messages) {
+            message.status = AVIMMessageStatusFailed;
+        }
+        [client invokeInUserInteractQueue:^{
+            for (AVIMMessage *message in messages) {
+                callback(message, false, ({
+                    AVIMErrorCode code = AVIMErrorCodeClientNotOpen;
+                    LCError(code, AVIMErrorMessage(code), nil);
+                }));
+            }
+        }];
+        return;
+    }
+    
+    for (AVIMMessage *message in messages) {
+        message.clientId = self->_clientId;
+        message.localClientId = self->_clientId;
+        message.conversationId = self->_conversationId;
+        message.status = AVIMMessageStatusSending;
+    }
+    
+    [client addOperationToInternalSerialQueue:^(AVIMClient *client) {
+        // files are uploaded concurrently, the batch is sent in its original order after all uploads finish.
+        LCIMMessageFileUploadStage *stage = [[LCIMMessageFileUploadStage alloc] initWithMessages:messages
+                                                                              maxConcurrentCount:option.maxConcurrentFileUploadCount
+                                                                                           queue:client.internalSerialQueue];
+        [self->_fileUploadStages addObject:stage];
+        [stage startWithFillingBlock:^(AVIMTypedMessage *typedMessage, AVFile *file) {
+            [self fillTypedMessage:typedMessage withFile:file];
+        } completion:^(LCIMMessageFileUploadStage *stage) {
+            [self->_fileUploadStages removeObjectIdenticalTo:stage];
+            [self sendRealMessages:stage.messages failures:stage.failures option:option callback:callback];
+        }];
+    }];
+}
+
+- (void)cancelSendingMessages:(NSArray<AVIMMessage *> *)messages
+{
+    AVIMClient *client = self.imClient;
+    if (!client) {
+        return;
+    }
+    NSArray<AVIMMessage *> *cancellingMessages = [messages copy];
+    [client addOperationToInternalSerialQueue:^(AVIMClient *client) {
+        for (LCIMMessageFileUploadStage *stage in [self->_fileUploadStages copy]) {
+            [stage cancelMessages:cancellingMessages];
+        }
+    }];
+}
+
 - (void)fillTypedMessage:(AVIMTypedMessage *)typedMessage withFile:(AVFile *)file
 {
     NSMutableDictionary *metaData = (file.metaData.mutableCopy
@@ -1426,87 +1611,38 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
         return;
     }
     
-    BOOL transientConv = (self.convType == LCIMConvTypeTransient);
-    BOOL transientMsg = option.transient;
-    BOOL receipt = option.receipt;
-    BOOL will = option.will;
-    AVIMMessagePriority priority = option.priority;
-    NSDictionary *pushData = option.pushData;
-    
-    LCIMProtobufCommandWrapper *commandWrapper = ({
-        
-        AVIMGenericCommand *outCommand = [AVIMGenericCommand new];
-        AVIMDirectCommand *directCommand = [AVIMDirectCommand new];
-        
-        outCommand.cmd = AVIMCommandType_Direct;
-        outCommand.directMessage = directCommand;
-        if (transientConv && priority) {
-            outCommand.priority = (int32_t)priority;
-        }
-        
-        directCommand.cid = self->_conversationId;
-        directCommand.msg = message.payload;
-        if (message.mentionAll) {
-            directCommand.mentionAll = message.mentionAll;
-        }
-        if (message.mentionList.count > 0) {
-            directCommand.mentionPidsArray = message.mentionList.mutableCopy;
-        }
-        if (transientMsg) {
-            directCommand.transient = transientMsg;
-        }
-        if (will) {
-            directCommand.will = will;
-        }
-        if (receipt) {
-            directCommand.r = receipt;
-        }
-        if (pushData && !transientConv && !transientMsg) {
-            NSError *error = nil;
-            NSData *data = [NSJSONSerialization dataWithJSONObject:pushData options:0 error:&error];
-            if (error) {
-                [client invokeInUserInteractQueue:^{
-                    callback(false, error);
-                }];
-                return;
-            }
-            directCommand.pushData = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
-        }
-        
-        LCIMProtobufCommandWrapper *commandWrapper = [LCIMProtobufCommandWrapper new];
-        commandWrapper.outCommand = outCommand;
-        commandWrapper;
-    });
+    NSError *error;
+    LCIMProtobufCommandWrapper *commandWrapper = [self directCommandWrapperWithMessage:message
+                                                                                option:option
+                                                                                 error:&error];
+    if (!commandWrapper) {
+        message.status = AVIMMessageStatusFailed;
+        message.encodedPayload = nil;
+        [client invokeInUserInteractQueue:^{
+            callback(false, error);
+        }];
+        return;
+    }
     
     [commandWrapper setCallback:^(AVIMClient *client, LCIMProtobufCommandWrapper *commandWrapper) {
         
         if (commandWrapper.error) {
             message.status = AVIMMessageStatusFailed;
+            message.encodedPayload = nil;
             [client invokeInUserInteractQueue:^{
                 callback(false, commandWrapper.error);
             }];
             return;
         }
         
-        AVIMGenericCommand *inCommand = commandWrapper.inCommand;
-        AVIMAckCommand *ackCommand = (inCommand.hasAckMessage ? inCommand.ackMessage : nil);
-        message.sendTimestamp = (ackCommand.hasT ? ackCommand.t : 0);
-        message.messageId = (ackCommand.hasUid ? ackCommand.uid : nil);
-        message.transient = (transientConv || transientMsg);
-        message.status = AVIMMessageStatusSent;
-        if (receipt && message.messageId) {
-            [self internalSyncLock:^{
-                self->_rcpMessageTable[message.messageId] = message;
-            }];
-        }
-        
-        if (!transientConv && !transientMsg && !will) {
+        if ([self didSendMessage:message option:option commandWrapper:commandWrapper]) {
             [self updateLastMessage:message client:client];
             if (client.messageQueryCacheEnabled) {
                 LCIMMessageCacheStore *messageCacheStore = [[LCIMMessageCacheStore alloc] initWithClientId:self->_clientId conversationId:self->_conversationId];
                 [messageCacheStore insertOrUpdateMessage:message withBreakpoint:NO];
             }
         }
+        message.encodedPayload = nil;
         
         [client invokeInUserInteractQueue:^{
             callback(true, nil);
@@ -1516,6 +1652,168 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
     [client sendCommandWrapper:commandWrapper];
 }
 
+- (void)sendRealMessages:(NSArray<AVIMMessage *> *)messages
+                failures:(NSArray *)failures
+                  option:(AVIMMessageOption *)option
+                callback:(void (^)(AVIMMessage *, BOOL, NSError * _Nullable))callback
+{
+    AVIMClient *client = self.imClient;
+    if (!client) {
+        return;
+    }
+    AssertRunInQueue(client.internalSerialQueue);
+    
+    NSUInteger count = messages.count;
+    NSMutableArray *results = [failures mutableCopy];
+    NSMutableArray<LCIMProtobufCommandWrapper *> *commandWrappers = [NSMutableArray arrayWithCapacity:count];
+    NSMutableArray<AVIMMessage *> *persistentMessages = [NSMutableArray arrayWithCapacity:count];
+    __block NSUInteger pendingCount = 0;
+    
+    void (^finish)(AVIMClient *) = ^(AVIMClient *client) {
+        AVIMMessage *latestMessage;
+        for (AVIMMessage *message in persistentMessages) {
+            if (!latestMessage ||
+                latestMessage.sendTimestamp <= message.sendTimestamp) {
+                latestMessage = message;
+            }
+        }
+        if (latestMessage) {
+            [self updateLastMessage:latestMessage client:client];
+            if (client.messageQueryCacheEnabled) {
+                LCIMMessageCacheStore *messageCacheStore = [[LCIMMessageCacheStore alloc] initWithClientId:self->_clientId conversationId:self->_conversationId];
+                [messageCacheStore insertOrUpdateMessagesInTransaction:persistentMessages withBreakpoint:NO];
+            }
+        }
+        for (AVIMMessage *message in messages) {
+            message.encodedPayload = nil;
+        }
+        [client invokeInUserInteractQueue:^{
+            [messages enumerateObjectsUsingBlock:^(AVIMMessage *message, NSUInteger idx, BOOL *stop) {
+                id result = results[idx];
+                if ([result isKindOfClass:[NSError class]]) {
+                    callback(message, false, result);
+                } else {
+                    callback(message, true, nil);
+                }
+            }];
+        }];
+    };
+    
+    for (NSUInteger index = 0; index < count; index++) {
+        AVIMMessage *message = messages[index];
+        if ([results[index] isKindOfClass:[NSError class]]) {
+            continue;
+        }
+        NSError *error;
+        LCIMProtobufCommandWrapper *commandWrapper = [self directCommandWrapperWithMessage:message
+                                                                                    option:option
+                                                                                     error:&error];
+        if (!commandWrapper) {
+            message.status = AVIMMessageStatusFailed;
+            results[index] = error;
+            continue;
+        }
+        [commandWrapper setCallback:^(AVIMClient *client, LCIMProtobufCommandWrapper *commandWrapper) {
+            if (commandWrapper.error) {
+                message.status = AVIMMessageStatusFailed;
+                results[index] = commandWrapper.error;
+            } else if ([self didSendMessage:message option:option commandWrapper:commandWrapper]) {
+                [persistentMessages addObject:message];
+            }
+            pendingCount -= 1;
+            if (pendingCount == 0) {
+                finish(client);
+            }
+        }];
+        [commandWrappers addObject:commandWrapper];
+    }
+    
+    pendingCount = commandWrappers.count;
+    if (pendingCount == 0) {
+        finish(client);
+    } else {
+        [client sendCommandWrappers:commandWrappers];
+    }
+}
+
+- (LCIMProtobufCommandWrapper *)directCommandWrapperWithMessage:(AVIMMessage *)message
+                                                         option:(AVIMMessageOption *)option
+                                                          error:(NSError * __autoreleasing *)error
+{
+    BOOL transientConv = (self.convType == LCIMConvTypeTransient);
+    BOOL transientMsg = option.transient;
+    BOOL receipt = option.receipt;
+    BOOL will = option.will;
+    AVIMMessagePriority priority = option.priority;
+    NSDictionary *pushData = option.pushData;
+    NSData *payloadData = message.payloadData;
+    
+    AVIMGenericCommand *outCommand = [AVIMGenericCommand new];
+    AVIMDirectCommand *directCommand = [AVIMDirectCommand new];
+    
+    outCommand.cmd = AVIMCommandType_Direct;
+    outCommand.directMessage = directCommand;
+    if (transientConv && priority) {
+        outCommand.priority = (int32_t)priority;
+    }
+    
+    directCommand.cid = self->_conversationId;
+    if (payloadData) {
+        [directCommand avim_setMsgData:payloadData];
+    }
+    if (message.mentionAll) {
+        directCommand.mentionAll = message.mentionAll;
+    }
+    if (message.mentionList.count > 0) {
+        directCommand.mentionPidsArray = message.mentionList.mutableCopy;
+    }
+    if (transientMsg) {
+        directCommand.transient = transientMsg;
+    }
+    if (will) {
+        directCommand.will = will;
+    }
+    if (receipt) {
+        directCommand.r = receipt;
+    }
+    if (pushData && !transientConv && !transientMsg) {
+        NSData *data = [NSJSONSerialization dataWithJSONObject:pushData options:0 error:error];
+        if (!data) {
+            return nil;
+        }
+        directCommand.pushData = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+    }
+    
+    message.encodedPayload = payloadData;
+    
+    LCIMProtobufCommandWrapper *commandWrapper = [LCIMProtobufCommandWrapper new];
+    commandWrapper.outCommand = outCommand;
+    return commandWrapper;
+}
+
+/// Apply the ack to the message, returns whether the message should update the last message and the cache.
+- (BOOL)didSendMessage:(AVIMMessage *)message
+                option:(AVIMMessageOption *)option
+        commandWrapper:(LCIMProtobufCommandWrapper *)commandWrapper
+{
+    BOOL transientConv = (self.convType == LCIMConvTypeTransient);
+    BOOL transientMsg = option.transient;
+    
+    AVIMGenericCommand *inCommand = commandWrapper.inCommand;
+    AVIMAckCommand *ackCommand = (inCommand.hasAckMessage ? inCommand.ackMessage : nil);
+    message.sendTimestamp = (ackCommand.hasT ? ackCommand.t : 0);
+    message.messageId = (ackCommand.hasUid ? ackCommand.uid : nil);
+    message.transient = (transientConv || transientMsg);
+    message.status = AVIMMessageStatusSent;
+    if (option.receipt && message.messageId) {
+        [self internalSyncLock:^{
+            self->_rcpMessageTable[message.messageId] = message;
+        }];
+    }
+    
+    return (!transientConv && !transientMsg && !option.will);
+}
+
 // MARK: - Message Patch
 
 - (void)updateMessage:(AVIMMessage *)oldMessage
@@ -1793,7 +2091,11 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
     }
 }
 
-- (void)queryMessagesFromServerWithCommand:(AVIMGenericCommand *)genericCommand
+/*
+ * Sends a logs command and decodes the messages in its result, without any side effect.
+ * `callback` is invoked in the internal serial queue of client.
+ */
+- (void)fetchMessagesFromServerWithCommand:(AVIMGenericCommand *)genericCommand
                                   callback:(void (^)(NSArray<AVIMMessage *> * messages, NSError * error))callback
 {
     AVIMClient *client = self.imClient;
@@ -1805,9 +2107,7 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
     commandWrapper.outCommand = genericCommand;
     [commandWrapper setCallback:^(AVIMClient *client, LCIMProtobufCommandWrapper *commandWrapper) {
         if (commandWrapper.error) {
-            [client invokeInUserInteractQueue:^{
-                callback(nil, commandWrapper.error);
-            }];
+            callback(nil, commandWrapper.error);
             return;
         }
         AVIMLogsCommand *logsInCommand = commandWrapper.inCommand.logsMessage;
@@ -1841,6 +2141,26 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
             }
             [messages addObject:message];
         }
+        callback(messages, nil);
+    }];
+    [client sendCommandWrapper:commandWrapper];
+}
+
+- (void)queryMessagesFromServerWithCommand:(AVIMGenericCommand *)genericCommand
+                                  callback:(void (^)(NSArray<AVIMMessage *> * messages, NSError * error))callback
+{
+    AVIMClient *client = self.imClient;
+    if (!client) {
+        return;
+    }
+    
+    [self fetchMessagesFromServerWithCommand:genericCommand callback:^(NSArray<AVIMMessage *> *messages, NSError *error) {
+        if (error) {
+            [client invokeInUserInteractQueue:^{
+                callback(nil, error);
+            }];
+            return;
+        }
         if (messages.firstObject) {
             [self updateLastMessage:messages.firstObject client:client];
         }
@@ -1850,13 +2170,11 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
             callback(messages, nil);
         }];
     }];
-    [client sendCommandWrapper:commandWrapper];
 }
 
-- (void)queryMessagesFromServerBeforeId:(NSString *)messageId
-                              timestamp:(int64_t)timestamp
-                                  limit:(NSUInteger)limit
-                               callback:(void (^)(NSArray<AVIMMessage *> * messages, NSError * error))callback
+- (AVIMGenericCommand *)logsCommandBeforeId:(NSString *)messageId
+                                  timestamp:(int64_t)timestamp
+                                      limit:(NSUInteger)limit
 {
     AVIMGenericCommand *genericCommand = [[AVIMGenericCommand alloc] init];
     AVIMLogsCommand *logsCommand = [[AVIMLogsCommand alloc] init];
@@ -1866,6 +2184,17 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
     logsCommand.mid    = messageId;
     logsCommand.t      = [self.class validTimestamp:timestamp];
     logsCommand.l      = (int32_t)[self.class validLimit:limit];
+    return genericCommand;
+}
+
+- (void)queryMessagesFromServerBeforeId:(NSString *)messageId
+                              timestamp:(int64_t)timestamp
+                                  limit:(NSUInteger)limit
+                               callback:(void (^)(NSArray<AVIMMessage *> * messages, NSError * error))callback
+{
+    AVIMGenericCommand *genericCommand = [self logsCommandBeforeId:messageId
+                                                         timestamp:timestamp
+                                                             limit:limit];
     [self queryMessagesFromServerWithCommand:genericCommand callback:callback];
 }
 
@@ -2025,6 +2354,9 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
             [AVIMBlockHelper callArrayResultBlock:callback
                                             array:messages
                                             error:nil];
+            
+            [self readAheadMessagesBeforeMessage:messages.firstObject
+                                           limit:limit];
         });
     }];
 }
@@ -2091,6 +2423,11 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
                     [AVIMBlockHelper callArrayResultBlock:callback
                                                     array:messages
                                                     error:error];
+                    
+                    if (!error) {
+                        [self readAheadMessagesBeforeMessage:messages.firstObject
+                                                       limit:limit];
+                    }
                 });
             }];
         };
@@ -2132,6 +2469,11 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
                                             array:cachedMessages
                                             error:nil];
             
+            if (socketOpened) {
+                [self readAheadMessagesBeforeMessage:cachedMessages.firstObject
+                                               limit:limit];
+            }
+            
             return;
         }
         
@@ -2206,6 +2548,9 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
                         [AVIMBlockHelper callArrayResultBlock:callback
                                                         array:messages
                                                         error:nil];
+                        
+                        [self readAheadMessagesBeforeMessage:messages.firstObject
+                                                       limit:limit];
                     });
                 }];
                 
@@ -2220,6 +2565,118 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
     });
 }
 
+/*
+ * Read-ahead of history messages, runs in `messageCacheOperationQueue`.
+ * Starting from `message` (the oldest message returned to the caller), walks back up to
+ * `messageQueryReadAheadPageCount` pages, pages already continuous in cache are skipped,
+ * pages with a breakpoint are fetched from server and merged into the cache, so that the
+ * following `queryMessagesBeforeId:` calls stay on the cache.
+ */
+- (void)readAheadMessagesBeforeMessage:(AVIMMessage *)message
+                                 limit:(NSUInteger)limit
+{
+    AVIMClient *client = self.imClient;
+    NSUInteger pageCount = client.messageQueryReadAheadPageCount;
+    
+    if (!message.messageId ||
+        !pageCount ||
+        !client.messageQueryCacheEnabled) {
+        return;
+    }
+    
+    __block BOOL started = false;
+    
+    [self internalSyncLock:^{
+        if (!self->_isReadingAhead) {
+            self->_isReadingAhead = true;
+            started = true;
+        }
+    }];
+    
+    if (started) {
+        [self readAheadMessagesBeforeMessage:message
+                                       limit:limit
+                          remainingPageCount:pageCount];
+    }
+}
+
+- (void)readAheadMessagesBeforeMessage:(AVIMMessage *)message
+                                 limit:(NSUInteger)limit
+                    remainingPageCount:(NSUInteger)remainingPageCount
+{
+    void (^finish)(void) = ^{
+        [self internalSyncLock:^{
+            self->_isReadingAhead = false;
+        }];
+    };
+    
+    if (remainingPageCount == 0 ||
+        self.imClient.status != AVIMClientStatusOpened) {
+        finish();
+        return;
+    }
+    
+    /* the anchor should be in cache, otherwise fetched pages can not be attached to it. */
+    AVIMMessage *anchorMessage = [[self messageCacheStore] getMessageById:message.messageId
+                                                                timestamp:message.sendTimestamp];
+    
+    if (!anchorMessage) {
+        finish();
+        return;
+    }
+    
+    if (!anchorMessage.breakpoint) {
+        
+        BOOL continuous = YES;
+        
+        NSArray *cachedMessages = [[self messageCache] messagesBeforeTimestamp:anchorMessage.sendTimestamp
+                                                                     messageId:anchorMessage.messageId
+                                                                conversationId:self.conversationId
+                                                                         limit:limit
+                                                                    continuous:&continuous];
+        
+        if (continuous && cachedMessages.count == limit) {
+            
+            [self readAheadMessagesBeforeMessage:cachedMessages.firstObject
+                                           limit:limit
+                              remainingPageCount:(remainingPageCount - 1)];
+            
+            return;
+        }
+    }
+    
+    /* pages read ahead only go to the cache, they neither acknowledge messages nor change the last message. */
+    AVIMGenericCommand *genericCommand = [self logsCommandBeforeId:anchorMessage.messageId
+                                                         timestamp:anchorMessage.sendTimestamp
+                                                             limit:limit];
+    
+    [self fetchMessagesFromServerWithCommand:genericCommand callback:^(NSArray *messages, NSError *error)
+     {
+        dispatch_async(messageCacheOperationQueue, ^{
+            
+            if (error || messages.count == 0) {
+                finish();
+                return;
+            }
+            
+            [self postprocessMessages:messages];
+            
+            [self cacheContinuousMessages:messages
+                              plusMessage:anchorMessage];
+            
+            /* less than a page means the beginning of the conversation is reached. */
+            if (messages.count < limit) {
+                finish();
+                return;
+            }
+            
+            [self readAheadMessagesBeforeMessage:messages.firstObject
+                                           limit:limit
+                              remainingPageCount:(remainingPageCount - 1)];
+        });
+    }];
+}
+
 - (void)queryMessagesInInterval:(AVIMMessageInterval *)interval
                       direction:(AVIMMessageQueryDirection)direction
                           limit:(NSUInteger)limit
@@ -2856,6 +3313,28 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
 
 // MARK: - Event Handler
 
+/// @note a `msg` body is a JSON string or plain text, a `binaryMsg` body is only sent when the session enabled
+/// `LCIMSessionConfigOptionsMessagePackBody` and always carries a typed message, so any other binary body is ignored.
+- (AVIMMessage *)receivedMessageWithContent:(NSString *)content binaryContent:(NSData *)binaryContent client:(AVIMClient *)client
+{
+    if (content) {
+        AVIMMessage *message = nil;
+        AVIMTypedMessageObject *messageObject = [[AVIMTypedMessageObject alloc] initWithJSON:content];
+        if ([messageObject isValidTypedMessageObject]) {
+            message = [AVIMTypedMessage messageWithMessageObject:messageObject];
+        } else {
+            message = [[AVIMMessage alloc] init];
+        }
+        message.content = content;
+        return message;
+    }
+    if (binaryContent.length > 0 &&
+        (client.sessionConfigBitmap & LCIMSessionConfigOptionsMessagePackBody)) {
+        return [AVIMTypedMessage messageWithMessagePack:binaryContent];
+    }
+    return nil;
+}
+
 - (AVIMMessage *)process_direct:(AVIMDirectCommand *)directCommand messageId:(NSString *)messageId isTransientMsg:(BOOL)isTransientMsg
 {
     AVIMClient *client = self.imClient;
@@ -2864,42 +3343,35 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
     }
     AssertRunInQueue(self->_internalSerialQueue);
     
-    NSString *content = (directCommand.hasMsg ? directCommand.msg : nil);
     int64_t timestamp = (directCommand.hasTimestamp ? directCommand.timestamp : 0);
-    if (!content || !timestamp) {
+    AVIMMessage *message = (timestamp
+                            ? [self receivedMessageWithContent:(directCommand.hasMsg ? directCommand.msg : nil)
+                                                 binaryContent:(directCommand.hasBinaryMsg ? directCommand.binaryMsg : nil)
+                                                        client:client]
+                            : nil);
+    if (!message) {
         /// @note
-        /// 1. message must with `msg` and `timestamp`, otherwise it's invalid.
+        /// 1. message must with `msg` (or `binaryMsg`) and `timestamp`, otherwise it's invalid.
         /// 2. directCommand's other properties is nullable or optional.
         return nil;
     }
     
-    AVIMMessage *message = ({
-        AVIMMessage *message = nil;
-        AVIMTypedMessageObject *messageObject = [[AVIMTypedMessageObject alloc] initWithJSON:content];
-        if ([messageObject isValidTypedMessageObject]) {
-            message = [AVIMTypedMessage messageWithMessageObject:messageObject];
-        } else {
-            message = [[AVIMMessage alloc] init];
-        }
-        message.conversationId = self->_conversationId;
-        message.messageId = messageId;
-        message.clientId = (directCommand.hasFromPeerId ? directCommand.fromPeerId : nil);
-        message.localClientId = self->_clientId;
-        message.content = content;
-        message.transient = isTransientMsg;
-        message.sendTimestamp = timestamp;
-        message.offline = (directCommand.hasOffline ? directCommand.offline : false);
-        message.hasMore = (directCommand.hasHasMore ? directCommand.hasMore : false);
-        message.mentionAll = (directCommand.hasMentionAll ? directCommand.mentionAll : false);
-        message.mentionList = directCommand.mentionPidsArray;
-        message.updatedAt = (directCommand.hasPatchTimestamp ? [NSDate dateWithTimeIntervalSince1970:(directCommand.patchTimestamp / 1000.0)] : nil);
-        if (message.ioType == AVIMMessageIOTypeOut) {
-            message.status = AVIMMessageStatusSent;
-        } else {
-            message.status = AVIMMessageStatusDelivered;
-        }
-        message;
-    });
+    message.conversationId = self->_conversationId;
+    message.messageId = messageId;
+    message.clientId = (directCommand.hasFromPeerId ? directCommand.fromPeerId : nil);
+    message.localClientId = self->_clientId;
+    message.transient = isTransientMsg;
+    message.sendTimestamp = timestamp;
+    message.offline = (directCommand.hasOffline ? directCommand.offline : false);
+    message.hasMore = (directCommand.hasHasMore ? directCommand.hasMore : false);
+    message.mentionAll = (directCommand.hasMentionAll ? directCommand.mentionAll : false);
+    message.mentionList = directCommand.mentionPidsArray;
+    message.updatedAt = (directCommand.hasPatchTimestamp ? [NSDate dateWithTimeIntervalSince1970:(directCommand.patchTimestamp / 1000.0)] : nil);
+    if (message.ioType == AVIMMessageIOTypeOut) {
+        message.status = AVIMMessageStatusSent;
+    } else {
+        message.status = AVIMMessageStatusDelivered;
+    }
     
     if (!isTransientMsg) {
         BOOL shouldIncreaseUnreadCount = [self updateLastMessage:message client:client];
@@ -2940,17 +3412,14 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
             NSString *messageId = (unreadTuple.hasMid ? unreadTuple.mid : nil);
             int64_t timestamp = (unreadTuple.hasTimestamp ? unreadTuple.timestamp : 0);
             NSString *fromId = (unreadTuple.hasFrom ? unreadTuple.from : nil);
-            if (content && messageId && timestamp && fromId) {
-                AVIMTypedMessageObject *typedMessageObject = [[AVIMTypedMessageObject alloc] initWithJSON:content];
-                if ([typedMessageObject isValidTypedMessageObject]) {
-                    lastMessage = [AVIMTypedMessage messageWithMessageObject:typedMessageObject];
-                } else {
-                    lastMessage = [[AVIMMessage alloc] init];
-                }
+            NSData *binaryContent = (unreadTuple.hasBinaryMsg ? unreadTuple.binaryMsg : nil);
+            if (messageId && timestamp && fromId) {
+                lastMessage = [self receivedMessageWithContent:content binaryContent:binaryContent client:client];
+            }
+            if (lastMessage) {
                 int64_t patchTimestamp = (unreadTuple.hasPatchTimestamp ? unreadTuple.patchTimestamp : 0);
                 lastMessage.status = AVIMMessageStatusDelivered;
                 lastMessage.conversationId = self->_conversationId;
-                lastMessage.content = content;
                 lastMessage.messageId = messageId;
                 lastMessage.sendTimestamp = timestamp;
                 lastMessage.clientId = fromId;
@@ -2990,24 +3459,18 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
     AssertRunInQueue(self->_internalSerialQueue);
     
     NSString *content = (patchItem.hasData_p ? patchItem.data_p : nil);
+    NSData *binaryContent = (patchItem.hasBinaryMsg ? patchItem.binaryMsg : nil);
     NSString *messageId = (patchItem.hasMid ? patchItem.mid : nil);
     int64_t timestamp = (patchItem.hasTimestamp ? patchItem.timestamp : 0);
     NSString *fromId = (patchItem.hasFrom ? patchItem.from : nil);
     int64_t patchTimestamp = (patchItem.hasPatchTimestamp ? patchItem.patchTimestamp : 0);
-    if (!content || !messageId || !timestamp || !fromId || !patchTimestamp) {
+    if (!messageId || !timestamp || !fromId || !patchTimestamp) {
         return nil;
     }
     
     AVIMMessage *patchMessage = ({
-        AVIMMessage *message = nil;
-        AVIMTypedMessageObject *messageObject = [[AVIMTypedMessageObject alloc] initWithJSON:content];
-        if ([messageObject isValidTypedMessageObject]) {
-            message = [AVIMTypedMessage messageWithMessageObject:messageObject];
-        } else {
-            message = [[AVIMMessage alloc] init];
-        }
+        AVIMMessage *message = [self receivedMessageWithContent:content binaryContent:binaryContent client:client];
         message.messageId = messageId;
-        message.content = content;
         message.sendTimestamp = timestamp;
         message.clientId = fromId;
         message.conversationId = self->_conversationId;
@@ -3018,6 +3481,9 @@ static void process_attr_and_attrModified(NSDictionary *attr, NSDictionary *attr
         message.updatedAt = [NSDate dateWithTimeIntervalSince1970:(patchTimestamp / 1000.0)];
         message;
     });
+    if (!patchMessage) {
+        return nil;
+    }
     
     [self updateLastMessage:patchMessage client:client];
     
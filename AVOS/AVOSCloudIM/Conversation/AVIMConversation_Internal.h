@@ -10,6 +10,9 @@
 #import "AVIMCommon_Internal.h"
 #import "MessagesProtoOrig.pbobjc.h"
 
+@class AVIMTypedMessage;
+@class AVFile;
+
 @interface AVIMConversation ()
 
 @property (nonatomic, readonly) LCIMConvType convType;
@@ -58,3 +61,22 @@
 @interface AVIMTemporaryConversation ()
 
 @end
+
+/// Uploads files of a message batch with a bounded count in flight.
+/// All methods should be invoked in its queue, the internal serial queue of the client.
+@interface LCIMMessageFileUploadStage : NSObject
+
+@property (nonatomic, readonly) NSArray<AVIMMessage *> *messages;
+/// `NSNull` or the `NSError` of the message at the same index.
+@property (nonatomic, readonly) NSMutableArray *failures;
+
+- (instancetype)initWithMessages:(NSArray<AVIMMessage *> *)messages
+              maxConcurrentCount:(NSUInteger)maxConcurrentCount
+                           queue:(dispatch_queue_t)queue;
+
+- (void)startWithFillingBlock:(void (^)(AVIMTypedMessage *typedMessage, AVFile *file))fillingBlock
+                   completion:(void (^)(LCIMMessageFileUploadStage *stage))completion NS_SWIFT_NAME(start(fillingBlock:completion:));
+
+- (void)cancelMessages:(NSArray<AVIMMessage *> *)messages NS_SWIFT_NAME(cancelMessages(_:));
+
+@end
@@ -60,8 +60,13 @@
     setter_name,                                    \
     [getter_name copy])
 
+@class AVMPMessagePackSchema;
+
 @interface AVIMDynamicObject : NSObject
 
+/// Schema of the known fields, used to encode `messagePack`. Subclasses of a fixed shape override it, default is nil.
++ (AVMPMessagePackSchema *)messagePackSchema;
+
 @property (nonatomic, readonly) NSMutableDictionary<NSString *, id> *localData;
 
 - (instancetype)initWithJSON:(NSString *)json;
@@ -67,7 +67,7 @@
     if (!data) {
         return nil;
     }
-    NSDictionary *dic = [AVMPMessagePackReader readData:data options:0 error:nil];
+    NSDictionary *dic = [AVMPMessagePackReader readData:data options:AVMPMessagePackReaderOptionsNoCopy error:nil];
     return ([dic isKindOfClass:[NSDictionary class]]
             ? [self initWithDictionary:dic]
             : nil);
@@ -170,9 +170,18 @@
     return [self rawDictionary];
 }
 
++ (AVMPMessagePackSchema *)messagePackSchema
+{
+    return nil;
+}
+
 - (NSData *)messagePack
 {
     NSDictionary *dic = [self rawDictionary];
+    AVMPMessagePackSchema *schema = [[self class] messagePackSchema];
+    if (schema) {
+        return [AVMPMessagePackWriter writeDictionary:dic schema:schema error:nil];
+    }
     return [AVMPMessagePackWriter writeObject:dic options:0 error:nil];
 }
 
@@ -7,9 +7,32 @@
 //
 
 #import "AVIMMessageObject.h"
+#import "AVMPMessagePack.h"
 
 @implementation AVIMMessageObject
 
++ (AVMPMessagePackSchema *)messagePackSchema
+{
+    static AVMPMessagePackSchema *schema;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        /* The number accessors store doubles, see LC_FORWARD_PROPERTY_ACCESSOR_NUMBER. */
+        schema = [AVMPMessagePackSchema schemaWithFieldTypes:@{
+            @"ioType":              @(AVMPMessagePackFieldTypeDouble),
+            @"status":              @(AVMPMessagePackFieldTypeDouble),
+            @"messageId":           @(AVMPMessagePackFieldTypeString),
+            @"clientId":            @(AVMPMessagePackFieldTypeString),
+            @"conversationId":      @(AVMPMessagePackFieldTypeString),
+            @"content":             @(AVMPMessagePackFieldTypeString),
+            @"sendTimestamp":       @(AVMPMessagePackFieldTypeDouble),
+            @"deliveredTimestamp":  @(AVMPMessagePackFieldTypeDouble),
+            @"readTimestamp":       @(AVMPMessagePackFieldTypeDouble),
+            @"updatedAt":           @(AVMPMessagePackFieldTypeObject),
+        }];
+    });
+    return schema;
+}
+
 LC_FORWARD_PROPERTY_ACCESSOR_NUMBER         (ioType,                setIoType,              AVIMMessageIOType)
 LC_FORWARD_PROPERTY_ACCESSOR_NUMBER         (status,                setStatus,              AVIMMessageStatus)
 LC_FORWARD_PROPERTY_ACCESSOR_OBJECT_COPY    (messageId,             setMessageId)
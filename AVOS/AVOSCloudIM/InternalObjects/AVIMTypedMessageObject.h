@@ -18,4 +18,9 @@
 
 - (BOOL)isValidTypedMessageObject;
 
+/// UTF-8 JSON bytes of the typed message, encoded without building an intermediate `NSString`.
+/// The result can be used for both the `direct` command and the message cache.
+/// Returns nil if some value can not be represented in JSON.
+- (NSData *)payloadData;
+
 @end
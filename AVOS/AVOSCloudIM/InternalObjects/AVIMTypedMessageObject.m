@@ -9,9 +9,320 @@
 #import "AVIMTypedMessageObject.h"
 #import "AVIMTypedMessage_Internal.h"
 #import "AVUtils.h"
+#import "AVMPMessagePack.h"
+#import <pthread.h>
+#import <xlocale.h>
+
+// MARK: - Payload Encoder
+
+/// Encoding more than this nesting level is treated as a failure, same as a cycle.
+static const NSUInteger LCIMPayloadMaxDepth = 512;
+/// Buffers grown beyond this size are released after use instead of being kept for the thread.
+static const size_t LCIMPayloadBufferRetainLimit = 64 * 1024;
+
+typedef struct {
+    uint8_t *bytes;
+    size_t length;
+    size_t capacity;
+} LCIMPayloadBuffer;
+
+static pthread_key_t LCIMPayloadBufferKey;
+
+static void LCIMPayloadBufferDestroy(void *value)
+{
+    LCIMPayloadBuffer *buffer = value;
+    free(buffer->bytes);
+    free(buffer);
+}
+
+static LCIMPayloadBuffer *LCIMPayloadBufferAcquire(void)
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pthread_key_create(&LCIMPayloadBufferKey, LCIMPayloadBufferDestroy);
+    });
+    LCIMPayloadBuffer *buffer = pthread_getspecific(LCIMPayloadBufferKey);
+    if (!buffer) {
+        buffer = calloc(1, sizeof(LCIMPayloadBuffer));
+        if (!buffer) {
+            return NULL;
+        }
+        pthread_setspecific(LCIMPayloadBufferKey, buffer);
+    }
+    buffer->length = 0;
+    return buffer;
+}
+
+static void LCIMPayloadBufferRelinquish(LCIMPayloadBuffer *buffer)
+{
+    if (buffer->capacity > LCIMPayloadBufferRetainLimit) {
+        free(buffer->bytes);
+        buffer->bytes = NULL;
+        buffer->capacity = 0;
+    }
+    buffer->length = 0;
+}
+
+static BOOL LCIMPayloadBufferReserve(LCIMPayloadBuffer *buffer, size_t count)
+{
+    if (count > SIZE_MAX - buffer->length) {
+        return false;
+    }
+    size_t required = buffer->length + count;
+    if (required <= buffer->capacity) {
+        return true;
+    }
+    size_t capacity = MAX(MAX(buffer->capacity * 2, required), (size_t)256);
+    uint8_t *bytes = realloc(buffer->bytes, capacity);
+    if (!bytes) {
+        return false;
+    }
+    buffer->bytes = bytes;
+    buffer->capacity = capacity;
+    return true;
+}
+
+static BOOL LCIMPayloadBufferAppend(LCIMPayloadBuffer *buffer, const void *bytes, size_t count)
+{
+    if (!LCIMPayloadBufferReserve(buffer, count)) {
+        return false;
+    }
+    memcpy(buffer->bytes + buffer->length, bytes, count);
+    buffer->length += count;
+    return true;
+}
+
+#define LCIMPayloadBufferAppendLiteral(buffer, literal) \
+    LCIMPayloadBufferAppend((buffer), (literal), sizeof(literal) - 1)
+
+static BOOL LCIMPayloadByteNeedsEscape(uint8_t byte)
+{
+    return (byte < 0x20 || byte == '"' || byte == '\\');
+}
+
+static BOOL LCIMPayloadWriteEscapedBytes(LCIMPayloadBuffer *buffer, const uint8_t *bytes, size_t count)
+{
+    static const char hex[] = "0123456789abcdef";
+    size_t start = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint8_t byte = bytes[i];
+        if (!LCIMPayloadByteNeedsEscape(byte)) {
+            continue;
+        }
+        if (!LCIMPayloadBufferAppend(buffer, bytes + start, i - start)) {
+            return false;
+        }
+        start = i + 1;
+        char escaped[6] = { '\\', 0, 0, 0, 0, 0 };
+        size_t escapedLength = 2;
+        switch (byte) {
+            case '"':  escaped[1] = '"';  break;
+            case '\\': escaped[1] = '\\'; break;
+            case '\b': escaped[1] = 'b';  break;
+            case '\f': escaped[1] = 'f';  break;
+            case '\n': escaped[1] = 'n';  break;
+            case '\r': escaped[1] = 'r';  break;
+            case '\t': escaped[1] = 't';  break;
+            default:
+                escaped[1] = 'u';
+                escaped[2] = '0';
+                escaped[3] = '0';
+                escaped[4] = hex[byte >> 4];
+                escaped[5] = hex[byte & 0xF];
+                escapedLength = 6;
+                break;
+        }
+        if (!LCIMPayloadBufferAppend(buffer, escaped, escapedLength)) {
+            return false;
+        }
+    }
+    return LCIMPayloadBufferAppend(buffer, bytes + start, count - start);
+}
+
+static BOOL LCIMPayloadWriteString(LCIMPayloadBuffer *buffer, NSString *string)
+{
+    if (!LCIMPayloadBufferAppendLiteral(buffer, "\"")) {
+        return false;
+    }
+    CFStringRef cfString = (__bridge CFStringRef)string;
+    CFIndex length = CFStringGetLength(cfString);
+    /* Only strings stored as ASCII expose their bytes, one per character; embedded NULs are kept. */
+    const char *cString = CFStringGetCStringPtr(cfString, kCFStringEncodingASCII);
+    if (cString) {
+        if (!LCIMPayloadWriteEscapedBytes(buffer, (const uint8_t *)cString, (size_t)length)) {
+            return false;
+        }
+    } else {
+        /* Transcode into the spare capacity of the buffer, then escape only if needed. */
+        CFIndex maxLength = CFStringGetMaximumSizeForEncoding(length, kCFStringEncodingUTF8);
+        if (maxLength == kCFNotFound || !LCIMPayloadBufferReserve(buffer, (size_t)maxLength)) {
+            return false;
+        }
+        uint8_t *tail = buffer->bytes + buffer->length;
+        CFIndex usedLength = 0;
+        CFIndex convertedLength = CFStringGetBytes(cfString, CFRangeMake(0, length),
+                                                   kCFStringEncodingUTF8, 0, false,
+                                                   tail, maxLength, &usedLength);
+        if (convertedLength != length) {
+            return false;
+        }
+        BOOL needsEscape = false;
+        for (CFIndex i = 0; i < usedLength; i++) {
+            if (LCIMPayloadByteNeedsEscape(tail[i])) {
+                needsEscape = true;
+                break;
+            }
+        }
+        if (needsEscape) {
+            uint8_t *raw = malloc(usedLength);
+            if (!raw) {
+                return false;
+            }
+            memcpy(raw, tail, usedLength);
+            BOOL written = LCIMPayloadWriteEscapedBytes(buffer, raw, (size_t)usedLength);
+            free(raw);
+            if (!written) {
+                return false;
+            }
+        } else {
+            buffer->length += (size_t)usedLength;
+        }
+    }
+    return LCIMPayloadBufferAppendLiteral(buffer, "\"");
+}
+
+/// Writes the shortest digits that read back as the same value, in the C locale.
+static int LCIMPayloadFormatDouble(char *string, size_t size, double value, BOOL isFloat)
+{
+    int length = 0;
+    for (int precision = isFloat ? 6 : 15; precision <= (isFloat ? 9 : 17); precision++) {
+        length = snprintf_l(string, size, NULL, "%.*g", precision, value);
+        if (length <= 0 || length >= (int)size) {
+            return length;
+        }
+        if (isFloat ? strtof_l(string, NULL, NULL) == (float)value : strtod_l(string, NULL, NULL) == value) {
+            break;
+        }
+    }
+    return length;
+}
+
+static BOOL LCIMPayloadWriteNumber(LCIMPayloadBuffer *buffer, NSNumber *number)
+{
+    if ((__bridge CFBooleanRef)number == kCFBooleanTrue) {
+        return LCIMPayloadBufferAppendLiteral(buffer, "true");
+    } else if ((__bridge CFBooleanRef)number == kCFBooleanFalse) {
+        return LCIMPayloadBufferAppendLiteral(buffer, "false");
+    }
+    char string[32];
+    int length = 0;
+    switch (number.objCType[0]) {
+        case 'c': case 's': case 'i': case 'l': case 'q':
+            length = snprintf(string, sizeof(string), "%lld", number.longLongValue);
+            break;
+        case 'C': case 'S': case 'I': case 'L': case 'Q':
+            length = snprintf(string, sizeof(string), "%llu", number.unsignedLongLongValue);
+            break;
+        case 'f': case 'd': {
+            /* Non-finite values have no JSON form, NSJSONSerialization raises on them. */
+            double value = number.doubleValue;
+            if (!isfinite(value)) {
+                return false;
+            }
+            if ([number isKindOfClass:[NSDecimalNumber class]]) {
+                const char *digits = [(NSDecimalNumber *)number descriptionWithLocale:nil].UTF8String;
+                return digits && LCIMPayloadBufferAppend(buffer, digits, strlen(digits));
+            }
+            length = LCIMPayloadFormatDouble(string, sizeof(string), value, number.objCType[0] == 'f');
+            break;
+        }
+        default:
+            return false;
+    }
+    if (length <= 0 || length >= (int)sizeof(string)) {
+        return false;
+    }
+    return LCIMPayloadBufferAppend(buffer, string, (size_t)length);
+}
+
+static BOOL LCIMPayloadWriteValue(LCIMPayloadBuffer *buffer, id value, NSUInteger depth);
+
+static BOOL LCIMPayloadWriteDictionary(LCIMPayloadBuffer *buffer, NSDictionary *dictionary, NSUInteger depth)
+{
+    if (!LCIMPayloadBufferAppendLiteral(buffer, "{")) {
+        return false;
+    }
+    __block BOOL succeeded = true;
+    __block BOOL first = true;
+    [dictionary enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+        if (![key isKindOfClass:[NSString class]] ||
+            (!first && !LCIMPayloadBufferAppendLiteral(buffer, ",")) ||
+            !LCIMPayloadWriteString(buffer, key) ||
+            !LCIMPayloadBufferAppendLiteral(buffer, ":") ||
+            !LCIMPayloadWriteValue(buffer, obj, depth + 1)) {
+            succeeded = false;
+            *stop = true;
+            return;
+        }
+        first = false;
+    }];
+    return succeeded && LCIMPayloadBufferAppendLiteral(buffer, "}");
+}
+
+static BOOL LCIMPayloadWriteArray(LCIMPayloadBuffer *buffer, NSArray *array, NSUInteger depth)
+{
+    if (!LCIMPayloadBufferAppendLiteral(buffer, "[")) {
+        return false;
+    }
+    BOOL first = true;
+    for (id obj in array) {
+        if ((!first && !LCIMPayloadBufferAppendLiteral(buffer, ",")) ||
+            !LCIMPayloadWriteValue(buffer, obj, depth + 1)) {
+            return false;
+        }
+        first = false;
+    }
+    return LCIMPayloadBufferAppendLiteral(buffer, "]");
+}
+
+static BOOL LCIMPayloadWriteValue(LCIMPayloadBuffer *buffer, id value, NSUInteger depth)
+{
+    if (depth > LCIMPayloadMaxDepth) {
+        return false;
+    }
+    if ([value isKindOfClass:[NSString class]]) {
+        return LCIMPayloadWriteString(buffer, value);
+    } else if ([value isKindOfClass:[NSNumber class]]) {
+        return LCIMPayloadWriteNumber(buffer, value);
+    } else if ([value isKindOfClass:[NSDictionary class]]) {
+        return LCIMPayloadWriteDictionary(buffer, value, depth);
+    } else if ([value isKindOfClass:[NSArray class]]) {
+        return LCIMPayloadWriteArray(buffer, value, depth);
+    } else if ([value isKindOfClass:[AVIMDynamicObject class]]) {
+        return LCIMPayloadWriteDictionary(buffer, [value dictionary], depth);
+    } else if ([value isKindOfClass:[NSNull class]]) {
+        return LCIMPayloadBufferAppendLiteral(buffer, "null");
+    }
+    return false;
+}
 
 @implementation AVIMTypedMessageObject
 
++ (AVMPMessagePackSchema *)messagePackSchema {
+    static AVMPMessagePackSchema *schema;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        schema = [AVMPMessagePackSchema schemaWithFieldTypes:@{
+            @"_lctype":  @(AVMPMessagePackFieldTypeInteger),
+            @"_lctext":  @(AVMPMessagePackFieldTypeString),
+            @"_lcfile":  @(AVMPMessagePackFieldTypeObject),
+            @"_lcloc":   @(AVMPMessagePackFieldTypeObject),
+            @"_lcattrs": @(AVMPMessagePackFieldTypeObject),
+        }];
+    });
+    return schema;
+}
+
 - (int32_t)_lctype {
     return [NSNumber _lc_decoding:self.localData key:@"_lctype"].intValue;
 }
@@ -52,6 +363,75 @@
     [self setObject:_lcloc forKey:@"_lcloc"];
 }
 
+- (NSData *)payloadData
+{
+    /* Typed fields go first with pre-encoded keys, custom fields follow. */
+    static const struct {
+        const char *key;
+        size_t keyLength;
+        __unsafe_unretained NSString *name;
+    } typedFields[] = {
+        { "\"_lctype\":",  sizeof("\"_lctype\":") - 1,  @"_lctype" },
+        { "\"_lctext\":",  sizeof("\"_lctext\":") - 1,  @"_lctext" },
+        { "\"_lcfile\":",  sizeof("\"_lcfile\":") - 1,  @"_lcfile" },
+        { "\"_lcloc\":",   sizeof("\"_lcloc\":") - 1,   @"_lcloc" },
+        { "\"_lcattrs\":", sizeof("\"_lcattrs\":") - 1, @"_lcattrs" },
+    };
+    static const size_t typedFieldCount = sizeof(typedFields) / sizeof(typedFields[0]);
+    
+    LCIMPayloadBuffer *buffer = LCIMPayloadBufferAcquire();
+    if (!buffer) {
+        return nil;
+    }
+    NSDictionary<NSString *, id> *localData = self.localData;
+    BOOL succeeded = LCIMPayloadBufferAppendLiteral(buffer, "{");
+    BOOL first = true;
+    NSUInteger writtenTypedFieldCount = 0;
+    for (size_t i = 0; succeeded && i < typedFieldCount; i++) {
+        id value = localData[typedFields[i].name];
+        if (!value) {
+            continue;
+        }
+        writtenTypedFieldCount += 1;
+        if ([value isKindOfClass:[NSNull class]]) {
+            continue;
+        }
+        succeeded = ((first || LCIMPayloadBufferAppendLiteral(buffer, ",")) &&
+                     LCIMPayloadBufferAppend(buffer, typedFields[i].key, typedFields[i].keyLength) &&
+                     LCIMPayloadWriteValue(buffer, value, 1));
+        first = false;
+    }
+    if (succeeded && localData.count > writtenTypedFieldCount) {
+        for (NSString *key in localData) {
+            BOOL isTypedField = false;
+            for (size_t i = 0; i < typedFieldCount; i++) {
+                if ([key isEqualToString:typedFields[i].name]) {
+                    isTypedField = true;
+                    break;
+                }
+            }
+            id value = localData[key];
+            if (isTypedField || [value isKindOfClass:[NSNull class]]) {
+                continue;
+            }
+            succeeded = ((first || LCIMPayloadBufferAppendLiteral(buffer, ",")) &&
+                         LCIMPayloadWriteString(buffer, key) &&
+                         LCIMPayloadBufferAppendLiteral(buffer, ":") &&
+                         LCIMPayloadWriteValue(buffer, value, 1));
+            first = false;
+            if (!succeeded) {
+                break;
+            }
+        }
+    }
+    succeeded = succeeded && LCIMPayloadBufferAppendLiteral(buffer, "}");
+    NSData *data = (succeeded
+                    ? [NSData dataWithBytes:buffer->bytes length:buffer->length]
+                    : nil);
+    LCIMPayloadBufferRelinquish(buffer);
+    return data;
+}
+
 - (BOOL)isValidTypedMessageObject
 {
     NSNumber *typeNumber = [NSNumber _lc_decoding:self.localData
@@ -93,6 +93,10 @@
     return self.content;
 }
 
+- (NSData *)payloadData {
+    return [[self payload] dataUsingEncoding:NSUTF8StringEncoding];
+}
+
 - (AVIMMessageIOType)ioType {
     if (!self.clientId || !self.localClientId) {
         return AVIMMessageIOTypeOut;
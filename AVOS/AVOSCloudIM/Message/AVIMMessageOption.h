@@ -24,6 +24,9 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, assign)           AVIMMessagePriority  priority;
 @property (nonatomic, strong, nullable) NSDictionary        *pushData;
 
+/// The max count of files uploading at the same time when sending a batch of messages, 0 means default value 3.
+@property (nonatomic, assign)           NSUInteger           maxConcurrentFileUploadCount;
+
 @end
 
 NS_ASSUME_NONNULL_END
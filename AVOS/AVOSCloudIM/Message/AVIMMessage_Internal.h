@@ -47,6 +47,17 @@
  */
 - (NSString *)payload;
 
+/*!
+ * UTF-8 encoded payload of current message
+ */
+- (NSData *)payloadData;
+
+/*!
+ * Payload bytes encoded for the outgoing direct command,
+ * reused by the message cache so that a sent message is encoded only once
+ */
+@property (nonatomic, strong) NSData *encodedPayload;
+
 //======================================================================
 //====== override readonly property to readwrite for internal use ======
 //======================================================================
@@ -24,6 +24,15 @@
     }];                                         \
 } while (0)
 
+#define LCIM_OPEN_DATABASE_IN_TRANSACTION(db, routine) do {  \
+    LCDatabaseQueue *dbQueue = [self databaseQueue];        \
+                                                            \
+    [dbQueue inTransaction:^(LCDatabase *db, BOOL *rollback) { \
+        db.logsErrors = LCIM_SHOULD_LOG_ERRORS;             \
+        routine;                                            \
+    }];                                                     \
+} while (0)
+
 @interface LCIMCacheStore : NSObject
 
 @property (nonatomic, readonly, copy) NSString *clientId;
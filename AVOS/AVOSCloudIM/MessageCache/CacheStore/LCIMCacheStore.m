@@ -58,6 +58,7 @@
 - (void)databaseQueueDidLoad {
     LCIM_OPEN_DATABASE(db, ({
         db.logsErrors = LCIM_SHOULD_LOG_ERRORS;
+        db.shouldCacheStatements = YES;
 
         [db executeUpdate:LCIM_SQL_CREATE_MESSAGE_TABLE];
 
@@ -99,10 +100,56 @@
             }
 
             [resultSet close];
+        }],
+
+        [LCDatabaseMigration migrationWithBlock:^(LCDatabase *db) {
+            [db executeStatements:LCIM_SQL_MESSAGE_MIGRATION_V5];
+            [self buildMessageRangesWithDatabase:db];
+            [db executeStatements:LCIM_SQL_MESSAGE_MIGRATION_V5_DROP_BREAKPOINT];
         }]
     ]];
 }
 
+/*!
+ * Build continuous ranges from breakpoints of cached messages.
+ * Each run of messages without breakpoint forms a range, together with the message before it.
+ */
+- (void)buildMessageRangesWithDatabase:(LCDatabase *)db {
+    NSMutableArray *ranges = [NSMutableArray array];
+
+    __block NSString *conversationId = nil;
+    __block NSArray  *startKey = nil;
+    __block NSArray  *endKey = nil;
+
+    void(^flushRange)(void) = ^{
+        if (conversationId && ![startKey isEqualToArray:endKey])
+            [ranges addObject:@[conversationId, startKey[0], startKey[1], endKey[0], endKey[1]]];
+    };
+
+    LCResultSet *result = [db executeQuery:LCIM_SQL_SELECT_MESSAGE_BREAKPOINTS];
+
+    while ([result next]) {
+        NSString *messageConversationId = [result stringForColumn:LCIM_FIELD_CONVERSATION_ID];
+        NSArray  *key = @[@([result longLongIntForColumn:LCIM_FIELD_TIMESTAMP]), [result stringForColumn:LCIM_FIELD_MESSAGE_ID]];
+
+        if ([result boolForColumn:LCIM_FIELD_BREAKPOINT] || ![messageConversationId isEqualToString:conversationId]) {
+            flushRange();
+
+            conversationId = messageConversationId;
+            startKey = key;
+        }
+
+        endKey = key;
+    }
+
+    [result close];
+
+    flushRange();
+
+    for (NSArray *args in ranges)
+        [db executeUpdate:LCIM_SQL_INSERT_MESSAGE_RANGE withArgumentsInArray:args];
+}
+
 - (void)dealloc {
     [_databaseQueue close];
 }
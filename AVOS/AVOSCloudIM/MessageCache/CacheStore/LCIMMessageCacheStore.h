@@ -17,18 +17,25 @@
 - (instancetype)initWithClientId:(NSString *)clientId conversationId:(NSString *)conversationId;
 
 - (void)insertOrUpdateMessage:(AVIMMessage *)message;
-- (void)insertOrUpdateMessage:(AVIMMessage *)message withBreakpoint:(BOOL)breakpoint;
+- (void)insertOrUpdateMessage:(AVIMMessage *)message withBreakpoint:(BOOL)breakpoint NS_SWIFT_NAME(insertOrUpdateMessage(_:withBreakpoint:));
 
 - (void)insertOrUpdateMessages:(NSArray<AVIMMessage *> *)messages;
 
-- (void)updateBreakpoint:(BOOL)breakpoint forMessages:(NSArray *)messages;
-- (void)updateBreakpoint:(BOOL)breakpoint forMessage:(AVIMMessage *)message;
+/* Insert or update messages in one transaction. */
+- (void)insertOrUpdateMessagesInTransaction:(NSArray<AVIMMessage *> *)messages withBreakpoint:(BOOL)breakpoint;
+
+/*
+ Insert messages which are continuous, e.g., a page of messages queried from server.
+ The range of messages is merged into the continuous ranges of cache.
+ */
+- (void)insertContinuousMessages:(NSArray<AVIMMessage *> *)messages NS_SWIFT_NAME(insertContinuousMessages(_:));
 
 - (void)updateMessageWithoutBreakpoint:(AVIMMessage *)message;
 
 - (void)updateEntries:(NSDictionary<NSString *, id> *)entries forMessageId:(NSString *)messageId;
 
-- (void)deleteMessage:(AVIMMessage *)message;
+/* Delete message, the message after it will have a breakpoint. */
+- (void)deleteMessage:(AVIMMessage *)message NS_SWIFT_NAME(deleteMessage(_:));
 
 - (BOOL)containMessage:(AVIMMessage *)message;
 
@@ -42,7 +49,13 @@
                            messageId:(NSString *)messageId
                                limit:(NSUInteger)limit;
 
-- (NSArray *)latestMessagesWithLimit:(NSUInteger)limit;
+/* `continuous` is set to whether none of the messages has a breakpoint. */
+- (NSArray *)messagesBeforeTimestamp:(int64_t)timestamp
+                           messageId:(NSString *)messageId
+                               limit:(NSUInteger)limit
+                          continuous:(BOOL *)continuous;
+
+- (NSArray *)latestMessagesWithLimit:(NSUInteger)limit NS_SWIFT_NAME(latestMessages(limit:));
 
 - (AVIMMessage *)latestNoBreakpointMessage;
 
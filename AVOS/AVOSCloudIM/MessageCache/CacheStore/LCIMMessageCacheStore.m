@@ -14,6 +14,72 @@
 #import "AVIMTypedMessage_Internal.h"
 #import "LCDatabaseMigrator.h"
 
+/*!
+ * A continuous range of cached messages, both ends are inclusive.
+ */
+@interface LCIMMessageRange : NSObject
+
+@property (nonatomic, assign) int64_t   rangeId;
+@property (nonatomic, assign) int64_t   startTimestamp;
+@property (nonatomic, copy)   NSString *startMessageId;
+@property (nonatomic, assign) int64_t   endTimestamp;
+@property (nonatomic, copy)   NSString *endMessageId;
+
+@end
+
+@implementation LCIMMessageRange
+
+@end
+
+/* Columns read by -messageForRecord:columnIndexes:, in the order of LCIMMessageColumnNames(). */
+typedef NS_ENUM(NSUInteger, LCIMMessageColumn) {
+    LCIMMessageColumnPayload = 0,
+    LCIMMessageColumnSeq,
+    LCIMMessageColumnMessageId,
+    LCIMMessageColumnConversationId,
+    LCIMMessageColumnFromPeerId,
+    LCIMMessageColumnMentionAll,
+    LCIMMessageColumnMentionList,
+    LCIMMessageColumnTimestamp,
+    LCIMMessageColumnReceiptTimestamp,
+    LCIMMessageColumnReadTimestamp,
+    LCIMMessageColumnPatchTimestamp,
+    LCIMMessageColumnStatus,
+    LCIMMessageColumnCount
+};
+
+static NSArray *LCIMMessageColumnNames(void) {
+    static NSArray *columnNames;
+    static dispatch_once_t onceToken;
+
+    dispatch_once(&onceToken, ^{
+        columnNames = @[
+            LCIM_FIELD_PAYLOAD,
+            @"seq",
+            LCIM_FIELD_MESSAGE_ID,
+            LCIM_FIELD_CONVERSATION_ID,
+            LCIM_FIELD_FROM_PEER_ID,
+            @"mention_all",
+            @"mention_list",
+            LCIM_FIELD_TIMESTAMP,
+            LCIM_FIELD_RECEIPT_TIMESTAMP,
+            LCIM_FIELD_READ_TIMESTAMP,
+            LCIM_FIELD_PATCH_TIMESTAMP,
+            LCIM_FIELD_STATUS
+        ];
+    });
+
+    return columnNames;
+}
+
+/* Messages are ordered by (timestamp, message id), the same as the order by clauses of message table. */
+static NSComparisonResult LCIMCompareMessageKeys(int64_t timestamp1, NSString *messageId1, int64_t timestamp2, NSString *messageId2) {
+    if (timestamp1 != timestamp2)
+        return timestamp1 < timestamp2 ? NSOrderedAscending : NSOrderedDescending;
+
+    return [messageId1 compare:messageId2 options:NSLiteralSearch];
+}
+
 @interface LCIMMessageCacheStore ()
 
 @property (copy, readwrite) NSString *conversationId;
@@ -65,6 +131,10 @@
     return [[NSDate date] timeIntervalSince1970] * 1000;
 }
 
+- (NSData *)payloadDataForMessage:(AVIMMessage *)message {
+    return message.encodedPayload ?: message.payloadData;
+}
+
 - (NSArray *)updationRecordForMessage:(AVIMMessage *)message {
     return @[
         message.clientId,
@@ -74,23 +144,23 @@
         [self receiptTimestampForMessage:message],
         [self readTimestampForMessage:message],
         [self patchTimestampForMessage:message],
-        [message.payload dataUsingEncoding:NSUTF8StringEncoding],
+        [self payloadDataForMessage:message],
         @(message.status),
         self.conversationId,
         message.messageId
     ];
 }
 
-- (NSArray *)replacingRecordForMessage:(AVIMMessage *)message withBreakpoint:(BOOL)breakpoint {
+- (NSArray *)replacingRecordForMessage:(AVIMMessage *)message {
     NSAssert(message.seq > 0, @"Message must has a sequence number.");
 
-    NSMutableArray *record = [[self insertionRecordForMessage:message withBreakpoint:breakpoint] mutableCopy];
+    NSMutableArray *record = [[self insertionRecordForMessage:message] mutableCopy];
     [record insertObject:@(message.seq) atIndex:0];
 
     return record;
 }
 
-- (NSArray *)insertionRecordForMessage:(AVIMMessage *)message withBreakpoint:(BOOL)breakpoint {
+- (NSArray *)insertionRecordForMessage:(AVIMMessage *)message {
     return @[
         message.messageId ?: [NSNull null],
         self.conversationId,
@@ -101,9 +171,8 @@
         [self receiptTimestampForMessage:message],
         [self readTimestampForMessage:message],
         [self patchTimestampForMessage:message],
-        [message.payload dataUsingEncoding:NSUTF8StringEncoding],
-        @(message.status),
-        @(breakpoint)
+        [self payloadDataForMessage:message],
+        @(message.status)
     ];
 }
 
@@ -113,20 +182,308 @@
 
 - (void)insertOrUpdateMessage:(AVIMMessage *)message withBreakpoint:(BOOL)breakpoint {
     LCIM_OPEN_DATABASE(db, ({
-        if (message.seq) {
-            NSArray *args = [self replacingRecordForMessage:message withBreakpoint:breakpoint];
-            [db executeUpdate:LCIM_SQL_REPLACE_MESSAGE withArgumentsInArray:args];
-        } else {
-            NSArray *args = [self insertionRecordForMessage:message withBreakpoint:breakpoint];
-            [db executeUpdate:LCIM_SQL_INSERT_MESSAGE withArgumentsInArray:args];
+        [self insertOrUpdateMessage:message withBreakpoint:breakpoint database:db];
+    }));
+}
+
+- (void)insertOrUpdateMessage:(AVIMMessage *)message withBreakpoint:(BOOL)breakpoint database:(LCDatabase *)db {
+    if (message.seq) {
+        NSArray *args = [self replacingRecordForMessage:message];
+        [db executeUpdate:LCIM_SQL_REPLACE_MESSAGE withArgumentsInArray:args];
+        return;
+    }
+
+    NSArray *args = [self insertionRecordForMessage:message];
+    [db executeUpdate:LCIM_SQL_INSERT_MESSAGE withArgumentsInArray:args];
+
+    if ([db changes] > 0) {
+        /* Sequence number is the rowid of message table. */
+        message.seq = [db lastInsertRowId];
+
+        /* A new message without breakpoint is continuous with the message before it. */
+        if (!breakpoint && message.messageId && message.sendTimestamp)
+            [self linkPreviousMessageToMessage:message database:db];
+    } else if (message.messageId) {
+        /* Message is cached already. Update it in place, which keeps its sequence number and ranges. */
+        [db executeUpdate:LCIM_SQL_UPDATE_MESSAGE withArgumentsInArray:[self updationRecordForMessage:message]];
+
+        NSArray *seqArgs = @[self.conversationId, message.messageId, [self timestampForMessage:message]];
+        LCResultSet *resultSet = [db executeQuery:LCIM_SQL_SELECT_MESSAGE_SEQ_BY_ID_AND_TIMESTAMP withArgumentsInArray:seqArgs];
+
+        if ([resultSet next])
+            message.seq = [resultSet longLongIntForColumn:@"seq"];
+
+        [resultSet close];
+    }
+}
+
+- (void)linkPreviousMessageToMessage:(AVIMMessage *)message database:(LCDatabase *)db {
+    int64_t previousTimestamp = 0;
+    NSString *previousMessageId = nil;
+
+    NSArray *args = @[self.conversationId, @(message.sendTimestamp), @(message.sendTimestamp), message.messageId, @1];
+
+    if ([self getMessageKeyWithQuery:LCIM_SQL_SELECT_MESSAGE_LESS_THAN_TIMESTAMP_AND_ID
+                           arguments:args
+                            database:db
+                           timestamp:&previousTimestamp
+                           messageId:&previousMessageId])
+    {
+        [self unionRangeFromTimestamp:previousTimestamp
+                            messageId:previousMessageId
+                          toTimestamp:message.sendTimestamp
+                            messageId:message.messageId
+                             database:db];
+    }
+}
+
+- (BOOL)getMessageKeyWithQuery:(NSString *)query
+                     arguments:(NSArray *)arguments
+                      database:(LCDatabase *)db
+                     timestamp:(int64_t *)timestamp
+                     messageId:(NSString **)messageId
+{
+    LCResultSet *result = [db executeQuery:query withArgumentsInArray:arguments];
+
+    BOOL found = NO;
+
+    if ([result next]) {
+        NSString *foundMessageId = [result stringForColumn:LCIM_FIELD_MESSAGE_ID];
+
+        if (foundMessageId) {
+            *timestamp = [result longLongIntForColumn:LCIM_FIELD_TIMESTAMP];
+            *messageId = foundMessageId;
+            found = YES;
+        }
+    }
+
+    [result close];
+
+    return found;
+}
+
+#pragma mark - Message ranges
+
+- (LCIMMessageRange *)rangeForRecord:(LCResultSet *)record {
+    LCIMMessageRange *range = [[LCIMMessageRange alloc] init];
+
+    range.rangeId        = [record longLongIntForColumn:@"id"];
+    range.startTimestamp = [record longLongIntForColumn:LCIM_FIELD_START_TIMESTAMP];
+    range.startMessageId = [record stringForColumn:LCIM_FIELD_START_MESSAGE_ID];
+    range.endTimestamp   = [record longLongIntForColumn:LCIM_FIELD_END_TIMESTAMP];
+    range.endMessageId   = [record stringForColumn:LCIM_FIELD_END_MESSAGE_ID];
+
+    return range;
+}
+
+- (LCIMMessageRange *)rangeContainingTimestamp:(int64_t)timestamp
+                                     messageId:(NSString *)messageId
+                                      database:(LCDatabase *)db
+{
+    NSArray *args = @[self.conversationId, @(timestamp), @(timestamp), messageId];
+    LCResultSet *result = [db executeQuery:LCIM_SQL_SELECT_MESSAGE_RANGE_STARTING_BEFORE withArgumentsInArray:args];
+
+    /* Ranges never overlap, so only the range starting nearest to the message may contain it. */
+    LCIMMessageRange *range = [result next] ? [self rangeForRecord:result] : nil;
+
+    [result close];
+
+    if (range && LCIMCompareMessageKeys(range.endTimestamp, range.endMessageId, timestamp, messageId) == NSOrderedAscending)
+        range = nil;
+
+    return range;
+}
+
+- (void)insertRangeFromTimestamp:(int64_t)startTimestamp
+                       messageId:(NSString *)startMessageId
+                     toTimestamp:(int64_t)endTimestamp
+                       messageId:(NSString *)endMessageId
+                        database:(LCDatabase *)db
+{
+    /* A range of single message tells nothing about continuity. */
+    if (LCIMCompareMessageKeys(startTimestamp, startMessageId, endTimestamp, endMessageId) != NSOrderedAscending)
+        return;
+
+    NSArray *args = @[self.conversationId, @(startTimestamp), startMessageId, @(endTimestamp), endMessageId];
+    [db executeUpdate:LCIM_SQL_INSERT_MESSAGE_RANGE withArgumentsInArray:args];
+}
+
+- (void)unionRangeFromTimestamp:(int64_t)startTimestamp
+                      messageId:(NSString *)startMessageId
+                    toTimestamp:(int64_t)endTimestamp
+                      messageId:(NSString *)endMessageId
+                       database:(LCDatabase *)db
+{
+    NSMutableArray *mergedRangeIds = [NSMutableArray array];
+
+    NSArray *args = @[
+        self.conversationId,
+        @(endTimestamp), @(endTimestamp), endMessageId,
+        @(startTimestamp), @(startTimestamp), startMessageId
+    ];
+    LCResultSet *result = [db executeQuery:LCIM_SQL_SELECT_MESSAGE_RANGES_OVERLAPPING withArgumentsInArray:args];
+
+    while ([result next]) {
+        LCIMMessageRange *range = [self rangeForRecord:result];
+
+        if (LCIMCompareMessageKeys(range.startTimestamp, range.startMessageId, startTimestamp, startMessageId) == NSOrderedAscending) {
+            startTimestamp = range.startTimestamp;
+            startMessageId = range.startMessageId;
+        }
+
+        if (LCIMCompareMessageKeys(range.endTimestamp, range.endMessageId, endTimestamp, endMessageId) == NSOrderedDescending) {
+            endTimestamp = range.endTimestamp;
+            endMessageId = range.endMessageId;
+        }
+
+        [mergedRangeIds addObject:@(range.rangeId)];
+    }
 
-            /* Assign sequence number to message. */
-            LCResultSet *resultSet = [db executeQuery:LCIM_SQL_LAST_MESSAGE_SEQ];
+    [result close];
 
-            if ([resultSet next])
-                message.seq = [resultSet longLongIntForColumn:@"seq"];
+    for (NSNumber *rangeId in mergedRangeIds)
+        [db executeUpdate:LCIM_SQL_DELETE_MESSAGE_RANGE withArgumentsInArray:@[rangeId]];
 
-            [resultSet close];
+    [self insertRangeFromTimestamp:startTimestamp
+                         messageId:startMessageId
+                       toTimestamp:endTimestamp
+                         messageId:endMessageId
+                          database:db];
+}
+
+- (void)splitRangeAtMessage:(AVIMMessage *)message database:(LCDatabase *)db {
+    int64_t timestamp = message.sendTimestamp;
+    NSString *messageId = message.messageId;
+
+    if (!messageId)
+        return;
+
+    LCIMMessageRange *range = [self rangeContainingTimestamp:timestamp messageId:messageId database:db];
+
+    if (!range)
+        return;
+
+    [db executeUpdate:LCIM_SQL_DELETE_MESSAGE_RANGE withArgumentsInArray:@[@(range.rangeId)]];
+
+    int64_t neighborTimestamp = 0;
+    NSString *neighborMessageId = nil;
+
+    NSArray *previousArgs = @[self.conversationId, @(timestamp), @(timestamp), messageId, @1];
+
+    if ([self getMessageKeyWithQuery:LCIM_SQL_SELECT_MESSAGE_LESS_THAN_TIMESTAMP_AND_ID
+                           arguments:previousArgs
+                            database:db
+                           timestamp:&neighborTimestamp
+                           messageId:&neighborMessageId])
+    {
+        if (LCIMCompareMessageKeys(range.startTimestamp, range.startMessageId, neighborTimestamp, neighborMessageId) != NSOrderedDescending) {
+            [self insertRangeFromTimestamp:range.startTimestamp
+                                 messageId:range.startMessageId
+                               toTimestamp:neighborTimestamp
+                                 messageId:neighborMessageId
+                                  database:db];
+        }
+    }
+
+    NSArray *nextArgs = @[self.conversationId, @(timestamp), @(timestamp), messageId];
+
+    /* Message after the removed one has a breakpoint now. */
+    if ([self getMessageKeyWithQuery:LCIM_SQL_SELECT_NEXT_MESSAGE
+                           arguments:nextArgs
+                            database:db
+                           timestamp:&neighborTimestamp
+                           messageId:&neighborMessageId])
+    {
+        if (LCIMCompareMessageKeys(neighborTimestamp, neighborMessageId, range.endTimestamp, range.endMessageId) != NSOrderedDescending) {
+            [self insertRangeFromTimestamp:neighborTimestamp
+                                 messageId:neighborMessageId
+                               toTimestamp:range.endTimestamp
+                                 messageId:range.endMessageId
+                                  database:db];
+        }
+    }
+}
+
+/*!
+ * Compute breakpoints of messages from ranges.
+ * @param messages Messages in ascending order.
+ */
+- (void)resolveBreakpointsForMessages:(NSArray<AVIMMessage *> *)messages database:(LCDatabase *)db {
+    LCIMMessageRange *range = nil;
+
+    for (AVIMMessage *message in [messages reverseObjectEnumerator]) {
+        int64_t timestamp = message.sendTimestamp;
+        NSString *messageId = message.messageId;
+
+        /* Local message without id never breaks continuity. */
+        if (!messageId) {
+            message.breakpoint = NO;
+            continue;
+        }
+
+        if (!range || LCIMCompareMessageKeys(timestamp, messageId, range.startTimestamp, range.startMessageId) != NSOrderedDescending)
+            range = [self rangeContainingTimestamp:timestamp messageId:messageId database:db];
+
+        message.breakpoint = !(range && LCIMCompareMessageKeys(range.startTimestamp, range.startMessageId, timestamp, messageId) == NSOrderedAscending);
+    }
+}
+
+/*!
+ * Check whether one range holds all messages with none of them at its start, so no message has a breakpoint.
+ * @param messages Messages in ascending order.
+ */
+- (BOOL)rangeCoversMessages:(NSArray<AVIMMessage *> *)messages database:(LCDatabase *)db {
+    AVIMMessage *firstMessage = nil;
+    AVIMMessage *lastMessage = nil;
+
+    /* Local message without id never breaks continuity. */
+    for (AVIMMessage *message in messages) {
+        if (message.messageId) {
+            firstMessage = firstMessage ?: message;
+            lastMessage = message;
+        }
+    }
+
+    if (!firstMessage)
+        return YES;
+
+    int64_t firstTimestamp = firstMessage.sendTimestamp;
+    int64_t lastTimestamp = lastMessage.sendTimestamp;
+    NSArray *args = @[self.conversationId, @(firstTimestamp), @(firstTimestamp), firstMessage.messageId, @(lastTimestamp), @(lastTimestamp), lastMessage.messageId];
+    LCResultSet *result = [db executeQuery:LCIM_SQL_SELECT_MESSAGE_RANGE_COVERING withArgumentsInArray:args];
+
+    BOOL covered = [result next];
+
+    [result close];
+
+    return covered;
+}
+
+- (void)insertContinuousMessages:(NSArray<AVIMMessage *> *)messages {
+    NSMutableArray *keyedMessages = [NSMutableArray array];
+
+    for (AVIMMessage *message in messages) {
+        if (message.messageId && message.sendTimestamp)
+            [keyedMessages addObject:message];
+    }
+
+    [keyedMessages sortUsingComparator:^NSComparisonResult(AVIMMessage *message1, AVIMMessage *message2) {
+        return LCIMCompareMessageKeys(message1.sendTimestamp, message1.messageId, message2.sendTimestamp, message2.messageId);
+    }];
+
+    AVIMMessage *oldestMessage = [keyedMessages firstObject];
+    AVIMMessage *newestMessage = [keyedMessages lastObject];
+
+    LCIM_OPEN_DATABASE_IN_TRANSACTION(db, ({
+        for (AVIMMessage *message in messages)
+            [self insertOrUpdateMessage:message withBreakpoint:YES database:db];
+
+        if (oldestMessage) {
+            [self unionRangeFromTimestamp:oldestMessage.sendTimestamp
+                                messageId:oldestMessage.messageId
+                              toTimestamp:newestMessage.sendTimestamp
+                                messageId:newestMessage.messageId
+                                 database:db];
         }
     }));
 }
@@ -136,22 +493,14 @@
         [self insertOrUpdateMessage:message];
 }
 
-- (void)updateBreakpoint:(BOOL)breakpoint forMessages:(NSArray *)messages {
-    LCIM_OPEN_DATABASE(db, ({
-        for (AVIMMessage *message in messages) {
-            NSArray *args = @[
-                @(breakpoint),
-                self.conversationId,
-                message.messageId
-            ];
-
-            [db executeUpdate:LCIM_SQL_UPDATE_MESSAGE_BREAKPOINT withArgumentsInArray:args];
-        }
-    }));
-}
+- (void)insertOrUpdateMessagesInTransaction:(NSArray<AVIMMessage *> *)messages withBreakpoint:(BOOL)breakpoint {
+    if (!messages.count)
+        return;
 
-- (void)updateBreakpoint:(BOOL)breakpoint forMessage:(AVIMMessage *)message {
-    [self updateBreakpoint:breakpoint forMessages:@[message]];
+    LCIM_OPEN_DATABASE_IN_TRANSACTION(db, ({
+        for (AVIMMessage *message in messages)
+            [self insertOrUpdateMessage:message withBreakpoint:breakpoint database:db];
+    }));
 }
 
 - (void)updateMessageWithoutBreakpoint:(AVIMMessage *)message {
@@ -193,7 +542,9 @@
 }
 
 - (void)deleteMessage:(AVIMMessage *)message {
-    LCIM_OPEN_DATABASE(db, ({
+    LCIM_OPEN_DATABASE_IN_TRANSACTION(db, ({
+        [self splitRangeAtMessage:message database:db];
+
         NSArray *args = @[
             self.conversationId,
             @(message.seq),
@@ -210,6 +561,14 @@
 - (NSArray *)messagesBeforeTimestamp:(int64_t)timestamp
                            messageId:(NSString *)messageId
                                limit:(NSUInteger)limit
+{
+    return [self messagesBeforeTimestamp:timestamp messageId:messageId limit:limit continuous:NULL];
+}
+
+- (NSArray *)messagesBeforeTimestamp:(int64_t)timestamp
+                           messageId:(NSString *)messageId
+                               limit:(NSUInteger)limit
+                          continuous:(BOOL *)continuous
 {
     NSMutableArray *messages = [NSMutableArray array];
 
@@ -224,11 +583,24 @@
             result = [db executeQuery:LCIM_SQL_SELECT_MESSAGE_LESS_THAN_TIMESTAMP withArgumentsInArray:args];
         }
 
-        while ([result next]) {
-            [messages insertObject:[self messageForRecord:result] atIndex:0];
-        }
+        [result enumerateRowsWithColumnNames:LCIMMessageColumnNames() usingBlock:^(LCResultSet *row, const int *columnIndexes, BOOL *stop) {
+            [messages insertObject:[self messageForRecord:row columnIndexes:columnIndexes] atIndex:0];
+        }];
 
         [result close];
+
+        /* Most pages lie in one range, which answers for every message at once. */
+        BOOL covered = [self rangeCoversMessages:messages database:db];
+
+        if (covered) {
+            for (AVIMMessage *message in messages)
+                message.breakpoint = NO;
+        } else {
+            [self resolveBreakpointsForMessages:messages database:db];
+        }
+
+        if (continuous)
+            *continuous = covered;
     }));
 
     return messages;
@@ -248,6 +620,9 @@
         }
 
         [result close];
+
+        if (message)
+            [self resolveBreakpointsForMessages:@[message] database:db];
     }));
 
     return message;
@@ -268,6 +643,9 @@
         }
         
         [result close];
+        
+        if (message)
+            [self resolveBreakpointsForMessages:@[message] database:db];
     }));
     
     return message;
@@ -291,15 +669,25 @@
         }
 
         [result close];
+
+        if (message)
+            [self resolveBreakpointsForMessages:@[message] database:db];
     }));
 
     return message;
 }
 
 - (id)messageForRecord:(LCResultSet *)record {
+    int columnIndexes[LCIMMessageColumnCount];
+    [record getColumnIndexes:columnIndexes forColumnNames:LCIMMessageColumnNames()];
+
+    return [self messageForRecord:record columnIndexes:columnIndexes];
+}
+
+- (id)messageForRecord:(LCResultSet *)record columnIndexes:(const int *)columnIndexes {
     AVIMMessage *message = nil;
 
-    NSData *data = [record dataForColumn:LCIM_FIELD_PAYLOAD];
+    NSData *data = [record dataNoCopyForColumnIndex:columnIndexes[LCIMMessageColumnPayload]];
     NSString *payload = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
 
     AVIMTypedMessageObject *messageObject = [[AVIMTypedMessageObject alloc] initWithJSON:payload];
@@ -310,23 +698,22 @@
         message = [[AVIMMessage alloc] init];
     }
 
-    message.seq                = [record longLongIntForColumn:@"seq"];
-    message.messageId          = [record stringForColumn:LCIM_FIELD_MESSAGE_ID];
-    message.conversationId     = [record stringForColumn:LCIM_FIELD_CONVERSATION_ID];
-    message.clientId           = [record stringForColumn:LCIM_FIELD_FROM_PEER_ID];
-    message.mentionAll         = [record boolForColumn:@"mention_all"];
+    message.seq                = [record longLongIntForColumnIndex:columnIndexes[LCIMMessageColumnSeq]];
+    message.messageId          = [record stringForColumnIndex:columnIndexes[LCIMMessageColumnMessageId]];
+    message.conversationId     = [record stringForColumnIndex:columnIndexes[LCIMMessageColumnConversationId]];
+    message.clientId           = [record stringForColumnIndex:columnIndexes[LCIMMessageColumnFromPeerId]];
+    message.mentionAll         = [record boolForColumnIndex:columnIndexes[LCIMMessageColumnMentionAll]];
     message.mentionList        = ({
-        NSData *data = [record dataForColumn:@"mention_list"];
+        NSData *data = [record dataForColumnIndex:columnIndexes[LCIMMessageColumnMentionList]];
         NSArray *mentionList = data ? [NSKeyedUnarchiver unarchiveObjectWithData:data] : nil;
         mentionList;
     });
-    message.sendTimestamp      = [record longLongIntForColumn:LCIM_FIELD_TIMESTAMP];
-    message.deliveredTimestamp = [record longLongIntForColumn:LCIM_FIELD_RECEIPT_TIMESTAMP];
-    message.readTimestamp      = [record longLongIntForColumn:LCIM_FIELD_READ_TIMESTAMP];
-    message.updatedAt          = [self dateFromTimestamp:[record doubleForColumn:LCIM_FIELD_PATCH_TIMESTAMP]];
+    message.sendTimestamp      = [record longLongIntForColumnIndex:columnIndexes[LCIMMessageColumnTimestamp]];
+    message.deliveredTimestamp = [record longLongIntForColumnIndex:columnIndexes[LCIMMessageColumnReceiptTimestamp]];
+    message.readTimestamp      = [record longLongIntForColumnIndex:columnIndexes[LCIMMessageColumnReadTimestamp]];
+    message.updatedAt          = [self dateFromTimestamp:[record doubleForColumnIndex:columnIndexes[LCIMMessageColumnPatchTimestamp]]];
     message.content            = payload;
-    message.status             = [record intForColumn:LCIM_FIELD_STATUS];
-    message.breakpoint         = [record boolForColumn:LCIM_FIELD_BREAKPOINT];
+    message.status             = [record intForColumnIndex:columnIndexes[LCIMMessageColumnStatus]];
     message.localClientId      = self.clientId;
 
     return message;
@@ -339,11 +726,13 @@
         NSArray *args = @[self.conversationId, @(limit)];
         LCResultSet *result = [db executeQuery:LCIM_SQL_LATEST_MESSAGE withArgumentsInArray:args];
 
-        while ([result next]) {
-            [messages insertObject:[self messageForRecord:result] atIndex:0];
-        }
+        [result enumerateRowsWithColumnNames:LCIMMessageColumnNames() usingBlock:^(LCResultSet *row, const int *columnIndexes, BOOL *stop) {
+            [messages insertObject:[self messageForRecord:row columnIndexes:columnIndexes] atIndex:0];
+        }];
 
         [result close];
+
+        [self resolveBreakpointsForMessages:messages database:db];
     }));
 
     return messages;
@@ -353,14 +742,22 @@
     __block AVIMMessage *message = nil;
 
     LCIM_OPEN_DATABASE(db, ({
-        NSArray *args = @[self.conversationId];
-        LCResultSet *result = [db executeQuery:LCIM_SQL_LATEST_NO_BREAKPOINT_MESSAGE withArgumentsInArray:args];
-
-        if ([result next]) {
-            message = [self messageForRecord:result];
-        }
+        LCResultSet *result = [db executeQuery:LCIM_SQL_SELECT_LATEST_MESSAGE_RANGE withArgumentsInArray:@[self.conversationId]];
+        LCIMMessageRange *range = [result next] ? [self rangeForRecord:result] : nil;
 
         [result close];
+
+        if (range) {
+            NSArray *args = @[self.conversationId, range.endMessageId, @(range.endTimestamp)];
+            result = [db executeQuery:LCIM_SQL_SELECT_MESSAGE_BY_ID_AND_TIMESTAMP withArgumentsInArray:args];
+
+            if ([result next]) {
+                message = [self messageForRecord:result];
+                message.breakpoint = NO;
+            }
+
+            [result close];
+        }
     }));
 
     return message;
@@ -370,6 +767,7 @@
     LCIM_OPEN_DATABASE(db, ({
         NSArray *args = @[self.conversationId];
         [db executeUpdate:LCIM_SQL_CLEAN_MESSAGE withArgumentsInArray:args];
+        [db executeUpdate:LCIM_SQL_CLEAN_MESSAGE_RANGE withArgumentsInArray:args];
     }));
 }
 
@@ -10,6 +10,7 @@
 #define AVOS_LCIMMessageCacheSQL_h
 
 #define LCIM_TABLE_MESSAGE              @"message"
+#define LCIM_TABLE_MESSAGE_RANGE        @"message_range"
 
 #define LCIM_FIELD_MESSAGE_ID           @"message_id"
 #define LCIM_FIELD_CONVERSATION_ID      @"conversation_id"
@@ -22,16 +23,21 @@
 #define LCIM_FIELD_BREAKPOINT           @"breakpoint"
 #define LCIM_FIELD_STATUS               @"status"
 
+#define LCIM_FIELD_START_TIMESTAMP      @"start_timestamp"
+#define LCIM_FIELD_START_MESSAGE_ID     @"start_message_id"
+#define LCIM_FIELD_END_TIMESTAMP        @"end_timestamp"
+#define LCIM_FIELD_END_MESSAGE_ID       @"end_message_id"
+
 #define LCIM_INDEX_MESSAGE              @"unique_index"
 
 #define LCIM_SQL_SELECT_NEXT_MESSAGE \
 @"select * from message where conversation_id = ? and (timestamp > ? or (timestamp = ? and message_id > ?)) order by timestamp, message_id limit 1"
 
 #define LCIM_SQL_INSERT_MESSAGE \
-@"insert or replace into message (message_id, conversation_id, from_peer_id, mention_all, mention_list, timestamp, receipt_timestamp, read_timestamp, patch_timestamp, payload, status, breakpoint) values (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
+@"insert or ignore into message (message_id, conversation_id, from_peer_id, mention_all, mention_list, timestamp, receipt_timestamp, read_timestamp, patch_timestamp, payload, status) values (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
 
 #define LCIM_SQL_REPLACE_MESSAGE \
-@"replace into message (seq, message_id, conversation_id, from_peer_id, mention_all, mention_list, timestamp, receipt_timestamp, read_timestamp, patch_timestamp, payload, status, breakpoint) values (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
+@"replace into message (seq, message_id, conversation_id, from_peer_id, mention_all, mention_list, timestamp, receipt_timestamp, read_timestamp, patch_timestamp, payload, status) values (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
 
 #define LCIM_SQL_UPDATE_MESSAGE \
 @"update message set from_peer_id = ?, mention_all = ?, mention_list = ?, timestamp = ?, receipt_timestamp = ?, read_timestamp = ?, patch_timestamp = ?, payload = ?, status = ? where conversation_id = ? and message_id = ?"
@@ -39,9 +45,6 @@
 #define LCIM_SQL_DELETE_MESSAGE \
 @"delete from message where conversation_id = ? and (seq = ? or (message_id is not null and message_id = ?))"
 
-#define LCIM_SQL_UPDATE_MESSAGE_BREAKPOINT \
-@"update message set breakpoint = ? where conversation_id = ? and message_id = ?"
-
 #define LCIM_SQL_SELECT_MESSAGE_LESS_THAN_TIMESTAMP \
 @"select * from message where conversation_id = ? and timestamp < ? order by timestamp desc limit ?"
 
@@ -54,6 +57,9 @@
 #define LCIM_SQL_SELECT_MESSAGE_BY_ID_AND_TIMESTAMP \
 @"select * from message where conversation_id = ? and message_id = ? and timestamp = ?"
 
+#define LCIM_SQL_SELECT_MESSAGE_SEQ_BY_ID_AND_TIMESTAMP \
+@"select seq from message where conversation_id = ? and message_id = ? and timestamp = ?"
+
 #define LCIM_SQL_DELETE_ALL_MESSAGES_OF_CONVERSATION \
 @"delete from message where conversation_id = ?"
 
@@ -66,8 +72,8 @@
 #define LCIM_SQL_SELECT_MESSAGE_LESS_THAN_TIMESTAMP_AND_ID \
 @"select * from message where conversation_id = ? and (timestamp < ? or (timestamp = ? and message_id < ?)) order by timestamp desc, message_id desc limit ?"
 
-#define LCIM_SQL_LATEST_NO_BREAKPOINT_MESSAGE \
-@"select *, max(timestamp) from message where conversation_id = ? and breakpoint = 0"
+#define LCIM_SQL_SELECT_MESSAGE_BREAKPOINTS \
+@"select conversation_id, message_id, timestamp, breakpoint from message where message_id is not null order by conversation_id, timestamp, message_id"
 
 #define LCIM_SQL_UPDATE_MESSAGE_ENTRIES_FMT \
 @"update message set %@ where conversation_id = ? and message_id = ?"
@@ -115,7 +121,72 @@ alter table message_seq rename to message;"
 @"delete from message;"               \
 @"create unique index if not exists message_unique_index on message(conversation_id, message_id, timestamp);"
 
-#define LCIM_SQL_LAST_MESSAGE_SEQ \
-@"select seq from sqlite_sequence where name=\"message\""
+/*
+ Continuous ranges of cached messages, ordered by (timestamp, message_id).
+ A message is continuous with its predecessor if and only if it lies in some range and is not the start of that range.
+ Ranges of one conversation never overlap, and ranges with a single message are not stored.
+ */
+
+#define LCIM_SQL_MESSAGE_MIGRATION_V5 \
+@"create table if not exists message_range(                                                                      \
+    id integer primary key autoincrement, conversation_id text,                                                  \
+    start_timestamp integer, start_message_id text,                                                              \
+    end_timestamp integer, end_message_id text);                                                                 \
+                                                                                                                 \
+create index if not exists message_range_index_start on message_range(conversation_id, start_timestamp, start_message_id); \
+create index if not exists message_range_index_end on message_range(conversation_id, end_timestamp, end_message_id);"
+
+/*
+ Once ranges are built from it, the 'breakpoint' column is dropped by rebuilding message table.
+ Sequence numbers are copied, so they stay valid after migration.
+ */
+
+#define LCIM_SQL_MESSAGE_MIGRATION_V5_DROP_BREAKPOINT \
+@"create table if not exists message_v5(                                                                         \
+    seq integer primary key autoincrement, message_id text,                                                      \
+    conversation_id text, from_peer_id text, timestamp real,                                                     \
+    receipt_timestamp real, read_timestamp real, patch_timestamp real,                                           \
+    mention_all integer, mention_list blob,                                                                      \
+    payload blob, status integer);                                                                               \
+                                                                                                                 \
+insert into message_v5(                                                                                          \
+    seq, message_id, conversation_id, from_peer_id, timestamp, receipt_timestamp,                                \
+    read_timestamp, patch_timestamp, mention_all, mention_list, payload, status)                                 \
+select                                                                                                           \
+    seq, message_id, conversation_id, from_peer_id, timestamp, receipt_timestamp,                                \
+    read_timestamp, patch_timestamp, mention_all, mention_list, payload, status                                  \
+from message;                                                                                                    \
+                                                                                                                 \
+drop table if exists message;                                                                                    \
+alter table message_v5 rename to message;                                                                        \
+                                                                                                                 \
+create unique index if not exists message_unique_index on message(conversation_id, message_id, timestamp);       \
+create index if not exists message_index_conversation_id on message(conversation_id);                            \
+create index if not exists message_index_message_id on message(message_id);                                      \
+create index if not exists message_index_timestamp on message(timestamp);"
+
+/* The range starting nearest before a message, the only range which may contain it. */
+#define LCIM_SQL_SELECT_MESSAGE_RANGE_STARTING_BEFORE \
+@"select * from message_range where conversation_id = ? and (start_timestamp < ? or (start_timestamp = ? and start_message_id <= ?)) order by start_timestamp desc, start_message_id desc limit 1"
+
+/* Ranges sharing at least one message with a range, given by its end and then its start. */
+#define LCIM_SQL_SELECT_MESSAGE_RANGES_OVERLAPPING \
+@"select * from message_range where conversation_id = ? and (start_timestamp < ? or (start_timestamp = ? and start_message_id <= ?)) and (end_timestamp > ? or (end_timestamp = ? and end_message_id >= ?))"
+
+/* A range holding two messages, with the first one after its start, so both and all messages between them are continuous. */
+#define LCIM_SQL_SELECT_MESSAGE_RANGE_COVERING \
+@"select id from message_range where conversation_id = ? and (start_timestamp < ? or (start_timestamp = ? and start_message_id < ?)) and (end_timestamp > ? or (end_timestamp = ? and end_message_id >= ?)) limit 1"
+
+#define LCIM_SQL_SELECT_LATEST_MESSAGE_RANGE \
+@"select * from message_range where conversation_id = ? order by start_timestamp desc, start_message_id desc limit 1"
+
+#define LCIM_SQL_INSERT_MESSAGE_RANGE \
+@"insert into message_range (conversation_id, start_timestamp, start_message_id, end_timestamp, end_message_id) values (?, ?, ?, ?, ?)"
+
+#define LCIM_SQL_DELETE_MESSAGE_RANGE \
+@"delete from message_range where id = ?"
+
+#define LCIM_SQL_CLEAN_MESSAGE_RANGE \
+@"delete from message_range where conversation_id = ?"
 
 #endif
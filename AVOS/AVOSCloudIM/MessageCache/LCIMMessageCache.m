@@ -53,15 +53,6 @@
     return [AVPersistenceUtils messageCacheDatabasePathWithName:self.clientId];
 }
 
-- (NSArray *)messagesOrderedByTimestampDescending:(NSArray *)messages {
-    NSString *key = NSStringFromSelector(@selector(sendTimestamp));
-    NSSortDescriptor *descriptor = [NSSortDescriptor sortDescriptorWithKey:key ascending:NO];
-
-    messages = [messages sortedArrayUsingDescriptors:@[descriptor]];
-
-    return messages;
-}
-
 - (NSArray *)messagesBeforeTimestamp:(int64_t)timestamp
                            messageId:(NSString *)messageId
                       conversationId:(NSString *)conversationId
@@ -70,85 +61,25 @@
 {
     LCIMMessageCacheStore *cacheStore = [self cacheStoreWithConversationId:conversationId];
 
-    NSArray *cachedMessages = [cacheStore messagesBeforeTimestamp:timestamp
-                                                        messageId:messageId
-                                                            limit:limit];
-
-    if (continuous) {
-        *continuous = YES;
-
-        for (AVIMMessage *message in cachedMessages) {
-            if (message.breakpoint) {
-                *continuous = NO;
-                break;
-            }
-        }
-    }
-
-    return cachedMessages;
-}
-
-- (NSArray *)trimFirstAndLastObjectFromArray:(NSArray *)array {
-    NSMutableArray *mutableArray = [array mutableCopy];
-
-    // Remove latest message
-    [mutableArray removeObjectAtIndex:0];
-
-    // Remove newest message
-    if ([mutableArray count]) {
-        [mutableArray removeObjectAtIndex:[array count] - 1];
-    }
-
-    return [mutableArray copy];
+    return [cacheStore messagesBeforeTimestamp:timestamp
+                                      messageId:messageId
+                                          limit:limit
+                                     continuous:continuous];
 }
 
 - (void)addContinuousMessages:(NSArray *)messages forConversationId:(NSString *)conversationId
 {
     if (messages.count == 0) { return; }
 
-    NSMutableArray *allMessages = [[self messagesOrderedByTimestampDescending:messages] mutableCopy];
-
-    AVIMMessage *oldestMessage = [allMessages lastObject];
-    AVIMMessage *newestMessage = [allMessages firstObject];
-    NSArray     *newerMessages = [allMessages subarrayWithRange:NSMakeRange(0, [allMessages count] - 1)];
-
-    /* insert breakpoint message or update oldest message without breakpoint */
-    [self insertMessageAndUpdateBreakpoint:oldestMessage forConversationId:conversationId];
-
-    LCIMMessageCacheStore *cacheStore = [self cacheStoreWithConversationId:conversationId];
-
-    BOOL newestMessageExisted = [cacheStore containMessage:newestMessage];
-
-    /* Insert messages and remove their breakpoints */
-    [cacheStore insertOrUpdateMessages:newerMessages];
-
-    if (!newestMessageExisted) {
-        AVIMMessage *nextMessage = [self nextMessageForMessage:newestMessage conversationId:conversationId];
-
-        if (nextMessage) {
-            [cacheStore updateBreakpoint:YES forMessage:nextMessage];
-        }
-    }
-}
-
-- (void)insertMessageAndUpdateBreakpoint:(AVIMMessage *)message forConversationId:(NSString *)conversationId {
     LCIMMessageCacheStore *cacheStore = [self cacheStoreWithConversationId:conversationId];
 
-    if ([cacheStore containMessage:message]) {
-        [cacheStore updateMessageWithoutBreakpoint:message];
-    } else {
-        [cacheStore insertOrUpdateMessage:message];
-        [cacheStore updateBreakpoint:YES forMessage:message];
-    }
+    [cacheStore insertContinuousMessages:messages];
 }
 
 - (void)deleteMessages:(NSArray *)messages forConversationId:(NSString *)conversationId {
     LCIMMessageCacheStore *cacheStore = [self cacheStoreWithConversationId:conversationId];
 
     for (AVIMMessage *message in messages) {
-        AVIMMessage *nextMessage = [self nextMessageForMessage:message conversationId:conversationId];
-
-        [cacheStore updateBreakpoint:YES forMessage:nextMessage];
         [cacheStore deleteMessage:message];
     }
 }
@@ -49,6 +49,9 @@
 //% @package
 //%  LCGPB_UNSAFE_UNRETAINED LCGPBMessage *_autocreator;
 //%}
+//%
+//%// Used to size the storage for a packed field before decoding it.
+//%- (void)internalResizeToCapacity:(NSUInteger)newCapacity;
 //%@end
 //%
 
@@ -61,6 +64,9 @@
  @package
   LCGPB_UNSAFE_UNRETAINED LCGPBMessage *_autocreator;
 }
+
+// Used to size the storage for a packed field before decoding it.
+- (void)internalResizeToCapacity:(NSUInteger)newCapacity;
 @end
 
 #pragma mark - UInt32
@@ -69,6 +75,9 @@
  @package
   LCGPB_UNSAFE_UNRETAINED LCGPBMessage *_autocreator;
 }
+
+// Used to size the storage for a packed field before decoding it.
+- (void)internalResizeToCapacity:(NSUInteger)newCapacity;
 @end
 
 #pragma mark - Int64
@@ -77,6 +86,9 @@
  @package
   LCGPB_UNSAFE_UNRETAINED LCGPBMessage *_autocreator;
 }
+
+// Used to size the storage for a packed field before decoding it.
+- (void)internalResizeToCapacity:(NSUInteger)newCapacity;
 @end
 
 #pragma mark - UInt64
@@ -85,6 +97,9 @@
  @package
   LCGPB_UNSAFE_UNRETAINED LCGPBMessage *_autocreator;
 }
+
+// Used to size the storage for a packed field before decoding it.
+- (void)internalResizeToCapacity:(NSUInteger)newCapacity;
 @end
 
 #pragma mark - Float
@@ -93,6 +108,9 @@
  @package
   LCGPB_UNSAFE_UNRETAINED LCGPBMessage *_autocreator;
 }
+
+// Used to size the storage for a packed field before decoding it.
+- (void)internalResizeToCapacity:(NSUInteger)newCapacity;
 @end
 
 #pragma mark - Double
@@ -101,6 +119,9 @@
  @package
   LCGPB_UNSAFE_UNRETAINED LCGPBMessage *_autocreator;
 }
+
+// Used to size the storage for a packed field before decoding it.
+- (void)internalResizeToCapacity:(NSUInteger)newCapacity;
 @end
 
 #pragma mark - Bool
@@ -109,6 +130,9 @@
  @package
   LCGPB_UNSAFE_UNRETAINED LCGPBMessage *_autocreator;
 }
+
+// Used to size the storage for a packed field before decoding it.
+- (void)internalResizeToCapacity:(NSUInteger)newCapacity;
 @end
 
 #pragma mark - Enum
@@ -117,6 +141,9 @@
  @package
   LCGPB_UNSAFE_UNRETAINED LCGPBMessage *_autocreator;
 }
+
+// Used to size the storage for a packed field before decoding it.
+- (void)internalResizeToCapacity:(NSUInteger)newCapacity;
 @end
 
 //%PDDM-EXPAND-END DECLARE_ARRAY_EXTRAS()
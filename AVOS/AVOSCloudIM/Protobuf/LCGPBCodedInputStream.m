@@ -113,7 +113,58 @@ static int64_t ReadRawLittleEndian64(LCGPBCodedInputStreamState *state) {
   return value;
 }
 
+// A varint never takes more than this many bytes on the wire.
+static const size_t kMaxVarintSize = 10;
+
+// Decodes a varint without bounds checks; the caller guarantees that at least
+// kMaxVarintSize bytes are readable at |ptr|.  Varints of up to eight bytes
+// (every tag, length and 32-bit value) are decoded from a single word: the
+// terminating byte is found from the clear continuation bits and the 7-bit
+// groups are packed together with three shift/mask steps.  Returns the
+// position after the varint, or NULL if it is longer than kMaxVarintSize.
+static inline const uint8_t *DecodeVarint64(const uint8_t *ptr,
+                                            uint64_t *value) {
+  uint64_t word;
+  memcpy(&word, ptr, sizeof(word));
+  word = OSSwapLittleToHostInt64(word);
+  uint64_t stops = ~word & 0x8080808080808080ULL;
+  if (stops) {
+    int bits = __builtin_ctzll(stops) + 1;
+    uint64_t x = word & 0x7F7F7F7F7F7F7F7FULL;
+    if (bits < 64) {
+      x &= (1ULL << bits) - 1;
+    }
+    x = (x & 0x007F007F007F007FULL) | ((x & 0x7F007F007F007F00ULL) >> 1);
+    x = (x & 0x00003FFF00003FFFULL) | ((x & 0x3FFF00003FFF0000ULL) >> 2);
+    x = (x & 0x000000000FFFFFFFULL) | ((x & 0x0FFFFFFF00000000ULL) >> 4);
+    *value = x;
+    return ptr + bits / 8;
+  }
+  uint64_t result = 0;
+  for (size_t i = 0; i < kMaxVarintSize; i++) {
+    uint64_t b = ptr[i];
+    result |= (b & 0x7F) << (7 * i);
+    if (b < 0x80) {
+      *value = result;
+      return ptr + i + 1;
+    }
+  }
+  return NULL;
+}
+
 static int64_t ReadRawVarint64(LCGPBCodedInputStreamState *state) {
+  // currentLimit never exceeds bufferSize, so this covers both bounds.
+  if (state->currentLimit - state->bufferPos >= kMaxVarintSize) {
+    const uint8_t *ptr = state->bytes + state->bufferPos;
+    uint64_t value;
+    const uint8_t *end = DecodeVarint64(ptr, &value);
+    if (end == NULL) {
+      RaiseException(LCGPBCodedInputStreamErrorInvalidVarInt,
+                     @"Invalid VarInt64");
+    }
+    state->bufferPos += end - ptr;
+    return (int64_t)value;
+  }
   int32_t shift = 0;
   int64_t result = 0;
   while (shift < 64) {
@@ -274,6 +325,55 @@ NSData *LCGPBCodedInputStreamReadRetainedBytesNoCopy(
   return result;
 }
 
+size_t LCGPBCodedInputStreamCountPackedVarints(
+    LCGPBCodedInputStreamState *state) {
+  const uint8_t *ptr = state->bytes + state->bufferPos;
+  const uint8_t *end = state->bytes + state->currentLimit;
+  size_t count = 0;
+  // Every varint ends in exactly one byte with a clear high bit, so count those
+  // eight bytes at a time.
+  while (end - ptr >= 8) {
+    uint64_t word;
+    memcpy(&word, ptr, sizeof(word));
+    count += __builtin_popcountll(~word & 0x8080808080808080ULL);
+    ptr += 8;
+  }
+  while (ptr < end) {
+    count += (*ptr++ < 0x80);
+  }
+  return count;
+}
+
+size_t LCGPBCodedInputStreamReadPackedVarints(LCGPBCodedInputStreamState *state,
+                                            uint64_t *values, size_t count) {
+  size_t n = 0;
+  // Decode unchecked while a whole varint is known to fit before the limit...
+  while (n < count &&
+         state->currentLimit - state->bufferPos >= kMaxVarintSize) {
+    const uint8_t *ptr = state->bytes + state->bufferPos;
+    const uint8_t *end = DecodeVarint64(ptr, &values[n]);
+    if (end == NULL) {
+      RaiseException(LCGPBCodedInputStreamErrorInvalidVarInt,
+                     @"Invalid VarInt64");
+    }
+    state->bufferPos += end - ptr;
+    n++;
+  }
+  // ...and finish the tail of the field byte by byte.
+  while (n < count && state->bufferPos < state->currentLimit) {
+    values[n++] = (uint64_t)ReadRawVarint64(state);
+  }
+  return n;
+}
+
+const uint8_t *LCGPBCodedInputStreamReadRawBytesInPlace(
+    LCGPBCodedInputStreamState *state, size_t size) {
+  CheckSize(state, size);
+  const uint8_t *result = state->bytes + state->bufferPos;
+  state->bufferPos += size;
+  return result;
+}
+
 size_t LCGPBCodedInputStreamPushLimit(LCGPBCodedInputStreamState *state,
                                     size_t byteLimit) {
   byteLimit += state->bufferPos;
@@ -100,6 +100,18 @@ NSData *LCGPBCodedInputStreamReadRetainedBytes(LCGPBCodedInputStreamState *state
 NSData *LCGPBCodedInputStreamReadRetainedBytesNoCopy(
     LCGPBCodedInputStreamState *state) __attribute((ns_returns_retained));
 
+// Returns the number of varints between the current position and the current
+// limit, used to size the storage of a packed repeated field before decoding it.
+size_t LCGPBCodedInputStreamCountPackedVarints(LCGPBCodedInputStreamState *state);
+// Decodes up to |count| consecutive varints into |values|, stopping early at the
+// current limit, and returns how many were decoded.
+size_t LCGPBCodedInputStreamReadPackedVarints(LCGPBCodedInputStreamState *state,
+                                            uint64_t *values, size_t count);
+// Returns |size| raw bytes at the current position without copying them and
+// advances past them.
+const uint8_t *LCGPBCodedInputStreamReadRawBytesInPlace(
+    LCGPBCodedInputStreamState *state, size_t size);
+
 size_t LCGPBCodedInputStreamPushLimit(LCGPBCodedInputStreamState *state,
                                     size_t byteLimit);
 void LCGPBCodedInputStreamPopLimit(LCGPBCodedInputStreamState *state,
@@ -167,6 +167,13 @@ static void LCGPBWriteRawLittleEndian64(LCGPBOutputBufferState *state,
   return [self initWithOutputStream:nil data:data];
 }
 
+- (instancetype)initWithData:(NSMutableData *)data offset:(size_t)offset {
+  if ((self = [self initWithOutputStream:nil data:data])) {
+    state_.position = offset;
+  }
+  return self;
+}
+
 // This initializer isn't exposed, but it is the designated initializer.
 // Setting OutputStream and NSData is to control the buffering behavior/size
 // of the work, but that is more obvious via the bufferSize: version.
@@ -32,6 +32,14 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@interface LCGPBCodedOutputStream ()
+
+// Writes into |data| starting at |offset|, leaving the bytes in front of it
+// untouched (e.g. room reserved for a transport header).
+- (instancetype)initWithData:(NSMutableData *)data offset:(size_t)offset;
+
+@end
+
 CF_EXTERN_C_BEGIN
 
 size_t LCGPBComputeDoubleSize(int32_t fieldNumber, double value)
@@ -564,6 +564,243 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   }
 }
 
+#pragma mark - Scalar map storage
+
+// The maps from an integer key to a scalar value keep their entries unboxed in
+// an open-addressing table instead of an NSMutableDictionary of NSNumbers, so
+// decoding or setting an entry allocates nothing once the table has room.
+// Keys and values are stored as 64-bit patterns, collisions are resolved by
+// linear probing, and removing an entry shifts the rest of its cluster back so
+// no tombstones are needed.
+
+typedef struct LCGPBScalarMapEntry {
+  uint64_t key;
+  uint64_t value;
+} LCGPBScalarMapEntry;
+
+typedef struct LCGPBScalarMap {
+  // One allocation: |capacity| entries followed by |capacity| occupied flags.
+  LCGPBScalarMapEntry *entries;
+  uint8_t *occupied;
+  NSUInteger capacity;  // Zero or a power of two.
+  NSUInteger count;
+} LCGPBScalarMap;
+
+static const NSUInteger kScalarMapMinCapacity = 8;
+
+static inline uint64_t ScalarMapPackUInt32(uint32_t value) { return value; }
+static inline uint64_t ScalarMapPackInt32(int32_t value) { return (uint32_t)value; }
+static inline uint64_t ScalarMapPackUInt64(uint64_t value) { return value; }
+static inline uint64_t ScalarMapPackInt64(int64_t value) { return (uint64_t)value; }
+static inline uint64_t ScalarMapPackBool(BOOL value) { return value ? 1 : 0; }
+static inline uint64_t ScalarMapPackEnum(int32_t value) { return (uint32_t)value; }
+static inline uint64_t ScalarMapPackFloat(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+static inline uint64_t ScalarMapPackDouble(double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static inline uint32_t ScalarMapUnpackUInt32(uint64_t bits) { return (uint32_t)bits; }
+static inline int32_t ScalarMapUnpackInt32(uint64_t bits) { return (int32_t)(uint32_t)bits; }
+static inline uint64_t ScalarMapUnpackUInt64(uint64_t bits) { return bits; }
+static inline int64_t ScalarMapUnpackInt64(uint64_t bits) { return (int64_t)bits; }
+static inline BOOL ScalarMapUnpackBool(uint64_t bits) { return bits != 0; }
+static inline int32_t ScalarMapUnpackEnum(uint64_t bits) { return (int32_t)(uint32_t)bits; }
+static inline float ScalarMapUnpackFloat(uint64_t bits) {
+  uint32_t narrowed = (uint32_t)bits;
+  float value;
+  memcpy(&value, &narrowed, sizeof(value));
+  return value;
+}
+static inline double ScalarMapUnpackDouble(uint64_t bits) {
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static inline NSUInteger ScalarMapSlot(uint64_t key, NSUInteger mask) {
+  // The MurmurHash3 finalizer, so that runs of small keys spread over the table.
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return (NSUInteger)key & mask;
+}
+
+static void ScalarMapRehash(LCGPBScalarMap *map, NSUInteger capacity) {
+  LCGPBScalarMapEntry *oldEntries = map->entries;
+  uint8_t *oldOccupied = map->occupied;
+  NSUInteger oldCapacity = map->capacity;
+
+  size_t size = capacity * (sizeof(LCGPBScalarMapEntry) + sizeof(uint8_t));
+  LCGPBScalarMapEntry *entries = malloc(size);
+  if (entries == NULL) {
+    [NSException raise:NSMallocException
+                format:@"Failed to allocate %lu bytes", (unsigned long)size];
+  }
+  uint8_t *occupied = (uint8_t *)(entries + capacity);
+  memset(occupied, 0, capacity);
+
+  NSUInteger mask = capacity - 1;
+  for (NSUInteger i = 0; i < oldCapacity; ++i) {
+    if (oldOccupied[i]) {
+      NSUInteger slot = ScalarMapSlot(oldEntries[i].key, mask);
+      while (occupied[slot]) {
+        slot = (slot + 1) & mask;
+      }
+      entries[slot] = oldEntries[i];
+      occupied[slot] = 1;
+    }
+  }
+  free(oldEntries);
+
+  map->entries = entries;
+  map->occupied = occupied;
+  map->capacity = capacity;
+}
+
+// Grows the table so that |count| entries fit under a 3/4 load factor.
+static void ScalarMapReserve(LCGPBScalarMap *map, NSUInteger count) {
+  NSUInteger capacity = map->capacity ? map->capacity : kScalarMapMinCapacity;
+  while (count > capacity / 4 * 3) {
+    capacity *= 2;
+  }
+  if (capacity != map->capacity) {
+    ScalarMapRehash(map, capacity);
+  }
+}
+
+static LCGPBScalarMapEntry *ScalarMapFind(const LCGPBScalarMap *map, uint64_t key) {
+  if (map->count == 0) {
+    return NULL;
+  }
+  NSUInteger mask = map->capacity - 1;
+  NSUInteger slot = ScalarMapSlot(key, mask);
+  while (map->occupied[slot]) {
+    if (map->entries[slot].key == key) {
+      return &map->entries[slot];
+    }
+    slot = (slot + 1) & mask;
+  }
+  return NULL;
+}
+
+static void ScalarMapSet(LCGPBScalarMap *map, uint64_t key, uint64_t value) {
+  if (map->count >= map->capacity / 4 * 3) {
+    ScalarMapReserve(map, map->count + 1);
+  }
+  NSUInteger mask = map->capacity - 1;
+  NSUInteger slot = ScalarMapSlot(key, mask);
+  while (map->occupied[slot]) {
+    if (map->entries[slot].key == key) {
+      map->entries[slot].value = value;
+      return;
+    }
+    slot = (slot + 1) & mask;
+  }
+  map->entries[slot].key = key;
+  map->entries[slot].value = value;
+  map->occupied[slot] = 1;
+  map->count++;
+}
+
+static void ScalarMapRemove(LCGPBScalarMap *map, uint64_t key) {
+  LCGPBScalarMapEntry *entry = ScalarMapFind(map, key);
+  if (entry == NULL) {
+    return;
+  }
+  NSUInteger mask = map->capacity - 1;
+  NSUInteger hole = (NSUInteger)(entry - map->entries);
+  NSUInteger slot = hole;
+  while (YES) {
+    slot = (slot + 1) & mask;
+    if (!map->occupied[slot]) {
+      break;
+    }
+    // An entry can move back into the hole unless its home slot lies
+    // (cyclically) after the hole.
+    NSUInteger home = ScalarMapSlot(map->entries[slot].key, mask);
+    if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+      map->entries[hole] = map->entries[slot];
+      hole = slot;
+    }
+  }
+  map->occupied[hole] = 0;
+  map->count--;
+}
+
+static void ScalarMapRemoveAll(LCGPBScalarMap *map) {
+  if (map->occupied) {
+    memset(map->occupied, 0, map->capacity);
+  }
+  map->count = 0;
+}
+
+static void ScalarMapFree(LCGPBScalarMap *map) {
+  free(map->entries);
+  map->entries = NULL;
+  map->occupied = NULL;
+  map->capacity = 0;
+  map->count = 0;
+}
+
+// Returns the next entry at or after |*index| and advances |*index| past it,
+// or NULL once the table is exhausted.
+static inline const LCGPBScalarMapEntry *ScalarMapNextEntry(const LCGPBScalarMap *map,
+                                                            NSUInteger *index) {
+  for (NSUInteger i = *index; i < map->capacity; ++i) {
+    if (map->occupied[i]) {
+      *index = i + 1;
+      return &map->entries[i];
+    }
+  }
+  *index = map->capacity;
+  return NULL;
+}
+
+static void ScalarMapAddEntries(LCGPBScalarMap *map, const LCGPBScalarMap *other) {
+  if (map == other || other->count == 0) {
+    return;
+  }
+  if (map->count == 0) {
+    // Copying into an empty map: take the other table as is.
+    if (map->capacity != other->capacity) {
+      ScalarMapFree(map);
+      ScalarMapRehash(map, other->capacity);
+    }
+    memcpy(map->entries, other->entries,
+           other->capacity * (sizeof(LCGPBScalarMapEntry) + sizeof(uint8_t)));
+    map->count = other->count;
+    return;
+  }
+  ScalarMapReserve(map, map->count + other->count);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(other, &index))) {
+    ScalarMapSet(map, entry->key, entry->value);
+  }
+}
+
+// Values compare by their stored bit patterns.
+static BOOL ScalarMapIsEqual(const LCGPBScalarMap *map, const LCGPBScalarMap *other) {
+  if (map->count != other->count) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(map, &index))) {
+    const LCGPBScalarMapEntry *otherEntry = ScalarMapFind(other, entry->key);
+    if (otherEntry == NULL || otherEntry->value != entry->value) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
 //
 // Macros for the common basic cases.
 //
@@ -583,11 +820,75 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 //%DICTIONARY_KEY_TO_ENUM_IMPL(KEY_NAME, KEY_TYPE, KisP, Enum, int32_t, KHELPER)
 
 //%PDDM-DEFINE DICTIONARY_KEY_TO_POD_IMPL(KEY_NAME, KEY_TYPE, KisP, VALUE_NAME, VALUE_TYPE, KHELPER)
-//%DICTIONARY_COMMON_IMPL(KEY_NAME, KEY_TYPE, KisP, VALUE_NAME, VALUE_TYPE, KHELPER, POD, VALUE_NAME, value)
+//%DICTIONARY_KEY_TO_POD_IMPL_##KHELPER(KEY_NAME, KEY_TYPE, KisP, VALUE_NAME, VALUE_TYPE)
+//%PDDM-DEFINE DICTIONARY_KEY_TO_POD_IMPL_POD(KEY_NAME, KEY_TYPE, KisP, VALUE_NAME, VALUE_TYPE)
+//%DICTIONARY_SCALAR_IMPL(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE)
+//%PDDM-DEFINE DICTIONARY_KEY_TO_POD_IMPL_OBJECT(KEY_NAME, KEY_TYPE, KisP, VALUE_NAME, VALUE_TYPE)
+//%DICTIONARY_COMMON_IMPL(KEY_NAME, KEY_TYPE, KisP, VALUE_NAME, VALUE_TYPE, OBJECT, POD, VALUE_NAME, value)
 
 //%PDDM-DEFINE DICTIONARY_POD_KEY_TO_OBJECT_IMPL(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE)
 //%DICTIONARY_COMMON_IMPL(KEY_NAME, KEY_TYPE, , VALUE_NAME, VALUE_TYPE, POD, OBJECT, Object, object)
 
+//%PDDM-DEFINE DICTIONARY_SCALAR_IMPL(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE)
+//%#pragma mark - KEY_NAME -> VALUE_NAME
+//%
+//%@implementation LCGPB##KEY_NAME##VALUE_NAME##Dictionary {
+//% @package
+//%  LCGPBScalarMap _map;
+//%}
+//%
+//%- (instancetype)init {
+//%  return [self initWith##VALUE_NAME##s:NULL forKeys:NULL count:0];
+//%}
+//%
+//%- (instancetype)initWith##VALUE_NAME##s:(const VALUE_TYPE [])values
+//%                ##VALUE_NAME$S##  forKeys:(const KEY_TYPE [])keys
+//%                ##VALUE_NAME$S##    count:(NSUInteger)count {
+//%  self = [super init];
+//%  if (self) {
+//%    if (count && values && keys) {
+//%      ScalarMapReserve(&_map, count);
+//%      for (NSUInteger i = 0; i < count; ++i) {
+//%        ScalarMapSet(&_map, ScalarMapPack##KEY_NAME(keys[i]), ScalarMapPack##VALUE_NAME(values[i]));
+//%      }
+//%    }
+//%  }
+//%  return self;
+//%}
+//%
+//%- (instancetype)initWithDictionary:(LCGPB##KEY_NAME##VALUE_NAME##Dictionary *)dictionary {
+//%  self = [self initWith##VALUE_NAME##s:NULL forKeys:NULL count:0];
+//%  if (self) {
+//%    if (dictionary) {
+//%      ScalarMapAddEntries(&_map, &dictionary->_map);
+//%    }
+//%  }
+//%  return self;
+//%}
+//%
+//%- (instancetype)initWithCapacity:(NSUInteger)numItems {
+//%  self = [self initWith##VALUE_NAME##s:NULL forKeys:NULL count:0];
+//%  if (self && numItems) {
+//%    ScalarMapReserve(&_map, numItems);
+//%  }
+//%  return self;
+//%}
+//%
+//%DICTIONARY_SCALAR_IMMUTABLE_CORE(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, VALUE_NAME, value, )
+//%
+//%- (BOOL)get##VALUE_NAME##:(nullable VALUE_TYPE *)value forKey:(KEY_TYPE)key {
+//%  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPack##KEY_NAME(key));
+//%  if (entry && value) {
+//%    *value = ScalarMapUnpack##VALUE_NAME(entry->value);
+//%  }
+//%  return (entry != NULL);
+//%}
+//%
+//%DICTIONARY_SCALAR_MUTABLE_CORE(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, VALUE_NAME, VALUE_NAME, value, )
+//%
+//%@end
+//%
+
 //%PDDM-DEFINE DICTIONARY_COMMON_IMPL(KEY_NAME, KEY_TYPE, KisP, VALUE_NAME, VALUE_TYPE, KHELPER, VHELPER, VNAME, VNAME_VAR)
 //%#pragma mark - KEY_NAME -> VALUE_NAME
 //%
@@ -640,7 +941,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 //%
 
 //%PDDM-DEFINE DICTIONARY_KEY_TO_ENUM_IMPL(KEY_NAME, KEY_TYPE, KisP, VALUE_NAME, VALUE_TYPE, KHELPER)
-//%DICTIONARY_KEY_TO_ENUM_IMPL2(KEY_NAME, KEY_TYPE, KisP, VALUE_NAME, VALUE_TYPE, KHELPER, POD)
+//%DICTIONARY_KEY_TO_ENUM_IMPL_##KHELPER(KEY_NAME, KEY_TYPE, KisP, VALUE_NAME, VALUE_TYPE)
+//%PDDM-DEFINE DICTIONARY_KEY_TO_ENUM_IMPL_POD(KEY_NAME, KEY_TYPE, KisP, VALUE_NAME, VALUE_TYPE)
+//%DICTIONARY_SCALAR_KEY_TO_ENUM_IMPL(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE)
+//%PDDM-DEFINE DICTIONARY_KEY_TO_ENUM_IMPL_OBJECT(KEY_NAME, KEY_TYPE, KisP, VALUE_NAME, VALUE_TYPE)
+//%DICTIONARY_KEY_TO_ENUM_IMPL2(KEY_NAME, KEY_TYPE, KisP, VALUE_NAME, VALUE_TYPE, OBJECT, POD)
 //%PDDM-DEFINE DICTIONARY_KEY_TO_ENUM_IMPL2(KEY_NAME, KEY_TYPE, KisP, VALUE_NAME, VALUE_TYPE, KHELPER, VHELPER)
 //%#pragma mark - KEY_NAME -> VALUE_NAME
 //%
@@ -755,6 +1060,255 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 //%@end
 //%
 
+//%PDDM-DEFINE DICTIONARY_SCALAR_KEY_TO_ENUM_IMPL(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE)
+//%#pragma mark - KEY_NAME -> VALUE_NAME
+//%
+//%@implementation LCGPB##KEY_NAME##VALUE_NAME##Dictionary {
+//% @package
+//%  LCGPBScalarMap _map;
+//%  LCGPBEnumValidationFunc _validationFunc;
+//%}
+//%
+//%@synthesize validationFunc = _validationFunc;
+//%
+//%- (instancetype)init {
+//%  return [self initWithValidationFunction:NULL rawValues:NULL forKeys:NULL count:0];
+//%}
+//%
+//%- (instancetype)initWithValidationFunction:(LCGPBEnumValidationFunc)func {
+//%  return [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+//%}
+//%
+//%- (instancetype)initWithValidationFunction:(LCGPBEnumValidationFunc)func
+//%                                 rawValues:(const VALUE_TYPE [])rawValues
+//%                                   forKeys:(const KEY_TYPE [])keys
+//%                                     count:(NSUInteger)count {
+//%  self = [super init];
+//%  if (self) {
+//%    _validationFunc = (func != NULL ? func : DictDefault_IsValidValue);
+//%    if (count && rawValues && keys) {
+//%      ScalarMapReserve(&_map, count);
+//%      for (NSUInteger i = 0; i < count; ++i) {
+//%        ScalarMapSet(&_map, ScalarMapPack##KEY_NAME(keys[i]), ScalarMapPack##VALUE_NAME(rawValues[i]));
+//%      }
+//%    }
+//%  }
+//%  return self;
+//%}
+//%
+//%- (instancetype)initWithDictionary:(LCGPB##KEY_NAME##VALUE_NAME##Dictionary *)dictionary {
+//%  self = [self initWithValidationFunction:dictionary.validationFunc
+//%                                rawValues:NULL
+//%                                  forKeys:NULL
+//%                                    count:0];
+//%  if (self) {
+//%    if (dictionary) {
+//%      ScalarMapAddEntries(&_map, &dictionary->_map);
+//%    }
+//%  }
+//%  return self;
+//%}
+//%
+//%- (instancetype)initWithValidationFunction:(LCGPBEnumValidationFunc)func
+//%                                  capacity:(NSUInteger)numItems {
+//%  self = [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+//%  if (self && numItems) {
+//%    ScalarMapReserve(&_map, numItems);
+//%  }
+//%  return self;
+//%}
+//%
+//%DICTIONARY_SCALAR_IMMUTABLE_CORE(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, Value, value, Raw)
+//%
+//%- (BOOL)getEnum:(VALUE_TYPE *)value forKey:(KEY_TYPE)key {
+//%  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPack##KEY_NAME(key));
+//%  if (entry && value) {
+//%    VALUE_TYPE result = ScalarMapUnpack##VALUE_NAME(entry->value);
+//%    if (!_validationFunc(result)) {
+//%      result = kLCGPBUnrecognizedEnumeratorValue;
+//%    }
+//%    *value = result;
+//%  }
+//%  return (entry != NULL);
+//%}
+//%
+//%- (BOOL)getRawValue:(VALUE_TYPE *)rawValue forKey:(KEY_TYPE)key {
+//%  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPack##KEY_NAME(key));
+//%  if (entry && rawValue) {
+//%    *rawValue = ScalarMapUnpack##VALUE_NAME(entry->value);
+//%  }
+//%  return (entry != NULL);
+//%}
+//%
+//%- (void)enumerateKeysAndEnumsUsingBlock:
+//%    (void (NS_NOESCAPE ^)(KEY_TYPE key, VALUE_TYPE value, BOOL *stop))block {
+//%  LCGPBEnumValidationFunc func = _validationFunc;
+//%  BOOL stop = NO;
+//%  NSUInteger index = 0;
+//%  const LCGPBScalarMapEntry *entry;
+//%  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+//%    VALUE_TYPE unwrapped = ScalarMapUnpack##VALUE_NAME(entry->value);
+//%    if (!func(unwrapped)) {
+//%      unwrapped = kLCGPBUnrecognizedEnumeratorValue;
+//%    }
+//%    block(ScalarMapUnpack##KEY_NAME(entry->key), unwrapped, &stop);
+//%    if (stop) {
+//%      break;
+//%    }
+//%  }
+//%}
+//%
+//%DICTIONARY_SCALAR_MUTABLE_CORE(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, Value, Enum, value, Raw)
+//%
+//%- (void)setEnum:(VALUE_TYPE)value forKey:(KEY_TYPE)key {
+//%  if (!_validationFunc(value)) {
+//%    [NSException raise:NSInvalidArgumentException
+//%                format:@"LCGPB##KEY_NAME##VALUE_NAME##Dictionary: Attempt to set an unknown enum value (%d)",
+//%                       value];
+//%  }
+//%
+//%  ScalarMapSet(&_map, ScalarMapPack##KEY_NAME(key), ScalarMapPack##VALUE_NAME(value));
+//%  if (_autocreator) {
+//%    LCGPBAutocreatedDictionaryModified(_autocreator, self);
+//%  }
+//%}
+//%
+//%@end
+//%
+
+//%PDDM-DEFINE DICTIONARY_SCALAR_IMMUTABLE_CORE(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, VNAME, VNAME_VAR, ACCESSOR_NAME)
+//%- (void)dealloc {
+//%  NSAssert(!_autocreator,
+//%           @"%@: Autocreator must be cleared before release, autocreator: %@",
+//%           [self class], _autocreator);
+//%  ScalarMapFree(&_map);
+//%  [super dealloc];
+//%}
+//%
+//%- (instancetype)copyWithZone:(NSZone *)zone {
+//%  return [[LCGPB##KEY_NAME##VALUE_NAME##Dictionary allocWithZone:zone] initWithDictionary:self];
+//%}
+//%
+//%- (BOOL)isEqual:(id)other {
+//%  if (self == other) {
+//%    return YES;
+//%  }
+//%  if (![other isKindOfClass:[LCGPB##KEY_NAME##VALUE_NAME##Dictionary class]]) {
+//%    return NO;
+//%  }
+//%  LCGPB##KEY_NAME##VALUE_NAME##Dictionary *otherDictionary = other;
+//%  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
+//%}
+//%
+//%- (NSUInteger)hash {
+//%  return _map.count;
+//%}
+//%
+//%- (NSString *)description {
+//%  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+//%  NSUInteger index = 0;
+//%  const LCGPBScalarMapEntry *entry;
+//%  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+//%    entries[@(ScalarMapUnpack##KEY_NAME(entry->key))] = @(ScalarMapUnpack##VALUE_NAME(entry->value));
+//%  }
+//%  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
+//%}
+//%
+//%- (NSUInteger)count {
+//%  return _map.count;
+//%}
+//%
+//%- (void)enumerateKeysAnd##ACCESSOR_NAME##VNAME##sUsingBlock:
+//%    (void (NS_NOESCAPE ^)(KEY_TYPE key, VALUE_TYPE VNAME_VAR, BOOL *stop))block {
+//%  BOOL stop = NO;
+//%  NSUInteger index = 0;
+//%  const LCGPBScalarMapEntry *entry;
+//%  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+//%    block(ScalarMapUnpack##KEY_NAME(entry->key), ScalarMapUnpack##VALUE_NAME(entry->value), &stop);
+//%    if (stop) {
+//%      break;
+//%    }
+//%  }
+//%}
+//%
+//%- (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
+//%  NSUInteger count = _map.count;
+//%  if (count == 0) {
+//%    return 0;
+//%  }
+//%
+//%  LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
+//%  LCGPBDataType keyDataType = field.mapKeyDataType;
+//%  size_t result = 0;
+//%  NSUInteger index = 0;
+//%  const LCGPBScalarMapEntry *entry;
+//%  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+//%    size_t msgSize = ComputeDict##KEY_NAME##FieldSize(ScalarMapUnpack##KEY_NAME(entry->key), kMapKeyFieldNumber, keyDataType);
+//%    msgSize += ComputeDict##VALUE_NAME##FieldSize(ScalarMapUnpack##VALUE_NAME(entry->value), kMapValueFieldNumber, valueDataType);
+//%    result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
+//%  }
+//%  size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
+//%  result += tagSize * count;
+//%  return result;
+//%}
+//%
+//%- (void)writeToCodedOutputStream:(LCGPBCodedOutputStream *)outputStream
+//%                         asField:(LCGPBFieldDescriptor *)field {
+//%  LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
+//%  LCGPBDataType keyDataType = field.mapKeyDataType;
+//%  uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
+//%  NSUInteger index = 0;
+//%  const LCGPBScalarMapEntry *entry;
+//%  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+//%    [outputStream writeInt32NoTag:tag];
+//%    // Write the size of the message.
+//%    KEY_TYPE unwrappedKey = ScalarMapUnpack##KEY_NAME(entry->key);
+//%    VALUE_TYPE unwrappedValue = ScalarMapUnpack##VALUE_NAME(entry->value);
+//%    size_t msgSize = ComputeDict##KEY_NAME##FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
+//%    msgSize += ComputeDict##VALUE_NAME##FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
+//%    [outputStream writeInt32NoTag:(int32_t)msgSize];
+//%    // Write the fields.
+//%    WriteDict##KEY_NAME##Field(outputStream, unwrappedKey, kMapKeyFieldNumber, keyDataType);
+//%    WriteDict##VALUE_NAME##Field(outputStream, unwrappedValue, kMapValueFieldNumber, valueDataType);
+//%  }
+//%}
+//%
+//%SERIAL_DATA_FOR_ENTRY_POD(KEY_NAME, VALUE_NAME)- (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
+//%     forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
+//%  ScalarMapSet(&_map, ScalarMapPack##KEY_NAME(key->value##KEY_NAME), ScalarMapPack##VALUE_NAME(value->value##VALUE_NAME));
+//%}
+//%
+//%- (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
+//%  [self enumerateKeysAnd##ACCESSOR_NAME##VNAME##sUsingBlock:^(KEY_TYPE key, VALUE_TYPE VNAME_VAR, BOOL *stop) {
+//%      #pragma unused(stop)
+//%      block(TEXT_FORMAT_OBJ##KEY_NAME(key), TEXT_FORMAT_OBJ##VALUE_NAME(VNAME_VAR));
+//%  }];
+//%}
+//%PDDM-DEFINE DICTIONARY_SCALAR_MUTABLE_CORE(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, VNAME, VNAME_REMOVE, VNAME_VAR, ACCESSOR_NAME)
+//%- (void)add##ACCESSOR_NAME##EntriesFromDictionary:(LCGPB##KEY_NAME##VALUE_NAME##Dictionary *)otherDictionary {
+//%  if (otherDictionary) {
+//%    ScalarMapAddEntries(&_map, &otherDictionary->_map);
+//%    if (_autocreator) {
+//%      LCGPBAutocreatedDictionaryModified(_autocreator, self);
+//%    }
+//%  }
+//%}
+//%
+//%- (void)set##ACCESSOR_NAME##VNAME##:(VALUE_TYPE)VNAME_VAR forKey:(KEY_TYPE)key {
+//%  ScalarMapSet(&_map, ScalarMapPack##KEY_NAME(key), ScalarMapPack##VALUE_NAME(VNAME_VAR));
+//%  if (_autocreator) {
+//%    LCGPBAutocreatedDictionaryModified(_autocreator, self);
+//%  }
+//%}
+//%
+//%- (void)remove##VNAME_REMOVE##ForKey:(KEY_TYPE)aKey {
+//%  ScalarMapRemove(&_map, ScalarMapPack##KEY_NAME(aKey));
+//%}
+//%
+//%- (void)removeAll {
+//%  ScalarMapRemoveAll(&_map);
+//%}
+
 //%PDDM-DEFINE DICTIONARY_IMMUTABLE_CORE(KEY_NAME, KEY_TYPE, KisP, VALUE_NAME, VALUE_TYPE, KHELPER, VHELPER, VNAME, VNAME_VAR, ACCESSOR_NAME)
 //%- (void)dealloc {
 //%  NSAssert(!_autocreator,
@@ -1432,7 +1986,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt32UInt32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -1444,10 +1998,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt32(keys[i]), ScalarMapPackUInt32(values[i]));
       }
     }
   }
@@ -1458,22 +2012,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithUInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithUInt32s:NULL forKeys:NULL count:0];
+  self = [self initWithUInt32s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -1489,30 +2046,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt32UInt32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt32(entry->key))] = @(ScalarMapUnpackUInt32(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndUInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, uint32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue unsignedIntValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt32(entry->key), ScalarMapUnpackUInt32(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -1520,8 +2081,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -1529,12 +2089,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt32FieldSize([aValue unsignedIntValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt32FieldSize(ScalarMapUnpackUInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt32FieldSize(ScalarMapUnpackUInt32(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -1547,15 +2106,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    uint32_t unwrappedValue = [aValue unsignedIntValue];
+    uint32_t unwrappedKey = ScalarMapUnpackUInt32(entry->key);
+    uint32_t unwrappedValue = ScalarMapUnpackUInt32(entry->value);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -1567,7 +2124,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt32) forKey:@(key->valueUInt32)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key->valueUInt32), ScalarMapPackUInt32(value->valueUInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -1578,16 +2135,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getUInt32:(nullable uint32_t *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedIntValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt32(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackUInt32(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBUInt32UInt32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -1595,18 +2152,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setUInt32:(uint32_t)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key), ScalarMapPackUInt32(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt32ForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -1615,7 +2172,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt32Int32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -1627,10 +2184,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt32(keys[i]), ScalarMapPackInt32(values[i]));
       }
     }
   }
@@ -1641,22 +2198,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithInt32s:NULL forKeys:NULL count:0];
+  self = [self initWithInt32s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -1672,30 +2232,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt32Int32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt32(entry->key))] = @(ScalarMapUnpackInt32(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, int32_t value, BOOL *stop))block {
-  BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue intValue], &stop);
+  BOOL stop = NO;
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt32(entry->key), ScalarMapUnpackInt32(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -1703,8 +2267,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -1712,12 +2275,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt32FieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt32FieldSize(ScalarMapUnpackUInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt32FieldSize(ScalarMapUnpackInt32(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -1730,15 +2292,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    int32_t unwrappedValue = [aValue intValue];
+    uint32_t unwrappedKey = ScalarMapUnpackUInt32(entry->key);
+    int32_t unwrappedValue = ScalarMapUnpackInt32(entry->value);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -1750,7 +2310,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt32) forKey:@(key->valueUInt32)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key->valueUInt32), ScalarMapPackInt32(value->valueInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -1761,16 +2321,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getInt32:(nullable int32_t *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped intValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt32(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackInt32(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBUInt32Int32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -1778,18 +2338,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setInt32:(int32_t)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key), ScalarMapPackInt32(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt32ForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -1798,7 +2358,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt32UInt64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -1810,10 +2370,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt32(keys[i]), ScalarMapPackUInt64(values[i]));
       }
     }
   }
@@ -1824,22 +2384,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithUInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithUInt64s:NULL forKeys:NULL count:0];
+  self = [self initWithUInt64s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -1855,30 +2418,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt32UInt64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt32(entry->key))] = @(ScalarMapUnpackUInt64(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndUInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, uint64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue unsignedLongLongValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt32(entry->key), ScalarMapUnpackUInt64(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -1886,8 +2453,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -1895,12 +2461,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt64FieldSize([aValue unsignedLongLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt32FieldSize(ScalarMapUnpackUInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt64FieldSize(ScalarMapUnpackUInt64(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -1913,15 +2478,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    uint64_t unwrappedValue = [aValue unsignedLongLongValue];
+    uint32_t unwrappedKey = ScalarMapUnpackUInt32(entry->key);
+    uint64_t unwrappedValue = ScalarMapUnpackUInt64(entry->value);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -1933,7 +2496,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt64) forKey:@(key->valueUInt32)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key->valueUInt32), ScalarMapPackUInt64(value->valueUInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -1944,16 +2507,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getUInt64:(nullable uint64_t *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedLongLongValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt32(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackUInt64(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBUInt32UInt64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -1961,18 +2524,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setUInt64:(uint64_t)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key), ScalarMapPackUInt64(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt64ForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -1981,7 +2544,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt32Int64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -1993,10 +2556,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt32(keys[i]), ScalarMapPackInt64(values[i]));
       }
     }
   }
@@ -2007,22 +2570,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithInt64s:NULL forKeys:NULL count:0];
+  self = [self initWithInt64s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -2038,30 +2604,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt32Int64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt32(entry->key))] = @(ScalarMapUnpackInt64(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, int64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue longLongValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt32(entry->key), ScalarMapUnpackInt64(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -2069,8 +2639,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -2078,12 +2647,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt64FieldSize([aValue longLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt32FieldSize(ScalarMapUnpackUInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt64FieldSize(ScalarMapUnpackInt64(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -2096,15 +2664,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    int64_t unwrappedValue = [aValue longLongValue];
+    uint32_t unwrappedKey = ScalarMapUnpackUInt32(entry->key);
+    int64_t unwrappedValue = ScalarMapUnpackInt64(entry->value);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -2116,7 +2682,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt64) forKey:@(key->valueUInt32)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key->valueUInt32), ScalarMapPackInt64(value->valueInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -2127,16 +2693,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getInt64:(nullable int64_t *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped longLongValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt32(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackInt64(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBUInt32Int64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -2144,18 +2710,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setInt64:(int64_t)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key), ScalarMapPackInt64(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt64ForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -2164,7 +2730,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt32BoolDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -2176,10 +2742,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                         count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt32(keys[i]), ScalarMapPackBool(values[i]));
       }
     }
   }
@@ -2190,22 +2756,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithBools:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithBools:NULL forKeys:NULL count:0];
+  self = [self initWithBools:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -2221,30 +2790,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt32BoolDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt32(entry->key))] = @(ScalarMapUnpackBool(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndBoolsUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, BOOL value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue boolValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt32(entry->key), ScalarMapUnpackBool(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -2252,8 +2825,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -2261,12 +2833,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictBoolFieldSize([aValue boolValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt32FieldSize(ScalarMapUnpackUInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictBoolFieldSize(ScalarMapUnpackBool(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -2279,15 +2850,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    BOOL unwrappedValue = [aValue boolValue];
+    uint32_t unwrappedKey = ScalarMapUnpackUInt32(entry->key);
+    BOOL unwrappedValue = ScalarMapUnpackBool(entry->value);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictBoolFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -2299,7 +2868,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueBool) forKey:@(key->valueUInt32)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key->valueUInt32), ScalarMapPackBool(value->valueBool));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -2310,16 +2879,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getBool:(nullable BOOL *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped boolValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt32(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackBool(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBUInt32BoolDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -2327,18 +2896,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setBool:(BOOL)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key), ScalarMapPackBool(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeBoolForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -2347,7 +2916,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt32FloatDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -2359,10 +2928,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt32(keys[i]), ScalarMapPackFloat(values[i]));
       }
     }
   }
@@ -2373,22 +2942,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithFloats:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithFloats:NULL forKeys:NULL count:0];
+  self = [self initWithFloats:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -2404,30 +2976,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt32FloatDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt32(entry->key))] = @(ScalarMapUnpackFloat(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndFloatsUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, float value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue floatValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt32(entry->key), ScalarMapUnpackFloat(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -2435,8 +3011,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -2444,12 +3019,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictFloatFieldSize([aValue floatValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt32FieldSize(ScalarMapUnpackUInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictFloatFieldSize(ScalarMapUnpackFloat(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -2462,15 +3036,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    float unwrappedValue = [aValue floatValue];
+    uint32_t unwrappedKey = ScalarMapUnpackUInt32(entry->key);
+    float unwrappedValue = ScalarMapUnpackFloat(entry->value);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictFloatFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -2482,7 +3054,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueFloat) forKey:@(key->valueUInt32)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key->valueUInt32), ScalarMapPackFloat(value->valueFloat));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -2493,16 +3065,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getFloat:(nullable float *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped floatValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt32(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackFloat(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBUInt32FloatDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -2510,18 +3082,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setFloat:(float)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key), ScalarMapPackFloat(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeFloatForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -2530,7 +3102,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt32DoubleDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -2542,10 +3114,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt32(keys[i]), ScalarMapPackDouble(values[i]));
       }
     }
   }
@@ -2556,22 +3128,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithDoubles:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithDoubles:NULL forKeys:NULL count:0];
+  self = [self initWithDoubles:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -2587,30 +3162,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt32DoubleDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt32(entry->key))] = @(ScalarMapUnpackDouble(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndDoublesUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, double value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue doubleValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt32(entry->key), ScalarMapUnpackDouble(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -2618,8 +3197,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -2627,12 +3205,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictDoubleFieldSize([aValue doubleValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt32FieldSize(ScalarMapUnpackUInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictDoubleFieldSize(ScalarMapUnpackDouble(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -2645,15 +3222,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    double unwrappedValue = [aValue doubleValue];
+    uint32_t unwrappedKey = ScalarMapUnpackUInt32(entry->key);
+    double unwrappedValue = ScalarMapUnpackDouble(entry->value);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictDoubleFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -2665,7 +3240,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueDouble) forKey:@(key->valueUInt32)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key->valueUInt32), ScalarMapPackDouble(value->valueDouble));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -2676,16 +3251,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getDouble:(nullable double *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped doubleValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt32(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackDouble(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBUInt32DoubleDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -2693,18 +3268,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setDouble:(double)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key), ScalarMapPackDouble(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeDoubleForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -2713,7 +3288,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt32EnumDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
   LCGPBEnumValidationFunc _validationFunc;
 }
 
@@ -2733,11 +3308,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                                      count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     _validationFunc = (func != NULL ? func : DictDefault_IsValidValue);
     if (count && rawValues && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(rawValues[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt32(keys[i]), ScalarMapPackEnum(rawValues[i]));
       }
     }
   }
@@ -2751,7 +3326,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                                     count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
@@ -2759,15 +3334,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (instancetype)initWithValidationFunction:(LCGPBEnumValidationFunc)func
                                   capacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+  self = [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -2783,30 +3361,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt32EnumDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt32(entry->key))] = @(ScalarMapUnpackEnum(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndRawValuesUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, int32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue intValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt32(entry->key), ScalarMapUnpackEnum(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -2814,8 +3396,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -2823,12 +3404,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictEnumFieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt32FieldSize(ScalarMapUnpackUInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictEnumFieldSize(ScalarMapUnpackEnum(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -2838,18 +3418,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)writeToCodedOutputStream:(LCGPBCodedOutputStream *)outputStream
                          asField:(LCGPBFieldDescriptor *)field {
-  LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
-  LCGPBDataType keyDataType = field.mapKeyDataType;
-  uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
+  LCGPBDataType keyDataType = field.mapKeyDataType;
+  uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    int32_t unwrappedValue = [aValue intValue];
+    uint32_t unwrappedKey = ScalarMapUnpackUInt32(entry->key);
+    int32_t unwrappedValue = ScalarMapUnpackEnum(entry->value);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictEnumFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -2873,7 +3451,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueEnum) forKey:@(key->valueUInt32)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key->valueUInt32), ScalarMapPackEnum(value->valueEnum));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -2884,38 +3462,37 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getEnum:(int32_t *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    int32_t result = [wrapped intValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt32(key));
+  if (entry && value) {
+    int32_t result = ScalarMapUnpackEnum(entry->value);
     if (!_validationFunc(result)) {
       result = kLCGPBUnrecognizedEnumeratorValue;
     }
     *value = result;
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (BOOL)getRawValue:(int32_t *)rawValue forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && rawValue) {
-    *rawValue = [wrapped intValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt32(key));
+  if (entry && rawValue) {
+    *rawValue = ScalarMapUnpackEnum(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)enumerateKeysAndEnumsUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, int32_t value, BOOL *stop))block {
   LCGPBEnumValidationFunc func = _validationFunc;
   BOOL stop = NO;
-  NSEnumerator *keys = [_dictionary keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = _dictionary[aKey];
-      int32_t unwrapped = [aValue intValue];
-      if (!func(unwrapped)) {
-        unwrapped = kLCGPBUnrecognizedEnumeratorValue;
-      }
-    block([aKey unsignedIntValue], unwrapped, &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    int32_t unwrapped = ScalarMapUnpackEnum(entry->value);
+    if (!func(unwrapped)) {
+      unwrapped = kLCGPBUnrecognizedEnumeratorValue;
+    }
+    block(ScalarMapUnpackUInt32(entry->key), unwrapped, &stop);
     if (stop) {
       break;
     }
@@ -2924,7 +3501,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)addRawEntriesFromDictionary:(LCGPBUInt32EnumDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -2932,18 +3509,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setRawValue:(int32_t)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key), ScalarMapPackEnum(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeEnumForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 - (void)setEnum:(int32_t)value forKey:(uint32_t)key {
@@ -2953,7 +3530,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                        value];
   }
 
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt32(key), ScalarMapPackEnum(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
@@ -3180,7 +3757,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt32UInt32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -3192,10 +3769,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt32(keys[i]), ScalarMapPackUInt32(values[i]));
       }
     }
   }
@@ -3206,22 +3783,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithUInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithUInt32s:NULL forKeys:NULL count:0];
+  self = [self initWithUInt32s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -3237,30 +3817,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt32UInt32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt32(entry->key))] = @(ScalarMapUnpackUInt32(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndUInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, uint32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue unsignedIntValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt32(entry->key), ScalarMapUnpackUInt32(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -3268,8 +3852,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -3277,12 +3860,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt32FieldSize([aValue unsignedIntValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt32FieldSize(ScalarMapUnpackInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt32FieldSize(ScalarMapUnpackUInt32(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -3295,15 +3877,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    uint32_t unwrappedValue = [aValue unsignedIntValue];
+    int32_t unwrappedKey = ScalarMapUnpackInt32(entry->key);
+    uint32_t unwrappedValue = ScalarMapUnpackUInt32(entry->value);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -3315,7 +3895,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt32) forKey:@(key->valueInt32)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key->valueInt32), ScalarMapPackUInt32(value->valueUInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -3326,16 +3906,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getUInt32:(nullable uint32_t *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedIntValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt32(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackUInt32(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBInt32UInt32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -3343,18 +3923,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setUInt32:(uint32_t)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key), ScalarMapPackUInt32(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt32ForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -3363,7 +3943,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt32Int32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -3375,10 +3955,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt32(keys[i]), ScalarMapPackInt32(values[i]));
       }
     }
   }
@@ -3389,22 +3969,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithInt32s:NULL forKeys:NULL count:0];
+  self = [self initWithInt32s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -3420,30 +4003,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt32Int32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt32(entry->key))] = @(ScalarMapUnpackInt32(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, int32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue intValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt32(entry->key), ScalarMapUnpackInt32(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -3451,8 +4038,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -3460,12 +4046,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt32FieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt32FieldSize(ScalarMapUnpackInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt32FieldSize(ScalarMapUnpackInt32(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -3478,15 +4063,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    int32_t unwrappedValue = [aValue intValue];
+    int32_t unwrappedKey = ScalarMapUnpackInt32(entry->key);
+    int32_t unwrappedValue = ScalarMapUnpackInt32(entry->value);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -3498,7 +4081,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt32) forKey:@(key->valueInt32)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key->valueInt32), ScalarMapPackInt32(value->valueInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -3509,16 +4092,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getInt32:(nullable int32_t *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped intValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt32(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackInt32(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBInt32Int32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -3526,18 +4109,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setInt32:(int32_t)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key), ScalarMapPackInt32(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt32ForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -3546,7 +4129,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt32UInt64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -3558,10 +4141,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt32(keys[i]), ScalarMapPackUInt64(values[i]));
       }
     }
   }
@@ -3572,22 +4155,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithUInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithUInt64s:NULL forKeys:NULL count:0];
+  self = [self initWithUInt64s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -3603,30 +4189,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt32UInt64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt32(entry->key))] = @(ScalarMapUnpackUInt64(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndUInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, uint64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue unsignedLongLongValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt32(entry->key), ScalarMapUnpackUInt64(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -3634,8 +4224,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -3643,12 +4232,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt64FieldSize([aValue unsignedLongLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt32FieldSize(ScalarMapUnpackInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt64FieldSize(ScalarMapUnpackUInt64(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -3661,15 +4249,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    uint64_t unwrappedValue = [aValue unsignedLongLongValue];
+    int32_t unwrappedKey = ScalarMapUnpackInt32(entry->key);
+    uint64_t unwrappedValue = ScalarMapUnpackUInt64(entry->value);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -3681,7 +4267,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt64) forKey:@(key->valueInt32)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key->valueInt32), ScalarMapPackUInt64(value->valueUInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -3692,16 +4278,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getUInt64:(nullable uint64_t *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedLongLongValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt32(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackUInt64(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBInt32UInt64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -3709,18 +4295,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setUInt64:(uint64_t)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key), ScalarMapPackUInt64(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt64ForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -3729,7 +4315,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt32Int64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -3741,10 +4327,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt32(keys[i]), ScalarMapPackInt64(values[i]));
       }
     }
   }
@@ -3755,22 +4341,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithInt64s:NULL forKeys:NULL count:0];
+  self = [self initWithInt64s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -3786,30 +4375,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt32Int64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt32(entry->key))] = @(ScalarMapUnpackInt64(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, int64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue longLongValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt32(entry->key), ScalarMapUnpackInt64(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -3817,8 +4410,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -3826,12 +4418,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt64FieldSize([aValue longLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt32FieldSize(ScalarMapUnpackInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt64FieldSize(ScalarMapUnpackInt64(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -3844,15 +4435,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    int64_t unwrappedValue = [aValue longLongValue];
+    int32_t unwrappedKey = ScalarMapUnpackInt32(entry->key);
+    int64_t unwrappedValue = ScalarMapUnpackInt64(entry->value);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -3864,7 +4453,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt64) forKey:@(key->valueInt32)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key->valueInt32), ScalarMapPackInt64(value->valueInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -3875,16 +4464,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getInt64:(nullable int64_t *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped longLongValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt32(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackInt64(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBInt32Int64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -3892,18 +4481,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setInt64:(int64_t)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key), ScalarMapPackInt64(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt64ForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -3912,7 +4501,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt32BoolDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -3924,10 +4513,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                         count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt32(keys[i]), ScalarMapPackBool(values[i]));
       }
     }
   }
@@ -3938,22 +4527,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithBools:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithBools:NULL forKeys:NULL count:0];
+  self = [self initWithBools:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -3969,30 +4561,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt32BoolDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt32(entry->key))] = @(ScalarMapUnpackBool(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndBoolsUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, BOOL value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue boolValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt32(entry->key), ScalarMapUnpackBool(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -4000,8 +4596,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -4009,12 +4604,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictBoolFieldSize([aValue boolValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt32FieldSize(ScalarMapUnpackInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictBoolFieldSize(ScalarMapUnpackBool(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -4027,15 +4621,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    BOOL unwrappedValue = [aValue boolValue];
+    int32_t unwrappedKey = ScalarMapUnpackInt32(entry->key);
+    BOOL unwrappedValue = ScalarMapUnpackBool(entry->value);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictBoolFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -4047,7 +4639,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueBool) forKey:@(key->valueInt32)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key->valueInt32), ScalarMapPackBool(value->valueBool));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -4058,16 +4650,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getBool:(nullable BOOL *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped boolValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt32(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackBool(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBInt32BoolDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -4075,18 +4667,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setBool:(BOOL)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key), ScalarMapPackBool(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeBoolForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -4095,7 +4687,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt32FloatDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -4107,10 +4699,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt32(keys[i]), ScalarMapPackFloat(values[i]));
       }
     }
   }
@@ -4121,22 +4713,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithFloats:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithFloats:NULL forKeys:NULL count:0];
+  self = [self initWithFloats:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -4152,30 +4747,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt32FloatDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt32(entry->key))] = @(ScalarMapUnpackFloat(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndFloatsUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, float value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue floatValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt32(entry->key), ScalarMapUnpackFloat(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -4183,8 +4782,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -4192,12 +4790,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictFloatFieldSize([aValue floatValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt32FieldSize(ScalarMapUnpackInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictFloatFieldSize(ScalarMapUnpackFloat(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -4208,17 +4805,15 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 - (void)writeToCodedOutputStream:(LCGPBCodedOutputStream *)outputStream
                          asField:(LCGPBFieldDescriptor *)field {
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
-  LCGPBDataType keyDataType = field.mapKeyDataType;
-  uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  LCGPBDataType keyDataType = field.mapKeyDataType;
+  uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    float unwrappedValue = [aValue floatValue];
+    int32_t unwrappedKey = ScalarMapUnpackInt32(entry->key);
+    float unwrappedValue = ScalarMapUnpackFloat(entry->value);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictFloatFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -4230,7 +4825,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueFloat) forKey:@(key->valueInt32)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key->valueInt32), ScalarMapPackFloat(value->valueFloat));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -4241,16 +4836,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getFloat:(nullable float *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped floatValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt32(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackFloat(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBInt32FloatDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -4258,18 +4853,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setFloat:(float)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key), ScalarMapPackFloat(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeFloatForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -4278,7 +4873,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt32DoubleDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -4290,10 +4885,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt32(keys[i]), ScalarMapPackDouble(values[i]));
       }
     }
   }
@@ -4304,22 +4899,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithDoubles:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithDoubles:NULL forKeys:NULL count:0];
+  self = [self initWithDoubles:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -4335,30 +4933,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt32DoubleDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt32(entry->key))] = @(ScalarMapUnpackDouble(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndDoublesUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, double value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue doubleValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt32(entry->key), ScalarMapUnpackDouble(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -4366,8 +4968,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -4375,12 +4976,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictDoubleFieldSize([aValue doubleValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt32FieldSize(ScalarMapUnpackInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictDoubleFieldSize(ScalarMapUnpackDouble(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -4393,15 +4993,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    double unwrappedValue = [aValue doubleValue];
+    int32_t unwrappedKey = ScalarMapUnpackInt32(entry->key);
+    double unwrappedValue = ScalarMapUnpackDouble(entry->value);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictDoubleFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -4413,7 +5011,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueDouble) forKey:@(key->valueInt32)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key->valueInt32), ScalarMapPackDouble(value->valueDouble));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -4424,16 +5022,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getDouble:(nullable double *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped doubleValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt32(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackDouble(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBInt32DoubleDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -4441,18 +5039,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setDouble:(double)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key), ScalarMapPackDouble(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeDoubleForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -4461,7 +5059,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt32EnumDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
   LCGPBEnumValidationFunc _validationFunc;
 }
 
@@ -4481,11 +5079,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                                      count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     _validationFunc = (func != NULL ? func : DictDefault_IsValidValue);
     if (count && rawValues && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(rawValues[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt32(keys[i]), ScalarMapPackEnum(rawValues[i]));
       }
     }
   }
@@ -4499,7 +5097,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                                     count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
@@ -4507,15 +5105,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (instancetype)initWithValidationFunction:(LCGPBEnumValidationFunc)func
                                   capacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+  self = [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -4531,30 +5132,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt32EnumDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt32(entry->key))] = @(ScalarMapUnpackEnum(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndRawValuesUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, int32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue intValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt32(entry->key), ScalarMapUnpackEnum(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -4562,8 +5167,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -4571,12 +5175,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictEnumFieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt32FieldSize(ScalarMapUnpackInt32(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictEnumFieldSize(ScalarMapUnpackEnum(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -4589,15 +5192,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    int32_t unwrappedValue = [aValue intValue];
+    int32_t unwrappedKey = ScalarMapUnpackInt32(entry->key);
+    int32_t unwrappedValue = ScalarMapUnpackEnum(entry->value);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictEnumFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -4621,7 +5222,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueEnum) forKey:@(key->valueInt32)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key->valueInt32), ScalarMapPackEnum(value->valueEnum));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -4632,38 +5233,37 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getEnum:(int32_t *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    int32_t result = [wrapped intValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt32(key));
+  if (entry && value) {
+    int32_t result = ScalarMapUnpackEnum(entry->value);
     if (!_validationFunc(result)) {
       result = kLCGPBUnrecognizedEnumeratorValue;
     }
     *value = result;
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (BOOL)getRawValue:(int32_t *)rawValue forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && rawValue) {
-    *rawValue = [wrapped intValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt32(key));
+  if (entry && rawValue) {
+    *rawValue = ScalarMapUnpackEnum(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)enumerateKeysAndEnumsUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, int32_t value, BOOL *stop))block {
   LCGPBEnumValidationFunc func = _validationFunc;
   BOOL stop = NO;
-  NSEnumerator *keys = [_dictionary keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = _dictionary[aKey];
-      int32_t unwrapped = [aValue intValue];
-      if (!func(unwrapped)) {
-        unwrapped = kLCGPBUnrecognizedEnumeratorValue;
-      }
-    block([aKey intValue], unwrapped, &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    int32_t unwrapped = ScalarMapUnpackEnum(entry->value);
+    if (!func(unwrapped)) {
+      unwrapped = kLCGPBUnrecognizedEnumeratorValue;
+    }
+    block(ScalarMapUnpackInt32(entry->key), unwrapped, &stop);
     if (stop) {
       break;
     }
@@ -4672,7 +5272,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)addRawEntriesFromDictionary:(LCGPBInt32EnumDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -4680,18 +5280,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setRawValue:(int32_t)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key), ScalarMapPackEnum(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeEnumForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 - (void)setEnum:(int32_t)value forKey:(int32_t)key {
@@ -4701,7 +5301,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                        value];
   }
 
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt32(key), ScalarMapPackEnum(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
@@ -4928,7 +5528,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt64UInt32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -4940,10 +5540,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt64(keys[i]), ScalarMapPackUInt32(values[i]));
       }
     }
   }
@@ -4954,22 +5554,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithUInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithUInt32s:NULL forKeys:NULL count:0];
+  self = [self initWithUInt32s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -4985,30 +5588,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt64UInt32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt64(entry->key))] = @(ScalarMapUnpackUInt32(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndUInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, uint32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue unsignedIntValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt64(entry->key), ScalarMapUnpackUInt32(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -5016,8 +5623,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -5025,12 +5631,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt32FieldSize([aValue unsignedIntValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt64FieldSize(ScalarMapUnpackUInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt32FieldSize(ScalarMapUnpackUInt32(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -5043,15 +5648,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    uint32_t unwrappedValue = [aValue unsignedIntValue];
+    uint64_t unwrappedKey = ScalarMapUnpackUInt64(entry->key);
+    uint32_t unwrappedValue = ScalarMapUnpackUInt32(entry->value);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -5063,7 +5666,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt32) forKey:@(key->valueUInt64)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key->valueUInt64), ScalarMapPackUInt32(value->valueUInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -5074,16 +5677,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getUInt32:(nullable uint32_t *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedIntValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt64(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackUInt32(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBUInt64UInt32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -5091,18 +5694,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setUInt32:(uint32_t)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key), ScalarMapPackUInt32(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt32ForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -5111,7 +5714,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt64Int32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -5123,10 +5726,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt64(keys[i]), ScalarMapPackInt32(values[i]));
       }
     }
   }
@@ -5137,22 +5740,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithInt32s:NULL forKeys:NULL count:0];
+  self = [self initWithInt32s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -5168,30 +5774,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt64Int32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt64(entry->key))] = @(ScalarMapUnpackInt32(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, int32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue intValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt64(entry->key), ScalarMapUnpackInt32(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -5199,8 +5809,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -5208,12 +5817,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt32FieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt64FieldSize(ScalarMapUnpackUInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt32FieldSize(ScalarMapUnpackInt32(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -5226,15 +5834,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    int32_t unwrappedValue = [aValue intValue];
+    uint64_t unwrappedKey = ScalarMapUnpackUInt64(entry->key);
+    int32_t unwrappedValue = ScalarMapUnpackInt32(entry->value);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -5246,7 +5852,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt32) forKey:@(key->valueUInt64)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key->valueUInt64), ScalarMapPackInt32(value->valueInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -5257,16 +5863,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getInt32:(nullable int32_t *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped intValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt64(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackInt32(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBUInt64Int32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -5274,18 +5880,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setInt32:(int32_t)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key), ScalarMapPackInt32(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt32ForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -5294,7 +5900,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt64UInt64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -5306,10 +5912,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt64(keys[i]), ScalarMapPackUInt64(values[i]));
       }
     }
   }
@@ -5320,22 +5926,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithUInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithUInt64s:NULL forKeys:NULL count:0];
+  self = [self initWithUInt64s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -5351,30 +5960,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt64UInt64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt64(entry->key))] = @(ScalarMapUnpackUInt64(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndUInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, uint64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue unsignedLongLongValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt64(entry->key), ScalarMapUnpackUInt64(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -5382,8 +5995,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -5391,12 +6003,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt64FieldSize([aValue unsignedLongLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt64FieldSize(ScalarMapUnpackUInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt64FieldSize(ScalarMapUnpackUInt64(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -5409,15 +6020,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    uint64_t unwrappedValue = [aValue unsignedLongLongValue];
+    uint64_t unwrappedKey = ScalarMapUnpackUInt64(entry->key);
+    uint64_t unwrappedValue = ScalarMapUnpackUInt64(entry->value);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -5429,7 +6038,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt64) forKey:@(key->valueUInt64)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key->valueUInt64), ScalarMapPackUInt64(value->valueUInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -5440,16 +6049,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getUInt64:(nullable uint64_t *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedLongLongValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt64(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackUInt64(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBUInt64UInt64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -5457,18 +6066,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setUInt64:(uint64_t)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key), ScalarMapPackUInt64(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt64ForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -5477,7 +6086,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt64Int64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -5489,10 +6098,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt64(keys[i]), ScalarMapPackInt64(values[i]));
       }
     }
   }
@@ -5503,22 +6112,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithInt64s:NULL forKeys:NULL count:0];
+  self = [self initWithInt64s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -5534,30 +6146,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt64Int64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt64(entry->key))] = @(ScalarMapUnpackInt64(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, int64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue longLongValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt64(entry->key), ScalarMapUnpackInt64(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -5565,8 +6181,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -5574,12 +6189,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt64FieldSize([aValue longLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt64FieldSize(ScalarMapUnpackUInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt64FieldSize(ScalarMapUnpackInt64(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -5588,19 +6202,17 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)writeToCodedOutputStream:(LCGPBCodedOutputStream *)outputStream
-                         asField:(LCGPBFieldDescriptor *)field {
-  LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
-  LCGPBDataType keyDataType = field.mapKeyDataType;
-  uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+                         asField:(LCGPBFieldDescriptor *)field {
+  LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
+  LCGPBDataType keyDataType = field.mapKeyDataType;
+  uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    int64_t unwrappedValue = [aValue longLongValue];
+    uint64_t unwrappedKey = ScalarMapUnpackUInt64(entry->key);
+    int64_t unwrappedValue = ScalarMapUnpackInt64(entry->value);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -5612,7 +6224,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt64) forKey:@(key->valueUInt64)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key->valueUInt64), ScalarMapPackInt64(value->valueInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -5623,16 +6235,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getInt64:(nullable int64_t *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped longLongValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt64(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackInt64(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBUInt64Int64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -5640,18 +6252,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setInt64:(int64_t)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key), ScalarMapPackInt64(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt64ForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -5660,7 +6272,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt64BoolDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -5672,10 +6284,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                         count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt64(keys[i]), ScalarMapPackBool(values[i]));
       }
     }
   }
@@ -5686,22 +6298,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithBools:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithBools:NULL forKeys:NULL count:0];
+  self = [self initWithBools:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -5717,30 +6332,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt64BoolDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt64(entry->key))] = @(ScalarMapUnpackBool(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndBoolsUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, BOOL value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue boolValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt64(entry->key), ScalarMapUnpackBool(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -5748,8 +6367,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -5757,12 +6375,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictBoolFieldSize([aValue boolValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt64FieldSize(ScalarMapUnpackUInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictBoolFieldSize(ScalarMapUnpackBool(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -5775,15 +6392,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    BOOL unwrappedValue = [aValue boolValue];
+    uint64_t unwrappedKey = ScalarMapUnpackUInt64(entry->key);
+    BOOL unwrappedValue = ScalarMapUnpackBool(entry->value);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictBoolFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -5795,7 +6410,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueBool) forKey:@(key->valueUInt64)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key->valueUInt64), ScalarMapPackBool(value->valueBool));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -5806,16 +6421,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getBool:(nullable BOOL *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped boolValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt64(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackBool(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBUInt64BoolDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -5823,18 +6438,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setBool:(BOOL)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key), ScalarMapPackBool(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeBoolForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -5843,7 +6458,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt64FloatDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -5855,10 +6470,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt64(keys[i]), ScalarMapPackFloat(values[i]));
       }
     }
   }
@@ -5869,22 +6484,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithFloats:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithFloats:NULL forKeys:NULL count:0];
+  self = [self initWithFloats:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -5900,30 +6518,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt64FloatDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt64(entry->key))] = @(ScalarMapUnpackFloat(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndFloatsUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, float value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue floatValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt64(entry->key), ScalarMapUnpackFloat(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -5931,8 +6553,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -5940,12 +6561,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictFloatFieldSize([aValue floatValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt64FieldSize(ScalarMapUnpackUInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictFloatFieldSize(ScalarMapUnpackFloat(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -5958,15 +6578,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    float unwrappedValue = [aValue floatValue];
+    uint64_t unwrappedKey = ScalarMapUnpackUInt64(entry->key);
+    float unwrappedValue = ScalarMapUnpackFloat(entry->value);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictFloatFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -5978,7 +6596,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueFloat) forKey:@(key->valueUInt64)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key->valueUInt64), ScalarMapPackFloat(value->valueFloat));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -5989,16 +6607,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getFloat:(nullable float *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped floatValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt64(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackFloat(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBUInt64FloatDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -6006,18 +6624,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setFloat:(float)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key), ScalarMapPackFloat(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeFloatForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -6026,7 +6644,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt64DoubleDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -6038,10 +6656,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt64(keys[i]), ScalarMapPackDouble(values[i]));
       }
     }
   }
@@ -6052,22 +6670,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithDoubles:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithDoubles:NULL forKeys:NULL count:0];
+  self = [self initWithDoubles:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -6083,30 +6704,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt64DoubleDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt64(entry->key))] = @(ScalarMapUnpackDouble(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndDoublesUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, double value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue doubleValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt64(entry->key), ScalarMapUnpackDouble(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -6114,8 +6739,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -6123,12 +6747,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictDoubleFieldSize([aValue doubleValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt64FieldSize(ScalarMapUnpackUInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictDoubleFieldSize(ScalarMapUnpackDouble(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -6141,15 +6764,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    double unwrappedValue = [aValue doubleValue];
+    uint64_t unwrappedKey = ScalarMapUnpackUInt64(entry->key);
+    double unwrappedValue = ScalarMapUnpackDouble(entry->value);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictDoubleFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -6161,7 +6782,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueDouble) forKey:@(key->valueUInt64)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key->valueUInt64), ScalarMapPackDouble(value->valueDouble));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -6172,16 +6793,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getDouble:(nullable double *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped doubleValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt64(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackDouble(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBUInt64DoubleDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -6189,18 +6810,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setDouble:(double)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key), ScalarMapPackDouble(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeDoubleForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -6209,7 +6830,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBUInt64EnumDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
   LCGPBEnumValidationFunc _validationFunc;
 }
 
@@ -6229,11 +6850,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                                      count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     _validationFunc = (func != NULL ? func : DictDefault_IsValidValue);
     if (count && rawValues && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(rawValues[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackUInt64(keys[i]), ScalarMapPackEnum(rawValues[i]));
       }
     }
   }
@@ -6247,7 +6868,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                                     count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
@@ -6255,15 +6876,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (instancetype)initWithValidationFunction:(LCGPBEnumValidationFunc)func
                                   capacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+  self = [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -6279,30 +6903,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBUInt64EnumDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackUInt64(entry->key))] = @(ScalarMapUnpackEnum(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndRawValuesUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, int32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue intValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackUInt64(entry->key), ScalarMapUnpackEnum(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -6310,8 +6938,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -6319,12 +6946,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictEnumFieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictUInt64FieldSize(ScalarMapUnpackUInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictEnumFieldSize(ScalarMapUnpackEnum(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -6337,15 +6963,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    int32_t unwrappedValue = [aValue intValue];
+    uint64_t unwrappedKey = ScalarMapUnpackUInt64(entry->key);
+    int32_t unwrappedValue = ScalarMapUnpackEnum(entry->value);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictEnumFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -6369,7 +6993,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueEnum) forKey:@(key->valueUInt64)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key->valueUInt64), ScalarMapPackEnum(value->valueEnum));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -6380,38 +7004,37 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getEnum:(int32_t *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    int32_t result = [wrapped intValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt64(key));
+  if (entry && value) {
+    int32_t result = ScalarMapUnpackEnum(entry->value);
     if (!_validationFunc(result)) {
       result = kLCGPBUnrecognizedEnumeratorValue;
     }
     *value = result;
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (BOOL)getRawValue:(int32_t *)rawValue forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && rawValue) {
-    *rawValue = [wrapped intValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackUInt64(key));
+  if (entry && rawValue) {
+    *rawValue = ScalarMapUnpackEnum(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)enumerateKeysAndEnumsUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, int32_t value, BOOL *stop))block {
   LCGPBEnumValidationFunc func = _validationFunc;
   BOOL stop = NO;
-  NSEnumerator *keys = [_dictionary keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = _dictionary[aKey];
-      int32_t unwrapped = [aValue intValue];
-      if (!func(unwrapped)) {
-        unwrapped = kLCGPBUnrecognizedEnumeratorValue;
-      }
-    block([aKey unsignedLongLongValue], unwrapped, &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    int32_t unwrapped = ScalarMapUnpackEnum(entry->value);
+    if (!func(unwrapped)) {
+      unwrapped = kLCGPBUnrecognizedEnumeratorValue;
+    }
+    block(ScalarMapUnpackUInt64(entry->key), unwrapped, &stop);
     if (stop) {
       break;
     }
@@ -6420,7 +7043,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)addRawEntriesFromDictionary:(LCGPBUInt64EnumDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -6428,18 +7051,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setRawValue:(int32_t)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key), ScalarMapPackEnum(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeEnumForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackUInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 - (void)setEnum:(int32_t)value forKey:(uint64_t)key {
@@ -6449,7 +7072,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                        value];
   }
 
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackUInt64(key), ScalarMapPackEnum(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
@@ -6676,7 +7299,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt64UInt32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -6688,10 +7311,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt64(keys[i]), ScalarMapPackUInt32(values[i]));
       }
     }
   }
@@ -6702,22 +7325,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithUInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithUInt32s:NULL forKeys:NULL count:0];
+  self = [self initWithUInt32s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -6733,30 +7359,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt64UInt32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt64(entry->key))] = @(ScalarMapUnpackUInt32(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndUInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, uint32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue unsignedIntValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt64(entry->key), ScalarMapUnpackUInt32(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -6764,8 +7394,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -6773,12 +7402,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt32FieldSize([aValue unsignedIntValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt64FieldSize(ScalarMapUnpackInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt32FieldSize(ScalarMapUnpackUInt32(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -6791,15 +7419,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    uint32_t unwrappedValue = [aValue unsignedIntValue];
+    int64_t unwrappedKey = ScalarMapUnpackInt64(entry->key);
+    uint32_t unwrappedValue = ScalarMapUnpackUInt32(entry->value);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -6811,7 +7437,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt32) forKey:@(key->valueInt64)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key->valueInt64), ScalarMapPackUInt32(value->valueUInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -6822,16 +7448,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getUInt32:(nullable uint32_t *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedIntValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt64(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackUInt32(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBInt64UInt32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -6839,18 +7465,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setUInt32:(uint32_t)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key), ScalarMapPackUInt32(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt32ForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -6859,7 +7485,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt64Int32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -6871,10 +7497,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt64(keys[i]), ScalarMapPackInt32(values[i]));
       }
     }
   }
@@ -6885,22 +7511,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithInt32s:NULL forKeys:NULL count:0];
+  self = [self initWithInt32s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -6916,30 +7545,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt64Int32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt64(entry->key))] = @(ScalarMapUnpackInt32(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, int32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue intValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt64(entry->key), ScalarMapUnpackInt32(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -6947,8 +7580,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -6956,12 +7588,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt32FieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt64FieldSize(ScalarMapUnpackInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt32FieldSize(ScalarMapUnpackInt32(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -6974,15 +7605,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    int32_t unwrappedValue = [aValue intValue];
+    int64_t unwrappedKey = ScalarMapUnpackInt64(entry->key);
+    int32_t unwrappedValue = ScalarMapUnpackInt32(entry->value);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -6994,7 +7623,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt32) forKey:@(key->valueInt64)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key->valueInt64), ScalarMapPackInt32(value->valueInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -7005,16 +7634,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getInt32:(nullable int32_t *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped intValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt64(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackInt32(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBInt64Int32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -7022,18 +7651,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setInt32:(int32_t)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key), ScalarMapPackInt32(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt32ForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -7042,7 +7671,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt64UInt64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -7054,10 +7683,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt64(keys[i]), ScalarMapPackUInt64(values[i]));
       }
     }
   }
@@ -7068,22 +7697,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithUInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithUInt64s:NULL forKeys:NULL count:0];
+  self = [self initWithUInt64s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -7099,30 +7731,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt64UInt64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt64(entry->key))] = @(ScalarMapUnpackUInt64(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndUInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, uint64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue unsignedLongLongValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt64(entry->key), ScalarMapUnpackUInt64(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -7130,8 +7766,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -7139,12 +7774,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt64FieldSize([aValue unsignedLongLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt64FieldSize(ScalarMapUnpackInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt64FieldSize(ScalarMapUnpackUInt64(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -7157,15 +7791,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    uint64_t unwrappedValue = [aValue unsignedLongLongValue];
+    int64_t unwrappedKey = ScalarMapUnpackInt64(entry->key);
+    uint64_t unwrappedValue = ScalarMapUnpackUInt64(entry->value);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -7177,7 +7809,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt64) forKey:@(key->valueInt64)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key->valueInt64), ScalarMapPackUInt64(value->valueUInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -7188,16 +7820,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getUInt64:(nullable uint64_t *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedLongLongValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt64(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackUInt64(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBInt64UInt64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -7205,18 +7837,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setUInt64:(uint64_t)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key), ScalarMapPackUInt64(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt64ForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -7225,7 +7857,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt64Int64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -7237,10 +7869,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt64(keys[i]), ScalarMapPackInt64(values[i]));
       }
     }
   }
@@ -7251,22 +7883,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithInt64s:NULL forKeys:NULL count:0];
+  self = [self initWithInt64s:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -7282,30 +7917,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt64Int64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt64(entry->key))] = @(ScalarMapUnpackInt64(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, int64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue longLongValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt64(entry->key), ScalarMapUnpackInt64(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -7313,8 +7952,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -7322,12 +7960,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt64FieldSize([aValue longLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt64FieldSize(ScalarMapUnpackInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt64FieldSize(ScalarMapUnpackInt64(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -7340,15 +7977,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    int64_t unwrappedValue = [aValue longLongValue];
+    int64_t unwrappedKey = ScalarMapUnpackInt64(entry->key);
+    int64_t unwrappedValue = ScalarMapUnpackInt64(entry->value);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -7360,7 +7995,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt64) forKey:@(key->valueInt64)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key->valueInt64), ScalarMapPackInt64(value->valueInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -7371,16 +8006,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getInt64:(nullable int64_t *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped longLongValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt64(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackInt64(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBInt64Int64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -7388,18 +8023,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setInt64:(int64_t)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key), ScalarMapPackInt64(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt64ForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -7408,7 +8043,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt64BoolDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -7420,10 +8055,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                         count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt64(keys[i]), ScalarMapPackBool(values[i]));
       }
     }
   }
@@ -7434,22 +8069,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithBools:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithBools:NULL forKeys:NULL count:0];
+  self = [self initWithBools:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -7465,30 +8103,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt64BoolDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt64(entry->key))] = @(ScalarMapUnpackBool(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndBoolsUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, BOOL value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue boolValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt64(entry->key), ScalarMapUnpackBool(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -7496,8 +8138,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -7505,12 +8146,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictBoolFieldSize([aValue boolValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt64FieldSize(ScalarMapUnpackInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictBoolFieldSize(ScalarMapUnpackBool(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -7523,15 +8163,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    BOOL unwrappedValue = [aValue boolValue];
+    int64_t unwrappedKey = ScalarMapUnpackInt64(entry->key);
+    BOOL unwrappedValue = ScalarMapUnpackBool(entry->value);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictBoolFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -7543,7 +8181,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueBool) forKey:@(key->valueInt64)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key->valueInt64), ScalarMapPackBool(value->valueBool));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -7554,16 +8192,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getBool:(nullable BOOL *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped boolValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt64(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackBool(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBInt64BoolDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -7571,18 +8209,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setBool:(BOOL)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key), ScalarMapPackBool(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeBoolForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -7591,7 +8229,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt64FloatDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -7603,10 +8241,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt64(keys[i]), ScalarMapPackFloat(values[i]));
       }
     }
   }
@@ -7617,22 +8255,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithFloats:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithFloats:NULL forKeys:NULL count:0];
+  self = [self initWithFloats:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -7648,30 +8289,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt64FloatDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt64(entry->key))] = @(ScalarMapUnpackFloat(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndFloatsUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, float value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue floatValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt64(entry->key), ScalarMapUnpackFloat(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -7679,8 +8324,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -7688,12 +8332,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictFloatFieldSize([aValue floatValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt64FieldSize(ScalarMapUnpackInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictFloatFieldSize(ScalarMapUnpackFloat(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -7706,15 +8349,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    float unwrappedValue = [aValue floatValue];
+    int64_t unwrappedKey = ScalarMapUnpackInt64(entry->key);
+    float unwrappedValue = ScalarMapUnpackFloat(entry->value);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictFloatFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -7726,7 +8367,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueFloat) forKey:@(key->valueInt64)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key->valueInt64), ScalarMapPackFloat(value->valueFloat));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -7737,16 +8378,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getFloat:(nullable float *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped floatValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt64(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackFloat(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBInt64FloatDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -7754,18 +8395,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setFloat:(float)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key), ScalarMapPackFloat(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeFloatForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -7774,7 +8415,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt64DoubleDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
 }
 
 - (instancetype)init {
@@ -7786,10 +8427,10 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt64(keys[i]), ScalarMapPackDouble(values[i]));
       }
     }
   }
@@ -7800,22 +8441,25 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   self = [self initWithDoubles:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithDoubles:NULL forKeys:NULL count:0];
+  self = [self initWithDoubles:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -7831,30 +8475,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt64DoubleDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt64(entry->key))] = @(ScalarMapUnpackDouble(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndDoublesUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, double value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue doubleValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt64(entry->key), ScalarMapUnpackDouble(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -7862,8 +8510,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -7871,12 +8518,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictDoubleFieldSize([aValue doubleValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt64FieldSize(ScalarMapUnpackInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictDoubleFieldSize(ScalarMapUnpackDouble(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -7889,15 +8535,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    double unwrappedValue = [aValue doubleValue];
+    int64_t unwrappedKey = ScalarMapUnpackInt64(entry->key);
+    double unwrappedValue = ScalarMapUnpackDouble(entry->value);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictDoubleFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -7909,7 +8553,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueDouble) forKey:@(key->valueInt64)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key->valueInt64), ScalarMapPackDouble(value->valueDouble));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -7920,16 +8564,16 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getDouble:(nullable double *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped doubleValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt64(key));
+  if (entry && value) {
+    *value = ScalarMapUnpackDouble(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)addEntriesFromDictionary:(LCGPBInt64DoubleDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -7937,18 +8581,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setDouble:(double)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key), ScalarMapPackDouble(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeDoubleForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 @end
@@ -7957,7 +8601,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 @implementation LCGPBInt64EnumDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  LCGPBScalarMap _map;
   LCGPBEnumValidationFunc _validationFunc;
 }
 
@@ -7977,11 +8621,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                                      count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     _validationFunc = (func != NULL ? func : DictDefault_IsValidValue);
     if (count && rawValues && keys) {
+      ScalarMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(rawValues[i]) forKey:@(keys[i])];
+        ScalarMapSet(&_map, ScalarMapPackInt64(keys[i]), ScalarMapPackEnum(rawValues[i]));
       }
     }
   }
@@ -7995,7 +8639,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                                     count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      ScalarMapAddEntries(&_map, &dictionary->_map);
     }
   }
   return self;
@@ -8003,15 +8647,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (instancetype)initWithValidationFunction:(LCGPBEnumValidationFunc)func
                                   capacity:(NSUInteger)numItems {
-  #pragma unused(numItems)
-  return [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+  self = [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+  if (self && numItems) {
+    ScalarMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  ScalarMapFree(&_map);
   [super dealloc];
 }
 
@@ -8027,30 +8674,34 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
     return NO;
   }
   LCGPBInt64EnumDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  return ScalarMapIsEqual(&_map, &otherDictionary->_map);
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:_map.count];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    entries[@(ScalarMapUnpackInt64(entry->key))] = @(ScalarMapUnpackEnum(entry->value));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return _map.count;
 }
 
 - (void)enumerateKeysAndRawValuesUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, int32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue intValue], &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    block(ScalarMapUnpackInt64(entry->key), ScalarMapUnpackEnum(entry->value), &stop);
     if (stop) {
       break;
     }
@@ -8058,8 +8709,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (size_t)computeSerializedSizeAsField:(LCGPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = _map.count;
   if (count == 0) {
     return 0;
   }
@@ -8067,12 +8717,11 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictEnumFieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    size_t msgSize = ComputeDictInt64FieldSize(ScalarMapUnpackInt64(entry->key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictEnumFieldSize(ScalarMapUnpackEnum(entry->value), kMapValueFieldNumber, valueDataType);
     result += LCGPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = LCGPBComputeWireFormatTagSize(LCGPBFieldNumber(field), LCGPBDataTypeMessage);
@@ -8085,15 +8734,13 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
   LCGPBDataType valueDataType = LCGPBGetFieldDataType(field);
   LCGPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = LCGPBWireFormatMakeTag(LCGPBFieldNumber(field), LCGPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    int32_t unwrappedValue = [aValue intValue];
+    int64_t unwrappedKey = ScalarMapUnpackInt64(entry->key);
+    int32_t unwrappedValue = ScalarMapUnpackEnum(entry->value);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictEnumFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -8117,7 +8764,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 - (void)setLCGPBGenericValue:(LCGPBGenericValue *)value
      forLCGPBGenericValueKey:(LCGPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueEnum) forKey:@(key->valueInt64)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key->valueInt64), ScalarMapPackEnum(value->valueEnum));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -8128,38 +8775,37 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (BOOL)getEnum:(int32_t *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    int32_t result = [wrapped intValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt64(key));
+  if (entry && value) {
+    int32_t result = ScalarMapUnpackEnum(entry->value);
     if (!_validationFunc(result)) {
       result = kLCGPBUnrecognizedEnumeratorValue;
     }
     *value = result;
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (BOOL)getRawValue:(int32_t *)rawValue forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && rawValue) {
-    *rawValue = [wrapped intValue];
+  const LCGPBScalarMapEntry *entry = ScalarMapFind(&_map, ScalarMapPackInt64(key));
+  if (entry && rawValue) {
+    *rawValue = ScalarMapUnpackEnum(entry->value);
   }
-  return (wrapped != NULL);
+  return (entry != NULL);
 }
 
 - (void)enumerateKeysAndEnumsUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, int32_t value, BOOL *stop))block {
   LCGPBEnumValidationFunc func = _validationFunc;
   BOOL stop = NO;
-  NSEnumerator *keys = [_dictionary keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = _dictionary[aKey];
-      int32_t unwrapped = [aValue intValue];
-      if (!func(unwrapped)) {
-        unwrapped = kLCGPBUnrecognizedEnumeratorValue;
-      }
-    block([aKey longLongValue], unwrapped, &stop);
+  NSUInteger index = 0;
+  const LCGPBScalarMapEntry *entry;
+  while ((entry = ScalarMapNextEntry(&_map, &index))) {
+    int32_t unwrapped = ScalarMapUnpackEnum(entry->value);
+    if (!func(unwrapped)) {
+      unwrapped = kLCGPBUnrecognizedEnumeratorValue;
+    }
+    block(ScalarMapUnpackInt64(entry->key), unwrapped, &stop);
     if (stop) {
       break;
     }
@@ -8168,7 +8814,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 
 - (void)addRawEntriesFromDictionary:(LCGPBInt64EnumDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    ScalarMapAddEntries(&_map, &otherDictionary->_map);
     if (_autocreator) {
       LCGPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -8176,18 +8822,18 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
 }
 
 - (void)setRawValue:(int32_t)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key), ScalarMapPackEnum(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeEnumForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  ScalarMapRemove(&_map, ScalarMapPackInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  ScalarMapRemoveAll(&_map);
 }
 
 - (void)setEnum:(int32_t)value forKey:(int64_t)key {
@@ -8197,7 +8843,7 @@ void LCGPBDictionaryReadEntry(id mapDictionary,
                        value];
   }
 
-  [_dictionary setObject:@(value) forKey:@(key)];
+  ScalarMapSet(&_map, ScalarMapPackInt64(key), ScalarMapPackEnum(value));
   if (_autocreator) {
     LCGPBAutocreatedDictionaryModified(_autocreator, self);
   }
@@ -342,6 +342,25 @@ CF_EXTERN_C_END
  **/
 - (nullable NSData *)data;
 
+/**
+ * Serializes the message into the given data, starting at the given offset.
+ *
+ * The length of the data is set to the offset plus the serialized size of the
+ * message. The bytes in front of the offset are left as they are, so room for a
+ * header can be reserved there, and the same data can be reused for several
+ * messages instead of allocating a new one for each.
+ *
+ * @note In DEBUG ONLY, the message is also checked for all required field,
+ *       if one is missing, NO will be returned.
+ *
+ * @param data   The data to write the message into.
+ * @param offset The position in the data at which the message starts.
+ *
+ * @return YES if the message was written, NO otherwise (the length of the data
+ *         is then set to the offset).
+ **/
+- (BOOL)writeToData:(NSMutableData *)data offset:(NSUInteger)offset;
+
 /**
  * Serializes a varint with the message size followed by the message data,
  * returning that as an NSData.
@@ -32,6 +32,7 @@
 
 #import <objc/runtime.h>
 #import <objc/message.h>
+#import <pthread.h>
 #import <stdatomic.h>
 
 #import "LCGPBArray_PackagePrivate.h"
@@ -143,6 +144,39 @@ static NSError *ErrorFromException(NSException *exception) {
   return error;
 }
 
+// Writing a message calls -serializedSize once for the whole tree and then
+// again for every submessage to emit its length prefix, so nested messages are
+// sized once per level of nesting.  While a message is being written the tree
+// can't change, so the sizes computed during that write are remembered here
+// (per thread, keyed by message) and reused.
+static pthread_key_t gSerializedSizeCacheKey;
+static pthread_once_t gSerializedSizeCacheKeyOnce = PTHREAD_ONCE_INIT;
+
+static void CreateSerializedSizeCacheKey(void) {
+  pthread_key_create(&gSerializedSizeCacheKey, NULL);
+}
+
+// Returns YES if this call started the cache; nested writes reuse the outer
+// one and must not end it.
+static BOOL BeginCachingSerializedSizes(void) {
+  pthread_once(&gSerializedSizeCacheKeyOnce, CreateSerializedSizeCacheKey);
+  if (pthread_getspecific(gSerializedSizeCacheKey)) {
+    return NO;
+  }
+  CFMutableDictionaryRef cache = CFDictionaryCreateMutable(NULL, 0, NULL, NULL);
+  pthread_setspecific(gSerializedSizeCacheKey, cache);
+  return YES;
+}
+
+static void EndCachingSerializedSizes(BOOL didBegin) {
+  if (!didBegin) {
+    return;
+  }
+  CFMutableDictionaryRef cache = pthread_getspecific(gSerializedSizeCacheKey);
+  pthread_setspecific(gSerializedSizeCacheKey, NULL);
+  CFRelease(cache);
+}
+
 static void CheckExtension(LCGPBMessage *self,
                            LCGPBExtensionDescriptor *extension) {
   if (![self isKindOfClass:extension.containingMessageClass]) {
@@ -1225,48 +1259,93 @@ static LCGPBUnknownFieldSet *GetOrMakeUnknownFields(LCGPBMessage *self) {
     return nil;
   }
 #endif
-  NSMutableData *data = [NSMutableData dataWithLength:[self serializedSize]];
-  LCGPBCodedOutputStream *stream =
-      [[LCGPBCodedOutputStream alloc] initWithData:data];
+  NSMutableData *data = nil;
+  BOOL didBeginCaching = BeginCachingSerializedSizes();
   @try {
-    [self writeToCodedOutputStream:stream];
-  }
-  @catch (NSException *exception) {
-    // This really shouldn't happen. The only way writeToCodedOutputStream:
-    // could throw is if something in the library has a bug and the
-    // serializedSize was wrong.
+    data = [NSMutableData dataWithLength:[self serializedSize]];
+    LCGPBCodedOutputStream *stream =
+        [[LCGPBCodedOutputStream alloc] initWithData:data];
+    @try {
+      [self writeToCodedOutputStream:stream];
+    }
+    @catch (NSException *exception) {
+      // This really shouldn't happen. The only way writeToCodedOutputStream:
+      // could throw is if something in the library has a bug and the
+      // serializedSize was wrong.
 #ifdef DEBUG
-    NSLog(@"%@: Internal exception while building message data: %@",
-          [self class], exception);
+      NSLog(@"%@: Internal exception while building message data: %@",
+            [self class], exception);
 #endif
-    data = nil;
+      data = nil;
+    }
+    [stream release];
+  }
+  @finally {
+    EndCachingSerializedSizes(didBeginCaching);
   }
-  [stream release];
   return data;
 }
 
-- (NSData *)delimitedData {
-  size_t serializedSize = [self serializedSize];
-  size_t varintSize = LCGPBComputeRawVarint32SizeForInteger(serializedSize);
-  NSMutableData *data =
-      [NSMutableData dataWithLength:(serializedSize + varintSize)];
-  LCGPBCodedOutputStream *stream =
-      [[LCGPBCodedOutputStream alloc] initWithData:data];
+- (BOOL)writeToData:(NSMutableData *)data offset:(NSUInteger)offset {
+#ifdef DEBUG
+  if (!self.initialized) {
+    return NO;
+  }
+#endif
+  BOOL result = YES;
+  BOOL didBeginCaching = BeginCachingSerializedSizes();
   @try {
-    [self writeDelimitedToCodedOutputStream:stream];
+    data.length = offset + [self serializedSize];
+    LCGPBCodedOutputStream *stream =
+        [[LCGPBCodedOutputStream alloc] initWithData:data offset:offset];
+    @try {
+      [self writeToCodedOutputStream:stream];
+    }
+    @catch (NSException *exception) {
+      // As with -data, this only happens if serializedSize was wrong.
+#ifdef DEBUG
+      NSLog(@"%@: Internal exception while writing message data: %@",
+            [self class], exception);
+#endif
+      data.length = offset;
+      result = NO;
+    }
+    [stream release];
   }
-  @catch (NSException *exception) {
-    // This really shouldn't happen.  The only way writeToCodedOutputStream:
-    // could throw is if something in the library has a bug and the
-    // serializedSize was wrong.
+  @finally {
+    EndCachingSerializedSizes(didBeginCaching);
+  }
+  return result;
+}
+
+- (NSData *)delimitedData {
+  NSMutableData *data = nil;
+  BOOL didBeginCaching = BeginCachingSerializedSizes();
+  @try {
+    size_t serializedSize = [self serializedSize];
+    size_t varintSize = LCGPBComputeRawVarint32SizeForInteger(serializedSize);
+    data = [NSMutableData dataWithLength:(serializedSize + varintSize)];
+    LCGPBCodedOutputStream *stream =
+        [[LCGPBCodedOutputStream alloc] initWithData:data];
+    @try {
+      [self writeDelimitedToCodedOutputStream:stream];
+    }
+    @catch (NSException *exception) {
+      // This really shouldn't happen.  The only way writeToCodedOutputStream:
+      // could throw is if something in the library has a bug and the
+      // serializedSize was wrong.
 #ifdef DEBUG
-    NSLog(@"%@: Internal exception while building message delimitedData: %@",
-          [self class], exception);
+      NSLog(@"%@: Internal exception while building message delimitedData: %@",
+            [self class], exception);
 #endif
-    // If it happens, truncate.
-    data.length = 0;
+      // If it happens, truncate.
+      data.length = 0;
+    }
+    [stream release];
+  }
+  @finally {
+    EndCachingSerializedSizes(didBeginCaching);
   }
-  [stream release];
   return data;
 }
 
@@ -2199,6 +2278,70 @@ static void MergeSingleFieldFromCodedInputStream(
   }  // switch
 }
 
+// Packed varints are decoded onto the stack this many at a time.
+#define kPackedVarintChunkSize 128
+
+// Appends a whole packed field (everything up to the current limit) to
+// |genericArray| in bulk: fixed width values straight from the input buffer,
+// varints with a single resize and one append per chunk.  Returns NO if the
+// field has to be decoded value by value instead (enums, which are validated
+// one at a time, and fixed width fields on big endian hosts or whose length is
+// not a multiple of the value size, so the error is raised where it occurs).
+static BOOL MergePackedFieldInBulk(id genericArray, LCGPBDataType fieldDataType,
+                                   LCGPBCodedInputStreamState *state) {
+  size_t length = LCGPBCodedInputStreamBytesUntilLimit(state);
+  switch (fieldDataType) {
+#define CASE_PACKED_FIXED(NAME, TYPE, ARRAY_TYPE)                               \
+    case LCGPBDataType##NAME: {                                                 \
+      if (OSHostByteOrder() != OSLittleEndian || length % sizeof(TYPE)) {       \
+        return NO;                                                              \
+      }                                                                         \
+      const uint8_t *bytes =                                                    \
+          LCGPBCodedInputStreamReadRawBytesInPlace(state, length);              \
+      [(LCGPB##ARRAY_TYPE##Array *)genericArray addValues:(const TYPE *)bytes   \
+                                                  count:length / sizeof(TYPE)]; \
+      return YES;                                                               \
+    }
+#define CASE_PACKED_VARINT(NAME, TYPE, ARRAY_TYPE, CONVERT)                     \
+    case LCGPBDataType##NAME: {                                                 \
+      LCGPB##ARRAY_TYPE##Array *array = genericArray;                           \
+      size_t count = LCGPBCodedInputStreamCountPackedVarints(state);            \
+      if (count > 0) {                                                          \
+        [array internalResizeToCapacity:array.count + count];                   \
+      }                                                                         \
+      uint64_t varints[kPackedVarintChunkSize];                                 \
+      TYPE values[kPackedVarintChunkSize];                                      \
+      size_t n;                                                                 \
+      while ((n = LCGPBCodedInputStreamReadPackedVarints(                       \
+                  state, varints, kPackedVarintChunkSize)) > 0) {               \
+        for (size_t i = 0; i < n; i++) {                                        \
+          uint64_t v = varints[i];                                              \
+          values[i] = CONVERT;                                                  \
+        }                                                                       \
+        [array addValues:values count:n];                                       \
+      }                                                                         \
+      return YES;                                                               \
+    }
+      CASE_PACKED_FIXED(Fixed32, uint32_t, UInt32)
+      CASE_PACKED_FIXED(SFixed32, int32_t, Int32)
+      CASE_PACKED_FIXED(Float, float, Float)
+      CASE_PACKED_FIXED(Fixed64, uint64_t, UInt64)
+      CASE_PACKED_FIXED(SFixed64, int64_t, Int64)
+      CASE_PACKED_FIXED(Double, double, Double)
+      CASE_PACKED_VARINT(Bool, BOOL, Bool, (int32_t)v != 0)
+      CASE_PACKED_VARINT(Int32, int32_t, Int32, (int32_t)v)
+      CASE_PACKED_VARINT(Int64, int64_t, Int64, (int64_t)v)
+      CASE_PACKED_VARINT(SInt32, int32_t, Int32, LCGPBDecodeZigZag32((uint32_t)v))
+      CASE_PACKED_VARINT(SInt64, int64_t, Int64, LCGPBDecodeZigZag64(v))
+      CASE_PACKED_VARINT(UInt32, uint32_t, UInt32, (uint32_t)v)
+      CASE_PACKED_VARINT(UInt64, uint64_t, UInt64, v)
+#undef CASE_PACKED_FIXED
+#undef CASE_PACKED_VARINT
+    default:
+      return NO;
+  }
+}
+
 static void MergeRepeatedPackedFieldFromCodedInputStream(
     LCGPBMessage *self, LCGPBFieldDescriptor *field, LCGPBFileSyntax syntax,
     LCGPBCodedInputStream *input) {
@@ -2207,6 +2350,10 @@ static void MergeRepeatedPackedFieldFromCodedInputStream(
   id genericArray = GetOrCreateArrayIvarWithField(self, field, syntax);
   int32_t length = LCGPBCodedInputStreamReadInt32(state);
   size_t limit = LCGPBCodedInputStreamPushLimit(state, length);
+  if (MergePackedFieldInBulk(genericArray, fieldDataType, state)) {
+    LCGPBCodedInputStreamPopLimit(state, limit);
+    return;
+  }
   while (LCGPBCodedInputStreamBytesUntilLimit(state) > 0) {
     switch (fieldDataType) {
 #define CASE_REPEATED_PACKED_POD(NAME, TYPE, ARRAY_TYPE)      \
@@ -2871,6 +3018,21 @@ static void MergeRepeatedNotPackedFieldFromCodedInputStream(
 #pragma mark - SerializedSize
 
 - (size_t)serializedSize {
+  pthread_once(&gSerializedSizeCacheKeyOnce, CreateSerializedSizeCacheKey);
+  CFMutableDictionaryRef cache = pthread_getspecific(gSerializedSizeCacheKey);
+  if (!cache) {
+    return [self computeSerializedSize];
+  }
+  const void *cachedSize;
+  if (CFDictionaryGetValueIfPresent(cache, self, &cachedSize)) {
+    return (size_t)cachedSize;
+  }
+  size_t result = [self computeSerializedSize];
+  CFDictionarySetValue(cache, self, (const void *)result);
+  return result;
+}
+
+- (size_t)computeSerializedSize {
   LCGPBDescriptor *descriptor = [[self class] descriptor];
   size_t result = 0;
 
@@ -101,6 +101,17 @@ NSMutableDictionary<NSNumber *, Class> const *_typeDict = nil;
     return message;
 }
 
++ (instancetype)messageWithMessagePack:(NSData *)data
+{
+    AVIMTypedMessageObject *messageObject = [[AVIMTypedMessageObject alloc] initWithMessagePack:data];
+    if (![messageObject isValidTypedMessageObject]) {
+        return nil;
+    }
+    AVIMTypedMessage *message = [self messageWithMessageObject:messageObject];
+    message.contentDeferred = true;
+    return message;
+}
+
 - (instancetype)init
 {
     if (![self conformsToProtocol:@protocol(AVIMTypedMessageSubclassing)]) {
@@ -140,7 +151,14 @@ NSMutableDictionary<NSNumber *, Class> const *_typeDict = nil;
 
 - (id)copyWithZone:(NSZone *)zone
 {
-    AVIMTypedMessage *message = [super copyWithZone:zone];
+    AVIMTypedMessage *message;
+    /// @note content and contentDeferred are copied together, so that a concurrent rendering can not be lost between them.
+    @synchronized (self) {
+        message = [super copyWithZone:zone];
+        if (message) {
+            [message setContentDeferred:self.contentDeferred];
+        }
+    }
     if (message) {
         [message setMessageObject:self.messageObject];
         [message setFileIvar:self.file];
@@ -149,6 +167,27 @@ NSMutableDictionary<NSNumber *, Class> const *_typeDict = nil;
     return message;
 }
 
+- (NSString *)content
+{
+    @synchronized (self) {
+        NSString *content = [super content];
+        if (!content && self.contentDeferred) {
+            content = [self.messageObject JSONString];
+            [super setContent:content];
+            self.contentDeferred = false;
+        }
+        return content;
+    }
+}
+
+- (void)setContent:(NSString *)content
+{
+    @synchronized (self) {
+        [super setContent:content];
+        self.contentDeferred = false;
+    }
+}
+
 - (AVIMTypedMessageObject *)messageObject
 {
     if (!_messageObject) {
@@ -334,10 +373,23 @@ NSMutableDictionary<NSNumber *, Class> const *_typeDict = nil;
 - (NSString *)payload
 {
     if (self.messageObject.localData.count > 0) {
-        return [self.messageObject JSONString];
+        NSData *data = [self.messageObject payloadData];
+        return (data
+                ? [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding]
+                : [self.messageObject JSONString]);
     } else {
         return [super payload];
     }
 }
 
+- (NSData *)payloadData
+{
+    if (self.messageObject.localData.count > 0) {
+        return ([self.messageObject payloadData] ?:
+                [[self.messageObject JSONString] dataUsingEncoding:NSUTF8StringEncoding]);
+    } else {
+        return [super payloadData];
+    }
+}
+
 @end
@@ -18,8 +18,15 @@ extern NSMutableDictionary<NSNumber *, Class> const *_typeDict;
 
 @property (nonatomic) AVIMTypedMessageObject *messageObject;
 
+/// Set for messages received with a MessagePack body, `content` is then rendered from `messageObject` on first access.
+/// Reading `content` renders it under a lock on the message, so concurrent readers get the same string.
+@property (nonatomic, assign) BOOL contentDeferred;
+
 + (instancetype)messageWithMessageObject:(AVIMTypedMessageObject *)messageObject;
 
+/// A typed message decoded from a MessagePack body, with `contentDeferred` set; nil if the body is not a typed message.
++ (instancetype)messageWithMessagePack:(NSData *)data NS_SWIFT_NAME(init(messagePack:));
+
 - (NSString *)decodingUrl;
 - (NSDictionary *)decodingMetaData;
 - (NSString *)decodingName;
@@ -0,0 +1,203 @@
+/*
+ * Encode/decode throughput of the avmp.c MessagePack codec, comparing the
+ * callback path (one indirect call per read or write, as streams use) with
+ * buffer mode (I/O inlined against a contiguous buffer).
+ *
+ * Build and run from this directory:
+ *
+ *   cc -O2 -I ../../AVOSCloudIM/AVMPMessagePack \
+ *      avmp_benchmark.c ../../AVOSCloudIM/AVMPMessagePack/avmp.c \
+ *      -o avmp_benchmark && ./avmp_benchmark
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "avmp.h"
+
+#define MESSAGE_COUNT 64
+#define ITERATIONS    2000
+
+typedef struct {
+  uint8_t *bytes;
+  size_t   length;
+  size_t   capacity;
+  size_t   index;
+} stream_t;
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool stream_read(avmp_ctx_t *ctx, void *data, size_t limit) {
+  stream_t *stream = ctx->buf;
+
+  if (limit > stream->length - stream->index)
+    return false;
+
+  memcpy(data, stream->bytes + stream->index, limit);
+  stream->index += limit;
+  return true;
+}
+
+static size_t stream_write(avmp_ctx_t *ctx, const void *data, size_t count) {
+  stream_t *stream = ctx->buf;
+
+  if (count > stream->capacity - stream->length) {
+    size_t capacity = stream->capacity * 2 + count;
+    stream->bytes = realloc(stream->bytes, capacity);
+    stream->capacity = capacity;
+  }
+
+  memcpy(stream->bytes + stream->length, data, count);
+  stream->length += count;
+  return count;
+}
+
+static bool buffer_grow(avmp_ctx_t *ctx, size_t needed) {
+  stream_t *stream = ctx->buf;
+  size_t capacity = ctx->size * 2 + needed;
+
+  stream->bytes = realloc(stream->bytes, capacity);
+  stream->capacity = capacity;
+  ctx->data = stream->bytes;
+  ctx->size = capacity;
+  return true;
+}
+
+/* A batch of IM-like messages: a map of ids, timestamps, flags and a payload. */
+static bool write_messages(avmp_ctx_t *ctx) {
+  static const char payload[] =
+    "{\"_lctype\":-1,\"_lctext\":\"The quick brown fox jumps over the lazy dog\"}";
+  char message_id[32];
+
+  if (!avmp_write_array(ctx, MESSAGE_COUNT))
+    return false;
+
+  for (int i = 0; i < MESSAGE_COUNT; i++) {
+    int length = snprintf(message_id, sizeof(message_id), "5c1f3a%08dabcdef", i);
+
+    if (!(avmp_write_map(ctx, 7) &&
+          avmp_write_str(ctx, "cid", 3) &&
+          avmp_write_str(ctx, "5c1f3a6b0b6160007f2c8a1e", 24) &&
+          avmp_write_str(ctx, "id", 2) &&
+          avmp_write_str(ctx, message_id, (uint32_t)length) &&
+          avmp_write_str(ctx, "from", 4) &&
+          avmp_write_str(ctx, "client-benchmark", 16) &&
+          avmp_write_str(ctx, "timestamp", 9) &&
+          avmp_write_uint(ctx, 1545000000000ULL + i) &&
+          avmp_write_str(ctx, "transient", 9) &&
+          avmp_write_bool(ctx, i % 2) &&
+          avmp_write_str(ctx, "score", 5) &&
+          avmp_write_double(ctx, i * 0.5) &&
+          avmp_write_str(ctx, "msg", 3) &&
+          avmp_write_str(ctx, payload, sizeof(payload) - 1)))
+      return false;
+  }
+
+  return true;
+}
+
+static bool read_value(avmp_ctx_t *ctx, char *scratch, size_t scratch_size) {
+  avmp_object_t obj;
+
+  if (!avmp_read_object(ctx, &obj))
+    return false;
+
+  switch (obj.type) {
+    case AVMP_TYPE_FIXSTR:
+    case AVMP_TYPE_STR8:
+    case AVMP_TYPE_STR16:
+    case AVMP_TYPE_STR32:
+      return obj.as.str_size <= scratch_size &&
+             avmp_read_bytes(ctx, scratch, obj.as.str_size);
+    case AVMP_TYPE_FIXARRAY:
+    case AVMP_TYPE_ARRAY16:
+    case AVMP_TYPE_ARRAY32:
+      for (uint32_t i = 0; i < obj.as.array_size; i++) {
+        if (!read_value(ctx, scratch, scratch_size))
+          return false;
+      }
+      return true;
+    case AVMP_TYPE_FIXMAP:
+    case AVMP_TYPE_MAP16:
+    case AVMP_TYPE_MAP32:
+      for (uint32_t i = 0; i < obj.as.map_size * 2; i++) {
+        if (!read_value(ctx, scratch, scratch_size))
+          return false;
+      }
+      return true;
+    default:
+      return true;
+  }
+}
+
+static void report(const char *name, size_t bytes, double seconds) {
+  printf("%-24s %9.1f MB/s\n", name, bytes * (double)ITERATIONS / seconds / 1e6);
+}
+
+int main(void) {
+  stream_t stream = {0};
+  avmp_ctx_t ctx;
+  char scratch[256];
+  double start;
+
+  /* Encode */
+
+  start = now();
+  for (int i = 0; i < ITERATIONS; i++) {
+    stream.length = 0;
+    avmp_init(&ctx, &stream, stream_read, stream_write);
+    if (!write_messages(&ctx)) {
+      fprintf(stderr, "callback encode: %s\n", avmp_strerror(&ctx));
+      return 1;
+    }
+  }
+  report("encode (callback)", stream.length, now() - start);
+
+  size_t encoded_length = stream.length;
+
+  start = now();
+  for (int i = 0; i < ITERATIONS; i++) {
+    avmp_init_buffer(&ctx, &stream, stream.bytes, stream.capacity, buffer_grow);
+    if (!write_messages(&ctx) || ctx.pos != encoded_length) {
+      fprintf(stderr, "buffer encode: %s\n", avmp_strerror(&ctx));
+      return 1;
+    }
+  }
+  report("encode (buffer)", encoded_length, now() - start);
+
+  /* Decode */
+
+  stream.length = encoded_length;
+
+  start = now();
+  for (int i = 0; i < ITERATIONS; i++) {
+    stream.index = 0;
+    avmp_init(&ctx, &stream, stream_read, stream_write);
+    if (!read_value(&ctx, scratch, sizeof(scratch))) {
+      fprintf(stderr, "callback decode: %s\n", avmp_strerror(&ctx));
+      return 1;
+    }
+  }
+  report("decode (callback)", encoded_length, now() - start);
+
+  start = now();
+  for (int i = 0; i < ITERATIONS; i++) {
+    avmp_init_buffer(&ctx, NULL, stream.bytes, encoded_length, NULL);
+    if (!read_value(&ctx, scratch, sizeof(scratch)) || ctx.pos != encoded_length) {
+      fprintf(stderr, "buffer decode: %s\n", avmp_strerror(&ctx));
+      return 1;
+    }
+  }
+  report("decode (buffer)", encoded_length, now() - start);
+
+  free(stream.bytes);
+  return 0;
+}
@@ -0,0 +1,356 @@
+/*
+ * Encode/decode benchmark and regression check for the vendored protobuf
+ * runtime (LCGPBMessage, LCGPBArray, LCGPBDictionary and the coded streams),
+ * over a corpus of AVIMGenericCommand shapes the IM client actually sees:
+ * direct messages, unread floods, conversation query results and patch lists.
+ * Scalar map storage, which the IM protocol does not use, is measured on an
+ * LCGPBInt32Int64Dictionary directly.
+ *
+ * Every case reports ns/op, allocations/op and allocated bytes/op (counted
+ * with the malloc logger hook) as JSON on stdout, and a table on stderr.  When
+ * given a baseline (a previous JSON output), the run fails if any metric of a
+ * case grew by more than the threshold (default 10%).
+ *
+ * Build and run from this directory on macOS (the runtime is MRC):
+ *
+ *   clang -O2 -fno-objc-arc -framework Foundation \
+ *      -I ../../AVOSCloudIM/Protobuf -I ../../AVOSCloudIM/Commands \
+ *      lcgpb_benchmark.m ../../AVOSCloudIM/Protobuf/*.m \
+ *      ../../AVOSCloudIM/Commands/MessagesProtoOrig.pbobjc.m \
+ *      -o lcgpb_benchmark
+ *   ./lcgpb_benchmark > baseline.json
+ *   ./lcgpb_benchmark --baseline baseline.json [--threshold 0.1] [--min-time 0.2]
+ */
+
+#import <Foundation/Foundation.h>
+
+#include <mach/mach_time.h>
+#include <malloc/malloc.h>
+
+#import "MessagesProtoOrig.pbobjc.h"
+#import "LCGPBDictionary_PackagePrivate.h"
+
+#pragma mark - Allocation counting
+
+// libmalloc calls this hook (installed by allocation tracing tools) on every
+// allocation and free; the type bits and argument layout are those of
+// <malloc/malloc.h>'s stack logging.
+typedef void (malloc_logger_t)(uint32_t type, uintptr_t arg1, uintptr_t arg2,
+                               uintptr_t arg3, uintptr_t result,
+                               uint32_t num_hot_frames_to_skip);
+extern malloc_logger_t *malloc_logger;
+
+#define MALLOC_LOG_TYPE_ALLOCATE   2
+#define MALLOC_LOG_TYPE_DEALLOCATE 4
+
+static uint64_t allocationCount;
+static uint64_t allocationBytes;
+
+static void CountAllocation(uint32_t type, uintptr_t arg1, uintptr_t arg2,
+                            uintptr_t arg3, uintptr_t result,
+                            uint32_t num_hot_frames_to_skip) {
+  if (!(type & MALLOC_LOG_TYPE_ALLOCATE)) {
+    return;
+  }
+  allocationCount++;
+  // realloc logs (zone, old pointer, new size); malloc and calloc log (zone, size).
+  allocationBytes += (type & MALLOC_LOG_TYPE_DEALLOCATE) ? arg3 : arg2;
+}
+
+#pragma mark - Corpus
+
+static NSString *ObjectId(NSUInteger index) {
+  return [NSString stringWithFormat:@"5c1f3a6b0b6160007f%06lu", (unsigned long)index];
+}
+
+static NSString *TextMessage(NSUInteger index) {
+  return [NSString stringWithFormat:
+          @"{\"_lctype\":-1,\"_lctext\":\"message %lu, the quick brown fox jumps over the lazy dog\","
+          @"\"_lcattrs\":{\"index\":%lu}}",
+          (unsigned long)index, (unsigned long)index];
+}
+
+static AVIMGenericCommand *DirectMessageCommand(void) {
+  AVIMDirectCommand *direct = [AVIMDirectCommand message];
+  direct.cid = ObjectId(0);
+  direct.id_p = @"w1YQ3qkFTmqlNAf8KBFG2g";
+  direct.fromPeerId = @"client-benchmark";
+  direct.timestamp = 1545000000000;
+  direct.msg = TextMessage(0);
+  direct.offline = YES;
+  [direct.mentionPidsArray addObjectsFromArray:@[@"client-1", @"client-2"]];
+
+  AVIMGenericCommand *command = [AVIMGenericCommand message];
+  command.cmd = AVIMCommandType_Direct;
+  command.peerId = @"client-receiver";
+  command.directMessage = direct;
+  return command;
+}
+
+static AVIMGenericCommand *UnreadFloodCommand(void) {
+  AVIMUnreadCommand *unread = [AVIMUnreadCommand message];
+  unread.notifTime = 1545000000000;
+  for (NSUInteger i = 0; i < 1000; i++) {
+    AVIMUnreadTuple *tuple = [AVIMUnreadTuple message];
+    tuple.cid = ObjectId(i);
+    tuple.unread = (int32_t)(i % 100);
+    tuple.mid = [NSString stringWithFormat:@"w1YQ3qkFTmqlNAf8%06lu", (unsigned long)i];
+    tuple.timestamp = 1545000000000 + (int64_t)i;
+    tuple.from = [NSString stringWithFormat:@"client-%lu", (unsigned long)(i % 7)];
+    tuple.data_p = TextMessage(i);
+    tuple.mentioned = (i % 2 == 0);
+    tuple.convType = 1;
+    [unread.convsArray addObject:tuple];
+  }
+
+  AVIMGenericCommand *command = [AVIMGenericCommand message];
+  command.cmd = AVIMCommandType_Unread;
+  command.peerId = @"client-benchmark";
+  command.unreadMessage = unread;
+  return command;
+}
+
+static AVIMGenericCommand *ConvQueryResultsCommand(void) {
+  NSMutableArray *conversations = [NSMutableArray array];
+  for (NSUInteger i = 0; i < 100; i++) {
+    [conversations addObject:@{
+      @"objectId": ObjectId(i),
+      @"name": [NSString stringWithFormat:@"Conversation %lu", (unsigned long)i],
+      @"m": @[@"client-benchmark", @"client-1", @"client-2", @"client-3"],
+      @"c": @"client-benchmark",
+      @"createdAt": @"2018-12-17T03:20:00.000Z",
+      @"updatedAt": @"2018-12-17T03:20:00.000Z",
+      @"lm": @{@"__type": @"Date", @"iso": @"2018-12-17T03:20:00.000Z"},
+      @"attr": @{@"type": @"private", @"index": @(i)},
+    }];
+  }
+  NSData *json = [NSJSONSerialization dataWithJSONObject:conversations options:0 error:NULL];
+
+  AVIMConvCommand *conv = [AVIMConvCommand message];
+  conv.limit = 100;
+  conv.results.data_p = [[[NSString alloc] initWithData:json
+                                               encoding:NSUTF8StringEncoding] autorelease];
+
+  AVIMGenericCommand *command = [AVIMGenericCommand message];
+  command.cmd = AVIMCommandType_Conv;
+  command.op = AVIMOpType_Results;
+  command.peerId = @"client-benchmark";
+  command.i = 42;
+  command.convMessage = conv;
+  return command;
+}
+
+static AVIMGenericCommand *PatchListCommand(void) {
+  AVIMPatchCommand *patch = [AVIMPatchCommand message];
+  patch.lastPatchTime = 1545000000000;
+  for (NSUInteger i = 0; i < 200; i++) {
+    AVIMPatchItem *item = [AVIMPatchItem message];
+    item.cid = ObjectId(i % 20);
+    item.mid = [NSString stringWithFormat:@"w1YQ3qkFTmqlNAf8%06lu", (unsigned long)i];
+    item.timestamp = 1545000000000 + (int64_t)i;
+    item.patchTimestamp = 1545000100000 + (int64_t)i;
+    item.from = [NSString stringWithFormat:@"client-%lu", (unsigned long)(i % 7)];
+    item.recall = (i % 5 == 0);
+    item.data_p = item.recall ? @"" : TextMessage(i);
+    [patch.patchesArray addObject:item];
+  }
+
+  AVIMGenericCommand *command = [AVIMGenericCommand message];
+  command.cmd = AVIMCommandType_Patch;
+  command.op = AVIMOpType_Modify;
+  command.peerId = @"client-benchmark";
+  command.patchMessage = patch;
+  return command;
+}
+
+#pragma mark - Maps
+
+static const int32_t kMapEntryCount = 1000;
+
+// Fills a map the way map-field decoding does, one generic value per entry.
+static BOOL DecodeMapEntries(void) {
+  LCGPBInt32Int64Dictionary *map = [[LCGPBInt32Int64Dictionary alloc] init];
+  LCGPBGenericValue key;
+  LCGPBGenericValue value;
+  for (int32_t i = 0; i < kMapEntryCount; i++) {
+    key.valueInt32 = i * 7919;
+    value.valueInt64 = 1545000000000 + i;
+    [map setLCGPBGenericValue:&value forLCGPBGenericValueKey:&key];
+  }
+  BOOL filled = (map.count == (NSUInteger)kMapEntryCount);
+  [map release];
+  return filled;
+}
+
+static BOOL LookUpMapEntries(LCGPBInt32Int64Dictionary *map) {
+  int64_t sum = 0;
+  for (int32_t i = 0; i < kMapEntryCount; i++) {
+    int64_t value;
+    if (![map getInt64:&value forKey:i * 7919]) {
+      return NO;
+    }
+    sum += value;
+  }
+  return sum != 0;
+}
+
+#pragma mark - Measurement
+
+typedef struct {
+  double nsPerOp;
+  double allocsPerOp;
+  double bytesPerOp;
+} Result;
+
+static double Nanoseconds(uint64_t ticks) {
+  static mach_timebase_info_data_t timebase;
+  if (timebase.denom == 0) {
+    mach_timebase_info(&timebase);
+  }
+  return (double)ticks * timebase.numer / timebase.denom;
+}
+
+// Runs |operation| in doubling batches until one batch takes at least
+// |minTime| seconds, and reports that batch.
+static Result Measure(double minTime, BOOL (^operation)(void)) {
+  for (NSUInteger iterations = 1;; iterations *= 2) {
+    allocationCount = 0;
+    allocationBytes = 0;
+    malloc_logger = CountAllocation;
+    uint64_t start = mach_absolute_time();
+    @autoreleasepool {
+      for (NSUInteger i = 0; i < iterations; i++) {
+        if (!operation()) {
+          malloc_logger = NULL;
+          fprintf(stderr, "operation failed\n");
+          exit(2);
+        }
+      }
+    }
+    double elapsed = Nanoseconds(mach_absolute_time() - start);
+    malloc_logger = NULL;
+    if (elapsed >= minTime * 1e9) {
+      return (Result){
+        .nsPerOp = elapsed / iterations,
+        .allocsPerOp = (double)allocationCount / iterations,
+        .bytesPerOp = (double)allocationBytes / iterations,
+      };
+    }
+  }
+}
+
+// Returns NO if any metric of |result| regressed against |baseline|.
+static BOOL CheckRegression(NSString *name, NSDictionary *result,
+                            NSDictionary *baseline, double threshold) {
+  BOOL passed = YES;
+  for (NSString *metric in @[@"ns_per_op", @"allocs_per_op", @"bytes_per_op"]) {
+    double previous = [baseline[metric] doubleValue];
+    double current = [result[metric] doubleValue];
+    if (previous > 0 && current > previous * (1 + threshold)) {
+      fprintf(stderr, "REGRESSION %s %s: %.1f -> %.1f (+%.1f%%)\n",
+              name.UTF8String, metric.UTF8String, previous, current,
+              (current / previous - 1) * 100);
+      passed = NO;
+    }
+  }
+  return passed;
+}
+
+int main(int argc, const char *argv[]) {
+  @autoreleasepool {
+    NSString *baselinePath = nil;
+    double threshold = 0.1;
+    double minTime = 0.2;
+    for (int i = 1; i + 1 < argc; i += 2) {
+      if (!strcmp(argv[i], "--baseline")) {
+        baselinePath = @(argv[i + 1]);
+      } else if (!strcmp(argv[i], "--threshold")) {
+        threshold = atof(argv[i + 1]);
+      } else if (!strcmp(argv[i], "--min-time")) {
+        minTime = atof(argv[i + 1]);
+      } else {
+        fprintf(stderr, "unknown option %s\n", argv[i]);
+        return 2;
+      }
+    }
+
+    NSDictionary<NSString *, NSDictionary *> *baseline = nil;
+    if (baselinePath) {
+      NSData *data = [NSData dataWithContentsOfFile:baselinePath];
+      NSArray *entries = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL][@"benchmarks"] : nil;
+      if (![entries isKindOfClass:[NSArray class]]) {
+        fprintf(stderr, "cannot read baseline %s\n", baselinePath.UTF8String);
+        return 2;
+      }
+      NSMutableDictionary *byName = [NSMutableDictionary dictionary];
+      for (NSDictionary *entry in entries) {
+        byName[entry[@"name"]] = entry;
+      }
+      baseline = byName;
+    }
+
+    NSDictionary<NSString *, AVIMGenericCommand *> *corpus = @{
+      @"direct": DirectMessageCommand(),
+      @"unread_flood": UnreadFloodCommand(),
+      @"conv_query_results": ConvQueryResultsCommand(),
+      @"patch_list": PatchListCommand(),
+    };
+
+    NSMutableArray *results = [NSMutableArray array];
+    __block BOOL passed = YES;
+    void (^record)(NSString *, Result, NSUInteger) = ^(NSString *name, Result result, NSUInteger wireBytes) {
+      NSMutableDictionary *entry = [NSMutableDictionary dictionaryWithDictionary:@{
+        @"name": name,
+        @"ns_per_op": @(result.nsPerOp),
+        @"allocs_per_op": @(result.allocsPerOp),
+        @"bytes_per_op": @(result.bytesPerOp),
+      }];
+      if (wireBytes) {
+        entry[@"wire_bytes"] = @(wireBytes);
+      }
+      [results addObject:entry];
+      fprintf(stderr, "%-28s %12.0f %12.1f %12.0f\n",
+              name.UTF8String, result.nsPerOp, result.allocsPerOp, result.bytesPerOp);
+      if (baseline[name] && !CheckRegression(name, entry, baseline[name], threshold)) {
+        passed = NO;
+      }
+    };
+    fprintf(stderr, "%-28s %12s %12s %12s\n", "benchmark", "ns/op", "allocs/op", "bytes/op");
+
+    for (NSString *shape in [corpus.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+      AVIMGenericCommand *command = corpus[shape];
+      NSData *wire = [command data];
+
+      Result encode = Measure(minTime, ^BOOL{
+        return [command data] != nil;
+      });
+      Result decode = Measure(minTime, ^BOOL{
+        NSError *error = nil;
+        AVIMGenericCommand *parsed = [AVIMGenericCommand parseFromData:wire error:&error];
+        return parsed != nil && error == nil;
+      });
+
+      record([shape stringByAppendingString:@"/encode"], encode, wire.length);
+      record([shape stringByAppendingString:@"/decode"], decode, wire.length);
+    }
+
+    LCGPBInt32Int64Dictionary *map = [[LCGPBInt32Int64Dictionary alloc] init];
+    for (int32_t i = 0; i < kMapEntryCount; i++) {
+      [map setInt64:1545000000000 + i forKey:i * 7919];
+    }
+    record(@"map_int32_int64/decode", Measure(minTime, ^BOOL{
+      return DecodeMapEntries();
+    }), 0);
+    record(@"map_int32_int64/lookup", Measure(minTime, ^BOOL{
+      return LookUpMapEntries(map);
+    }), 0);
+    [map release];
+
+    NSData *json = [NSJSONSerialization dataWithJSONObject:@{@"benchmarks": results}
+                                                   options:NSJSONWritingPrettyPrinted
+                                                     error:NULL];
+    fwrite(json.bytes, 1, json.length, stdout);
+    fputc('\n', stdout);
+    return passed ? 0 : 1;
+  }
+}
@@ -0,0 +1,289 @@
+/*
+ * Differential fuzzing of the avmp.c tokenizer against the one-shot reader.
+ *
+ * Random MessagePack documents, some of them corrupted or truncated, are
+ * decoded once with avmp_read_object() over the whole buffer and once with
+ * avmp_tokenizer_next() over random fragments of it.  Both must yield the same
+ * objects and payloads, and must agree on how the input ends.
+ *
+ * Build and run from this directory:
+ *
+ *   cc -O1 -g -fsanitize=address,undefined -I ../../AVOSCloudIM/AVMPMessagePack \
+ *      avmp_tokenizer_fuzz.c ../../AVOSCloudIM/AVMPMessagePack/avmp.c \
+ *      -o avmp_tokenizer_fuzz && ./avmp_tokenizer_fuzz [iterations] [seed]
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "avmp.h"
+
+typedef struct {
+  uint8_t *bytes;
+  size_t   length;
+  size_t   capacity;
+} buffer_t;
+
+enum {
+  END_COMPLETE,
+  END_TRUNCATED,
+  END_INVALID
+};
+
+static uint64_t rng_state;
+
+static uint32_t rnd(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return (uint32_t)(rng_state >> 16);
+}
+
+static uint32_t rnd_below(uint32_t n) {
+  return n ? rnd() % n : 0;
+}
+
+static void append(buffer_t *buffer, const void *data, size_t size) {
+  if (!size)
+    return;
+
+  if (size > buffer->capacity - buffer->length) {
+    buffer->capacity = buffer->capacity * 2 + size;
+    buffer->bytes = realloc(buffer->bytes, buffer->capacity);
+  }
+  memcpy(buffer->bytes + buffer->length, data, size);
+  buffer->length += size;
+}
+
+static bool grow(avmp_ctx_t *ctx, size_t needed) {
+  buffer_t *buffer = ctx->buf;
+
+  buffer->capacity = ctx->size * 2 + needed;
+  buffer->bytes = realloc(buffer->bytes, buffer->capacity);
+  ctx->data = buffer->bytes;
+  ctx->size = buffer->capacity;
+  return true;
+}
+
+static uint32_t random_length(void) {
+  static const uint32_t lengths[] = {0, 1, 15, 31, 32, 255, 256, 300, 65535, 65536};
+
+  if (rnd_below(4))
+    return rnd_below(40);
+
+  uint32_t length = lengths[rnd_below(sizeof(lengths) / sizeof(lengths[0]))];
+
+  /* Keep the large ones rare. */
+  return (length > 1000 && rnd_below(8)) ? length / 64 : length;
+}
+
+static void write_random_value(avmp_ctx_t *ctx, int depth) {
+  static uint8_t bytes[65536];
+  uint32_t length;
+
+  switch (rnd_below(depth < 4 ? 14 : 12)) {
+    case 0:  avmp_write_uint(ctx, rnd_below(128)); break;
+    case 1:  avmp_write_sint(ctx, -(int64_t)rnd_below(32) - 1); break;
+    case 2:  avmp_write_uint(ctx, ((uint64_t)rnd() << 32 | rnd()) >> rnd_below(64)); break;
+    case 3:  avmp_write_sint(ctx, -(int64_t)(((uint64_t)rnd() << 31 | rnd()) >> rnd_below(62))); break;
+    case 4:  avmp_write_float(ctx, (float)rnd() / 7.0f); break;
+    case 5:  avmp_write_double(ctx, (double)rnd() / 3.0); break;
+    case 6:  avmp_write_nil(ctx); break;
+    case 7:  avmp_write_bool(ctx, rnd_below(2)); break;
+    case 8:
+      length = random_length();
+      for (uint32_t i = 0; i < length; i++)
+        bytes[i] = 'a' + rnd_below(26);
+      avmp_write_str(ctx, (const char *)bytes, length);
+      break;
+    case 9:
+      length = random_length();
+      for (uint32_t i = 0; i < length; i++)
+        bytes[i] = (uint8_t)rnd();
+      avmp_write_bin(ctx, bytes, length);
+      break;
+    case 10:
+    case 11: {
+      static const uint32_t ext_lengths[] = {1, 2, 4, 8, 16, 3, 300};
+      length = ext_lengths[rnd_below(sizeof(ext_lengths) / sizeof(ext_lengths[0]))];
+      for (uint32_t i = 0; i < length; i++)
+        bytes[i] = (uint8_t)rnd();
+      avmp_write_ext(ctx, (int8_t)rnd_below(128), length, bytes);
+      break;
+    }
+    case 12:
+      length = rnd_below(4) ? rnd_below(8) : 16 + rnd_below(8);
+      avmp_write_array(ctx, length);
+      for (uint32_t i = 0; i < length; i++)
+        write_random_value(ctx, depth + 1);
+      break;
+    case 13:
+      length = rnd_below(4) ? rnd_below(8) : 16 + rnd_below(8);
+      avmp_write_map(ctx, length);
+      for (uint32_t i = 0; i < length * 2; i++)
+        write_random_value(ctx, depth + 1);
+      break;
+  }
+}
+
+static void trace_object(buffer_t *trace, const avmp_object_t *obj) {
+  append(trace, obj, sizeof(avmp_object_t));
+}
+
+static uint32_t payload_size(const avmp_object_t *obj) {
+  switch (obj->type) {
+    case AVMP_TYPE_FIXSTR: case AVMP_TYPE_STR8: case AVMP_TYPE_STR16: case AVMP_TYPE_STR32:
+      return obj->as.str_size;
+    case AVMP_TYPE_BIN8: case AVMP_TYPE_BIN16: case AVMP_TYPE_BIN32:
+      return obj->as.bin_size;
+    case AVMP_TYPE_EXT8: case AVMP_TYPE_EXT16: case AVMP_TYPE_EXT32:
+    case AVMP_TYPE_FIXEXT1: case AVMP_TYPE_FIXEXT2: case AVMP_TYPE_FIXEXT4:
+    case AVMP_TYPE_FIXEXT8: case AVMP_TYPE_FIXEXT16:
+      return obj->as.ext.size;
+    default:
+      return 0;
+  }
+}
+
+/* Reference: the one-shot reader over the whole input. */
+static int read_one_shot(const uint8_t *input, size_t size, buffer_t *trace) {
+  avmp_ctx_t ctx;
+
+  avmp_init_buffer(&ctx, NULL, (void *)input, size, NULL);
+
+  while (ctx.pos < size) {
+    avmp_object_t obj;
+
+    memset(&obj, 0, sizeof(obj));
+
+    if (!avmp_read_object(&ctx, &obj))
+      return strcmp(avmp_strerror(&ctx), "Invalid type") ? END_TRUNCATED : END_INVALID;
+
+    uint32_t length = payload_size(&obj);
+
+    if (length > size - ctx.pos)
+      return END_TRUNCATED;
+
+    trace_object(trace, &obj);
+    append(trace, input + ctx.pos, length);
+    ctx.pos += length;
+  }
+
+  return END_COMPLETE;
+}
+
+/* Subject: the tokenizer over random fragments, each in its own allocation. */
+static int read_fragmented(const uint8_t *input, size_t size, buffer_t *trace) {
+  avmp_tokenizer_t tok;
+  avmp_token_t token;
+  avmp_object_t obj;
+  buffer_t payload = {0};
+  size_t offset = 0;
+  int end = END_COMPLETE;
+
+  avmp_tokenizer_init(&tok);
+  memset(&obj, 0, sizeof(obj));
+
+  while (offset < size) {
+    size_t fragment_size = rnd_below(4) ? rnd_below(18) : rnd_below(2000);
+
+    if (fragment_size > size - offset)
+      fragment_size = size - offset;
+
+    uint8_t *fragment = malloc(fragment_size ? fragment_size : 1);
+    memcpy(fragment, input + offset, fragment_size);
+    offset += fragment_size;
+
+    avmp_tokenizer_feed(&tok, fragment, fragment_size);
+
+    int result;
+    while ((result = avmp_tokenizer_next(&tok, &token)) == AVMP_TOKENIZER_OK) {
+      if (token.kind == AVMP_TOKEN_OBJECT) {
+        obj = token.obj;
+        payload.length = 0;
+      } else {
+        append(&payload, token.data, token.size);
+      }
+
+      if (token.complete) {
+        trace_object(trace, &obj);
+        append(trace, payload.bytes, payload.length);
+      }
+    }
+
+    free(fragment);
+
+    if (result == AVMP_TOKENIZER_ERROR) {
+      end = END_INVALID;
+      break;
+    }
+  }
+
+  if (end == END_COMPLETE && avmp_tokenizer_is_pending(&tok))
+    end = END_TRUNCATED;
+
+  free(payload.bytes);
+  return end;
+}
+
+int main(int argc, char **argv) {
+  unsigned long iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000;
+  unsigned long seed = argc > 2 ? strtoul(argv[2], NULL, 10) : 1;
+  unsigned long counts[3] = {0};
+
+  rng_state = seed * 2654435761u + 1;
+
+  for (unsigned long i = 0; i < iterations; i++) {
+    buffer_t document = {0};
+    buffer_t expected = {0};
+    buffer_t actual = {0};
+    avmp_ctx_t ctx;
+
+    document.bytes = malloc(64);
+    document.capacity = 64;
+    avmp_init_buffer(&ctx, &document, document.bytes, document.capacity, grow);
+
+    for (uint32_t n = 1 + rnd_below(3); n > 0; n--)
+      write_random_value(&ctx, 0);
+
+    document.length = ctx.pos;
+
+    /* Corrupt some of the documents. */
+    switch (rnd_below(4)) {
+      case 0:
+        for (uint32_t n = 1 + rnd_below(4); n > 0 && document.length; n--)
+          document.bytes[rnd_below((uint32_t)document.length)] = (uint8_t)rnd();
+        break;
+      case 1:
+        document.length = rnd_below((uint32_t)document.length + 1);
+        break;
+    }
+
+    int expected_end = read_one_shot(document.bytes, document.length, &expected);
+    int actual_end = read_fragmented(document.bytes, document.length, &actual);
+
+    if (expected_end != actual_end ||
+        expected.length != actual.length ||
+        (expected.length && memcmp(expected.bytes, actual.bytes, expected.length))) {
+      fprintf(stderr, "mismatch at iteration %lu (seed %lu): end %d vs %d, trace %zu vs %zu bytes\n",
+              i, seed, expected_end, actual_end, expected.length, actual.length);
+      free(document.bytes);
+      free(expected.bytes);
+      free(actual.bytes);
+      return 1;
+    }
+
+    counts[expected_end]++;
+
+    free(document.bytes);
+    free(expected.bytes);
+    free(actual.bytes);
+  }
+
+  printf("%lu documents: %lu complete, %lu truncated, %lu invalid\n",
+         iterations, counts[END_COMPLETE], counts[END_TRUNCATED], counts[END_INVALID]);
+  return 0;
+}
@@ -9,6 +9,7 @@
 #import <Foundation/Foundation.h>
 
 @class AVLiveQuery;
+@class AVIMJsonObjectMessage;
 
 FOUNDATION_EXPORT NSString * const AVLiveQueryEventKey;
 FOUNDATION_EXPORT NSNotificationName const AVLiveQueryEventNotification;
@@ -23,4 +24,7 @@ FOUNDATION_EXPORT NSNotificationName const AVLiveQueryEventNotification;
 - (void)addLiveQueryObjectToWeakTable:(AVLiveQuery *)liveQueryObject;
 - (void)removeLiveQueryObjectFromWeakTable:(AVLiveQuery *)liveQueryObject;
 
+/// The event carried by a data message, read from its MessagePack body if it has one, otherwise from its JSON body.
++ (id)dictionaryFromDataMessage:(AVIMJsonObjectMessage *)message NS_SWIFT_NAME(dictionary(fromDataMessage:));
+
 @end
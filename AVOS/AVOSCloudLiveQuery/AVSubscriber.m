@@ -16,6 +16,9 @@
 #import "LCRTMConnection.h"
 #import "MessagesProtoOrig.pbobjc.h"
 #import "AVIMErrorUtil.h"
+#import "AVIMCommon_Internal.h"
+#import "AVOSCloudIM.h"
+#import "AVMPMessagePack.h"
 
 static NSString * const AVIdentifierPrefix = @"livequery";
 NSString * const AVLiveQueryEventKey = @"AVLiveQueryEventKey";
@@ -135,17 +138,27 @@ NSNotificationName const AVLiveQueryEventNotification = @"AVLiveQueryEventNotifi
     }
 }
 
-- (void)handleDataMessage:(AVIMJsonObjectMessage *)message
++ (id)dictionaryFromDataMessage:(AVIMJsonObjectMessage *)message
 {
+    if (message.hasBinaryData) {
+        /// @note the event is decoded straight into the property dictionary, no JSON string is built.
+        return [AVMPMessagePackReader readData:message.binaryData
+                                       options:AVMPMessagePackReaderOptionsNoCopy
+                                         error:nil];
+    }
     NSString *JSONString = (message.hasData_p ? message.data_p : nil);
     if (!JSONString) {
-        return;
+        return nil;
     }
-    NSError *error;
-    NSDictionary *dictionary = [NSJSONSerialization JSONObjectWithData:[JSONString dataUsingEncoding:NSUTF8StringEncoding]
-                                                               options:0
-                                                                 error:&error];
-    if (error || !dictionary) {
+    return [NSJSONSerialization JSONObjectWithData:[JSONString dataUsingEncoding:NSUTF8StringEncoding]
+                                           options:0
+                                             error:nil];
+}
+
+- (void)handleDataMessage:(AVIMJsonObjectMessage *)message
+{
+    NSDictionary *dictionary = [AVSubscriber dictionaryFromDataMessage:message];
+    if (![dictionary isKindOfClass:[NSDictionary class]]) {
         return;
     }
     NSDictionary *event = (NSDictionary *)[AVObjectUtils objectFromDictionary:dictionary
@@ -166,6 +179,11 @@ NSNotificationName const AVLiveQueryEventNotification = @"AVLiveQueryEventNotifi
     command.appId = [self.serviceConsumer.application identifierThrowException];
     command.installationId = self.identifier;
     command.service = LCRTMServiceLiveQuery;
+    if ([AVOSCloudIM defaultOptions].messagePackBodyEnabled) {
+        AVIMSessionCommand *sessionCommand = [AVIMSessionCommand new];
+        sessionCommand.configBitmap = LCIMSessionConfigOptionsMessagePackBody;
+        command.sessionMessage = sessionCommand;
+    }
     return command;
 }
 
@@ -0,0 +1,272 @@
+//
+//  AVCacheManagerTestCase.swift
+//  LeanCloudObjcTests
+//
+//  Copyright © 2021 LeanCloud Inc. All rights reserved.
+//
+
+import XCTest
+@testable import LeanCloudObjc
+
+class AVCacheManagerTestCase: BaseTestCase {
+
+    func testSaveAndGet() {
+        let cacheManager = AVCacheManager.sharedInstance()
+        let key = uuid
+        let JSON: [String: Any] = ["results": [["objectId": uuid, "count": 1]]]
+
+        cacheManager.saveJSON(JSON, forKey: key)
+        XCTAssertTrue(cacheManager.hasCache(forKey: key))
+
+        expecting { (exp) in
+            cacheManager.get(withKey: key, maxCacheAge: 60) { (object, error) in
+                XCTAssertNil(error)
+                XCTAssertEqual((object as? NSDictionary), JSON as NSDictionary)
+                exp.fulfill()
+            }
+        }
+
+        expecting { (exp) in
+            cacheManager.get(withKey: key, maxCacheAge: 0) { (object, error) in
+                XCTAssertNil(object)
+                XCTAssertNotNil(error)
+                exp.fulfill()
+            }
+        }
+
+        cacheManager.clearCache(forKey: key)
+        XCTAssertFalse(cacheManager.hasCache(forKey: key))
+    }
+
+    func testExpiry() {
+        let cacheManager = AVCacheManager.sharedInstance()
+        let key = uuid
+
+        cacheManager.saveJSON(["value": 1], forKey: key, maxCacheAge: 1)
+        XCTAssertTrue(cacheManager.hasCache(forKey: key))
+        Thread.sleep(forTimeInterval: 1.5)
+        XCTAssertFalse(cacheManager.hasCache(forKey: key))
+    }
+
+    func testEviction() {
+        let cacheManager = AVCacheManager.sharedInstance()
+        let maxCacheSize = cacheManager.maxCacheSize
+        defer {
+            cacheManager.maxCacheSize = maxCacheSize
+        }
+        XCTAssertTrue(AVCacheManager.clearAllCache())
+
+        cacheManager.maxCacheSize = 64 * 1024
+        let keys = (0..<64).map { "\(uuid)-\($0)" }
+        let value = String(repeating: "x", count: 4 * 1024)
+        cacheManager.saveJSON(["value": value], forKey: keys[0])
+        expecting { (exp) in
+            cacheManager.get(withKey: keys[0], maxCacheAge: 60) { (object, error) in
+                XCTAssertNotNil(object)
+                exp.fulfill()
+            }
+        }
+        for key in keys.dropFirst() {
+            cacheManager.saveJSON(["value": value], forKey: key)
+        }
+
+        /* The least recently used values go first, so the newest ones are kept. */
+        let keptKeys = keys.filter { cacheManager.hasCache(forKey: $0) }
+        XCTAssertTrue(cacheManager.hasCache(forKey: keys.last!))
+        XCTAssertLessThanOrEqual(keptKeys.count, 16)
+        XCTAssertEqual(keptKeys, Array(keys.suffix(keptKeys.count)))
+
+        /* An evicted value is not served from the memory cache either. */
+        expecting { (exp) in
+            cacheManager.get(withKey: keys[0], maxCacheAge: 60) { (object, error) in
+                XCTAssertNil(object)
+                exp.fulfill()
+            }
+        }
+    }
+
+    func testCollapsingCachedGets() {
+        let client = AVPaasClient.sharedInstance()
+        let parameters = ["where": "{\"objectId\":\"\(uuid)\"}"]
+        let collapsedRequestCount = client.collapsedRequestCount
+        let cacheHitCount = client.cacheHitCount
+
+        expecting(count: 5) { (exp) in
+            for _ in 0..<5 {
+                client.getObject("classes/\(uuid)", withParameters: parameters, policy: .cacheElseNetwork, maxCacheAge: 60) { (_, _) in
+                    exp.fulfill()
+                }
+            }
+        }
+        XCTAssertEqual(client.collapsedRequestCount, collapsedRequestCount)
+
+        let path = "classes/AVCacheManagerTestCase"
+        var results: [NSDictionary] = []
+        expecting(count: 5) { (exp) in
+            for _ in 0..<5 {
+                client.getObject(path, withParameters: parameters, policy: .cacheElseNetwork, maxCacheAge: 60) { (object, _) in
+                    if let result = object as? NSDictionary {
+                        results.append(result)
+                    }
+                    exp.fulfill()
+                }
+            }
+        }
+        XCTAssertEqual(client.collapsedRequestCount, collapsedRequestCount + 4)
+        XCTAssertEqual(results.count, 5)
+        XCTAssertEqual(Set(results.map { ObjectIdentifier($0) }).count, results.count)
+        XCTAssertTrue(results.allSatisfy { $0 == results.first })
+
+        expecting { (exp) in
+            client.getObject(path, withParameters: parameters, policy: .cacheElseNetwork, maxCacheAge: 60) { (object, error) in
+                XCTAssertNotNil(object)
+                XCTAssertNil(error)
+                exp.fulfill()
+            }
+        }
+        XCTAssertEqual(client.cacheHitCount, cacheHitCount + 1)
+    }
+
+    func testCollapsingCachedGetsPerSession() {
+        let client = AVPaasClient.sharedInstance()
+        let currentUser = client.currentUser
+        defer {
+            client.currentUser = currentUser
+        }
+        let user = AVUser()
+        user.sessionToken = uuid
+        let parameters = ["where": "{\"objectId\":\"\(uuid)\"}"]
+        let collapsedRequestCount = client.collapsedRequestCount
+
+        /* Requests sent with different sessions are not shared. */
+        expecting(count: 4) { (exp) in
+            for sessionUser in [nil, nil, user, user] as [AVUser?] {
+                client.currentUser = sessionUser
+                client.getObject("classes/AVCacheManagerTestCase", withParameters: parameters, policy: .networkOnly, maxCacheAge: 60) { (_, _) in
+                    exp.fulfill()
+                }
+            }
+        }
+        XCTAssertEqual(client.collapsedRequestCount, collapsedRequestCount + 2)
+    }
+
+    func testConditionalGET() {
+        var conditionalRequestHeaders: [String: String]?
+        let body = "{\"results\":[1,2,3]}".data(using: .utf8)!
+        let server = LocalHTTPStubServer { (headers) in
+            if headers["if-none-match"] == "\"v1\"" {
+                conditionalRequestHeaders = headers
+                return (304, ["ETag": "\"v1\""], Data())
+            }
+            return (200, ["ETag": "\"v1\"", "Last-Modified": "Mon, 01 Feb 2021 00:00:00 GMT", "Content-Type": "application/json"], body)
+        }
+        defer {
+            server.stop()
+        }
+
+        let request = URLRequest(url: URL(string: "http://127.0.0.1:\(server.port)/1.1/classes/\(uuid)")!)
+        for _ in 0..<2 {
+            expecting { (exp) in
+                AVPaasClient.sharedInstance().perform(request, saveResult: true) { (object, error) in
+                    XCTAssertNil(error)
+                    XCTAssertEqual((object as? [String: Any])?["results"] as? [Int], [1, 2, 3])
+                    exp.fulfill()
+                }
+            }
+        }
+
+        XCTAssertEqual(conditionalRequestHeaders?["if-none-match"], "\"v1\"")
+        XCTAssertEqual(conditionalRequestHeaders?["if-modified-since"], "Mon, 01 Feb 2021 00:00:00 GMT")
+        XCTAssertEqual(AVCacheManager.sharedInstance().conditionalHeaders(forKey: request.url!.absoluteString)["If-None-Match"], "\"v1\"")
+    }
+
+    func testConditionalHeadersFollowSaves() {
+        let cacheManager = AVCacheManager.sharedInstance()
+        let key = uuid
+
+        cacheManager.saveJSON(["value": 1], forKey: key, eTag: "\"v1\"", lastModified: nil)
+        XCTAssertEqual(cacheManager.conditionalHeaders(forKey: key), ["If-None-Match": "\"v1\""])
+        XCTAssertTrue(cacheManager.hasCache(forKey: key))
+        XCTAssertEqual(cacheManager.conditionalHeaders(forKey: key), ["If-None-Match": "\"v1\""])
+
+        cacheManager.saveJSON(["value": 2], forKey: key)
+        XCTAssertEqual(cacheManager.conditionalHeaders(forKey: key), [:])
+
+        cacheManager.saveJSON(["value": 3], forKey: key, eTag: nil, lastModified: "Mon, 01 Feb 2021 00:00:00 GMT")
+        XCTAssertEqual(cacheManager.conditionalHeaders(forKey: key), ["If-Modified-Since": "Mon, 01 Feb 2021 00:00:00 GMT"])
+        cacheManager.clearCache(forKey: key)
+        XCTAssertEqual(cacheManager.conditionalHeaders(forKey: key), [:])
+    }
+}
+
+/// A minimal HTTP/1.1 server on 127.0.0.1, answering one connection at a time with `handler`.
+/// Request header names are passed to `handler` in lowercase, along with the `:method` and `:path` of the request line.
+class LocalHTTPStubServer {
+
+    typealias Response = (status: Int, headers: [String: String], body: Data)
+
+    private(set) var port: UInt16 = 0
+    private let listeningSocket: Int32
+
+    init(handler: @escaping ([String: String]) -> Response) {
+        listeningSocket = socket(AF_INET, SOCK_STREAM, 0)
+
+        var address = sockaddr_in()
+        var length = socklen_t(MemoryLayout<sockaddr_in>.size)
+        address.sin_len = UInt8(length)
+        address.sin_family = sa_family_t(AF_INET)
+        address.sin_addr.s_addr = inet_addr("127.0.0.1")
+        withUnsafeMutablePointer(to: &address) {
+            $0.withMemoryRebound(to: sockaddr.self, capacity: 1) {
+                _ = bind(listeningSocket, $0, length)
+                _ = getsockname(listeningSocket, $0, &length)
+            }
+        }
+        listen(listeningSocket, 8)
+        port = UInt16(bigEndian: address.sin_port)
+
+        let listeningSocket = self.listeningSocket
+        Thread.detachNewThread {
+            while true {
+                let connection = accept(listeningSocket, nil, nil)
+                guard connection >= 0 else {
+                    return
+                }
+                var request = Data()
+                var buffer = [UInt8](repeating: 0, count: 4096)
+                while request.range(of: "\r\n\r\n".data(using: .utf8)!) == nil {
+                    let count = read(connection, &buffer, buffer.count)
+                    guard count > 0 else {
+                        break
+                    }
+                    request.append(buffer, count: count)
+                }
+                let lines = (String(data: request, encoding: .utf8) ?? "").components(separatedBy: "\r\n")
+                let requestLine = lines.first?.components(separatedBy: " ") ?? []
+                var headers: [String: String] = [:]
+                if requestLine.count > 1 {
+                    headers[":method"] = requestLine[0]
+                    headers[":path"] = requestLine[1]
+                }
+                for line in lines.dropFirst() {
+                    if let separator = line.range(of: ": ") {
+                        headers[line[..<separator.lowerBound].lowercased()] = String(line[separator.upperBound...])
+                    }
+                }
+                let response = handler(headers)
+                var head = "HTTP/1.1 \(response.status) Stub\r\nContent-Length: \(response.body.count)\r\nConnection: close\r\n"
+                for (field, value) in response.headers {
+                    head += "\(field): \(value)\r\n"
+                }
+                let data = (head + "\r\n").data(using: .utf8)! + response.body
+                _ = data.withUnsafeBytes { write(connection, $0.baseAddress, data.count) }
+                close(connection)
+            }
+        }
+    }
+
+    func stop() {
+        shutdown(listeningSocket, SHUT_RDWR)
+        close(listeningSocket)
+    }
+}
@@ -0,0 +1,244 @@
+//
+//  AVPaasClientTestCase.swift
+//  LeanCloudObjcTests
+//
+//  Copyright © 2021 LeanCloud Inc. All rights reserved.
+//
+
+import XCTest
+@testable import LeanCloudObjc
+
+class AVPaasClientTestCase: BaseTestCase {
+
+    var journalDirectories: [String] = []
+
+    override func tearDown() {
+        for directory in journalDirectories {
+            try? FileManager.default.removeItem(atPath: directory)
+        }
+        journalDirectories = []
+        super.tearDown()
+    }
+
+    func newJournalDirectory() -> String {
+        let directory = (NSTemporaryDirectory() as NSString).appendingPathComponent(uuid)
+        try! FileManager.default.createDirectory(atPath: directory, withIntermediateDirectories: true, attributes: nil)
+        journalDirectories.append(directory)
+        return directory
+    }
+
+    func journalSize(_ directory: String) -> Int {
+        let attributes = try? FileManager.default.attributesOfItem(atPath: (directory as NSString).appendingPathComponent("journal"))
+        return (attributes?[.size] as? NSNumber)?.intValue ?? 0
+    }
+
+    func request(_ index: Int, method: String = "DELETE", sessionToken: String? = nil, headers: [String: String] = [:]) -> URLRequest {
+        var request = URLRequest(url: URL(string: "http://127.0.0.1/1.1/classes/AVPaasClientTestCase/\(index)")!)
+        request.httpMethod = method
+        if let sessionToken = sessionToken {
+            request.setValue(sessionToken, forHTTPHeaderField: "X-LC-Session")
+        }
+        for (field, value) in headers {
+            request.setValue(value, forHTTPHeaderField: field)
+        }
+        return request
+    }
+
+    func testEventuallyRequestsReplayInOrder() {
+        let lock = NSLock()
+        var requestPaths: [String] = []
+        let server = LocalHTTPStubServer { (headers) in
+            lock.lock()
+            requestPaths.append(headers[":path"] ?? "")
+            lock.unlock()
+            return (200, ["Content-Type": "application/json"], "{}".data(using: .utf8)!)
+        }
+        defer {
+            server.stop()
+        }
+
+        let paths = (0..<5).map { "/1.1/classes/AVPaasClientTestCase/\(uuid)-\($0)" }
+        var replayedPaths: [String] = []
+        expecting(count: paths.count) { (exp) in
+            for path in paths {
+                AVPaasClient.sharedInstance().deleteObject("http://127.0.0.1:\(server.port)\(path)", withParameters: nil, eventually: true) { (_, error) in
+                    XCTAssertNil(error)
+                    replayedPaths.append(path)
+                    exp.fulfill()
+                }
+            }
+        }
+
+        XCTAssertEqual(replayedPaths, paths)
+        lock.lock()
+        XCTAssertEqual(requestPaths, paths)
+        lock.unlock()
+    }
+
+    func testEventuallyRequestsRetryAndReportTheirOwnOutcome() {
+        let paths = (0..<5).map { "/1.1/classes/AVPaasClientTestCase/\(uuid)-\($0)" }
+        let lock = NSLock()
+        var requestPaths: [String] = []
+        var failureCount = 1
+        let server = LocalHTTPStubServer { (headers) in
+            lock.lock()
+            defer {
+                lock.unlock()
+            }
+            let path = headers[":path"] ?? ""
+            requestPaths.append(path)
+            if path == paths[0] && failureCount > 0 {
+                failureCount -= 1
+                return (503, ["Content-Type": "application/json"], "{\"code\":503,\"error\":\"unavailable\"}".data(using: .utf8)!)
+            }
+            return (200, ["Content-Type": "application/json"], "{}".data(using: .utf8)!)
+        }
+        defer {
+            server.stop()
+        }
+
+        var outcomes: [(path: String, error: NSError?)] = []
+        expecting(count: paths.count) { (exp) in
+            for path in paths {
+                AVPaasClient.sharedInstance().deleteObject("http://127.0.0.1:\(server.port)\(path)", withParameters: nil, eventually: true) { (_, error) in
+                    outcomes.append((path, error as NSError?))
+                    exp.fulfill()
+                }
+            }
+        }
+
+        XCTAssertEqual(outcomes.map { $0.path }, paths)
+        XCTAssertEqual(outcomes.first?.error?.code, 503)
+        XCTAssertTrue(outcomes.dropFirst().allSatisfy { $0.error == nil })
+
+        /* The failed request does not hold back requests to other objects, and is retried after a backoff. */
+        var attempts = 0
+        while attempts < 10 {
+            lock.lock()
+            let count = requestPaths.count
+            lock.unlock()
+            if count > paths.count {
+                break
+            }
+            delay(seconds: 1)
+            attempts += 1
+        }
+        lock.lock()
+        XCTAssertEqual(requestPaths, paths + [paths[0]])
+        lock.unlock()
+    }
+
+    func testEventuallyServerFailuresAreCapped() {
+        let client = AVPaasClient.sharedInstance()
+        let serverError = NSError(domain: "LeanCloudErrorDomain", code: 503, userInfo: ["code": 503, "error": "unavailable"])
+        let entry = LCEventuallyEntry()
+        for _ in 0..<4 {
+            XCTAssertFalse(client.shouldAcknowledgeEventuallyEntry(entry, error: serverError))
+        }
+        XCTAssertTrue(client.shouldAcknowledgeEventuallyEntry(entry, error: serverError))
+        XCTAssertEqual(entry.serverFailureCount, 5)
+
+        /* Network errors keep the request without counting against it. */
+        let networkEntry = LCEventuallyEntry()
+        let networkError = NSError(domain: NSURLErrorDomain, code: NSURLErrorNotConnectedToInternet, userInfo: nil)
+        for _ in 0..<10 {
+            XCTAssertFalse(client.shouldAcknowledgeEventuallyEntry(networkEntry, error: networkError))
+        }
+        XCTAssertEqual(networkEntry.serverFailureCount, 0)
+
+        XCTAssertTrue(client.shouldAcknowledgeEventuallyEntry(LCEventuallyEntry(), error: nil))
+        XCTAssertTrue(client.shouldAcknowledgeEventuallyEntry(LCEventuallyEntry(), error: NSError(domain: "LeanCloudErrorDomain", code: 101, userInfo: ["code": 101, "error": "not found"])))
+    }
+
+    func testJournalTruncatesTornTail() {
+        let directory = newJournalDirectory()
+        let journal = LCEventuallyJournal(directory: directory)
+        for i in 0..<3 {
+            journal.append(request(i), path: nil, parameters: nil, block: nil)
+        }
+        let size = journalSize(directory)
+
+        let fileHandle = FileHandle(forWritingAtPath: (directory as NSString).appendingPathComponent("journal"))!
+        fileHandle.seekToEndOfFile()
+        /* A record header announcing 256 bytes, followed by only one. */
+        fileHandle.write(Data([0, 0, 1, 0, 0xDE, 0xAD, 0xBE, 0xEF, 0x7B]))
+        fileHandle.closeFile()
+
+        let reopened = LCEventuallyJournal(directory: directory)
+        XCTAssertEqual(reopened.entriesToReplay()?.map { $0.request.url }, (0..<3).map { request($0).url })
+        XCTAssertEqual(journalSize(directory), size)
+
+        reopened.append(request(3), path: nil, parameters: nil, block: nil)
+        XCTAssertEqual(LCEventuallyJournal(directory: directory).entriesToReplay()?.map { $0.request.url }, (0..<4).map { request($0).url })
+    }
+
+    func testJournalCompaction() {
+        let directory = newJournalDirectory()
+        let journal = LCEventuallyJournal(directory: directory)
+        for i in 0..<100 {
+            journal.append(request(i), path: nil, parameters: nil, block: nil)
+        }
+        let entries = journal.entriesToReplay()!
+        XCTAssertEqual(entries.count, 100)
+
+        /* Fewer acknowledgements than the threshold are appended as records. */
+        let size = journalSize(directory)
+        journal.acknowledge(Array(entries[0..<5]))
+        XCTAssertGreaterThan(journalSize(directory), size)
+        XCTAssertEqual(LCEventuallyJournal(directory: directory).entriesToReplay()?.map { $0.sequence }, entries[5...].map { $0.sequence })
+
+        /* Past the threshold, the journal is rewritten with only the pending records. */
+        journal.acknowledge(Array(entries[5..<70]))
+        let pending = Array(entries[70...])
+        XCTAssertEqual(journalSize(directory), 4 + pending.reduce(0) { $0 + $1.record.count })
+        XCTAssertEqual(LCEventuallyJournal(directory: directory).entriesToReplay()?.map { $0.sequence }, pending.map { $0.sequence })
+
+        journal.acknowledge(pending)
+        XCTAssertEqual(journalSize(directory), 4)
+        XCTAssertNil(LCEventuallyJournal(directory: directory).entriesToReplay())
+    }
+
+    func testJournalImportsArchivedRequests() {
+        let directory = newJournalDirectory()
+        let fileNames = ["1612137600.5", "1612137600.25", "1612137601"]
+        for (fileName, index) in zip(fileNames, [1, 0, 2]) {
+            XCTAssertTrue(NSKeyedArchiver.archiveRootObject(request(index) as NSURLRequest, toFile: (directory as NSString).appendingPathComponent(fileName)))
+        }
+
+        let journal = LCEventuallyJournal(directory: directory)
+        XCTAssertEqual(journal.entriesToReplay()?.map { $0.request.url }, (0..<3).map { request($0).url })
+        for fileName in fileNames {
+            XCTAssertFalse(FileManager.default.fileExists(atPath: (directory as NSString).appendingPathComponent(fileName)))
+        }
+        XCTAssertEqual(LCEventuallyJournal(directory: directory).entriesToReplay()?.count, 3)
+    }
+
+    func testEventuallyBatching() {
+        let journal = LCEventuallyJournal(directory: newJournalDirectory())
+        let parameters = ["count": ["__op": "Increment", "amount": 1]]
+        for _ in 0..<3 {
+            journal.append(request(0, method: "PUT", sessionToken: "a"), path: "classes/AVPaasClientTestCase/0", parameters: parameters, block: nil)
+        }
+        journal.append(request(0, method: "PUT", sessionToken: "b"), path: "classes/AVPaasClientTestCase/0", parameters: parameters, block: nil)
+        journal.append(request(1, method: "PUT", sessionToken: "b"), path: "classes/AVPaasClientTestCase/1", parameters: parameters, block: nil)
+        journal.append(request(1), path: nil, parameters: nil, block: nil)
+        journal.append(request(1), path: nil, parameters: nil, block: nil)
+        for _ in 0..<60 {
+            journal.append(request(2, method: "PUT"), path: "classes/AVPaasClientTestCase/2", parameters: parameters, block: nil)
+        }
+        /* Requests are only batched with the same headers, which the batch is sent with. */
+        journal.append(request(3, method: "PUT", headers: ["X-LC-Prod": "0"]), path: "classes/AVPaasClientTestCase/3", parameters: parameters, block: nil)
+        journal.append(request(3, method: "PUT", headers: ["X-LC-Prod": "1"]), path: "classes/AVPaasClientTestCase/3", parameters: parameters, block: nil)
+        journal.append(request(3, method: "PUT", headers: ["X-LC-Prod": "1", "X-LC-Sign": "signed,1"]), path: "classes/AVPaasClientTestCase/3", parameters: parameters, block: nil)
+
+        let client = AVPaasClient.sharedInstance()
+        var entries = journal.entriesToReplay()!
+        var groupSizes: [Int] = []
+        while !entries.isEmpty {
+            let group = client.eventuallyGroup(from: entries)
+            groupSizes.append(group.count)
+            entries.removeFirst(group.count)
+        }
+        XCTAssertEqual(groupSizes, [3, 1, 1, 1, 1, 50, 10, 1, 2])
+    }
+}
@@ -14,6 +14,9 @@ class BaseTestCase: XCTestCase {
     static let timeout: TimeInterval = 60.0
     let timeout: TimeInterval = 60.0
     
+    /// Database files removed with their journals after each test.
+    var databasePaths: [String] = []
+    
     static var uuid: String {
         return UUID().uuidString.replacingOccurrences(of: "-", with: "")
     }
@@ -57,6 +60,16 @@ class BaseTestCase: XCTestCase {
         AVFile.clearAllPersistentCache()
         super.tearDown()
     }
+    
+    override func tearDown() {
+        for path in databasePaths {
+            for suffix in ["", "-wal", "-shm", "-journal"] {
+                try? FileManager.default.removeItem(atPath: path + suffix)
+            }
+        }
+        databasePaths = []
+        super.tearDown()
+    }
 }
 
 extension BaseTestCase {
@@ -96,6 +109,12 @@ extension BaseTestCase {
         wait(for: exps, timeout: timeout)
     }
     
+    func newDatabasePath() -> String {
+        let path = (NSTemporaryDirectory() as NSString).appendingPathComponent("\(uuid).db")
+        databasePaths.append(path)
+        return path
+    }
+    
     func delay(seconds: TimeInterval = 3.0) {
         let exp = expectation(description: "delay \(seconds) seconds.")
         exp.isInverted = true
@@ -115,10 +115,376 @@ class IMMessageTestCase: RTMBaseTestCase {
         delegator3.reset()
         delegator4.reset()
     }
+    
+    func testSendMessages() {
+        guard let client1 = newOpenedClient(clientIDSuffix: "1"),
+              let client2 = newOpenedClient(clientIDSuffix: "2") else {
+            XCTFail()
+            return
+        }
+        
+        let delegator2 = AVIMClientDelegator()
+        client2.delegate = delegator2
+        var conversation: AVIMConversation?
+        
+        expecting { (exp) in
+            client1.createConversation(withName: nil, clientIds: [client2.clientId]) { (conv, error) in
+                XCTAssertNil(error)
+                conversation = conv
+                exp.fulfill()
+            }
+        }
+        
+        let messages = (0..<5).map { AVIMTextMessage(text: "\($0)", attributes: nil) }
+        var sentMessages: [AVIMMessage] = []
+        
+        expecting(count: 10) { (exp) in
+            delegator2.didReceiveTypedMessage = { _, _ in
+                exp.fulfill()
+            }
+            conversation?.sendMessages(messages, option: nil, callback: { (message, success, error) in
+                XCTAssertTrue(success)
+                XCTAssertNil(error)
+                XCTAssertNotNil(message.messageId)
+                sentMessages.append(message)
+                exp.fulfill()
+            })
+        }
+        
+        XCTAssertEqual(sentMessages.count, messages.count)
+        for (sent, message) in zip(sentMessages, messages) {
+            XCTAssertTrue(sent === message)
+        }
+        XCTAssertNotNil(conversation?.lastMessage)
+        XCTAssertEqual(
+            conversation?.lastMessage?.sendTimestamp,
+            messages.map { $0.sendTimestamp }.max())
+        
+        delegator2.reset()
+    }
+
+    func testReadAheadOnlyFillsCache() {
+        guard let client1 = newOpenedClient(clientIDSuffix: "1"),
+              let client2 = newOpenedClient(clientIDSuffix: "2") else {
+            XCTFail()
+            return
+        }
+
+        var conversation: AVIMConversation?
+        expecting { (exp) in
+            client1.createConversation(withName: nil, clientIds: [client2.clientId]) { (conv, error) in
+                XCTAssertNil(error)
+                conversation = conv
+                exp.fulfill()
+            }
+        }
+        guard let conv = conversation, let conversationID = conv.conversationId else {
+            XCTFail()
+            return
+        }
+
+        let pageSize = 5
+        let messages = (0..<(pageSize * 3)).map { AVIMTextMessage(text: "\($0)", attributes: nil) }
+        expecting(count: messages.count) { (exp) in
+            conv.sendMessages(messages, option: nil, callback: { (_, success, error) in
+                XCTAssertTrue(success)
+                XCTAssertNil(error)
+                exp.fulfill()
+            })
+        }
+
+        let cacheStore = LCIMMessageCacheStore(clientId: client1.clientId, conversationId: conversationID)
+        cacheStore.cleanCache()
+        client1.messageQueryReadAheadPageCount = 2
+
+        expecting { (exp) in
+            conv.queryMessages(withLimit: UInt(pageSize)) { (result, error) in
+                XCTAssertNil(error)
+                XCTAssertEqual(result?.map { $0.messageId }, messages.suffix(pageSize).map { $0.messageId })
+                exp.fulfill()
+            }
+        }
+        let lastMessage = conv.lastMessage
+        XCTAssertEqual(lastMessage?.messageId, messages.last?.messageId)
+
+        /* Two more pages are read ahead into the cache. */
+        var attempts = 0
+        while cacheStore.latestMessages(limit: 100).count < messages.count && attempts < 30 {
+            delay(seconds: 1)
+            attempts += 1
+        }
+        XCTAssertEqual(
+            (cacheStore.latestMessages(limit: 100) as! [AVIMMessage]).map { $0.messageId },
+            messages.map { $0.messageId })
+        XCTAssertTrue(conv.lastMessage === lastMessage)
+    }
+
+    func testFileUploadStageLimitsConcurrentUploads() {
+        let queue = DispatchQueue(label: "IMMessageTestCase.file-upload-stage")
+        let files = (0..<7).map { _ in StubUploadFile() }
+        var messages: [AVIMMessage] = files.map { AVIMFileMessage(text: nil, file: $0, attributes: nil) }
+        messages.insert(AVIMTextMessage(text: "no file", attributes: nil), at: 3)
+        let stage = LCIMMessageFileUploadStage(messages: messages, maxConcurrentCount: 2, queue: queue)
+
+        var filledFiles: [AVFile] = []
+        var completionCount = 0
+        queue.sync {
+            stage.start(fillingBlock: { (_, file) in
+                filledFiles.append(file)
+            }, completion: { (_) in
+                completionCount += 1
+            })
+        }
+
+        var maxUploadingCount = 0
+        while true {
+            let uploadingFiles = queue.sync { files.filter { $0.isUploading } }
+            guard let file = uploadingFiles.last else {
+                break
+            }
+            maxUploadingCount = max(maxUploadingCount, uploadingFiles.count)
+            file.finish()
+            queue.sync {}
+        }
+
+        XCTAssertEqual(maxUploadingCount, 2)
+        XCTAssertEqual(files.map { $0.uploadCount }, Array(repeating: 1, count: files.count))
+        XCTAssertEqual(Set(filledFiles.map { ObjectIdentifier($0) }), Set(files.map { ObjectIdentifier($0) }))
+        XCTAssertEqual(completionCount, 1)
+        XCTAssertTrue(stage.failures.allSatisfy { $0 is NSNull })
+    }
+
+    func testFileUploadStageCancelsQueuedAndUploadingMessages() {
+        let queue = DispatchQueue(label: "IMMessageTestCase.file-upload-stage")
+        let files = (0..<3).map { _ in StubUploadFile() }
+        let messages = files.map { AVIMFileMessage(text: nil, file: $0, attributes: nil) }
+        let stage = LCIMMessageFileUploadStage(messages: messages, maxConcurrentCount: 1, queue: queue)
+
+        var filledFiles: [AVFile] = []
+        var completedStage: LCIMMessageFileUploadStage?
+        queue.sync {
+            stage.start(fillingBlock: { (_, file) in
+                filledFiles.append(file)
+            }, completion: { (stage) in
+                completedStage = stage
+            })
+        }
+        XCTAssertTrue(queue.sync { files[0].isUploading })
+
+        /* The first message is uploading, the second one is still queued. */
+        queue.sync {
+            stage.cancelMessages([messages[0], messages[1]])
+        }
+        XCTAssertTrue(queue.sync { files[0].isCancelled })
+        XCTAssertEqual(files[1].uploadCount, 0)
+        XCTAssertEqual(messages[1].status, .failed)
+        /* The cancelled upload holds its slot until it returns. */
+        XCTAssertFalse(queue.sync { files[2].isUploading })
+
+        /* An upload finishing after it was cancelled still fails its message. */
+        files[0].finish()
+        queue.sync {}
+        XCTAssertTrue(queue.sync { files[2].isUploading })
+        XCTAssertNil(completedStage)
+        files[2].finish()
+        queue.sync {}
+
+        XCTAssertTrue(completedStage === stage)
+        XCTAssertEqual(files.map { $0.uploadCount }, [1, 0, 1])
+        XCTAssertEqual(filledFiles.map { ObjectIdentifier($0) }, [ObjectIdentifier(files[2])])
+        XCTAssertEqual((stage.failures[0] as? NSError)?.code, NSURLErrorCancelled)
+        XCTAssertEqual((stage.failures[1] as? NSError)?.code, NSURLErrorCancelled)
+        XCTAssertTrue(stage.failures[2] is NSNull)
+        XCTAssertEqual(messages[0].status, .failed)
+    }
+
+    func testCancelSendingMessages() {
+        guard let client1 = newOpenedClient(clientIDSuffix: "1"),
+              let client2 = newOpenedClient(clientIDSuffix: "2") else {
+            XCTFail()
+            return
+        }
+
+        var conversation: AVIMConversation?
+        expecting { (exp) in
+            client1.createConversation(withName: nil, clientIds: [client2.clientId]) { (conv, error) in
+                XCTAssertNil(error)
+                conversation = conv
+                exp.fulfill()
+            }
+        }
+        guard let conv = conversation else {
+            XCTFail()
+            return
+        }
+
+        let files = (0..<3).map { _ in StubUploadFile() }
+        let messages: [AVIMMessage] = files.map { AVIMFileMessage(text: nil, file: $0, attributes: nil) } + [AVIMTextMessage(text: "text", attributes: nil)]
+        let option = AVIMMessageOption()
+        option.maxConcurrentFileUploadCount = 1
+
+        var results: [(message: AVIMMessage, succeeded: Bool, error: NSError?)] = []
+        expecting(count: messages.count) { (exp) in
+            files[0].onUpload = { (file) in
+                /* Cancels the uploading message and the queued one, then lets the upload return. */
+                conv.cancelSendingMessages([messages[0], messages[1]])
+                client1.internalSerialQueue.async {
+                    file.finish()
+                }
+            }
+            files[2].onUpload = { (file) in
+                file.finish()
+            }
+            conv.sendMessages(messages, option: option, callback: { (message, succeeded, error) in
+                results.append((message, succeeded, error as NSError?))
+                exp.fulfill()
+            })
+        }
+
+        XCTAssertEqual(results.map { ObjectIdentifier($0.message) }, messages.map { ObjectIdentifier($0) })
+        XCTAssertEqual(results.map { $0.succeeded }, [false, false, true, true])
+        XCTAssertEqual(results.map { $0.error?.code }, [NSURLErrorCancelled, NSURLErrorCancelled, nil, nil])
+        XCTAssertEqual(files.map { $0.uploadCount }, [1, 0, 1])
+        XCTAssertNil(messages[0].messageId)
+        XCTAssertNil(messages[1].messageId)
+        XCTAssertNotNil(messages[2].messageId)
+        XCTAssertNotNil(messages[3].messageId)
+    }
+
+    func testTypedMessagePayloadMatchesJSONSerialization() {
+        let nulString = NSString(bytes: [0x61, 0x00, 0x62] as [UInt8], length: 3, encoding: String.Encoding.ascii.rawValue)!
+        let message = AVIMTextMessage(text: "\u{0}text \"quoted\" \\ /\n\u{1F600} 中文", attributes: [
+            "nul": nulString,
+            "float": Float(0.1),
+            "double": 0.1,
+            "integral": 2.0,
+            "large": 1e20,
+            "decimal": NSDecimalNumber(string: "3.14159265358979323846"),
+            "int": Int64.min,
+            "uint": UInt64.max,
+            "bool": true,
+            "nested": ["array": [1, 2.5, "a\u{0}b", NSNull()]],
+        ])
+        message.setObject(nulString, forKey: "custom")
+        message.setObject(NSNull(), forKey: "removed")
+
+        let payloadData = message.messageObject.payloadData()!
+        let jsonData = try! JSONSerialization.data(withJSONObject: message.messageObject.dictionary()!)
+        let payload = try! JSONSerialization.jsonObject(with: payloadData) as! NSDictionary
+        XCTAssertEqual(payload, try! JSONSerialization.jsonObject(with: jsonData) as! NSDictionary)
+        XCTAssertEqual((payload["custom"] as? String)?.utf8.count, 3)
+        XCTAssertNil(payload["removed"])
+
+        /* Integers and decimals keep their digits, other numbers are written with the shortest digits of the same value. */
+        let payloadString = String(data: payloadData, encoding: .utf8)!
+        let jsonString = String(data: jsonData, encoding: .utf8)!
+        XCTAssertTrue(payloadString.contains("\"float\":0.1"))
+        XCTAssertFalse(payloadString.contains("\"float\":0.10"))
+        XCTAssertTrue(payloadString.contains("\"large\":1e+20"))
+        XCTAssertEqual(payload["large"] as? Double, 1e20)
+        for key in ["double", "integral", "decimal", "uint"] {
+            let attributes = message.attributes! as NSDictionary
+            let number = String(data: try! JSONSerialization.data(withJSONObject: [attributes[key]!]), encoding: .utf8)!.dropFirst().dropLast()
+            XCTAssertTrue(payloadString.contains("\"\(key)\":\(number)"), key)
+            XCTAssertTrue(jsonString.contains("\"\(key)\":\(number)"), key)
+        }
+
+        /* The direct command carries the encoded bytes as its 'msg' field, which reads back as set. */
+        let directCommand = AVIMDirectCommand()
+        directCommand.cid = uuid
+        directCommand.avim_setMsgData(payloadData)
+        XCTAssertTrue(directCommand.hasMsg)
+        XCTAssertEqual(directCommand.msg.data(using: .utf8), payloadData)
+        let decoded = try! AVIMDirectCommand(data: directCommand.data()!)
+        XCTAssertEqual(decoded.cid, directCommand.cid)
+        XCTAssertEqual(decoded.msg.data(using: .utf8), payloadData)
+    }
+
+    func testMessagePackSchemaWriterMatchesGenericWriter() {
+        let nulString = NSString(bytes: [0x61, 0x00, 0x62] as [UInt8], length: 3, encoding: String.Encoding.ascii.rawValue)!
+        let fields: [[String: Any]] = [
+            ["_lctype": -1],
+            ["_lctype": Int64.max],
+            ["_lctype": UInt64.max],
+            ["_lctype": 2.0],
+            ["_lctype": Float(1.5)],
+            ["_lctext": nulString],
+            ["_lctext": String(repeating: "中文 \u{1F600}", count: 20)],
+            ["_lcattrs": ["nul": nulString, "double": 3.0, "nested": [1, "/", NSNull()]]],
+            ["custom": nulString],
+        ]
+        for field in fields {
+            /* A plain dynamic object has no schema and takes the generic path. */
+            let schemaData = AVIMTypedMessageObject(dictionary: field).messagePack()
+            let genericData = AVIMDynamicObject(dictionary: field).messagePack()
+            XCTAssertNotNil(schemaData)
+            XCTAssertEqual(schemaData, genericData, "\(field)")
+        }
+        let decoded = AVIMTypedMessageObject(messagePack: AVIMTypedMessageObject(dictionary: fields[5]).messagePack())
+        XCTAssertEqual(decoded?._lctext?.utf16.count, 3)
+
+        /* The message accessors store doubles, which the schema writes the way the generic path does. */
+        let messageObject = AVIMMessageObject()
+        messageObject.ioType = .out
+        messageObject.status = .sent
+        messageObject.sendTimestamp = 1_500_000_000_123
+        messageObject.deliveredTimestamp = 1_500_000_000_456
+        messageObject.messageId = uuid
+        let messageFields = messageObject.dictionary()!
+        XCTAssertEqual(messageObject.messagePack(), AVIMDynamicObject(dictionary: messageFields).messagePack())
+        for field in [["status": 3], ["sendTimestamp": Int64.max], ["readTimestamp": Float(1.5)], ["readTimestamp": 2.0]] as [[String: Any]] {
+            XCTAssertEqual(AVIMMessageObject(dictionary: field).messagePack(), AVIMDynamicObject(dictionary: field).messagePack(), "\(field)")
+        }
+    }
+
+    func testMessagePackSchemaWriterPerformance() {
+        let objects = messagePackBenchmarkDictionaries().map { AVIMTypedMessageObject(dictionary: $0) }
+        measure {
+            for object in objects {
+                XCTAssertNotNil(object.messagePack())
+            }
+        }
+    }
+
+    func testMessagePackGenericWriterPerformance() {
+        let objects = messagePackBenchmarkDictionaries().map { AVIMDynamicObject(dictionary: $0) }
+        measure {
+            for object in objects {
+                XCTAssertNotNil(object.messagePack())
+            }
+        }
+    }
+
+    func testMessageArchivingPerformance() {
+        let messages: [AVIMMessage] = (0..<500).map {
+            AVIMTextMessage(
+                text: "Message \($0), the quick brown fox jumps over the lazy dog.",
+                attributes: ["index": $0, "mention": "client-\($0 % 7)", "pinned": $0 % 2 == 0])
+        }
+
+        measure {
+            for message in messages {
+                let data = NSKeyedArchiver.archivedData(withRootObject: message)
+                let unarchived = NSKeyedUnarchiver.unarchiveObject(with: data) as? AVIMTextMessage
+                XCTAssertEqual(unarchived?.text, (message as? AVIMTextMessage)?.text)
+            }
+        }
+    }
 }
 
 extension IMMessageTestCase {
     
+    func messagePackBenchmarkDictionaries() -> [[String: Any]] {
+        return (0..<1000).map {
+            [
+                "_lctype": -2,
+                "_lctext": "Message \($0), the quick brown fox jumps over the lazy dog.",
+                "_lcfile": ["url": "https://example.com/\($0).png", "objId": "\($0)", "metaData": ["size": 1024 * $0, "width": 640, "height": 480]],
+                "_lcattrs": ["index": $0, "mention": "client-\($0 % 7)", "pinned": $0 % 2 == 0],
+            ]
+        }
+    }
+    
     func newOpenedClient(
         clientID: String? = nil,
         clientIDSuffix: String? = nil) -> AVIMClient?
@@ -141,3 +507,32 @@ extension IMMessageTestCase {
         return client
     }
 }
+
+/// A file whose uploads are finished by the test instead of the network.
+class StubUploadFile: AVFile {
+    
+    private(set) var uploadCount = 0
+    private(set) var isCancelled = false
+    var onUpload: ((StubUploadFile) -> Void)?
+    private var completionHandler: ((Bool, Error?) -> Void)?
+    
+    var isUploading: Bool {
+        return completionHandler != nil
+    }
+    
+    override func upload(progress uploadProgressBlock: ((Int) -> Void)?, completionHandler: @escaping (Bool, Error?) -> Void) {
+        uploadCount += 1
+        self.completionHandler = completionHandler
+        onUpload?(self)
+    }
+    
+    override func cancelUploading() {
+        isCancelled = true
+    }
+    
+    func finish() {
+        let completionHandler = self.completionHandler
+        self.completionHandler = nil
+        completionHandler?(true, nil)
+    }
+}
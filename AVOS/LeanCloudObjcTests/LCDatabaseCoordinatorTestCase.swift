@@ -0,0 +1,160 @@
+//
+//  LCDatabaseCoordinatorTestCase.swift
+//  LeanCloudObjcTests
+//
+//  Copyright © 2021 LeanCloud Inc. All rights reserved.
+//
+
+import XCTest
+@testable import LeanCloudObjc
+
+class LCDatabaseCoordinatorTestCase: BaseTestCase {
+
+    let producerCount = 8
+    let jobsPerProducer = 250
+
+    func newCoordinator() -> LCDatabaseCoordinator {
+        let coordinator = LCDatabaseCoordinator(databasePath: newDatabasePath())
+        coordinator.executeJob { (db) in
+            XCTAssertTrue(db.executeUpdate("CREATE TABLE t (k INTEGER PRIMARY KEY, v INTEGER)", withArgumentsIn: []))
+        }
+        return coordinator
+    }
+
+    func count(in coordinator: LCDatabaseCoordinator) -> Int32 {
+        var count: Int32 = 0
+        coordinator.executeJob { (db) in
+            let result = db.executeQuery("SELECT COUNT(*) FROM t", withArgumentsIn: [])
+            if result?.next() == true {
+                count = result?.int(forColumnIndex: 0) ?? 0
+            }
+            result?.close()
+        }
+        return count
+    }
+
+    func testAsyncJobs() {
+        let coordinator = newCoordinator()
+        var committed: [Int] = []
+
+        expecting(count: 10) { (exp) in
+            for i in 0..<10 {
+                coordinator.executeTransactionAsync({ (db) in
+                    XCTAssertTrue(db.executeUpdate("INSERT INTO t (k, v) VALUES (?, ?)", withArgumentsIn: [i, i]))
+                }, completionQueue: nil) { (succeeded) in
+                    XCTAssertTrue(Thread.isMainThread)
+                    XCTAssertTrue(succeeded)
+                    committed.append(i)
+                    exp.fulfill()
+                }
+            }
+        }
+        XCTAssertEqual(committed, Array(0..<10))
+
+        for i in 10..<20 {
+            coordinator.executeTransactionAsync({ (db) in
+                XCTAssertTrue(db.executeUpdate("INSERT INTO t (k, v) VALUES (?, ?)", withArgumentsIn: [i, i]))
+            }, completionQueue: nil, completion: nil)
+        }
+        XCTAssertEqual(count(in: coordinator), 20)
+    }
+
+    func testFailedJobIsRolledBackAlone() {
+        let coordinator = newCoordinator()
+        let started = DispatchSemaphore(value: 0)
+        let resume = DispatchSemaphore(value: 0)
+
+        /* Hold the job queue in a first batch, so the next jobs are group committed together. */
+        coordinator.executeTransactionAsync({ (db) in
+            XCTAssertTrue(db.executeUpdate("INSERT INTO t (k, v) VALUES (?, ?)", withArgumentsIn: [0, 0]))
+            started.signal()
+            resume.wait()
+        }, completionQueue: nil, completion: nil)
+        started.wait()
+
+        var results: [Int: Bool] = [:]
+        expecting(count: 3) { (exp) in
+            for i in 1...3 {
+                coordinator.executeTransactionAsync({ (db) in
+                    XCTAssertTrue(db.executeUpdate("INSERT INTO t (k, v) VALUES (?, ?)", withArgumentsIn: [i, i]))
+                    if i == 2 {
+                        NSException(name: .internalInconsistencyException, reason: "job \(i) failed", userInfo: nil).raise()
+                    }
+                }, completionQueue: nil) { (succeeded) in
+                    results[i] = succeeded
+                    exp.fulfill()
+                }
+            }
+            resume.signal()
+        }
+        XCTAssertEqual(results, [1: true, 2: false, 3: true])
+
+        var keys: [Int32] = []
+        coordinator.executeJob { (db) in
+            let result = db.executeQuery("SELECT k FROM t ORDER BY k", withArgumentsIn: [])
+            while result?.next() == true {
+                keys.append(result?.int(forColumnIndex: 0) ?? -1)
+            }
+            result?.close()
+        }
+        XCTAssertEqual(keys, [0, 1, 3])
+    }
+
+    func testAsyncContentionPerformance() {
+        let coordinator = newCoordinator()
+        var base = 0
+
+        measure {
+            let offset = base
+            base += producerCount * jobsPerProducer
+            let group = DispatchGroup()
+            runProducers { (producer, i) in
+                group.enter()
+                coordinator.executeTransactionAsync({ (db) in
+                    _ = db.executeUpdate("INSERT INTO t (k, v) VALUES (?, ?)", withArgumentsIn: [offset + producer * self.jobsPerProducer + i, i])
+                }, completionQueue: DispatchQueue.global()) { (succeeded) in
+                    XCTAssertTrue(succeeded)
+                    group.leave()
+                }
+            }
+            XCTAssertEqual(group.wait(timeout: .now() + 60), .success)
+        }
+        XCTAssertEqual(Int(count(in: coordinator)), base)
+    }
+
+    func testSyncContentionPerformance() {
+        let coordinator = newCoordinator()
+        var base = 0
+
+        measure {
+            let offset = base
+            base += producerCount * jobsPerProducer
+            runProducers { (producer, i) in
+                coordinator.executeJob { (db) in
+                    _ = db.executeUpdate("INSERT INTO t (k, v) VALUES (?, ?)", withArgumentsIn: [offset + producer * self.jobsPerProducer + i, i])
+                }
+            }
+        }
+        XCTAssertEqual(Int(count(in: coordinator)), base)
+    }
+
+    /// Runs `job` `jobsPerProducer` times on each of `producerCount` threads, started together, and waits for them.
+    func runProducers(_ job: @escaping (_ producer: Int, _ index: Int) -> Void) {
+        let start = DispatchSemaphore(value: 0)
+        let group = DispatchGroup()
+        for producer in 0..<producerCount {
+            group.enter()
+            Thread.detachNewThread {
+                start.wait()
+                for i in 0..<self.jobsPerProducer {
+                    job(producer, i)
+                }
+                group.leave()
+            }
+        }
+        for _ in 0..<producerCount {
+            start.signal()
+        }
+        XCTAssertEqual(group.wait(timeout: .now() + 60), .success)
+    }
+}
@@ -0,0 +1,76 @@
+//
+//  LCDatabaseTestCase.swift
+//  LeanCloudObjcTests
+//
+//  Copyright © 2021 LeanCloud Inc. All rights reserved.
+//
+
+import XCTest
+@testable import LeanCloudObjc
+
+class LCDatabaseTestCase: BaseTestCase {
+
+    func testStatementCache() {
+        let db = LCDatabase(path: newDatabasePath())
+        XCTAssertTrue(db.open())
+        defer {
+            _ = db.close()
+        }
+        db.shouldCacheStatements = true
+        db.statementCacheCountLimit = 2
+        XCTAssertTrue(db.executeUpdate("CREATE TABLE t (k TEXT PRIMARY KEY, v INTEGER)", withArgumentsIn: []))
+
+        let insert = LCSQLHandle(sql: "INSERT INTO t (k, v) VALUES (?, ?)")
+        XCTAssertTrue(LCSQLHandle(sql: "INSERT INTO t (k, v) VALUES (?, ?)") === insert)
+
+        let hitCount = db.statementCacheHitCount
+        let missCount = db.statementCacheMissCount
+        for i in 0..<10 {
+            XCTAssertTrue(db.executeUpdate(with: insert, arguments: ["\(i)", i]))
+        }
+        XCTAssertEqual(db.statementCacheHitCount, hitCount + 9)
+        XCTAssertEqual(db.statementCacheMissCount, missCount + 1)
+
+        for column in ["k", "v", "k, v"] {
+            let result = db.executeQuery("SELECT \(column) FROM t", withArgumentsIn: [])
+            XCTAssertEqual(result?.next(), true)
+            result?.close()
+        }
+        XCTAssertEqual(db.cachedStatements.count, 2)
+
+        let result = db.executeQuery(with: LCSQLHandle(sql: "SELECT COUNT(*) FROM t"), arguments: [])
+        XCTAssertEqual(result?.next(), true)
+        XCTAssertEqual(result?.int(forColumnIndex: 0), 10)
+        result?.close()
+    }
+
+    func testRowEnumeration() {
+        let db = LCDatabase(path: newDatabasePath())
+        XCTAssertTrue(db.open())
+        defer {
+            _ = db.close()
+        }
+        db.shouldCacheStatements = true
+        XCTAssertTrue(db.executeUpdate("CREATE TABLE t (k TEXT PRIMARY KEY, v INTEGER)", withArgumentsIn: []))
+        for i in 0..<10 {
+            XCTAssertTrue(db.executeUpdate("INSERT INTO t (k, v) VALUES (?, ?)", withArgumentsIn: ["\(i)", i]))
+        }
+
+        for _ in 0..<2 {
+            var rows: [Int32] = []
+            let result = db.executeQuery("SELECT k, v FROM t ORDER BY v", withArgumentsIn: [])
+            result?.enumerateRows(withColumnNames: ["V", "k", "absent"]) { (row, columnIndexes, stop) in
+                XCTAssertEqual(columnIndexes[0], 1)
+                XCTAssertEqual(columnIndexes[1], 0)
+                XCTAssertEqual(columnIndexes[2], -1)
+                XCTAssertEqual(row.string(forColumnIndex: columnIndexes[1]), "\(row.int(forColumnIndex: columnIndexes[0]))")
+                rows.append(row.int(forColumnIndex: columnIndexes[0]))
+                if rows.count == 5 {
+                    stop.pointee = true
+                }
+            }
+            result?.close()
+            XCTAssertEqual(rows, [0, 1, 2, 3, 4])
+        }
+    }
+}
@@ -0,0 +1,153 @@
+//
+//  LCIMMessageCacheStoreTestCase.swift
+//  LeanCloudObjcTests
+//
+//  Copyright © 2021 LeanCloud Inc. All rights reserved.
+//
+
+import XCTest
+@testable import LeanCloudObjc
+
+class LCIMMessageCacheStoreTestCase: BaseTestCase {
+
+    let conversationID = "LCIMMessageCacheStoreTestCase"
+
+    func newClientID() -> String {
+        let clientID = uuid
+        databasePaths.append(LCIMCacheStore.databasePath(withName: clientID))
+        return clientID
+    }
+
+    func message(_ index: Int) -> AVIMMessage {
+        let message = AVIMMessage(content: "\(index)")
+        message.messageId = String(format: "message-%03d", index)
+        message.clientId = "sender"
+        message.sendTimestamp = 1_612_137_600_000 + Int64(index)
+        return message
+    }
+
+    func index(of message: AVIMMessage) -> Int {
+        return Int(message.messageId!.components(separatedBy: "-").last!)!
+    }
+
+    func cachedIndexes(_ store: LCIMMessageCacheStore) -> [Int] {
+        return store.latestMessages(limit: 100).map { index(of: $0 as! AVIMMessage) }
+    }
+
+    func breakpointIndexes(_ store: LCIMMessageCacheStore) -> [Int] {
+        return store.latestMessages(limit: 100)
+            .map { $0 as! AVIMMessage }
+            .filter { $0.breakpoint }
+            .map { index(of: $0) }
+    }
+
+    func testRangeMerging() {
+        let store = LCIMMessageCacheStore(clientId: newClientID(), conversationId: conversationID)
+
+        store.insertContinuousMessages((0...4).map { message($0) })
+        XCTAssertEqual(breakpointIndexes(store), [0])
+
+        store.insertContinuousMessages((8...9).map { message($0) })
+        XCTAssertEqual(breakpointIndexes(store), [0, 8])
+        XCTAssertEqual(store.latestNoBreakpointMessage()?.messageId, message(9).messageId)
+
+        /* A page overlapping both ranges joins them. */
+        store.insertContinuousMessages((3...8).map { message($0) })
+        XCTAssertEqual(cachedIndexes(store), Array(0...9))
+        XCTAssertEqual(breakpointIndexes(store), [0])
+
+        /* Deleting a message splits its range. */
+        store.deleteMessage(message(5))
+        XCTAssertEqual(cachedIndexes(store), [0, 1, 2, 3, 4, 6, 7, 8, 9])
+        XCTAssertEqual(breakpointIndexes(store), [0, 6])
+
+        /* A new message extends the range before it, unless it has a breakpoint. */
+        let newMessage = message(10)
+        store.insertOrUpdateMessage(newMessage, withBreakpoint: false)
+        store.insertOrUpdateMessage(message(12), withBreakpoint: true)
+        XCTAssertGreaterThan(newMessage.seq, 0)
+        XCTAssertEqual(breakpointIndexes(store), [0, 6, 12])
+
+        /* Updating a cached message keeps its sequence number and ranges. */
+        let updatedMessage = message(10)
+        updatedMessage.content = "updated"
+        store.insertOrUpdateMessage(updatedMessage, withBreakpoint: true)
+        XCTAssertEqual(updatedMessage.seq, newMessage.seq)
+        XCTAssertEqual(breakpointIndexes(store), [0, 6, 12])
+        XCTAssertEqual((store.latestMessages(limit: 100) as! [AVIMMessage]).first { $0.messageId == newMessage.messageId }?.content, "updated")
+    }
+
+    func testPageContinuity() {
+        let store = LCIMMessageCacheStore(clientId: newClientID(), conversationId: conversationID)
+        store.insertContinuousMessages((0...9).map { message($0) })
+        var continuous: ObjCBool = false
+
+        /* A page inside one range is continuous, one starting at the range start is not. */
+        var page = store.messagesBeforeTimestamp(message(10).sendTimestamp, messageId: message(10).messageId, limit: 5, continuous: &continuous) as! [AVIMMessage]
+        XCTAssertEqual(page.map { index(of: $0) }, Array(5...9))
+        XCTAssertTrue(continuous.boolValue)
+        XCTAssertTrue(page.allSatisfy { !$0.breakpoint })
+        page = store.messagesBeforeTimestamp(message(5).sendTimestamp, messageId: message(5).messageId, limit: 5, continuous: &continuous) as! [AVIMMessage]
+        XCTAssertEqual(page.map { index(of: $0) }, Array(0...4))
+        XCTAssertFalse(continuous.boolValue)
+        XCTAssertEqual(page.filter { $0.breakpoint }.map { index(of: $0) }, [0])
+
+        /* A page across two ranges is not continuous either. */
+        store.deleteMessage(message(7))
+        page = store.messagesBeforeTimestamp(message(10).sendTimestamp, messageId: message(10).messageId, limit: 5, continuous: &continuous) as! [AVIMMessage]
+        XCTAssertEqual(page.map { index(of: $0) }, [4, 5, 6, 8, 9])
+        XCTAssertFalse(continuous.boolValue)
+        XCTAssertEqual(page.filter { $0.breakpoint }.map { index(of: $0) }, [8])
+    }
+
+    func testMigrationBuildsRangesFromBreakpoints() {
+        let clientID = newClientID()
+        let database = LCDatabase(path: LCIMCacheStore.databasePath(withName: clientID))
+        XCTAssertTrue(database.open())
+        /* Message table as of the sixth migration, which still has the 'breakpoint' column. */
+        XCTAssertTrue(database.executeStatements("""
+            create table message(
+                seq integer primary key autoincrement, message_id text,
+                conversation_id text, from_peer_id text, timestamp real,
+                receipt_timestamp real, read_timestamp real, patch_timestamp real,
+                mention_all integer, mention_list blob,
+                payload blob, status integer, breakpoint bool);
+            create unique index message_unique_index on message(conversation_id, message_id, timestamp);
+            """))
+        let breakpoints = [true, false, false, true, false, true, true, false]
+        for (index, breakpoint) in breakpoints.enumerated() {
+            let message = self.message(index)
+            XCTAssertTrue(database.executeUpdate(
+                "insert into message (message_id, conversation_id, from_peer_id, timestamp, payload, status, breakpoint) values (?, ?, ?, ?, ?, ?, ?)",
+                withArgumentsIn: [message.messageId!, conversationID, message.clientId!, Double(message.sendTimestamp), message.content!.data(using: .utf8)!, 0, breakpoint]))
+        }
+        /* Continuity never spans conversations. */
+        XCTAssertTrue(database.executeUpdate(
+            "insert into message (message_id, conversation_id, from_peer_id, timestamp, payload, status, breakpoint) values (?, ?, ?, ?, ?, ?, ?)",
+            withArgumentsIn: ["other", uuid, "sender", Double(message(4).sendTimestamp), Data(), 0, false]))
+        database.setUserVersion(6)
+        database.close()
+
+        let store = LCIMMessageCacheStore(clientId: clientID, conversationId: conversationID)
+        XCTAssertEqual(cachedIndexes(store), Array(0..<breakpoints.count))
+        XCTAssertEqual(breakpointIndexes(store), [0, 3, 5, 6])
+        XCTAssertEqual((store.latestMessages(limit: 100) as! [AVIMMessage]).map { $0.seq }, Array(1...Int64(breakpoints.count)))
+
+        var columnNames: [String] = []
+        store.databaseQueue().inDatabase { (db) in
+            let result = db.executeQuery("pragma table_info(message)", withArgumentsIn: [])
+            while result?.next() == true {
+                columnNames.append(result?.string(forColumn: "name") ?? "")
+            }
+            result?.close()
+        }
+        XCTAssertTrue(columnNames.contains("seq"))
+        XCTAssertFalse(columnNames.contains("breakpoint"))
+
+        /* Sequence numbers continue after the copied ones. */
+        let newMessage = message(breakpoints.count)
+        store.insertOrUpdateMessage(newMessage, withBreakpoint: false)
+        XCTAssertEqual(newMessage.seq, Int64(breakpoints.count + 2))
+        XCTAssertEqual(breakpointIndexes(store), [0, 3, 5, 6])
+    }
+}
@@ -0,0 +1,114 @@
+//
+//  LCKeyValueStoreTestCase.swift
+//  LeanCloudObjcTests
+//
+//  Copyright © 2021 LeanCloud Inc. All rights reserved.
+//
+
+import XCTest
+@testable import LeanCloudObjc
+
+class LCKeyValueStoreTestCase: BaseTestCase {
+
+    func testReadThroughAndWriteBehind() {
+        let path = newDatabasePath()
+        let store = LCKeyValueStore(databasePath: path)
+        let key = uuid
+        let data = uuid.data(using: .utf8)!
+
+        XCTAssertNil(store.data(forKey: key))
+        store.setData(data, forKey: key)
+        XCTAssertEqual(store.data(forKey: key), data)
+
+        let anotherStore = LCKeyValueStore(databasePath: path)
+        XCTAssertEqual(anotherStore.data(forKey: key), data)
+
+        store.deleteKey(key)
+        XCTAssertNil(anotherStore.data(forKey: key))
+
+        store.setData(data, forKey: key)
+        store.flush()
+        XCTAssertEqual(anotherStore.data(forKey: key), data)
+    }
+
+    func testLargeValueBypassesMemory() {
+        let store = LCKeyValueStore(databasePath: newDatabasePath())
+        let key = uuid
+        let data = Data(count: 1024 * 1024)
+
+        store.setData(data, forKey: key)
+        XCTAssertEqual(store.data(forKey: key), data)
+        store.flush()
+        XCTAssertEqual(store.data(forKey: key), data)
+    }
+
+    func testBatchOperations() {
+        let path = newDatabasePath()
+        let store = LCKeyValueStore(databasePath: path)
+        var dictionary: [String: Data] = [:]
+        for i in 0..<1200 {
+            dictionary["key-\(i)"] = "\(i)".data(using: .utf8)!
+        }
+
+        store.setDataDictionary(dictionary)
+        store.flush()
+        XCTAssertEqual(LCKeyValueStore(databasePath: path).data(forKeys: Array(dictionary.keys) + ["absent"]), dictionary)
+
+        store.deleteKeys(["key-0", "key-1"])
+        let result = store.data(forKeys: ["key-0", "key-1", "key-2"])
+        XCTAssertEqual(result, ["key-2": dictionary["key-2"]!])
+    }
+
+    func testPrefixAndRangeScan() {
+        let store = LCKeyValueStore(databasePath: newDatabasePath())
+        let keys = ["a", "b/1", "b/2", "b/3", "c"] + (0..<300).map { String(format: "d/%03d", $0) }
+        store.setDataDictionary(Dictionary(uniqueKeysWithValues: keys.map { ($0, $0.data(using: .utf8)!) }))
+
+        var scanned: [String] = []
+        store.enumerateData(withKeyPrefix: "b/") { (key, data, _) in
+            XCTAssertEqual(String(data: data, encoding: .utf8), key)
+            scanned.append(key)
+        }
+        XCTAssertEqual(scanned, ["b/1", "b/2", "b/3"])
+
+        scanned = []
+        store.enumerateData(fromKey: "b/2", toKey: "d/") { (key, _, _) in
+            scanned.append(key)
+        }
+        XCTAssertEqual(scanned, ["b/2", "b/3", "c"])
+
+        scanned = []
+        store.enumerateData(withKeyPrefix: "d/") { (key, _, stop) in
+            scanned.append(key)
+            if scanned.count == 200 {
+                stop.pointee = true
+            }
+        }
+        XCTAssertEqual(scanned, Array(keys[5..<205]))
+
+        for prefix in ["", nil] as [String?] {
+            scanned = []
+            store.enumerateData(withKeyPrefix: prefix) { (key, _, _) in
+                scanned.append(key)
+            }
+            XCTAssertEqual(scanned, keys)
+        }
+    }
+
+    func testReadPerformance() {
+        let store = LCKeyValueStore(databasePath: newDatabasePath())
+        let keys = (0..<100).map { "key-\($0)" }
+        for key in keys {
+            store.setData(key.data(using: .utf8)!, forKey: key)
+        }
+        store.flush()
+
+        measure {
+            for _ in 0..<100 {
+                for key in keys {
+                    XCTAssertNotNil(store.data(forKey: key))
+                }
+            }
+        }
+    }
+}
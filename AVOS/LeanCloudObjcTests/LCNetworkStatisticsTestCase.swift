@@ -0,0 +1,73 @@
+//
+//  LCNetworkStatisticsTestCase.swift
+//  LeanCloudObjcTests
+//
+//  Copyright © 2021 LeanCloud Inc. All rights reserved.
+//
+
+import XCTest
+@testable import LeanCloudObjc
+
+class LCNetworkStatisticsTestCase: BaseTestCase {
+
+    func testStripedCounters() {
+        let statistics = LCNetworkStatistics(keyValueStore: LCKeyValueStore(databasePath: newDatabasePath()))
+
+        DispatchQueue.concurrentPerform(iterations: 8) { (i) in
+            for _ in 0..<1000 {
+                statistics.addResponse(withStatusCode: 200 + i % 2)
+            }
+            statistics.addResponse(withStatusCode: 0)
+            statistics.addTimeout()
+        }
+
+        let attributes = statistics.attributes() as NSDictionary
+        XCTAssertEqual(attributes["200"] as? Int, 4000)
+        XCTAssertEqual(attributes["201"] as? Int, 4000)
+        XCTAssertEqual(attributes["other"] as? Int, 8)
+        XCTAssertEqual(attributes["timeout"] as? Int, 8)
+        XCTAssertEqual(attributes["total"] as? Int, 8016)
+        XCTAssertNil(attributes["avg"])
+    }
+
+    func testLatencyHistogram() {
+        let statistics = LCNetworkStatistics(keyValueStore: LCKeyValueStore(databasePath: newDatabasePath()))
+
+        for _ in 0..<90 {
+            statistics.addResponse(withStatusCode: 200, costTime: 10)
+        }
+        for _ in 0..<10 {
+            statistics.addResponse(withStatusCode: 200, costTime: 1000)
+        }
+        /* Only 2xx responses make it into the histogram. */
+        statistics.addResponse(withStatusCode: 500, costTime: 60000)
+
+        let attributes = statistics.attributes() as NSDictionary
+        XCTAssertEqual(attributes["total"] as? Int, 101)
+        XCTAssertEqual(attributes["avg"] as? Double ?? 0, 109, accuracy: 0.001)
+        /* Percentiles are the middle of a bucket, a quarter octave wide. */
+        XCTAssertEqual(attributes["p50"] as? Double ?? 0, 10, accuracy: 10 * 0.2)
+        XCTAssertEqual(attributes["p90"] as? Double ?? 0, 10, accuracy: 10 * 0.2)
+        XCTAssertEqual(attributes["p99"] as? Double ?? 0, 1000, accuracy: 1000 * 0.2)
+    }
+
+    func testPersistence() {
+        let path = newDatabasePath()
+        let store = LCKeyValueStore(databasePath: path)
+        let statistics = LCNetworkStatistics(keyValueStore: store)
+
+        for costTime in [3.0, 30, 300] {
+            statistics.addResponse(withStatusCode: 200, costTime: costTime)
+        }
+        statistics.addResponse(withStatusCode: 404)
+        statistics.addResponse(withStatusCode: 0)
+        statistics.addTimeout()
+
+        let attributes = statistics.attributes() as NSDictionary
+        store.flush()
+
+        let reloaded = LCNetworkStatistics(keyValueStore: LCKeyValueStore(databasePath: path))
+        XCTAssertEqual(reloaded.attributes() as NSDictionary, attributes)
+        XCTAssertEqual(attributes["total"] as? Int, 6)
+    }
+}
@@ -9,3 +9,15 @@
 #import "AVPaasClient_internal.h"
 #import "AVIMClient_Internal.h"
 #import "LCRTMConnection_Internal.h"
+#import "LCKeyValueStore.h"
+#import "AVCacheManager.h"
+#import "LCDatabase.h"
+#import "LCDatabaseCoordinator.h"
+#import "LCNetworkStatistics.h"
+#import "AVIMMessage_Internal.h"
+#import "AVIMTypedMessage_Internal.h"
+#import "AVIMMessageObject.h"
+#import "AVSubscriber.h"
+#import "LCIMMessageCacheStore.h"
+#import "AVIMDirectCommand+DirectCommandAdditions.h"
+#import "AVIMConversation_Internal.h"
@@ -412,6 +412,139 @@ class RTMConnectionTestCase: RTMBaseTestCase {
         connection.removeDelegator(with: consumer)
         LCRTMConnectionManager.shared().unregister(with: consumer)
     }
+    
+    func testCommandSerializationIntoFramingBuffer() {
+        let outCommand = AVIMGenericCommand()
+        outCommand.cmd = .direct
+        outCommand.peerId = uuid
+        let directCommand = AVIMDirectCommand()
+        directCommand.cid = uuid
+        directCommand.msg = String(repeating: "message", count: 100)
+        outCommand.directMessage = directCommand
+        let reserved = Int(LCRTMWebSocketFrameHeaderReservedLength)
+        let buffer = NSMutableData(length: reserved)!
+        XCTAssertTrue(outCommand.write(to: buffer, offset: UInt(reserved)))
+        XCTAssertEqual(
+            buffer.subdata(with: NSRange(location: reserved, length: buffer.length - reserved)),
+            outCommand.data())
+    }
+    
+    func testUnreadCommandDecodingPerformance() {
+        let unreadCommand = AVIMUnreadCommand()
+        for index in 0..<5000 {
+            let tuple = AVIMUnreadTuple()
+            tuple.cid = String(format: "5c1f3a6b0b6160007f%06d", index)
+            tuple.unread = Int32(index % 100)
+            tuple.mid = uuid
+            tuple.timestamp = 1545000000000 + Int64(index)
+            tuple.from = "client-\(index % 7)"
+            tuple.data_p = "{\"_lctype\":-1,\"_lctext\":\"\(index)\"}"
+            tuple.mentioned = index % 2 == 0
+            unreadCommand.convsArray.add(tuple)
+        }
+        let outCommand = AVIMGenericCommand()
+        outCommand.cmd = .unread
+        outCommand.unreadMessage = unreadCommand
+        let data = outCommand.data()!
+        
+        measure {
+            let inCommand = try? AVIMGenericCommand.parse(from: data)
+            XCTAssertEqual(inCommand?.unreadMessage.convsArray_Count, 5000)
+        }
+    }
+    
+    func testDataMessageBinaryBody() {
+        let body = Data([0x81, 0xA2, 0x6F, 0x70, 0xA6, 0x63, 0x72, 0x65, 0x61, 0x74, 0x65])
+        let binaryMessage = AVIMJsonObjectMessage()
+        binaryMessage.data_p = ""
+        binaryMessage.binaryData = body
+        let jsonMessage = AVIMJsonObjectMessage()
+        jsonMessage.data_p = "{\"op\":\"create\"}"
+        let dataCommand = AVIMDataCommand()
+        dataCommand.msgArray.add(binaryMessage)
+        dataCommand.msgArray.add(jsonMessage)
+        let outCommand = AVIMGenericCommand()
+        outCommand.cmd = .data
+        outCommand.dataMessage = dataCommand
+        
+        let inCommand = try? AVIMGenericCommand.parse(from: outCommand.data()!)
+        let messages = inCommand?.dataMessage.msgArray as? [AVIMJsonObjectMessage]
+        XCTAssertEqual(messages?.count, 2)
+        XCTAssertEqual(messages?.first?.hasBinaryData, true)
+        XCTAssertEqual(messages?.first?.binaryData, body)
+        XCTAssertEqual(messages?.last?.hasBinaryData, false)
+        XCTAssertEqual(messages?.last?.data_p, jsonMessage.data_p)
+        for message in messages ?? [] {
+            XCTAssertEqual(AVSubscriber.dictionary(fromDataMessage: message) as? NSDictionary, ["op": "create"])
+        }
+    }
+    
+    func testTypedMessageBinaryBody() {
+        let attributes: [String: Any] = ["count": 1, "ratio": 0.5, "tags": ["a", "b"], "nested": ["flag": true]]
+        let textMessage = AVIMTextMessage(text: "hello", attributes: attributes)
+        let body = textMessage.messageObject.messagePack()!
+        
+        let message = AVIMTypedMessage(messagePack: body) as? AVIMTextMessage
+        XCTAssertEqual(message?.text, "hello")
+        XCTAssertEqual(message?.attributes as NSDictionary?, attributes as NSDictionary)
+        XCTAssertEqual(message?.contentDeferred, true)
+        XCTAssertNil(AVIMTypedMessage(messagePack: Data([0x81, 0xA2, 0x6F, 0x70, 0xA6, 0x63, 0x72, 0x65, 0x61, 0x74, 0x65])))
+        
+        /* Concurrent readers all get the one rendered content. */
+        let lock = NSLock()
+        var contents: [String] = []
+        DispatchQueue.concurrentPerform(iterations: 8) { (_) in
+            let content = message?.content
+            lock.lock()
+            if let content = content {
+                contents.append(content)
+            }
+            lock.unlock()
+        }
+        XCTAssertEqual(contents.count, 8)
+        XCTAssertEqual(Set(contents).count, 1)
+        XCTAssertEqual(message?.contentDeferred, false)
+        let JSON = try? JSONSerialization.jsonObject(with: contents.first?.data(using: .utf8) ?? Data())
+        XCTAssertEqual(JSON as? NSDictionary, textMessage.messageObject.dictionary() as NSDictionary)
+        
+        /* A copy keeps rendering lazily, and an explicit content wins over rendering. */
+        let copy = AVIMTypedMessage(messagePack: body)?.copy() as? AVIMTextMessage
+        XCTAssertEqual(copy?.contentDeferred, true)
+        XCTAssertEqual(copy?.content, contents.first)
+        let overridden = AVIMTypedMessage(messagePack: body)
+        overridden?.content = "{}"
+        XCTAssertEqual(overridden?.content, "{}")
+    }
+    
+    func testScalarMapStorage() {
+        let map = LCGPBInt32Int64Dictionary()
+        for key in Int32(-500)..<500 {
+            map.setInt64(Int64(key) * 3, forKey: key)
+        }
+        XCTAssertEqual(map.count, 1000)
+        for key in stride(from: Int32(-500), to: 500, by: 2) {
+            map.removeInt64(forKey: key)
+        }
+        XCTAssertEqual(map.count, 500)
+        var value: Int64 = 0
+        XCTAssertFalse(map.getInt64(&value, forKey: -500))
+        XCTAssertTrue(map.getInt64(&value, forKey: -499))
+        XCTAssertEqual(value, -1497)
+        var sum: Int64 = 0
+        map.enumerateKeysAndInt64s { (key, value, _) in
+            XCTAssertEqual(Int64(key) * 3, value)
+            sum += value
+        }
+        XCTAssertEqual(sum, Int64(stride(from: -499, to: 500, by: 2).reduce(0, +) * 3))
+        
+        let copy = map.copy() as! LCGPBInt32Int64Dictionary
+        XCTAssertEqual(copy, map)
+        copy.setInt64(0, forKey: 1)
+        XCTAssertNotEqual(copy, map)
+        map.removeAll()
+        XCTAssertEqual(map.count, 0)
+        XCTAssertEqual(copy.count, 500)
+    }
 }
 
 class RTMConnectionDelegator: NSObject, LCRTMConnectionDelegate {